@@ -9,7 +9,9 @@
 #include <util/strencodings.h>
 #include <util/string.h>
 
+#include <bit>
 #include <cassert>
+#include <cstdint>
 #include <cstring>
 
 #include <limits>
@@ -37,6 +39,28 @@ static const int8_t mapBase58[256] = {
     -1,-1,-1,-1,-1,-1,-1,-1, -1,-1,-1,-1,-1,-1,-1,-1,
 };
 
+/** 58^5, the largest power of 58 that fits a 32-bit limb. */
+static constexpr uint32_t BASE58_LIMB{58 * 58 * 58 * 58 * 58};
+
+/**
+ * Apply "limbs = limbs * multiplier + add" to a number in little-endian limbs
+ * of the given base, adding limbs as needed. limb * multiplier + add must fit
+ * 64 bits.
+ */
+template <uint64_t base>
+static void MulAdd(std::vector<uint32_t>& limbs, uint64_t multiplier, uint64_t add)
+{
+    for (uint32_t& limb : limbs) {
+        add += limb * multiplier;
+        limb = add % base;
+        add /= base;
+    }
+    while (add != 0) {
+        limbs.push_back(add % base);
+        add /= base;
+    }
+}
+
 [[nodiscard]] static bool DecodeBase58(const char* psz, std::vector<unsigned char>& vch, int max_ret_len)
 {
     // Skip leading spaces.
@@ -44,45 +68,44 @@ static const int8_t mapBase58[256] = {
         psz++;
     // Skip and count leading '1's.
     int zeroes = 0;
-    int length = 0;
     while (*psz == '1') {
         zeroes++;
         if (zeroes > max_ret_len) return false;
         psz++;
     }
-    // Allocate enough space in big-endian base256 representation.
-    int size = strlen(psz) * 733 /1000 + 1; // log(58) / log(256), rounded up.
-    std::vector<unsigned char> b256(size);
-    // Process the characters.
+    // The number in 32-bit limbs, least significant first, and its length in bytes.
+    std::vector<uint32_t> limbs;
+    limbs.reserve(strlen(psz) * 733 / 4000 + 1); // log(58) / log(256), rounded up.
+    const auto length = [&] {
+        return limbs.empty() ? 0 : int(4 * limbs.size()) - std::countl_zero(limbs.back()) / 8;
+    };
+    // Process the characters, up to 5 at a time.
     static_assert(std::size(mapBase58) == 256, "mapBase58.size() should be 256"); // guarantee not out of range
     while (*psz && !IsSpace(*psz)) {
-        // Decode base58 character
-        int carry = mapBase58[(uint8_t)*psz];
-        if (carry == -1)  // Invalid b58 character
-            return false;
-        int i = 0;
-        for (std::vector<unsigned char>::reverse_iterator it = b256.rbegin(); (carry != 0 || i < length) && (it != b256.rend()); ++it, ++i) {
-            carry += 58 * (*it);
-            *it = carry % 256;
-            carry /= 256;
+        uint64_t multiplier = 1;
+        uint64_t digits = 0;
+        for (int i = 0; i < 5 && *psz && !IsSpace(*psz); ++i, ++psz) {
+            // Decode base58 character
+            const int digit = mapBase58[(uint8_t)*psz];
+            if (digit == -1) // Invalid b58 character
+                return false;
+            multiplier *= 58;
+            digits = digits * 58 + digit;
         }
-        assert(carry == 0);
-        length = i;
-        if (length + zeroes > max_ret_len) return false;
-        psz++;
+        MulAdd<uint64_t{1} << 32>(limbs, multiplier, digits);
+        if (length() + zeroes > max_ret_len) return false;
     }
     // Skip trailing spaces.
     while (IsSpace(*psz))
         psz++;
     if (*psz != 0)
         return false;
-    // Skip leading zeroes in b256.
-    std::vector<unsigned char>::iterator it = b256.begin() + (size - length);
     // Copy result into output vector.
-    vch.reserve(zeroes + (b256.end() - it));
+    vch.reserve(zeroes + length());
     vch.assign(zeroes, 0x00);
-    while (it != b256.end())
-        vch.push_back(*(it++));
+    for (int i = length() - 1; i >= 0; --i) {
+        vch.push_back(limbs[i / 4] >> (8 * (i % 4)));
+    }
     return true;
 }
 
@@ -90,39 +113,38 @@ std::string EncodeBase58(std::span<const unsigned char> input)
 {
     // Skip & count leading zeroes.
     int zeroes = 0;
-    int length = 0;
     while (input.size() > 0 && input[0] == 0) {
         input = input.subspan(1);
         zeroes++;
     }
-    // Allocate enough space in big-endian base58 representation.
-    int size = input.size() * 138 / 100 + 1; // log(256) / log(58), rounded up.
-    std::vector<unsigned char> b58(size);
-    // Process the bytes.
+    // The number in limbs of 5 base58 digits, least significant first.
+    std::vector<uint32_t> limbs;
+    limbs.reserve(input.size() * 138 / 500 + 1); // log(256) / log(58), rounded up.
+    // Process the bytes, up to 4 at a time, starting with what doesn't fill 4.
     while (input.size() > 0) {
-        int carry = input[0];
-        int i = 0;
-        // Apply "b58 = b58 * 256 + ch".
-        for (std::vector<unsigned char>::reverse_iterator it = b58.rbegin(); (carry != 0 || i < length) && (it != b58.rend()); it++, i++) {
-            carry += 256 * (*it);
-            *it = carry % 58;
-            carry /= 58;
-        }
-
-        assert(carry == 0);
-        length = i;
-        input = input.subspan(1);
+        const size_t bytes = input.size() % 4 ? input.size() % 4 : 4;
+        uint64_t value = 0;
+        for (size_t i = 0; i < bytes; ++i) value = (value << 8) | input[i];
+        MulAdd<BASE58_LIMB>(limbs, uint64_t{1} << (8 * bytes), value);
+        input = input.subspan(bytes);
     }
-    // Skip leading zeroes in base58 result.
-    std::vector<unsigned char>::iterator it = b58.begin() + (size - length);
-    while (it != b58.end() && *it == 0)
-        it++;
-    // Translate the result into a string.
+    // Translate the result into a string, without the leading zeroes of the most significant limb.
     std::string str;
-    str.reserve(zeroes + (b58.end() - it));
+    str.reserve(zeroes + 5 * limbs.size());
     str.assign(zeroes, '1');
-    while (it != b58.end())
-        str += pszBase58[*(it++)];
+    for (auto limb = limbs.rbegin(); limb != limbs.rend(); ++limb) {
+        char digits[5];
+        uint32_t value = *limb;
+        for (int i = 4; i >= 0; --i) {
+            digits[i] = pszBase58[value % 58];
+            value /= 58;
+        }
+        int skip = 0;
+        if (limb == limbs.rbegin()) {
+            while (digits[skip] == '1') skip++;
+        }
+        str.append(digits + skip, 5 - skip);
+    }
     return str;
 }
 
@@ -124,10 +124,40 @@ uint32_t EncodingConstant(Encoding encoding) {
     return encoding == Encoding::BECH32 ? 1 : 0x2bc830a3;
 }
 
+/* For each set bit n in c0, the top 5 bits of c, PolyMod adds {2^n}k(x) (see below). These
+ * constants can be computed using the following Sage code (continuing the code above):
+ *
+ * for i in [1,2,4,8,16]: # Print out {1,2,4,8,16}*(g(x) mod x^6), packed in hex integers.
+ *     v = 0
+ *     for coef in reversed((F.fetch_int(i)*(G % x**6)).coefficients(sparse=True)):
+ *         v = v*32 + coef.integer_representation()
+ *     print("0x%x" % v)
+ *
+ * To add them all at once, POLYMOD_TABLE has their sum for each value of c0. */
+constexpr std::array<uint32_t, 32> GeneratePolyModTable()
+{
+    constexpr uint32_t K[5] = {
+        0x3b6a57b2, //     k(x) = {29}x^5 + {22}x^4 + {20}x^3 + {21}x^2 + {29}x + {18}
+        0x26508e6d, //  {2}k(x) = {19}x^5 +  {5}x^4 +     x^3 +  {3}x^2 + {19}x + {13}
+        0x1ea119fa, //  {4}k(x) = {15}x^5 + {10}x^4 +  {2}x^3 +  {6}x^2 + {15}x + {26}
+        0x3d4233dd, //  {8}k(x) = {30}x^5 + {20}x^4 +  {4}x^3 + {12}x^2 + {30}x + {29}
+        0x2a1462b3, // {16}k(x) = {21}x^5 +     x^4 +  {8}x^3 + {24}x^2 + {21}x + {19}
+    };
+    std::array<uint32_t, 32> table{};
+    for (size_t c0 = 0; c0 < table.size(); ++c0) {
+        for (int n = 0; n < 5; ++n) {
+            if ((c0 >> n) & 1) table[c0] ^= K[n];
+        }
+    }
+    return table;
+}
+constexpr std::array<uint32_t, 32> POLYMOD_TABLE = GeneratePolyModTable();
+
 /** This function will compute what 6 5-bit values to XOR into the last 6 input values, in order to
  *  make the checksum 0. These 6 values are packed together in a single 30-bit integer. The higher
- *  bits correspond to earlier values. */
-uint32_t PolyMod(const data& v)
+ *  bits correspond to earlier values. The input is the expanded HRP, the values and `zeroes`
+ *  zeroes, as in BIP173, but isn't copied into a single list. */
+uint32_t PolyMod(const std::string& hrp, const data& values, size_t zeroes = 0)
 {
     // The input is interpreted as a list of coefficients of a polynomial over F = GF(32), with an
     // implicit 1 in front. If the input is [v0,v1,v2,v3,v4], that polynomial is v(x) =
@@ -175,7 +205,7 @@ uint32_t PolyMod(const data& v)
     // length 1023 and distance 4. See https://en.wikipedia.org/wiki/BCH_code for more details.
 
     uint32_t c = 1;
-    for (const auto v_i : v) {
+    const auto step = [&c](uint8_t v_i) {
         // We want to update `c` to correspond to a polynomial with one extra term. If the initial
         // value of `c` consists of the coefficients of c(x) = f(x) mod g(x), we modify it to
         // correspond to c'(x) = (f(x) * x + v_i) mod g(x), where v_i is the next input to
@@ -196,22 +226,17 @@ uint32_t PolyMod(const data& v)
         // Then compute c1*x^5 + c2*x^4 + c3*x^3 + c4*x^2 + c5*x + v_i:
         c = ((c & 0x1ffffff) << 5) ^ v_i;
 
-        // Finally, for each set bit n in c0, conditionally add {2^n}k(x). These constants can be
-        // computed using the following Sage code (continuing the code above):
-        //
-        // for i in [1,2,4,8,16]: # Print out {1,2,4,8,16}*(g(x) mod x^6), packed in hex integers.
-        //     v = 0
-        //     for coef in reversed((F.fetch_int(i)*(G % x**6)).coefficients(sparse=True)):
-        //         v = v*32 + coef.integer_representation()
-        //     print("0x%x" % v)
-        //
-        if (c0 & 1)  c ^= 0x3b6a57b2; //     k(x) = {29}x^5 + {22}x^4 + {20}x^3 + {21}x^2 + {29}x + {18}
-        if (c0 & 2)  c ^= 0x26508e6d; //  {2}k(x) = {19}x^5 +  {5}x^4 +     x^3 +  {3}x^2 + {19}x + {13}
-        if (c0 & 4)  c ^= 0x1ea119fa; //  {4}k(x) = {15}x^5 + {10}x^4 +  {2}x^3 +  {6}x^2 + {15}x + {26}
-        if (c0 & 8)  c ^= 0x3d4233dd; //  {8}k(x) = {30}x^5 + {20}x^4 +  {4}x^3 + {12}x^2 + {30}x + {29}
-        if (c0 & 16) c ^= 0x2a1462b3; // {16}k(x) = {21}x^5 +     x^4 +  {8}x^3 + {24}x^2 + {21}x + {19}
-
-    }
+        // Finally, for each set bit n in c0, conditionally add {2^n}k(x):
+        c ^= POLYMOD_TABLE[c0];
+    };
+
+    // The HRP expanded into the high bits of each character, a zero, and the low bits of each
+    // character, followed by the values and the zeroes.
+    for (const char ch : hrp) step(ch >> 5);
+    step(0);
+    for (const char ch : hrp) step(ch & 0x1f);
+    for (const uint8_t v_i : values) step(v_i);
+    for (size_t i = 0; i < zeroes; ++i) step(0);
     return c;
 }
 
@@ -308,21 +333,6 @@ bool CheckCharacters(const std::string& str, std::vector<int>& errors)
     return errors.empty();
 }
 
-std::vector<unsigned char> PreparePolynomialCoefficients(const std::string& hrp, const data& values)
-{
-    data ret;
-    ret.reserve(hrp.size() + 1 + hrp.size() + values.size() + CHECKSUM_SIZE);
-
-    /** Expand a HRP for use in checksum computation. */
-    for (size_t i = 0; i < hrp.size(); ++i) ret.push_back(hrp[i] >> 5);
-    ret.push_back(0);
-    for (size_t i = 0; i < hrp.size(); ++i) ret.push_back(hrp[i] & 0x1f);
-
-    ret.insert(ret.end(), values.begin(), values.end());
-
-    return ret;
-}
-
 /** Verify a checksum. */
 Encoding VerifyChecksum(const std::string& hrp, const data& values)
 {
@@ -331,8 +341,7 @@ Encoding VerifyChecksum(const std::string& hrp, const data& values)
     // list of values would result in a new valid list. For that reason, Bech32 requires the
     // resulting checksum to be 1 instead. In Bech32m, this constant was amended. See
     // https://gist.github.com/sipa/14c248c288c3880a3b191f978a34508e for details.
-    auto enc = PreparePolynomialCoefficients(hrp, values);
-    const uint32_t check = PolyMod(enc);
+    const uint32_t check = PolyMod(hrp, values);
     if (check == EncodingConstant(Encoding::BECH32)) return Encoding::BECH32;
     if (check == EncodingConstant(Encoding::BECH32M)) return Encoding::BECH32M;
     return Encoding::INVALID;
@@ -341,9 +350,7 @@ Encoding VerifyChecksum(const std::string& hrp, const data& values)
 /** Create a checksum. */
 data CreateChecksum(Encoding encoding, const std::string& hrp, const data& values)
 {
-    auto enc = PreparePolynomialCoefficients(hrp, values);
-    enc.insert(enc.end(), CHECKSUM_SIZE, 0x00);
-    uint32_t mod = PolyMod(enc) ^ EncodingConstant(encoding); // Determine what to XOR into those 6 zeroes.
+    uint32_t mod = PolyMod(hrp, values, CHECKSUM_SIZE) ^ EncodingConstant(encoding); // Determine what to XOR into those 6 zeroes.
     data ret(CHECKSUM_SIZE);
     for (size_t i = 0; i < CHECKSUM_SIZE; ++i) {
         // Convert the 5-bit groups in mod to checksum values.
@@ -447,8 +454,7 @@ std::pair<std::string, std::vector<int>> LocateErrors(const std::string& str, Ch
         std::vector<int> possible_errors;
         // Recall that (expanded hrp + values) is interpreted as a list of coefficients of a polynomial
         // over GF(32). PolyMod computes the "remainder" of this polynomial modulo the generator G(x).
-        auto enc = PreparePolynomialCoefficients(hrp, values);
-        uint32_t residue = PolyMod(enc) ^ EncodingConstant(encoding);
+        uint32_t residue = PolyMod(hrp, values) ^ EncodingConstant(encoding);
 
         // All valid codewords should be multiples of G(x), so this remainder (after XORing with the encoding
         // constant) should be 0 - hence 0 indicates there are no errors present.
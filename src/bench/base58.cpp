@@ -41,6 +41,17 @@ static void Base58CheckEncode(benchmark::Bench& bench)
 }
 
 
+// As for an extended key
+static void Base58CheckEncode78(benchmark::Bench& bench)
+{
+    std::array<unsigned char, 78> buff;
+    for (size_t i = 0; i < buff.size(); ++i) buff[i] = i * 37 + 11;
+    bench.batch(buff.size()).unit("byte").run([&] {
+        EncodeBase58Check(buff);
+    });
+}
+
+
 static void Base58Decode(benchmark::Bench& bench)
 {
     const char* addr = "17VZNX1SN5NtKa8UQFxwQbFeFc3iqRYhem";
@@ -53,4 +64,5 @@ static void Base58Decode(benchmark::Bench& bench)
 
 BENCHMARK(Base58Encode, benchmark::PriorityLevel::HIGH);
 BENCHMARK(Base58CheckEncode, benchmark::PriorityLevel::HIGH);
+BENCHMARK(Base58CheckEncode78, benchmark::PriorityLevel::HIGH);
 BENCHMARK(Base58Decode, benchmark::PriorityLevel::HIGH);
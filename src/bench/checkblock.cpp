@@ -8,10 +8,13 @@
 #include <common/args.h>
 #include <consensus/validation.h>
 #include <primitives/block.h>
+#include <primitives/block_view.h>
 #include <primitives/transaction.h>
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
+#include <support/allocators/chunk_arena.h>
+#include <tinyformat.h>
 #include <util/chaintype.h>
 #include <validation.h>
 
@@ -19,46 +22,115 @@
 #include <cstddef>
 #include <memory>
 #include <optional>
+#include <string>
 #include <vector>
 
 // These are the two major time-sinks which happen after we have fully received
 // a block off the wire, but before we can relay the block on to peers using
-// compact block relay.
+// compact block relay. Each is measured with the transactions deserialized as
+// usual, and in an arena (see TransactionSerParams::arena), and reports the
+// heap allocations of the deserialized block.
 
-static void DeserializeBlockTest(benchmark::Bench& bench)
+/** Heap allocations held by a deserialized block, other than the CBlock */
+static size_t CountAllocations(const CBlock& block, const ChunkArena* arena)
+{
+    const auto owns{[](const CScript& script) { return script.allocated_memory() > 0 && !script.is_borrowed(); }};
+    size_t allocations{arena ? arena->ChunkCount() : block.vtx.size()};
+    allocations += block.vtx.capacity() > 0;
+    for (const auto& tx : block.vtx) {
+        allocations += (tx->vin.capacity() > 0) + (tx->vout.capacity() > 0);
+        for (const auto& txin : tx->vin) {
+            allocations += owns(txin.scriptSig) + (txin.scriptWitness.stack.capacity() > 0);
+            for (const auto& item : txin.scriptWitness.stack) allocations += item.capacity() > 0;
+        }
+        for (const auto& txout : tx->vout) allocations += owns(txout.scriptPubKey);
+    }
+    return allocations;
+}
+
+static void DeserializeBlock(benchmark::Bench& bench, const std::string& name, bool use_arena, const CChainParams* check_params)
 {
     DataStream stream(benchmark::data::block413567);
     std::byte a{0};
     stream.write({&a, 1}); // Prevent compaction
 
-    bench.unit("block").run([&] {
-        CBlock block;
-        stream >> TX_WITH_WITNESS(block);
+    const auto deserialize{[&](CBlock& block, std::optional<ChunkArena>& arena) {
+        if (use_arena) arena.emplace(TX_ARENA_CHUNK_SIZE);
+        const TransactionSerParams params{.allow_witness = true, .arena = arena ? &*arena : nullptr};
+        stream >> params(block);
         bool rewound = stream.Rewind(benchmark::data::block413567.size());
         assert(rewound);
+    }};
+    {
+        CBlock block;
+        std::optional<ChunkArena> arena;
+        deserialize(block, arena);
+        bench.name(strprintf("%s with %u heap allocations per block", name, CountAllocations(block, arena ? &*arena : nullptr)));
+    }
+
+    bench.unit("block").run([&] {
+        CBlock block; // Note that CBlock caches its checked state, so we need to recreate it here
+        std::optional<ChunkArena> arena;
+        deserialize(block, arena);
+
+        if (check_params) {
+            BlockValidationState validationState;
+            bool checked = CheckBlock(block, validationState, check_params->GetConsensus());
+            assert(checked);
+        }
     });
 }
 
+static void DeserializeBlockTest(benchmark::Bench& bench)
+{
+    DeserializeBlock(bench, __func__, /*use_arena=*/false, /*check_params=*/nullptr);
+}
+
+static void DeserializeBlockArenaTest(benchmark::Bench& bench)
+{
+    DeserializeBlock(bench, __func__, /*use_arena=*/true, /*check_params=*/nullptr);
+}
+
 static void DeserializeAndCheckBlockTest(benchmark::Bench& bench)
 {
-    DataStream stream(benchmark::data::block413567);
-    std::byte a{0};
-    stream.write({&a, 1}); // Prevent compaction
+    ArgsManager bench_args;
+    const auto chainParams = CreateChainParams(bench_args, ChainType::MAIN);
+    DeserializeBlock(bench, __func__, /*use_arena=*/false, chainParams.get());
+}
 
+static void DeserializeAndCheckBlockArenaTest(benchmark::Bench& bench)
+{
     ArgsManager bench_args;
     const auto chainParams = CreateChainParams(bench_args, ChainType::MAIN);
+    DeserializeBlock(bench, __func__, /*use_arena=*/true, chainParams.get());
+}
 
+// The txids of a block, as needed by the txindex and getblock with verbosity 1,
+// from the block deserialized and from a BlockView of it.
+static void BlockTxidsTest(benchmark::Bench& bench)
+{
     bench.unit("block").run([&] {
-        CBlock block; // Note that CBlock caches its checked state, so we need to recreate it here
-        stream >> TX_WITH_WITNESS(block);
-        bool rewound = stream.Rewind(benchmark::data::block413567.size());
-        assert(rewound);
+        CBlock block;
+        SpanReader{benchmark::data::block413567} >> TX_WITH_WITNESS(block);
+        std::vector<Txid> txids;
+        txids.reserve(block.vtx.size());
+        for (const auto& tx : block.vtx) txids.push_back(tx->GetHash());
+        assert(txids.size() == 1557);
+    });
+}
 
-        BlockValidationState validationState;
-        bool checked = CheckBlock(block, validationState, chainParams->GetConsensus());
-        assert(checked);
+static void BlockViewTxidsTest(benchmark::Bench& bench)
+{
+    bench.unit("block").run([&] {
+        const BlockView view{benchmark::data::block413567};
+        const std::vector<Txid> txids{view.GetTxids()};
+        assert(txids.size() == 1557);
     });
 }
 
 BENCHMARK(DeserializeBlockTest, benchmark::PriorityLevel::HIGH);
+BENCHMARK(DeserializeBlockArenaTest, benchmark::PriorityLevel::HIGH);
 BENCHMARK(DeserializeAndCheckBlockTest, benchmark::PriorityLevel::HIGH);
+BENCHMARK(DeserializeAndCheckBlockArenaTest, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockTxidsTest, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockViewTxidsTest, benchmark::PriorityLevel::HIGH);
@@ -11,6 +11,7 @@
 #include <crypto/sha3.h>
 #include <crypto/sha512.h>
 #include <crypto/siphash.h>
+#include <hash.h>
 #include <random.h>
 #include <span.h>
 #include <tinyformat.h>
@@ -181,6 +182,40 @@ static void SHA256D64_1024_SHANI(benchmark::Bench& bench)
     SHA256AutoDetect();
 }
 
+/* Messages of about the size of a transaction, as when computing the txids of a block */
+static void SHA256DMulti_250b(benchmark::Bench& bench, sha256_implementation::UseImplementation use_implementation, const char* name)
+{
+    bench.name(strprintf("%s using the '%s' SHA256 implementation", name, SHA256AutoDetect(use_implementation)));
+    std::vector<uint8_t> in(250 * 1024, 0);
+    std::vector<std::span<const unsigned char>> pieces;
+    for (size_t i = 0; i < 1024; ++i) pieces.emplace_back(in.data() + 250 * i, 250);
+    std::vector<SHA256Message> messages;
+    for (const auto& piece : pieces) messages.emplace_back(&piece, 1);
+    std::vector<uint8_t> out(32 * 1024);
+    bench.batch(in.size()).unit("byte").run([&] {
+        SHA256DMulti(out.data(), messages);
+    });
+    SHA256AutoDetect();
+}
+
+static void SHA256DMulti_250b_STANDARD(benchmark::Bench& bench) { SHA256DMulti_250b(bench, sha256_implementation::STANDARD, __func__); }
+static void SHA256DMulti_250b_SSE4(benchmark::Bench& bench) { SHA256DMulti_250b(bench, sha256_implementation::USE_SSE4, __func__); }
+static void SHA256DMulti_250b_AVX2(benchmark::Bench& bench) { SHA256DMulti_250b(bench, sha256_implementation::USE_SSE4_AND_AVX2, __func__); }
+static void SHA256DMulti_250b_SHANI(benchmark::Bench& bench) { SHA256DMulti_250b(bench, sha256_implementation::USE_SSE4_AND_SHANI, __func__); }
+
+/* The same messages hashed one at a time, for comparison */
+static void SHA256D_250b(benchmark::Bench& bench)
+{
+    bench.name(strprintf("%s using the '%s' SHA256 implementation", __func__, SHA256AutoDetect()));
+    std::vector<uint8_t> in(250 * 1024, 0);
+    std::vector<uint8_t> out(32 * 1024);
+    bench.batch(in.size()).unit("byte").run([&] {
+        for (size_t i = 0; i < 1024; ++i) {
+            CHash256().Write(std::span{in}.subspan(250 * i, 250)).Finalize(std::span{out}.subspan(32 * i, 32));
+        }
+    });
+}
+
 static void SHA512(benchmark::Bench& bench)
 {
     uint8_t hash[CSHA512::OUTPUT_SIZE];
@@ -278,6 +313,11 @@ BENCHMARK(SHA256D64_1024_STANDARD, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256D64_1024_SSE4, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256D64_1024_AVX2, benchmark::PriorityLevel::HIGH);
 BENCHMARK(SHA256D64_1024_SHANI, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SHA256DMulti_250b_STANDARD, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SHA256DMulti_250b_SSE4, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SHA256DMulti_250b_AVX2, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SHA256DMulti_250b_SHANI, benchmark::PriorityLevel::HIGH);
+BENCHMARK(SHA256D_250b, benchmark::PriorityLevel::HIGH);
 
 BENCHMARK(MuHash, benchmark::PriorityLevel::HIGH);
 BENCHMARK(MuHashMul, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,126 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <dbtrace.h>
+#include <dbwrapper.h>
+#include <kvstore.h>
+#include <random.h>
+#include <test/util/setup_common.h>
+#include <uint256.h>
+#include <util/fs.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// Replays of recorded database traces against -dbprofile settings: a
+// write-heavy trace, like that of the chainstate, and a read-heavy one, like
+// that of an index looked up by RPCs.
+
+using Key = std::pair<uint8_t, uint256>;
+
+static constexpr size_t CACHE_BYTES{8 << 20};
+static constexpr size_t TRACE_KEYS{20'000};
+static constexpr size_t TRACE_BATCH_KEYS{2'000};
+
+/** Batches of new keys, erasing the oldest ones, with reads of recent keys in between */
+static void WriteHeavyWorkload(CDBWrapper& db, FastRandomContext& rng)
+{
+    std::deque<Key> keys;
+    for (size_t batches{0}; batches < 4 * TRACE_KEYS / TRACE_BATCH_KEYS; ++batches) {
+        CDBBatch batch{db};
+        for (size_t i{0}; i < TRACE_BATCH_KEYS; ++i) {
+            batch.Write(keys.emplace_back(uint8_t{'C'}, rng.rand256()), rng.rand256());
+        }
+        for (; keys.size() > TRACE_KEYS; keys.pop_front()) batch.Erase(keys.front());
+        db.WriteBatch(batch);
+        for (size_t i{0}; i < TRACE_BATCH_KEYS / 4; ++i) {
+            (void)db.Exists(keys[keys.size() - 1 - rng.randrange(TRACE_BATCH_KEYS)]);
+        }
+    }
+}
+
+/** One batch of keys, then lookups of keys that are mostly missing, and a few scans */
+static void ReadHeavyWorkload(CDBWrapper& db, FastRandomContext& rng)
+{
+    std::vector<Key> keys;
+    CDBBatch batch{db};
+    for (size_t i{0}; i < TRACE_KEYS; ++i) {
+        batch.Write(keys.emplace_back(uint8_t{'t'}, rng.rand256()), std::vector<unsigned char>(100));
+    }
+    db.WriteBatch(batch);
+    for (size_t i{0}; i < 5 * TRACE_KEYS; ++i) {
+        (void)db.Exists(rng.randbool() ? keys[rng.randrange(keys.size())] : Key{uint8_t{'t'}, rng.rand256()});
+    }
+    for (size_t i{0}; i < 10; ++i) {
+        std::unique_ptr<CDBIterator> it{db.NewIterator()};
+        it->Seek(keys[rng.randrange(keys.size())]);
+        for (size_t n{0}; n < 100 && it->Valid(); ++n) it->Next();
+    }
+}
+
+static std::vector<DBTraceOp> RecordTrace(const BasicTestingSetup& setup, void (*workload)(CDBWrapper&, FastRandomContext&))
+{
+    DBOptions options;
+    options.trace_path = setup.m_path_root / "workload.dbtrace";
+    {
+        CDBWrapper db{DBParams{
+            .path = setup.m_path_root / "recorded",
+            .cache_bytes = CACHE_BYTES,
+            .wipe_data = true,
+            .obfuscate = true,
+            .options = options}};
+        FastRandomContext rng{/*fDeterministic=*/true};
+        workload(db, rng);
+    }
+    return ReadDBTrace(options.trace_path);
+}
+
+static void DBReplayTrace(benchmark::Bench& bench, void (*workload)(CDBWrapper&, FastRandomContext&), const DBOptions& profile)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>()};
+    const auto trace{RecordTrace(*testing_setup, workload)};
+    bench.batch(trace.size()).unit("op").run([&] {
+        const auto store{OpenLevelDB(DBParams{
+            .path = testing_setup->m_path_root / "replayed",
+            .cache_bytes = CACHE_BYTES,
+            .wipe_data = true,
+            .options = profile})};
+        ReplayDBTrace(*store, trace);
+    });
+}
+
+/** -dbprofile=<db>:blockcache=10,writebuffer=16,bloombits=0 */
+static DBOptions WriteProfile()
+{
+    DBOptions options;
+    options.block_cache_percent = 10;
+    options.write_buffer_size = 16 << 20;
+    options.bloom_bits = 0;
+    return options;
+}
+
+/** -dbprofile=<db>:blockcache=90,bloombits=16,blocksize=16 */
+static DBOptions ReadProfile()
+{
+    DBOptions options;
+    options.block_cache_percent = 90;
+    options.bloom_bits = 16;
+    options.block_size = 16 << 10;
+    return options;
+}
+
+static void DBReplayWriteHeavyDefault(benchmark::Bench& bench) { DBReplayTrace(bench, WriteHeavyWorkload, {}); }
+static void DBReplayWriteHeavyWriteProfile(benchmark::Bench& bench) { DBReplayTrace(bench, WriteHeavyWorkload, WriteProfile()); }
+static void DBReplayReadHeavyDefault(benchmark::Bench& bench) { DBReplayTrace(bench, ReadHeavyWorkload, {}); }
+static void DBReplayReadHeavyReadProfile(benchmark::Bench& bench) { DBReplayTrace(bench, ReadHeavyWorkload, ReadProfile()); }
+
+BENCHMARK(DBReplayWriteHeavyDefault, benchmark::PriorityLevel::HIGH);
+BENCHMARK(DBReplayWriteHeavyWriteProfile, benchmark::PriorityLevel::HIGH);
+BENCHMARK(DBReplayReadHeavyDefault, benchmark::PriorityLevel::HIGH);
+BENCHMARK(DBReplayReadHeavyReadProfile, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,126 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <dbwrapper.h>
+#include <random.h>
+#include <test/util/setup_common.h>
+#include <uint256.h>
+#include <util/check.h>
+#include <util/fs.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// The storage engines on coins-like entries: the keys are a prefix, a txid and
+// an output index, and the values are about the size of a compressed P2WPKH
+// output, as in the chainstate database.
+
+using CoinKey = std::pair<uint8_t, std::pair<uint256, uint32_t>>;
+using CoinValue = std::pair<uint256, uint64_t>;
+
+static constexpr size_t COINS{100'000};
+static constexpr size_t BATCH_COINS{10'000};
+
+static CoinKey RandomKey(FastRandomContext& rng)
+{
+    return {uint8_t{'C'}, {rng.rand256(), uint32_t(rng.randrange(4))}};
+}
+
+static CoinValue RandomValue(FastRandomContext& rng)
+{
+    return {rng.rand256(), rng.rand64()};
+}
+
+static std::unique_ptr<CDBWrapper> MakeCoinsDB(const BasicTestingSetup& setup, DBEngine engine)
+{
+    return std::make_unique<CDBWrapper>(DBParams{
+        .path = setup.m_path_root / "coins",
+        .cache_bytes = 8 << 20,
+        .wipe_data = true,
+        .obfuscate = true,
+        .options = {.engine = engine}});
+}
+
+static std::vector<CoinKey> FillCoinsDB(CDBWrapper& db, FastRandomContext& rng)
+{
+    std::vector<CoinKey> keys;
+    CDBBatch batch{db};
+    for (size_t i{0}; i < COINS; ++i) {
+        batch.Write(keys.emplace_back(RandomKey(rng)), RandomValue(rng));
+    }
+    db.WriteBatch(batch);
+    return keys;
+}
+
+/** Each batch adds coins and, once there are COINS, erases as many of the oldest, like flushes of connected blocks */
+static void DBWriteCoins(benchmark::Bench& bench, DBEngine engine)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>()};
+    const auto db{MakeCoinsDB(*testing_setup, engine)};
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::deque<CoinKey> unspent;
+    bench.batch(BATCH_COINS).unit("coin").run([&] {
+        CDBBatch batch{*db};
+        for (size_t i{0}; i < BATCH_COINS; ++i) {
+            batch.Write(unspent.emplace_back(RandomKey(rng)), RandomValue(rng));
+        }
+        for (; unspent.size() > COINS; unspent.pop_front()) {
+            batch.Erase(unspent.front());
+        }
+        db->WriteBatch(batch);
+    });
+}
+
+static void DBReadCoins(benchmark::Bench& bench, DBEngine engine)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>()};
+    const auto db{MakeCoinsDB(*testing_setup, engine)};
+    FastRandomContext rng{/*fDeterministic=*/true};
+    const auto keys{FillCoinsDB(*db, rng)};
+    bench.unit("coin").run([&] {
+        CoinValue value;
+        Assert(db->Read(keys[rng.randrange(keys.size())], value));
+        ankerl::nanobench::doNotOptimizeAway(value);
+    });
+}
+
+static void DBIterateCoins(benchmark::Bench& bench, DBEngine engine)
+{
+    const auto testing_setup{MakeNoLogFileContext<const BasicTestingSetup>()};
+    const auto db{MakeCoinsDB(*testing_setup, engine)};
+    FastRandomContext rng{/*fDeterministic=*/true};
+    FillCoinsDB(*db, rng);
+    bench.batch(COINS).unit("coin").run([&] {
+        std::unique_ptr<CDBIterator> it{db->NewIterator()};
+        size_t count{0};
+        for (it->Seek(uint8_t{'C'}); it->Valid(); it->Next()) {
+            CoinKey key;
+            CoinValue value;
+            if (!it->GetKey(key) || key.first != 'C') break;
+            Assert(it->GetValue(value));
+            ++count;
+        }
+        assert(count == COINS);
+    });
+}
+
+static void DBWriteCoinsLevelDB(benchmark::Bench& bench) { DBWriteCoins(bench, DBEngine::LEVELDB); }
+static void DBWriteCoinsLogDB(benchmark::Bench& bench) { DBWriteCoins(bench, DBEngine::LOGDB); }
+static void DBReadCoinsLevelDB(benchmark::Bench& bench) { DBReadCoins(bench, DBEngine::LEVELDB); }
+static void DBReadCoinsLogDB(benchmark::Bench& bench) { DBReadCoins(bench, DBEngine::LOGDB); }
+static void DBIterateCoinsLevelDB(benchmark::Bench& bench) { DBIterateCoins(bench, DBEngine::LEVELDB); }
+static void DBIterateCoinsLogDB(benchmark::Bench& bench) { DBIterateCoins(bench, DBEngine::LOGDB); }
+
+BENCHMARK(DBWriteCoinsLevelDB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(DBWriteCoinsLogDB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(DBReadCoinsLevelDB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(DBReadCoinsLogDB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(DBIterateCoinsLevelDB, benchmark::PriorityLevel::HIGH);
+BENCHMARK(DBIterateCoinsLogDB, benchmark::PriorityLevel::HIGH);
@@ -10,7 +10,7 @@
 #include <utility>
 #include <vector>
 
-static GCSFilter::ElementSet GenerateGCSTestElements()
+static GCSFilter::ElementSet GenerateGCSTestElements(int count = 100000)
 {
     GCSFilter::ElementSet elements;
 
@@ -18,7 +18,7 @@ static GCSFilter::ElementSet GenerateGCSTestElements()
     // with at least 100,000 elements results in benchmarks that have the same
     // ns/op. This makes it easy to reason about how long (in nanoseconds) a single
     // filter element takes to process.
-    for (int i = 0; i < 100000; ++i) {
+    for (int i = 0; i < count; ++i) {
         GCSFilter::Element element(32);
         element[0] = static_cast<unsigned char>(i);
         element[1] = static_cast<unsigned char>(i >> 8);
@@ -45,7 +45,20 @@ static void GCSFilterConstruct(benchmark::Bench& bench)
     auto elements = GenerateGCSTestElements();
 
     uint64_t siphash_k0 = 0;
-    bench.run([&]{
+    bench.batch(elements.size()).unit("element").run([&]{
+        GCSFilter filter({siphash_k0, 0, BASIC_FILTER_P, BASIC_FILTER_M}, elements);
+
+        siphash_k0++;
+    });
+}
+
+// Build a filter the size of a typical full block's.
+static void GCSFilterConstructBlockSized(benchmark::Bench& bench)
+{
+    auto elements = GenerateGCSTestElements(5000);
+
+    uint64_t siphash_k0 = 0;
+    bench.batch(elements.size()).unit("element").run([&]{
         GCSFilter filter({siphash_k0, 0, BASIC_FILTER_P, BASIC_FILTER_M}, elements);
 
         siphash_k0++;
@@ -59,7 +72,7 @@ static void GCSFilterDecode(benchmark::Bench& bench)
     GCSFilter filter({0, 0, BASIC_FILTER_P, BASIC_FILTER_M}, elements);
     auto encoded = filter.GetEncoded();
 
-    bench.run([&] {
+    bench.batch(elements.size()).unit("element").run([&] {
         GCSFilter filter({0, 0, BASIC_FILTER_P, BASIC_FILTER_M}, encoded, /*skip_decode_check=*/false);
     });
 }
@@ -86,8 +99,29 @@ static void GCSFilterMatch(benchmark::Bench& bench)
         filter.Match(GCSFilter::Element());
     });
 }
+
+// Match a wallet's worth of scripts, none of which are in the filter, so that the whole filter is decoded.
+static void GCSFilterMatchAny(benchmark::Bench& bench)
+{
+    auto elements = GenerateGCSTestElements();
+
+    GCSFilter filter({0, 0, BASIC_FILTER_P, BASIC_FILTER_M}, elements);
+    GCSFilter::ElementSet queries;
+    for (int i = 0; i < 1000; ++i) {
+        GCSFilter::Element query(22);
+        query[0] = static_cast<unsigned char>(i);
+        query[1] = static_cast<unsigned char>(i >> 8);
+        queries.insert(std::move(query));
+    }
+
+    bench.batch(elements.size()).unit("element").run([&] {
+        filter.MatchAny(queries);
+    });
+}
 BENCHMARK(GCSBlockFilterGetHash, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterConstruct, benchmark::PriorityLevel::HIGH);
+BENCHMARK(GCSFilterConstructBlockSized, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterDecode, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterDecodeSkipCheck, benchmark::PriorityLevel::HIGH);
 BENCHMARK(GCSFilterMatch, benchmark::PriorityLevel::HIGH);
+BENCHMARK(GCSFilterMatchAny, benchmark::PriorityLevel::HIGH);
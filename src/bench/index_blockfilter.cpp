@@ -28,7 +28,7 @@
 using namespace util::hex_literals;
 
 // Very simple block filter index sync benchmark, only using coinbase outputs.
-static void BlockFilterIndexSync(benchmark::Bench& bench)
+static void BlockFilterIndexSync(benchmark::Bench& bench, int workers)
 {
     const auto test_setup = MakeNoLogFileContext<TestChain100Setup>();
 
@@ -46,6 +46,7 @@ static void BlockFilterIndexSync(benchmark::Bench& bench)
     bench.minEpochIterations(5).run([&] {
         BlockFilterIndex filter_index(interfaces::MakeChain(test_setup->m_node), BlockFilterType::BASIC,
                                       /*n_cache_size=*/0, /*f_memory=*/false, /*f_wipe=*/true);
+        filter_index.SetSyncWorkers(workers);
         assert(filter_index.Init());
         assert(!filter_index.BlockUntilSyncedToCurrentChain());
         filter_index.Sync();
@@ -56,4 +57,8 @@ static void BlockFilterIndexSync(benchmark::Bench& bench)
     });
 }
 
-BENCHMARK(BlockFilterIndexSync, benchmark::PriorityLevel::HIGH);
+static void BlockFilterIndexSyncSerial(benchmark::Bench& bench) { BlockFilterIndexSync(bench, /*workers=*/0); }
+static void BlockFilterIndexSyncParallel(benchmark::Bench& bench) { BlockFilterIndexSync(bench, DEFAULT_INDEX_WORKERS); }
+
+BENCHMARK(BlockFilterIndexSyncSerial, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockFilterIndexSyncParallel, benchmark::PriorityLevel::HIGH);
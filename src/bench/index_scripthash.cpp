@@ -0,0 +1,99 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or https://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <bench/bench.h>
+#include <chain.h>
+#include <index/base.h>
+#include <index/scripthashindex.h>
+#include <interfaces/chain.h>
+#include <primitives/transaction.h>
+#include <pubkey.h>
+#include <script/script.h>
+#include <sync.h>
+#include <test/util/setup_common.h>
+#include <uint256.h>
+#include <util/strencodings.h>
+#include <util/time.h>
+#include <validation.h>
+
+#include <cassert>
+#include <memory>
+#include <optional>
+#include <vector>
+
+using namespace util::hex_literals;
+
+static constexpr int CHAIN_SIZE{600};
+
+static CScript BenchScript()
+{
+    CPubKey pubkey{"02ed26169896db86ced4cbb7b3ecef9859b5952825adbeab998fb5b307e54949c9"_hex_u8};
+    return GetScriptForDestination(WitnessV0KeyHash(pubkey));
+}
+
+static std::unique_ptr<TestChain100Setup> MakeChain()
+{
+    auto test_setup = MakeNoLogFileContext<TestChain100Setup>();
+    const CScript script{BenchScript()};
+    std::vector<CMutableTransaction> noTxns;
+    for (int i = 0; i < CHAIN_SIZE - 100; i++) {
+        test_setup->CreateAndProcessBlock(noTxns, script);
+        SetMockTime(GetTime() + 1);
+    }
+    assert(WITH_LOCK(::cs_main, return test_setup->m_node.chainman->ActiveHeight() == CHAIN_SIZE));
+    return test_setup;
+}
+
+// Simple script hash index sync benchmark, only using coinbase outputs.
+static void ScriptHashIndexSync(benchmark::Bench& bench)
+{
+    const auto test_setup = MakeChain();
+
+    bench.minEpochIterations(5).run([&] {
+        ScriptHashIndex index(interfaces::MakeChain(test_setup->m_node), /*n_cache_size=*/0, /*f_memory=*/false, /*f_wipe=*/true);
+        assert(index.Init());
+        assert(!index.BlockUntilSyncedToCurrentChain());
+        index.Sync();
+
+        IndexSummary summary = index.GetSummary();
+        assert(summary.synced);
+        assert(summary.best_block_hash == WITH_LOCK(::cs_main, return test_setup->m_node.chainman->ActiveTip()->GetBlockHash()));
+    });
+}
+
+// Page through the history and the unspent outputs of a script with CHAIN_SIZE - 100 entries.
+static void ScriptHashIndexLookup(benchmark::Bench& bench)
+{
+    static constexpr size_t PAGE_SIZE{100};
+    const auto test_setup = MakeChain();
+    ScriptHashIndex index(interfaces::MakeChain(test_setup->m_node), /*n_cache_size=*/1 << 20, /*f_memory=*/false, /*f_wipe=*/true);
+    assert(index.Init());
+    index.Sync();
+    const uint256 script_hash{ComputeScriptHash(BenchScript())};
+
+    bench.batch(2 * (CHAIN_SIZE - 100)).unit("entry").run([&] {
+        size_t found{0};
+        std::optional<ScriptHistoryPosition> after_pos;
+        while (true) {
+            const auto page{index.FindHistory(script_hash, after_pos, PAGE_SIZE)};
+            if (page->empty()) break;
+            found += page->size();
+            after_pos = page->back().pos;
+        }
+        std::optional<COutPoint> after_outpoint;
+        while (true) {
+            const auto page{index.FindUnspent(script_hash, after_outpoint, PAGE_SIZE)};
+            if (page->empty()) break;
+            found += page->size();
+            after_outpoint = page->back().outpoint;
+        }
+        assert(found == 2 * (CHAIN_SIZE - 100));
+    });
+
+    index.Stop();
+}
+
+BENCHMARK(ScriptHashIndexSync, benchmark::PriorityLevel::HIGH);
+BENCHMARK(ScriptHashIndexLookup, benchmark::PriorityLevel::HIGH);
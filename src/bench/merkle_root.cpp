@@ -3,10 +3,16 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <bench/data/block413567.raw.h>
 #include <consensus/merkle.h>
+#include <primitives/block.h>
+#include <primitives/block_view.h>
 #include <random.h>
+#include <serialize.h>
+#include <streams.h>
 #include <uint256.h>
 
+#include <cassert>
 #include <vector>
 
 static void MerkleRoot(benchmark::Bench& bench)
@@ -24,4 +30,28 @@ static void MerkleRoot(benchmark::Bench& bench)
     });
 }
 
+// The merkle roots of a block from its bytes, with the txids computed as when
+// it is deserialized, or several at a time from a BlockView
+
+static void BlockMerkleRoots(benchmark::Bench& bench)
+{
+    bench.unit("block").run([&] {
+        CBlock block;
+        SpanReader{benchmark::data::block413567} >> TX_WITH_WITNESS(block);
+        assert(BlockMerkleRoot(block) == block.hashMerkleRoot);
+        ankerl::nanobench::doNotOptimizeAway(BlockWitnessMerkleRoot(block));
+    });
+}
+
+static void BlockViewMerkleRoots(benchmark::Bench& bench)
+{
+    bench.unit("block").run([&] {
+        const BlockView view{benchmark::data::block413567};
+        assert(BlockMerkleRoot(view) == view.Header().hashMerkleRoot);
+        ankerl::nanobench::doNotOptimizeAway(BlockWitnessMerkleRoot(view));
+    });
+}
+
 BENCHMARK(MerkleRoot, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockMerkleRoots, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockViewMerkleRoots, benchmark::PriorityLevel::HIGH);
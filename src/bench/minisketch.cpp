@@ -0,0 +1,64 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <minisketch.h>
+#include <node/minisketchwrapper.h>
+#include <random.h>
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using node::MakeMinisketch32;
+
+/** Build a sketch of a set of transaction short ids and serialize it, as a reconciliation responder does. */
+static void MinisketchEncode(benchmark::Bench& bench, size_t capacity, size_t num_elements)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<uint32_t> short_ids(num_elements);
+    for (auto& id : short_ids) id = rng.rand32() | 1;
+
+    bench.batch(num_elements).unit("element").run([&] {
+        Minisketch sketch{MakeMinisketch32(capacity)};
+        for (uint32_t id : short_ids) sketch.Add(id);
+        auto serialized{sketch.Serialize()};
+        ankerl::nanobench::doNotOptimizeAway(serialized);
+    });
+}
+
+/** Merge a received sketch with the local one and decode the set difference, as a reconciliation initiator does. */
+static void MinisketchDecode(benchmark::Bench& bench, size_t capacity)
+{
+    FastRandomContext rng{/*fDeterministic=*/true};
+    // Both sides share most of their set; the differences fill the sketch's capacity.
+    Minisketch local{MakeMinisketch32(capacity)};
+    Minisketch remote{MakeMinisketch32(capacity)};
+    for (int i = 0; i < 1000; ++i) {
+        const uint32_t id{rng.rand32() | 1};
+        local.Add(id);
+        remote.Add(id);
+    }
+    for (size_t i = 0; i < capacity; ++i) (i % 2 ? local : remote).Add(rng.rand32() | 1);
+    const auto serialized{remote.Serialize()};
+
+    bench.run([&] {
+        Minisketch received{MakeMinisketch32(capacity)};
+        received.Deserialize(serialized);
+        received.Merge(local);
+        const auto differences{received.Decode(capacity)};
+        assert(differences && differences->size() == capacity);
+    });
+}
+
+static void MinisketchEncode16(benchmark::Bench& bench) { MinisketchEncode(bench, 16, 100); }
+static void MinisketchEncode64(benchmark::Bench& bench) { MinisketchEncode(bench, 64, 400); }
+static void MinisketchDecode16(benchmark::Bench& bench) { MinisketchDecode(bench, 16); }
+static void MinisketchDecode64(benchmark::Bench& bench) { MinisketchDecode(bench, 64); }
+
+BENCHMARK(MinisketchEncode16, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MinisketchEncode64, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MinisketchDecode16, benchmark::PriorityLevel::HIGH);
+BENCHMARK(MinisketchDecode64, benchmark::PriorityLevel::HIGH);
@@ -3,12 +3,14 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <bench/bench.h>
+#include <bench/data/block413567.raw.h>
 #include <random.h>
 #include <util/strencodings.h>
 
 #include <cassert>
 #include <cstddef>
 #include <optional>
+#include <string>
 #include <vector>
 
 std::string generateHexString(size_t length) {
@@ -34,4 +36,17 @@ static void HexParse(benchmark::Bench& bench)
     });
 }
 
+// As for the hex of a block passed to submitblock
+static void HexParseBlock(benchmark::Bench& bench)
+{
+    const std::string data{HexStr(benchmark::data::block413567)};
+
+    bench.batch(data.size()).unit("base16").run([&] {
+        auto result = TryParseHex(data);
+        assert(result != std::nullopt);
+        ankerl::nanobench::doNotOptimizeAway(result);
+    });
+}
+
 BENCHMARK(HexParse, benchmark::PriorityLevel::HIGH);
+BENCHMARK(HexParseBlock, benchmark::PriorityLevel::HIGH);
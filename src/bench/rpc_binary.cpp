@@ -0,0 +1,108 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data/block413567.raw.h>
+#include <rpc/binary.h>
+#include <rpc/request.h>
+#include <streams.h>
+#include <univalue.h>
+#include <util/check.h>
+#include <util/strencodings.h>
+
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+// The encoding and decoding of a call on both ends, over each transport,
+// without the execution of the method. The result is either a small object,
+// like the result of gettxout, or a block, as returned by getblock with
+// verbosity 0 (in hex for JSON-RPC and as is for the binary transport).
+
+static UniValue SmallResult()
+{
+    UniValue result{UniValue::VOBJ};
+    result.pushKV("bestblock", std::string(64, 'a'));
+    result.pushKV("confirmations", 1234);
+    result.pushKV("value", UniValue{UniValue::VNUM, "0.12345678"});
+    UniValue script{UniValue::VOBJ};
+    script.pushKV("hex", std::string(44, 'b'));
+    script.pushKV("address", "hyl1qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqq");
+    result.pushKV("scriptPubKey", std::move(script));
+    result.pushKV("coinbase", false);
+    return result;
+}
+
+static UniValue CallParams()
+{
+    UniValue params{UniValue::VARR};
+    params.push_back(std::string(64, 'c'));
+    params.push_back(0);
+    return params;
+}
+
+static void RpcCallJSON(benchmark::Bench& bench, const std::function<UniValue()>& result)
+{
+    bench.run([&] {
+        // client
+        const std::string request_text{JSONRPCRequestObj("getblock", CallParams(), 1).write()};
+        // server
+        UniValue request_value;
+        Assert(request_value.read(request_text));
+        JSONRPCRequest request;
+        request.parse(request_value);
+        const std::string reply_text{JSONRPCReplyObj(result(), NullUniValue, request.id, request.m_json_version).write()};
+        // client
+        UniValue reply;
+        Assert(reply.read(reply_text));
+        ankerl::nanobench::doNotOptimizeAway(reply["result"]);
+    });
+}
+
+static void RpcCallBinary(benchmark::Bench& bench, const std::function<UniValue()>& result)
+{
+    bench.run([&] {
+        // client
+        DataStream request_body;
+        WriteBinaryRPCRequest(request_body, {.id = 1, .method = "getblock", .params = CallParams()});
+        // server
+        const auto requests{ReadBinaryRPCRequests(request_body)};
+        BinaryRPCReply reply;
+        reply.id = requests.at(0).id;
+        reply.result = result();
+        DataStream reply_body;
+        WriteBinaryRPCReply(reply_body, reply);
+        // client
+        const auto replies{ReadBinaryRPCReplies(reply_body)};
+        ankerl::nanobench::doNotOptimizeAway(replies.at(0).result);
+    });
+}
+
+static void RpcCallJSONSmall(benchmark::Bench& bench)
+{
+    RpcCallJSON(bench, SmallResult);
+}
+
+static void RpcCallBinarySmall(benchmark::Bench& bench)
+{
+    RpcCallBinary(bench, SmallResult);
+}
+
+static void RpcCallJSONBlock(benchmark::Bench& bench)
+{
+    RpcCallJSON(bench, [] { return UniValue{HexStr(benchmark::data::block413567)}; });
+}
+
+static void RpcCallBinaryBlock(benchmark::Bench& bench)
+{
+    const auto& block{benchmark::data::block413567};
+    RpcCallBinary(bench, [&] { return UniValue{std::string{reinterpret_cast<const char*>(block.data()), block.size()}}; });
+}
+
+BENCHMARK(RpcCallJSONSmall, benchmark::PriorityLevel::HIGH);
+BENCHMARK(RpcCallBinarySmall, benchmark::PriorityLevel::HIGH);
+BENCHMARK(RpcCallJSONBlock, benchmark::PriorityLevel::HIGH);
+BENCHMARK(RpcCallBinaryBlock, benchmark::PriorityLevel::HIGH);
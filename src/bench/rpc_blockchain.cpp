@@ -9,6 +9,7 @@
 #include <primitives/block.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
+#include <rpc/util.h>
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
@@ -19,6 +20,8 @@
 
 #include <cstddef>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace {
@@ -86,3 +89,29 @@ static void BlockToJsonVerboseWrite(benchmark::Bench& bench)
 }
 
 BENCHMARK(BlockToJsonVerboseWrite, benchmark::PriorityLevel::HIGH);
+
+static void BlockToJsonVerbosity3Write(benchmark::Bench& bench)
+{
+    TestBlockAndIndex data;
+    const uint256 pow_limit{data.testing_setup->m_node.chainman->GetParams().GetConsensus().powLimit};
+    bench.run([&] {
+        auto str = blockToJSON(data.testing_setup->m_node.chainman->m_blockman, data.block, data.blockindex, data.blockindex, TxVerbosity::SHOW_DETAILS_AND_PREVOUT, pow_limit).write();
+        ankerl::nanobench::doNotOptimizeAway(str);
+    });
+}
+
+static void BlockToJsonVerbosity3Streamed(benchmark::Bench& bench)
+{
+    TestBlockAndIndex data;
+    const uint256 pow_limit{data.testing_setup->m_node.chainman->GetParams().GetConsensus().powLimit};
+    size_t written{0};
+    bench.run([&] {
+        JSONStreamWriter writer{[&](std::string_view text) { written += text.size(); }};
+        WriteBlockJSON(writer, data.block, /*block_undo=*/nullptr, data.blockindex, data.blockindex, TxVerbosity::SHOW_DETAILS_AND_PREVOUT, pow_limit);
+        writer.Flush();
+    });
+    ankerl::nanobench::doNotOptimizeAway(written);
+}
+
+BENCHMARK(BlockToJsonVerbosity3Write, benchmark::PriorityLevel::HIGH);
+BENCHMARK(BlockToJsonVerbosity3Streamed, benchmark::PriorityLevel::HIGH);
@@ -18,4 +18,15 @@ static void HexStrBench(benchmark::Bench& bench)
     });
 }
 
+// As for each txid and script of a block in getblock
+static void HexStrTxidBench(benchmark::Bench& bench)
+{
+    const auto data{benchmark::data::block413567.first(32)};
+    bench.batch(data.size()).unit("byte").run([&] {
+        auto hex = HexStr(data);
+        ankerl::nanobench::doNotOptimizeAway(hex);
+    });
+}
+
 BENCHMARK(HexStrBench, benchmark::PriorityLevel::HIGH);
+BENCHMARK(HexStrTxidBench, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,100 @@
+// Copyright (c) The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <consensus/amount.h>
+#include <kernel/cs_main.h>
+#include <net.h>
+#include <net_processing.h>
+#include <primitives/transaction.h>
+#include <protocol.h>
+#include <random.h>
+#include <script/script.h>
+#include <sync.h>
+#include <test/util/net.h>
+#include <test/util/setup_common.h>
+#include <test/util/txmempool.h>
+#include <txmempool.h>
+#include <util/check.h>
+#include <util/time.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Announcing transactions to inbound peers, while a few transactions that are
+// already in the mempool are relayed between their trickles, as rebroadcast
+// ones are. Many transactions stay queued, as only a few of them are
+// announced to each peer at a time.
+static void TxInventoryTrickle(benchmark::Bench& bench)
+{
+    constexpr size_t NUM_PEERS{8};
+    constexpr size_t NUM_QUEUED{10'000};
+    constexpr size_t NUM_RELAYED_PER_TRICKLE{20};
+    constexpr size_t NUM_TRICKLES{50};
+
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>()};
+    CTxMemPool& pool{*Assert(testing_setup->m_node.mempool)};
+    PeerManager& peerman{*testing_setup->m_node.peerman};
+    auto& connman{static_cast<ConnmanTestMsg&>(*testing_setup->m_node.connman)};
+
+    FastRandomContext det_rand{/*fDeterministic=*/true};
+    std::vector<CTransactionRef> txs;
+    {
+        LOCK2(cs_main, pool.cs);
+        for (size_t i = 0; i < NUM_QUEUED + NUM_TRICKLES * NUM_RELAYED_PER_TRICKLE; ++i) {
+            CMutableTransaction tx;
+            tx.vin.emplace_back(Txid::FromUint256(det_rand.rand256()), 0);
+            tx.vout.emplace_back(COIN, CScript{} << OP_TRUE);
+            txs.push_back(MakeTransactionRef(tx));
+            TryAddToMempool(pool, TestMemPoolEntryHelper{}.Fee(1000 + det_rand.randrange(10'000)).FromTx(txs.back()));
+        }
+    }
+
+    NodeSeconds now{Now<NodeSeconds>()};
+    SetMockTime(now);
+    std::vector<std::unique_ptr<CNode>> nodes;
+    for (NodeId id = 0; id < static_cast<NodeId>(NUM_PEERS); ++id) {
+        nodes.push_back(std::make_unique<CNode>(id,
+                                                /*sock=*/nullptr,
+                                                CAddress{},
+                                                /*nKeyedNetGroupIn=*/0,
+                                                /*nLocalHostNonceIn=*/0,
+                                                CAddress{},
+                                                /*addrNameIn=*/"",
+                                                ConnectionType::INBOUND,
+                                                /*inbound_onion=*/false,
+                                                /*network_key=*/0));
+        LOCK(NetEventsInterface::g_msgproc_mutex);
+        connman.Handshake(*nodes.back(), /*successfully_connected=*/true, ServiceFlags(NODE_NETWORK | NODE_WITNESS),
+                          ServiceFlags(NODE_NETWORK | NODE_WITNESS), PROTOCOL_VERSION, /*relay_txs=*/true);
+    }
+
+    const auto trickle{[&] {
+        now += std::chrono::seconds{10};
+        SetMockTime(now);
+        LOCK(NetEventsInterface::g_msgproc_mutex);
+        for (const auto& node : nodes) {
+            peerman.SendMessages(node.get());
+            connman.FlushSendBuffer(*node);
+        }
+    }};
+    // Let the peers schedule their first trickle, so that transactions are queued for them.
+    trickle();
+    for (size_t i = 0; i < NUM_QUEUED; ++i) peerman.RelayTransaction(txs[i]->GetHash(), txs[i]->GetWitnessHash());
+
+    size_t next_relayed{NUM_QUEUED};
+    bench.epochs(5).epochIterations(NUM_TRICKLES / 5).run([&] {
+        for (size_t i = 0; i < NUM_RELAYED_PER_TRICKLE && next_relayed < txs.size(); ++i, ++next_relayed) {
+            peerman.RelayTransaction(txs[next_relayed]->GetHash(), txs[next_relayed]->GetWitnessHash());
+        }
+        trickle();
+    });
+
+    for (const auto& node : nodes) peerman.FinalizeNode(*node);
+    SetMockTime(0);
+}
+
+BENCHMARK(TxInventoryTrickle, benchmark::PriorityLevel::HIGH);
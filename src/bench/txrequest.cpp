@@ -0,0 +1,62 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <net.h>
+#include <primitives/transaction.h>
+#include <random.h>
+#include <txrequest.h>
+#include <uint256.h>
+
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/** Announcement storm: NUM_TXS transactions are each announced by ANNOUNCERS_PER_TX of NUM_PEERS peers, then
+ *  requested from, and delivered by, the selected peer, with some requests expiring along the way. */
+static void TxRequestAnnouncementStorm(benchmark::Bench& bench)
+{
+    static constexpr int NUM_PEERS{125};
+    static constexpr int NUM_TXS{4000};
+    static constexpr int ANNOUNCERS_PER_TX{8};
+
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<Txid> txids;
+    txids.reserve(NUM_TXS);
+    for (int i = 0; i < NUM_TXS; ++i) txids.push_back(Txid::FromUint256(rng.rand256()));
+    std::vector<std::vector<NodeId>> announcers(NUM_TXS);
+    for (auto& peers : announcers) {
+        for (int i = 0; i < ANNOUNCERS_PER_TX; ++i) peers.push_back(rng.randrange(NUM_PEERS));
+    }
+
+    bench.batch(NUM_TXS * ANNOUNCERS_PER_TX).unit("announcement").run([&] {
+        TxRequestTracker tracker{/*deterministic=*/true};
+        std::chrono::microseconds now{1s};
+        for (int i = 0; i < NUM_TXS; ++i) {
+            for (NodeId peer : announcers[i]) {
+                // Non-preferred (inbound) peers announce with a delay, as in net_processing.
+                const bool preferred{peer % 4 == 0};
+                tracker.ReceivedInv(peer, GenTxid{txids[i]}, preferred, preferred ? now : now + 2s);
+            }
+            if (i % 100 == 99) now += 100ms;
+        }
+        std::vector<std::pair<NodeId, GenTxid>> expired;
+        while (tracker.Size() > 0) {
+            // Move past both the announcement delays and the expiry of unanswered requests.
+            now += 61s;
+            for (NodeId peer = 0; peer < NUM_PEERS; ++peer) {
+                for (const GenTxid& gtxid : tracker.GetRequestable(peer, now, &expired)) {
+                    tracker.RequestedTx(peer, gtxid.ToUint256(), now + 60s);
+                    // Every tenth peer never answers, leaving its requests to expire.
+                    if (peer % 10 != 0) tracker.ReceivedResponse(peer, gtxid.ToUint256());
+                }
+            }
+        }
+        assert(tracker.Size() == 0);
+    });
+}
+
+BENCHMARK(TxRequestAnnouncementStorm, benchmark::PriorityLevel::HIGH);
@@ -0,0 +1,118 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data/block413567.raw.h>
+#include <core_io.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <uint256.h>
+#include <univalue.h>
+#include <util/check.h>
+#include <util/strencodings.h>
+
+#include <memory>
+#include <string>
+
+namespace {
+
+/** JSON payloads of the sizes and shapes the RPC server reads and writes */
+struct RPCPayloads {
+    const std::unique_ptr<const BasicTestingSetup> testing_setup{MakeNoLogFileContext<const BasicTestingSetup>(ChainType::MAIN)};
+    //! The transactions of a block, as in the result of getblock with verbosity 2
+    UniValue block_txs{UniValue::VARR};
+    //! A batch of getrawtransaction requests for these transactions
+    std::string batch_request;
+    //! A request with a large base64 PSBT, as sent to walletprocesspsbt
+    std::string psbt_request;
+
+    RPCPayloads()
+    {
+        CBlock block;
+        DataStream{benchmark::data::block413567} >> TX_WITH_WITNESS(block);
+
+        UniValue batch{UniValue::VARR};
+        for (const CTransactionRef& tx : block.vtx) {
+            UniValue tx_json{UniValue::VOBJ};
+            TxToUniv(*tx, /*block_hash=*/uint256(), tx_json);
+            block_txs.push_back(std::move(tx_json));
+
+            UniValue request{UniValue::VOBJ};
+            request.pushKV("jsonrpc", "2.0");
+            request.pushKV("id", batch.size());
+            request.pushKV("method", "getrawtransaction");
+            UniValue params{UniValue::VARR};
+            params.push_back(tx->GetHash().GetHex());
+            params.push_back(true);
+            request.pushKV("params", std::move(params));
+            batch.push_back(std::move(request));
+        }
+        batch_request = batch.write();
+
+        UniValue request{UniValue::VOBJ};
+        request.pushKV("jsonrpc", "2.0");
+        request.pushKV("id", 1);
+        request.pushKV("method", "walletprocesspsbt");
+        UniValue params{UniValue::VARR};
+        params.push_back(EncodeBase64(benchmark::data::block413567));
+        request.pushKV("params", std::move(params));
+        psbt_request = request.write();
+    }
+};
+
+} // namespace
+
+static void UniValueParse(benchmark::Bench& bench, const std::string& json)
+{
+    bench.batch(json.size()).unit("byte").run([&] {
+        UniValue value;
+        Assert(value.read(json));
+        ankerl::nanobench::doNotOptimizeAway(value);
+    });
+}
+
+static void UniValueReadBlock(benchmark::Bench& bench)
+{
+    const RPCPayloads payloads;
+    UniValueParse(bench, payloads.block_txs.write());
+}
+
+static void UniValueReadBatch(benchmark::Bench& bench)
+{
+    const RPCPayloads payloads;
+    UniValueParse(bench, payloads.batch_request);
+}
+
+static void UniValueReadPSBT(benchmark::Bench& bench)
+{
+    const RPCPayloads payloads;
+    UniValueParse(bench, payloads.psbt_request);
+}
+
+static void UniValueWriteBlock(benchmark::Bench& bench)
+{
+    const RPCPayloads payloads;
+    bench.batch(payloads.block_txs.write().size()).unit("byte").run([&] {
+        auto str = payloads.block_txs.write();
+        ankerl::nanobench::doNotOptimizeAway(str);
+    });
+}
+
+static void UniValueWriteBlockPretty(benchmark::Bench& bench)
+{
+    const RPCPayloads payloads;
+    bench.batch(payloads.block_txs.write(4).size()).unit("byte").run([&] {
+        auto str = payloads.block_txs.write(4);
+        ankerl::nanobench::doNotOptimizeAway(str);
+    });
+}
+
+BENCHMARK(UniValueReadBlock, benchmark::PriorityLevel::HIGH);
+BENCHMARK(UniValueReadBatch, benchmark::PriorityLevel::HIGH);
+BENCHMARK(UniValueReadPSBT, benchmark::PriorityLevel::HIGH);
+BENCHMARK(UniValueWriteBlock, benchmark::PriorityLevel::HIGH);
+BENCHMARK(UniValueWriteBlockPretty, benchmark::PriorityLevel::HIGH);
@@ -11,21 +11,42 @@
 #include <script/script.h>
 #include <span.h>
 #include <test/util/transaction_utils.h>
+#include <tinyformat.h>
 #include <uint256.h>
 
 #include <array>
 #include <cassert>
 #include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <string>
 #include <vector>
 
-// Microbenchmark for verification of a basic P2WPKH script. Can be easily
-// modified to measure performance of other types of scripts.
-static void VerifyScriptBench(benchmark::Bench& bench)
+//! Heap allocations made by each thread, to report those of verifying a
+//! script. Replacing operator new counts them in all benchmarks, which only
+//! costs an increment.
+static thread_local size_t g_allocations{0};
+
+void* operator new(size_t size)
+{
+    ++g_allocations;
+    if (void* ptr{std::malloc(size ? size : 1)}) return ptr;
+    throw std::bad_alloc{};
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+enum class Template { P2PKH, P2WPKH, P2SH_P2WPKH, P2TR_KEY_PATH };
+
+// Microbenchmark for verification of a spend of a standard template, with the
+// fast path for it or with the generic interpreter, which also reports the heap
+// allocations of verifying it. Can be easily modified to measure performance of
+// other types of scripts.
+static void VerifyScriptBench(benchmark::Bench& bench, const std::string& name, Template type, bool generic)
 {
     ECC_Context ecc_context{};
 
-    const script_verify_flags flags{SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_P2SH};
-    const int witnessversion = 0;
+    const script_verify_flags flags{SCRIPT_VERIFY_WITNESS | SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_TAPROOT};
 
     // Key pair.
     CKey key;
@@ -34,38 +55,88 @@ static void VerifyScriptBench(benchmark::Bench& bench)
             0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1
         }
     };
-    key.Set(vchKey.begin(), vchKey.end(), false);
+    key.Set(vchKey.begin(), vchKey.end(), /*fCompressedIn=*/true);
     CPubKey pubkey = key.GetPubKey();
     uint160 pubkeyHash;
     CHash160().Write(pubkey).Finalize(pubkeyHash);
 
     // Script.
-    CScript scriptPubKey = CScript() << witnessversion << ToByteVector(pubkeyHash);
+    const CScript p2wpkh = CScript() << OP_0 << ToByteVector(pubkeyHash);
+    CScript scriptPubKey;
     CScript scriptSig;
-    CScript witScriptPubkey = CScript() << OP_DUP << OP_HASH160 << ToByteVector(pubkeyHash) << OP_EQUALVERIFY << OP_CHECKSIG;
+    switch (type) {
+    case Template::P2PKH:
+        scriptPubKey = CScript() << OP_DUP << OP_HASH160 << ToByteVector(pubkeyHash) << OP_EQUALVERIFY << OP_CHECKSIG;
+        break;
+    case Template::P2WPKH:
+        scriptPubKey = p2wpkh;
+        break;
+    case Template::P2SH_P2WPKH:
+        scriptPubKey = CScript() << OP_HASH160 << ToByteVector(Hash160(p2wpkh)) << OP_EQUAL;
+        scriptSig = CScript() << ToByteVector(p2wpkh);
+        break;
+    case Template::P2TR_KEY_PATH:
+        scriptPubKey = CScript() << OP_1 << ToByteVector(XOnlyPubKey{pubkey}.CreateTapTweak(nullptr)->first);
+        break;
+    }
     const CMutableTransaction& txCredit = BuildCreditingTransaction(scriptPubKey, 1);
     CMutableTransaction txSpend = BuildSpendingTransaction(scriptSig, CScriptWitness(), CTransaction(txCredit));
+    PrecomputedTransactionData txdata;
+    txdata.Init(txSpend, {txCredit.vout[0]}, /*force=*/true);
     CScriptWitness& witness = txSpend.vin[0].scriptWitness;
     witness.stack.emplace_back();
-    key.Sign(SignatureHash(witScriptPubkey, txSpend, 0, SIGHASH_ALL, txCredit.vout[0].nValue, SigVersion::WITNESS_V0), witness.stack.back());
-    witness.stack.back().push_back(static_cast<unsigned char>(SIGHASH_ALL));
-    witness.stack.push_back(ToByteVector(pubkey));
+    if (type == Template::P2PKH) {
+        std::vector<unsigned char> sig;
+        key.Sign(SignatureHash(scriptPubKey, txSpend, 0, SIGHASH_ALL, txCredit.vout[0].nValue, SigVersion::BASE, &txdata), sig);
+        sig.push_back(static_cast<unsigned char>(SIGHASH_ALL));
+        txSpend.vin[0].scriptSig = CScript() << sig << ToByteVector(pubkey);
+        witness.SetNull();
+    } else if (type == Template::P2TR_KEY_PATH) {
+        ScriptExecutionData execdata;
+        execdata.m_annex_init = true;
+        execdata.m_annex_present = false;
+        uint256 hash;
+        assert(SignatureHashSchnorr(hash, execdata, txSpend, 0, SIGHASH_DEFAULT, SigVersion::TAPROOT, txdata, MissingDataBehavior::ASSERT_FAIL));
+        const uint256 merkle_root{};
+        witness.stack.back().resize(64);
+        assert(key.SignSchnorr(hash, witness.stack.back(), &merkle_root, uint256::ONE));
+    } else {
+        CScript witScriptPubkey = CScript() << OP_DUP << OP_HASH160 << ToByteVector(pubkeyHash) << OP_EQUALVERIFY << OP_CHECKSIG;
+        key.Sign(SignatureHash(witScriptPubkey, txSpend, 0, SIGHASH_ALL, txCredit.vout[0].nValue, SigVersion::WITNESS_V0, &txdata), witness.stack.back());
+        witness.stack.back().push_back(static_cast<unsigned char>(SIGHASH_ALL));
+        witness.stack.push_back(ToByteVector(pubkey));
+    }
 
     // Benchmark.
-    bench.run([&] {
+    const auto verify{[&, verify_script = generic ? VerifyScriptGeneric : VerifyScript] {
         ScriptError err;
-        bool success = VerifyScript(
+        bool success = verify_script(
             txSpend.vin[0].scriptSig,
             txCredit.vout[0].scriptPubKey,
             &txSpend.vin[0].scriptWitness,
             flags,
-            MutableTransactionSignatureChecker(&txSpend, 0, txCredit.vout[0].nValue, MissingDataBehavior::ASSERT_FAIL),
+            MutableTransactionSignatureChecker(&txSpend, 0, txCredit.vout[0].nValue, txdata, MissingDataBehavior::ASSERT_FAIL),
             &err);
         assert(err == SCRIPT_ERR_OK);
         assert(success);
-    });
+    }};
+    // Count the allocations of a verification once the script stacks of this
+    // thread have been grown by an earlier one, as they are in validation.
+    verify();
+    const size_t allocations{g_allocations};
+    verify();
+    bench.name(strprintf("%s with %u heap allocations", name, g_allocations - allocations));
+    bench.run(verify);
 }
 
+static void VerifyScriptP2PKH(benchmark::Bench& bench) { VerifyScriptBench(bench, "VerifyScriptP2PKH", Template::P2PKH, /*generic=*/false); }
+static void VerifyScriptP2WPKH(benchmark::Bench& bench) { VerifyScriptBench(bench, "VerifyScriptP2WPKH", Template::P2WPKH, /*generic=*/false); }
+static void VerifyScriptP2WPKHGeneric(benchmark::Bench& bench) { VerifyScriptBench(bench, "VerifyScriptP2WPKHGeneric", Template::P2WPKH, /*generic=*/true); }
+static void VerifyScriptP2SHP2WPKH(benchmark::Bench& bench) { VerifyScriptBench(bench, "VerifyScriptP2SHP2WPKH", Template::P2SH_P2WPKH, /*generic=*/false); }
+static void VerifyScriptP2SHP2WPKHGeneric(benchmark::Bench& bench) { VerifyScriptBench(bench, "VerifyScriptP2SHP2WPKHGeneric", Template::P2SH_P2WPKH, /*generic=*/true); }
+static void VerifyScriptP2TRKeyPath(benchmark::Bench& bench) { VerifyScriptBench(bench, "VerifyScriptP2TRKeyPath", Template::P2TR_KEY_PATH, /*generic=*/false); }
+static void VerifyScriptP2TRKeyPathGeneric(benchmark::Bench& bench) { VerifyScriptBench(bench, "VerifyScriptP2TRKeyPathGeneric", Template::P2TR_KEY_PATH, /*generic=*/true); }
+
 static void VerifyNestedIfScript(benchmark::Bench& bench)
 {
     std::vector<std::vector<unsigned char>> stack;
@@ -87,5 +158,11 @@ static void VerifyNestedIfScript(benchmark::Bench& bench)
     });
 }
 
-BENCHMARK(VerifyScriptBench, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyScriptP2PKH, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyScriptP2WPKH, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyScriptP2WPKHGeneric, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyScriptP2SHP2WPKH, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyScriptP2SHP2WPKHGeneric, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyScriptP2TRKeyPath, benchmark::PriorityLevel::HIGH);
+BENCHMARK(VerifyScriptP2TRKeyPathGeneric, benchmark::PriorityLevel::HIGH);
 BENCHMARK(VerifyNestedIfScript, benchmark::PriorityLevel::HIGH);
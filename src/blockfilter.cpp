@@ -2,9 +2,12 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <algorithm>
+#include <bit>
 #include <mutex>
 #include <set>
 #include <string_view>
+#include <utility>
 
 #include <blockfilter.h>
 #include <crypto/siphash.h>
@@ -25,20 +28,44 @@ static const std::map<BlockFilterType, std::string> g_filter_types = {
 
 uint64_t GCSFilter::HashToRange(const Element& element) const
 {
-    uint64_t hash = CSipHasher(m_params.m_siphash_k0, m_params.m_siphash_k1)
-        .Write(element)
-        .Finalize();
+    uint64_t hash = PresaltedSipHasher(m_params.m_siphash_k0, m_params.m_siphash_k1)(element);
     return FastRange64(hash, m_F);
 }
 
+/** Below this many values, std::sort is faster than RadixSort. */
+static constexpr size_t RADIX_SORT_MIN_SIZE{256};
+
+/** LSD radix sort of values below max_value, 11 bits per pass. */
+static void RadixSort(std::vector<uint64_t>& values, uint64_t max_value)
+{
+    static constexpr int RADIX_BITS{11};
+    static constexpr size_t RADIX_SIZE{size_t{1} << RADIX_BITS};
+    const int passes{(static_cast<int>(std::bit_width(max_value)) + RADIX_BITS - 1) / RADIX_BITS};
+    std::vector<uint64_t> buffer(values.size());
+    std::vector<size_t> counts(RADIX_SIZE);
+    for (int shift = 0; shift < passes * RADIX_BITS; shift += RADIX_BITS) {
+        std::fill(counts.begin(), counts.end(), 0);
+        for (uint64_t value : values) ++counts[(value >> shift) & (RADIX_SIZE - 1)];
+        size_t offset{0};
+        for (size_t& count : counts) offset += std::exchange(count, offset);
+        for (uint64_t value : values) buffer[counts[(value >> shift) & (RADIX_SIZE - 1)]++] = value;
+        values.swap(buffer);
+    }
+}
+
 std::vector<uint64_t> GCSFilter::BuildHashedSet(const ElementSet& elements) const
 {
+    const PresaltedSipHasher hasher(m_params.m_siphash_k0, m_params.m_siphash_k1);
     std::vector<uint64_t> hashed_elements;
     hashed_elements.reserve(elements.size());
     for (const Element& element : elements) {
-        hashed_elements.push_back(HashToRange(element));
+        hashed_elements.push_back(FastRange64(hasher(element), m_F));
+    }
+    if (hashed_elements.size() < RADIX_SORT_MIN_SIZE) {
+        std::sort(hashed_elements.begin(), hashed_elements.end());
+    } else {
+        RadixSort(hashed_elements, m_F);
     }
-    std::sort(hashed_elements.begin(), hashed_elements.end());
     return hashed_elements;
 }
 
@@ -62,11 +89,11 @@ GCSFilter::GCSFilter(const Params& params, std::vector<unsigned char> encoded_fi
 
     // Verify that the encoded filter contains exactly N elements. If it has too much or too little
     // data, a std::ios_base::failure exception will be raised.
-    BitStreamReader bitreader{stream};
+    GolombRiceReader reader{std::span{m_encoded}.last(stream.size())};
     for (uint64_t i = 0; i < m_N; ++i) {
-        GolombRiceDecode(bitreader, m_params.m_P);
+        reader.Decode(m_params.m_P);
     }
-    if (!stream.empty()) {
+    if (reader.BytesRead() != stream.size()) {
         throw std::ios_base::failure("encoded_filter contains excess data");
     }
 }
@@ -89,16 +116,16 @@ GCSFilter::GCSFilter(const Params& params, const ElementSet& elements)
         return;
     }
 
-    BitStreamWriter bitwriter{stream};
+    GolombRiceWriter writer{m_encoded};
 
     uint64_t last_value = 0;
     for (uint64_t value : BuildHashedSet(elements)) {
         uint64_t delta = value - last_value;
-        GolombRiceEncode(bitwriter, m_params.m_P, delta);
+        writer.Encode(m_params.m_P, delta);
         last_value = value;
     }
 
-    bitwriter.Flush();
+    writer.Flush();
 }
 
 bool GCSFilter::MatchInternal(const uint64_t* element_hashes, size_t size) const
@@ -109,12 +136,12 @@ bool GCSFilter::MatchInternal(const uint64_t* element_hashes, size_t size) const
     uint64_t N = ReadCompactSize(stream);
     assert(N == m_N);
 
-    BitStreamReader bitreader{stream};
+    GolombRiceReader reader{std::span{m_encoded}.last(stream.size())};
 
     uint64_t value = 0;
     size_t hashes_index = 0;
     for (uint32_t i = 0; i < m_N; ++i) {
-        uint64_t delta = GolombRiceDecode(bitreader, m_params.m_P);
+        uint64_t delta = reader.Decode(m_params.m_P);
         value += delta;
 
         while (true) {
@@ -4,6 +4,7 @@
 
 #include <consensus/merkle.h>
 #include <hash.h>
+#include <primitives/block_view.h>
 #include <util/check.h>
 
 /*     WARNING! If you're reading this because you're learning about crypto
@@ -84,6 +85,27 @@ uint256 BlockWitnessMerkleRoot(const CBlock& block)
     return ComputeMerkleRoot(std::move(leaves));
 }
 
+uint256 BlockMerkleRoot(const BlockView& block, bool* mutated)
+{
+    std::vector<uint256> leaves;
+    leaves.reserve(block.TxCount());
+    for (const Txid& txid : block.GetTxids()) {
+        leaves.push_back(txid.ToUint256());
+    }
+    return ComputeMerkleRoot(std::move(leaves), mutated);
+}
+
+uint256 BlockWitnessMerkleRoot(const BlockView& block)
+{
+    std::vector<uint256> leaves;
+    leaves.reserve(block.TxCount());
+    for (const Wtxid& wtxid : block.GetWtxids()) {
+        leaves.push_back(wtxid.ToUint256());
+    }
+    if (!leaves.empty()) leaves[0].SetNull(); // The witness hash of the coinbase is 0.
+    return ComputeMerkleRoot(std::move(leaves));
+}
+
 /* This implements a constant-space merkle path calculator, limited to 2^32 leaves. */
 static void MerkleComputation(const std::vector<uint256>& leaves, uint32_t leaf_pos, std::vector<uint256>& path)
 {
@@ -10,6 +10,8 @@
 #include <primitives/block.h>
 #include <uint256.h>
 
+class BlockView;
+
 uint256 ComputeMerkleRoot(std::vector<uint256> hashes, bool* mutated = nullptr);
 
 /*
@@ -17,11 +19,17 @@ uint256 ComputeMerkleRoot(std::vector<uint256> hashes, bool* mutated = nullptr);
  * *mutated is set to true if a duplicated subtree was found.
  */
 uint256 BlockMerkleRoot(const CBlock& block, bool* mutated = nullptr);
+/*
+ * As above, for a block that isn't deserialized. Its txids are computed
+ * several at a time, which is faster than deserializing it for its txids.
+ */
+uint256 BlockMerkleRoot(const BlockView& block, bool* mutated = nullptr);
 
 /*
  * Compute the Merkle root of the witness transactions in a block.
  */
 uint256 BlockWitnessMerkleRoot(const CBlock& block);
+uint256 BlockWitnessMerkleRoot(const BlockView& block);
 
 /**
  * Compute merkle path to the specified transaction
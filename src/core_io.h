@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 #include <optional>
+#include <span>
 
 class CBlock;
 class CBlockHeader;
@@ -36,6 +37,8 @@ enum class TxVerbosity {
 CScript ParseScript(const std::string& s);
 std::string ScriptToAsmStr(const CScript& script, const bool fAttemptSighashDecode = false);
 [[nodiscard]] bool DecodeHexTx(CMutableTransaction& tx, const std::string& hex_tx, bool try_no_witness = false, bool try_witness = true);
+/** Like DecodeHexTx, for the serialized transaction itself */
+[[nodiscard]] bool DecodeRawTx(CMutableTransaction& tx, std::span<const unsigned char> tx_data, bool try_no_witness = false, bool try_witness = true);
 [[nodiscard]] bool DecodeHexBlk(CBlock&, const std::string& strHexBlk);
 bool DecodeHexBlockHeader(CBlockHeader&, const std::string& hex_header);
 
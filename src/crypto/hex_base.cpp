@@ -8,8 +8,13 @@
 #include <cassert>
 #include <cstring>
 #include <string>
+#include <string_view>
 #include <tuple>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 namespace {
 
 using ByteAsHex = std::array<char, 2>;
@@ -26,6 +31,54 @@ constexpr std::array<ByteAsHex, 256> CreateByteToHexMap()
     return byte_to_hex;
 }
 
+#if defined(__SSE2__)
+// SSE2 is part of x86-64, so unlike the SHA256 kernels these need no runtime
+// detection.
+
+/** Hex encode 16 bytes into 32 characters. */
+void HexEncode16(const uint8_t* in, char* out)
+{
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in));
+    const __m128i low_nibble = _mm_set1_epi8(0x0f);
+    const auto to_hex = [](__m128i nibbles) {
+        // '0' + n, and 'a' - '0' - 10 more for n > 9
+        const __m128i letters = _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10));
+        return _mm_add_epi8(_mm_add_epi8(nibbles, _mm_set1_epi8('0')), letters);
+    };
+    const __m128i high = to_hex(_mm_and_si128(_mm_srli_epi16(bytes, 4), low_nibble));
+    const __m128i low = to_hex(_mm_and_si128(bytes, low_nibble));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(high, low));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(high, low));
+}
+
+/** Hex decode 32 characters into 16 bytes, or return false if any isn't a hex digit. */
+bool HexDecode16(const char* in, uint8_t* out)
+{
+    const auto decode = [](__m128i chars, __m128i& valid) {
+        // Digits and letters of either case, by the offsets from '0' and from
+        // 'a' of the characters (made lower case). Bytes compare as signed, so
+        // the offsets are moved to start at -128.
+        const __m128i bias = _mm_set1_epi8(-128);
+        const __m128i digits = _mm_sub_epi8(chars, _mm_set1_epi8('0'));
+        const __m128i letters = _mm_sub_epi8(_mm_or_si128(chars, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+        const __m128i is_digit = _mm_cmplt_epi8(_mm_add_epi8(digits, bias), _mm_set1_epi8(-128 + 10));
+        const __m128i is_letter = _mm_cmplt_epi8(_mm_add_epi8(letters, bias), _mm_set1_epi8(-128 + 6));
+        valid = _mm_and_si128(valid, _mm_or_si128(is_digit, is_letter));
+        return _mm_or_si128(_mm_and_si128(is_digit, digits), _mm_and_si128(is_letter, _mm_add_epi8(letters, _mm_set1_epi8(10))));
+    };
+    __m128i valid = _mm_set1_epi8(-1);
+    const __m128i nibbles0 = decode(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)), valid);
+    const __m128i nibbles1 = decode(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 16)), valid);
+    if (_mm_movemask_epi8(valid) != 0xffff) return false;
+    // Each pair of characters is a 16-bit lane, with the high nibble first
+    const auto combine = [](__m128i nibbles) {
+        return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00ff)), 4), _mm_srli_epi16(nibbles, 8));
+    };
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_packus_epi16(combine(nibbles0), combine(nibbles1)));
+    return true;
+}
+#endif
+
 } // namespace
 
 std::string HexStr(const std::span<const uint8_t> s)
@@ -35,7 +88,14 @@ std::string HexStr(const std::span<const uint8_t> s)
     static_assert(sizeof(byte_to_hex) == 512);
 
     char* it = rv.data();
-    for (uint8_t v : s) {
+    std::span<const uint8_t> rest{s};
+#if defined(__SSE2__)
+    for (; rest.size() >= 16; rest = rest.subspan(16)) {
+        HexEncode16(rest.data(), it);
+        it += 32;
+    }
+#endif
+    for (uint8_t v : rest) {
         std::memcpy(it, byte_to_hex[v].data(), 2);
         it += 2;
     }
@@ -67,3 +127,22 @@ signed char HexDigit(char c)
     return p_util_hexdigit[(unsigned char)c];
 }
 
+bool DecodeHexDigits(std::string_view hex, std::span<uint8_t> out)
+{
+    assert(hex.size() == out.size() * 2);
+    const char* in = hex.data();
+    uint8_t* it = out.data();
+#if defined(__SSE2__)
+    for (; it + 16 <= out.data() + out.size(); it += 16, in += 32) {
+        if (!HexDecode16(in, it)) return false;
+    }
+#endif
+    for (; it != out.data() + out.size(); ++it, in += 2) {
+        const signed char high = HexDigit(in[0]);
+        const signed char low = HexDigit(in[1]);
+        if (high < 0 || low < 0) return false;
+        *it = uint8_t(high << 4) | uint8_t(low);
+    }
+    return true;
+}
+
@@ -11,6 +11,7 @@
 #include <cstdint>
 #include <span>
 #include <string>
+#include <string_view>
 
 /**
  * Convert a span of bytes to a lower-case hexadecimal string.
@@ -21,4 +22,11 @@ inline std::string HexStr(const std::span<const std::byte> s) { return HexStr(Ma
 
 signed char HexDigit(char c);
 
+/**
+ * Decode hex digits of either case, without whitespace, into the bytes of out,
+ * which must be half as many. Returns false if any character isn't a hex
+ * digit, leaving out partially written.
+ */
+bool DecodeHexDigits(std::string_view hex, std::span<uint8_t> out);
+
 #endif // HYLIUM_CRYPTO_HEX_BASE_H
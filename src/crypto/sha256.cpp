@@ -6,8 +6,11 @@
 #include <crypto/common.h>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstring>
+#include <optional>
+#include <utility>
 
 #if !defined(DISABLE_OPTIMIZED_SHA256)
 #include <compat/cpuid.h> // IWYU pragma: keep
@@ -32,11 +35,13 @@ void Transform(uint32_t* s, const unsigned char* chunk, size_t blocks);
 namespace sha256d64_sse41
 {
 void Transform_4way(unsigned char* out, const unsigned char* in);
+void TransformMulti_4way(uint32_t* const* s, const unsigned char* const* chunks);
 }
 
 namespace sha256d64_avx2
 {
 void Transform_8way(unsigned char* out, const unsigned char* in);
+void TransformMulti_8way(uint32_t* const* s, const unsigned char* const* chunks);
 }
 
 namespace sha256d64_x86_shani
@@ -437,6 +442,8 @@ void TransformD64(unsigned char* out, const unsigned char* in)
 
 typedef void (*TransformType)(uint32_t*, const unsigned char*, size_t);
 typedef void (*TransformD64Type)(unsigned char*, const unsigned char*);
+/** Transform one 64-byte chunk for each of several states, like Transform(s[i], chunks[i], 1). */
+typedef void (*TransformMultiType)(uint32_t* const*, const unsigned char* const*);
 
 template<TransformType tr>
 void TransformD64Wrapper(unsigned char* out, const unsigned char* in)
@@ -482,6 +489,8 @@ TransformD64Type TransformD64 = sha256::TransformD64;
 TransformD64Type TransformD64_2way = nullptr;
 TransformD64Type TransformD64_4way = nullptr;
 TransformD64Type TransformD64_8way = nullptr;
+TransformMultiType TransformMulti_4way = nullptr;
+TransformMultiType TransformMulti_8way = nullptr;
 
 bool SelfTest() {
     // Input state (equal to the initial SHA256 state)
@@ -565,6 +574,24 @@ bool SelfTest() {
         if (!std::equal(out, out + 256, result_d64)) return false;
     }
 
+    // Test TransformMulti_4way and TransformMulti_8way, if available, with lane i
+    // transforming the state after i chunks with the next chunk.
+    for (const auto& [transform, lanes] : {std::pair{TransformMulti_4way, 4}, std::pair{TransformMulti_8way, 8}}) {
+        if (!transform) continue;
+        uint32_t states[8][8];
+        uint32_t* state_ptrs[8];
+        const unsigned char* chunks[8];
+        for (int i = 0; i < lanes; ++i) {
+            std::copy(result[i], result[i] + 8, states[i]);
+            state_ptrs[i] = states[i];
+            chunks[i] = data + 1 + 64 * i;
+        }
+        transform(state_ptrs, chunks);
+        for (int i = 0; i < lanes; ++i) {
+            if (!std::equal(states[i], states[i] + 8, result[i + 1])) return false;
+        }
+    }
+
     return true;
 }
 
@@ -590,6 +617,8 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
     TransformD64_2way = nullptr;
     TransformD64_4way = nullptr;
     TransformD64_8way = nullptr;
+    TransformMulti_4way = nullptr;
+    TransformMulti_8way = nullptr;
 
 #if !defined(DISABLE_OPTIMIZED_SHA256)
 #if defined(HAVE_GETCPUID)
@@ -639,6 +668,7 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
 #endif
 #if defined(ENABLE_SSE41)
         TransformD64_4way = sha256d64_sse41::Transform_4way;
+        TransformMulti_4way = sha256d64_sse41::TransformMulti_4way;
         ret += ";sse41(4way)";
 #endif
     }
@@ -646,6 +676,7 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
 #if defined(ENABLE_AVX2)
     if (have_avx2 && have_avx && enabled_avx) {
         TransformD64_8way = sha256d64_avx2::Transform_8way;
+        TransformMulti_8way = sha256d64_avx2::TransformMulti_8way;
         ret += ";avx2(8way)";
     }
 #endif
@@ -779,3 +810,147 @@ void SHA256D64(unsigned char* out, const unsigned char* in, size_t blocks)
         --blocks;
     }
 }
+
+namespace {
+/** The padded 64-byte chunks of a message given in pieces, read one at a time. */
+class PaddedMessage
+{
+    SHA256Message m_pieces;
+    size_t m_piece{0};
+    size_t m_pos{0};
+    uint64_t m_bytes{0};
+    bool m_padded{false};
+    bool m_done{false};
+    unsigned char m_buf[64];
+
+    void SkipRead()
+    {
+        while (m_piece < m_pieces.size() && m_pos == m_pieces[m_piece].size()) {
+            ++m_piece;
+            m_pos = 0;
+        }
+    }
+
+public:
+    explicit PaddedMessage(SHA256Message pieces) : m_pieces{pieces}
+    {
+        for (const auto& piece : pieces) m_bytes += piece.size();
+        SkipRead();
+    }
+
+    /** Whether the last chunk was read. */
+    bool Done() const { return m_done; }
+
+    /** The next chunk, valid until the next call. Chunks within a piece are not copied. */
+    const unsigned char* Next()
+    {
+        if (!m_padded && m_piece < m_pieces.size() && m_pieces[m_piece].size() - m_pos >= 64) {
+            const unsigned char* chunk = m_pieces[m_piece].data() + m_pos;
+            m_pos += 64;
+            SkipRead();
+            return chunk;
+        }
+        size_t used = 0;
+        while (used < 64 && m_piece < m_pieces.size()) {
+            const size_t n = std::min(64 - used, m_pieces[m_piece].size() - m_pos);
+            memcpy(m_buf + used, m_pieces[m_piece].data() + m_pos, n);
+            used += n;
+            m_pos += n;
+            SkipRead();
+        }
+        if (used < 64 && !m_padded) {
+            m_buf[used++] = 0x80;
+            m_padded = true;
+        }
+        if (m_padded && used <= 56) {
+            memset(m_buf + used, 0, 56 - used);
+            WriteBE64(m_buf + 56, m_bytes << 3);
+            m_done = true;
+        } else {
+            memset(m_buf + used, 0, 64 - used);
+        }
+        return m_buf;
+    }
+};
+
+/** Hash the messages in as many lanes as the widest TransformMulti has, refilling a lane as soon as its message is done. */
+template <bool double_hash>
+void SHA256MultiImpl(unsigned char* output, std::span<const SHA256Message> messages)
+{
+    if (!TransformMulti_4way && !TransformMulti_8way) {
+        // One lane at a time, as with SHA-NI, is no faster than CSHA256.
+        for (const auto& message : messages) {
+            CSHA256 hasher;
+            for (const auto& piece : message) hasher.Write(piece.data(), piece.size());
+            hasher.Finalize(output);
+            if (double_hash) hasher.Reset().Write(output, 32).Finalize(output);
+            output += 32;
+        }
+        return;
+    }
+    struct Lane {
+        std::optional<PaddedMessage> message;
+        size_t index{0};
+        bool second_stage{false};
+        uint32_t s[8];
+        unsigned char digest[32];
+        std::span<const unsigned char> digest_piece{digest};
+    };
+    std::array<Lane, 8> lanes;
+    const size_t width = TransformMulti_8way ? 8 : 4;
+    size_t next = 0;
+    while (true) {
+        uint32_t* states[8];
+        const unsigned char* chunks[8];
+        size_t active = 0;
+        for (size_t i = 0; i < width; ++i) {
+            Lane& lane = lanes[i];
+            if (!lane.message && next < messages.size()) {
+                lane.message.emplace(messages[next]);
+                lane.index = next++;
+                lane.second_stage = false;
+                sha256::Initialize(lane.s);
+            }
+            if (lane.message) {
+                states[active] = lane.s;
+                chunks[active] = lane.message->Next();
+                ++active;
+            }
+        }
+        if (active == 0) break;
+
+        size_t done = 0;
+        if (TransformMulti_8way) {
+            for (; active - done >= 8; done += 8) TransformMulti_8way(states + done, chunks + done);
+        }
+        if (TransformMulti_4way) {
+            for (; active - done >= 4; done += 4) TransformMulti_4way(states + done, chunks + done);
+        }
+        for (; done < active; ++done) Transform(states[done], chunks[done], 1);
+
+        for (size_t i = 0; i < width; ++i) {
+            Lane& lane = lanes[i];
+            if (!lane.message || !lane.message->Done()) continue;
+            unsigned char* out = double_hash && !lane.second_stage ? lane.digest : output + 32 * lane.index;
+            for (int j = 0; j < 8; ++j) WriteBE32(out + 4 * j, lane.s[j]);
+            if (double_hash && !lane.second_stage) {
+                lane.message.emplace(SHA256Message{&lane.digest_piece, 1});
+                lane.second_stage = true;
+                sha256::Initialize(lane.s);
+            } else {
+                lane.message.reset();
+            }
+        }
+    }
+}
+} // namespace
+
+void SHA256Multi(unsigned char* output, std::span<const SHA256Message> messages)
+{
+    SHA256MultiImpl<false>(output, messages);
+}
+
+void SHA256DMulti(unsigned char* output, std::span<const SHA256Message> messages)
+{
+    SHA256MultiImpl<true>(output, messages);
+}
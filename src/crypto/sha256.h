@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <cstdlib>
+#include <span>
 #include <string>
 
 /** A hasher class for SHA-256. */
@@ -50,4 +51,17 @@ std::string SHA256AutoDetect(sha256_implementation::UseImplementation use_implem
  */
 void SHA256D64(unsigned char* output, const unsigned char* input, size_t blocks);
 
+/** A message to hash with SHA256Multi, in pieces that are hashed as if concatenated. */
+using SHA256Message = std::span<const std::span<const unsigned char>>;
+
+/** Compute the SHA256's of messages of any length, several at a time in SIMD
+ *  lanes when available, like the txids of the transactions of a block.
+ *  output:   pointer to a messages.size()*32 byte output buffer
+ *  messages: the messages to hash.
+ */
+void SHA256Multi(unsigned char* output, std::span<const SHA256Message> messages);
+
+/** As SHA256Multi, for double-SHA256's. */
+void SHA256DMulti(unsigned char* output, std::span<const SHA256Message> messages);
+
 #endif // HYLIUM_CRYPTO_SHA256_H
@@ -71,6 +71,35 @@ void inline Write8(unsigned char* out, int offset, __m256i v) {
     WriteLE32(out + 224 + offset, _mm256_extract_epi32(v, 0));
 }
 
+/** The SHA-256 round constants. */
+const uint32_t ROUND_K[64] = {
+    0x428a2f98ul, 0x71374491ul, 0xb5c0fbcful, 0xe9b5dba5ul, 0x3956c25bul, 0x59f111f1ul, 0x923f82a4ul, 0xab1c5ed5ul,
+    0xd807aa98ul, 0x12835b01ul, 0x243185beul, 0x550c7dc3ul, 0x72be5d74ul, 0x80deb1feul, 0x9bdc06a7ul, 0xc19bf174ul,
+    0xe49b69c1ul, 0xefbe4786ul, 0x0fc19dc6ul, 0x240ca1ccul, 0x2de92c6ful, 0x4a7484aaul, 0x5cb0a9dcul, 0x76f988daul,
+    0x983e5152ul, 0xa831c66dul, 0xb00327c8ul, 0xbf597fc7ul, 0xc6e00bf3ul, 0xd5a79147ul, 0x06ca6351ul, 0x14292967ul,
+    0x27b70a85ul, 0x2e1b2138ul, 0x4d2c6dfcul, 0x53380d13ul, 0x650a7354ul, 0x766a0abbul, 0x81c2c92eul, 0x92722c85ul,
+    0xa2bfe8a1ul, 0xa81a664bul, 0xc24b8b70ul, 0xc76c51a3ul, 0xd192e819ul, 0xd6990624ul, 0xf40e3585ul, 0x106aa070ul,
+    0x19a4c116ul, 0x1e376c08ul, 0x2748774cul, 0x34b0bcb5ul, 0x391c0cb3ul, 0x4ed8aa4aul, 0x5b9cca4ful, 0x682e6ff3ul,
+    0x748f82eeul, 0x78a5636ful, 0x84c87814ul, 0x8cc70208ul, 0x90befffaul, 0xa4506cebul, 0xbef9a3f7ul, 0xc67178f2ul,
+};
+
+/** Word i of the message schedule, computed in place in the ring w of the last 16 words. */
+__m256i inline Schedule(__m256i* w, int i)
+{
+    if (i >= 16) Inc(w[i & 15], sigma1(w[(i + 14) & 15]), w[(i + 9) & 15], sigma0(w[(i + 1) & 15]));
+    return w[i & 15];
+}
+
+/** Word i of the states of the lanes. */
+__m256i inline Load8(const uint32_t* const* s, int i) { return _mm256_setr_epi32(s[0][i], s[1][i], s[2][i], s[3][i], s[4][i], s[5][i], s[6][i], s[7][i]); }
+
+void inline Store8(uint32_t* const* s, int i, __m256i v)
+{
+    alignas(sizeof(__m256i)) uint32_t words[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(words), v);
+    for (int j = 0; j < 8; ++j) s[j][i] = words[j];
+}
+
 }
 
 void Transform_8way(unsigned char* out, const unsigned char* in)
@@ -324,6 +353,42 @@ void Transform_8way(unsigned char* out, const unsigned char* in)
     Write8(out, 28, Add(h, K(0x5be0cd19ul)));
 }
 
+
+void TransformMulti_8way(uint32_t* const* s, const unsigned char* const* chunks)
+{
+    __m256i w[16];
+    for (int i = 0; i < 16; ++i) w[i] = _mm256_setr_epi32(ReadBE32(chunks[0] + 4 * i), ReadBE32(chunks[1] + 4 * i), ReadBE32(chunks[2] + 4 * i), ReadBE32(chunks[3] + 4 * i), ReadBE32(chunks[4] + 4 * i), ReadBE32(chunks[5] + 4 * i), ReadBE32(chunks[6] + 4 * i), ReadBE32(chunks[7] + 4 * i));
+
+    __m256i a = Load8(s, 0);
+    __m256i b = Load8(s, 1);
+    __m256i c = Load8(s, 2);
+    __m256i d = Load8(s, 3);
+    __m256i e = Load8(s, 4);
+    __m256i f = Load8(s, 5);
+    __m256i g = Load8(s, 6);
+    __m256i h = Load8(s, 7);
+
+    for (int i = 0; i < 64; i += 8) {
+        Round(a, b, c, d, e, f, g, h, Add(K(ROUND_K[i + 0]), Schedule(w, i + 0)));
+        Round(h, a, b, c, d, e, f, g, Add(K(ROUND_K[i + 1]), Schedule(w, i + 1)));
+        Round(g, h, a, b, c, d, e, f, Add(K(ROUND_K[i + 2]), Schedule(w, i + 2)));
+        Round(f, g, h, a, b, c, d, e, Add(K(ROUND_K[i + 3]), Schedule(w, i + 3)));
+        Round(e, f, g, h, a, b, c, d, Add(K(ROUND_K[i + 4]), Schedule(w, i + 4)));
+        Round(d, e, f, g, h, a, b, c, Add(K(ROUND_K[i + 5]), Schedule(w, i + 5)));
+        Round(c, d, e, f, g, h, a, b, Add(K(ROUND_K[i + 6]), Schedule(w, i + 6)));
+        Round(b, c, d, e, f, g, h, a, Add(K(ROUND_K[i + 7]), Schedule(w, i + 7)));
+    }
+
+    Store8(s, 0, Add(a, Load8(s, 0)));
+    Store8(s, 1, Add(b, Load8(s, 1)));
+    Store8(s, 2, Add(c, Load8(s, 2)));
+    Store8(s, 3, Add(d, Load8(s, 3)));
+    Store8(s, 4, Add(e, Load8(s, 4)));
+    Store8(s, 5, Add(f, Load8(s, 5)));
+    Store8(s, 6, Add(g, Load8(s, 6)));
+    Store8(s, 7, Add(h, Load8(s, 7)));
+}
+
 }
 
 #endif
@@ -4,6 +4,7 @@
 
 #include <crypto/siphash.h>
 
+#include <crypto/common.h>
 #include <uint256.h>
 
 #include <bit>
@@ -124,6 +125,33 @@ uint64_t PresaltedSipHasher::operator()(const uint256& val) const noexcept
     return v0 ^ v1 ^ v2 ^ v3;
 }
 
+uint64_t PresaltedSipHasher::operator()(std::span<const unsigned char> data) const noexcept
+{
+    uint64_t v0 = m_state.v[0], v1 = m_state.v[1], v2 = m_state.v[2], v3 = m_state.v[3];
+    // Only the low 8 bits of the input size matter.
+    uint64_t t = uint64_t{data.size()} << 56;
+    for (; data.size() >= 8; data = data.subspan(8)) {
+        const uint64_t d = ReadLE64(data.data());
+        v3 ^= d;
+        SIPROUND;
+        SIPROUND;
+        v0 ^= d;
+    }
+    for (size_t i = 0; i < data.size(); ++i) {
+        t |= uint64_t{data[i]} << (8 * i);
+    }
+    v3 ^= t;
+    SIPROUND;
+    SIPROUND;
+    v0 ^= t;
+    v2 ^= 0xFF;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    SIPROUND;
+    return v0 ^ v1 ^ v2 ^ v3;
+}
+
 /** Specialized implementation for efficiency */
 uint64_t PresaltedSipHasher::operator()(const uint256& val, uint32_t extra) const noexcept
 {
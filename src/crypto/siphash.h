@@ -48,7 +48,7 @@ public:
  *
  * This class caches the initial SipHash v[0..3] state derived from (k0, k1)
  * and implements a specialized hashing path for uint256 values, with or
- * without an extra 32-bit word. The internal state is immutable, so
+ * without an extra 32-bit word, and for byte strings hashed in one go. The internal state is immutable, so
  * PresaltedSipHasher instances can be reused for multiple hashes with the
  * same key.
  */
@@ -62,6 +62,9 @@ public:
     /** Equivalent to CSipHasher(k0, k1).Write(val).Finalize(). */
     uint64_t operator()(const uint256& val) const noexcept;
 
+    /** Equivalent to CSipHasher(k0, k1).Write(data).Finalize(), reading the data a 64-bit word at a time. */
+    uint64_t operator()(std::span<const unsigned char> data) const noexcept;
+
     /**
      * Equivalent to CSipHasher(k0, k1).Write(val).Write(extra).Finalize(),
      * with `extra` encoded as 4 little-endian bytes.
@@ -0,0 +1,219 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <dbtrace.h>
+
+#include <dbwrapper.h>
+#include <kvstore.h>
+#include <logging.h>
+#include <random.h>
+#include <span.h>
+#include <streams.h>
+#include <sync.h>
+
+#include <optional>
+#include <utility>
+
+namespace {
+
+std::string ToKey(std::span<const std::byte> key)
+{
+    return {reinterpret_cast<const char*>(key.data()), key.size()};
+}
+
+class TraceFile
+{
+private:
+    Mutex m_mutex;
+    AutoFile m_file GUARDED_BY(m_mutex);
+
+public:
+    explicit TraceFile(const fs::path& path) : m_file{fsbridge::fopen(path, "ab")}
+    {
+        if (WITH_LOCK(m_mutex, return m_file.IsNull())) {
+            throw dbwrapper_error("Failed to open database trace " + fs::PathToString(path));
+        }
+    }
+
+    ~TraceFile()
+    {
+        LOCK(m_mutex);
+        if (m_file.fclose() != 0) LogError("Failed to close database trace");
+    }
+
+    void Append(std::span<const DBTraceOp> ops) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        for (const auto& op : ops) m_file << op;
+    }
+
+    void Append(DBTraceOp::Type type, std::span<const std::byte> key, uint32_t value_size = 0) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        const DBTraceOp op{.type = type, .key = ToKey(key), .value_size = value_size};
+        Append(std::span{&op, 1});
+    }
+};
+
+class TracingBatch : public KVBatch
+{
+public:
+    const std::unique_ptr<KVBatch> m_batch;
+    std::vector<DBTraceOp> m_ops;
+
+    explicit TracingBatch(std::unique_ptr<KVBatch> batch) : m_batch{std::move(batch)} {}
+
+    void Put(std::span<const std::byte> key, std::span<const std::byte> value) override
+    {
+        m_batch->Put(key, value);
+        m_ops.push_back({.type = DBTraceOp::Type::PUT, .key = ToKey(key), .value_size = uint32_t(value.size())});
+    }
+    void Delete(std::span<const std::byte> key) override
+    {
+        m_batch->Delete(key);
+        m_ops.push_back({.type = DBTraceOp::Type::ERASE, .key = ToKey(key)});
+    }
+    void Clear() override
+    {
+        m_batch->Clear();
+        m_ops.clear();
+    }
+    size_t ApproximateSize() const override { return m_batch->ApproximateSize(); }
+};
+
+class TracingIterator : public KVIterator
+{
+private:
+    const std::unique_ptr<KVIterator> m_iterator;
+    const std::shared_ptr<TraceFile> m_trace;
+
+public:
+    TracingIterator(std::unique_ptr<KVIterator> iterator, std::shared_ptr<TraceFile> trace)
+        : m_iterator{std::move(iterator)}, m_trace{std::move(trace)} {}
+
+    bool Valid() const override { return m_iterator->Valid(); }
+    void SeekToFirst() override
+    {
+        m_trace->Append(DBTraceOp::Type::SEEK, {});
+        m_iterator->SeekToFirst();
+    }
+    void Seek(std::span<const std::byte> key) override
+    {
+        m_trace->Append(DBTraceOp::Type::SEEK, key);
+        m_iterator->Seek(key);
+    }
+    void Next() override
+    {
+        m_trace->Append(DBTraceOp::Type::NEXT, {});
+        m_iterator->Next();
+    }
+    std::span<const std::byte> Key() const override { return m_iterator->Key(); }
+    std::span<const std::byte> Value() const override { return m_iterator->Value(); }
+};
+
+class TracingStore : public KVStore
+{
+private:
+    const std::unique_ptr<KVStore> m_store;
+    const std::shared_ptr<TraceFile> m_trace;
+
+public:
+    TracingStore(std::unique_ptr<KVStore> store, const fs::path& path)
+        : m_store{std::move(store)}, m_trace{std::make_shared<TraceFile>(path)} {}
+
+    std::unique_ptr<KVBatch> NewBatch() const override { return std::make_unique<TracingBatch>(m_store->NewBatch()); }
+
+    void Write(KVBatch& kvbatch, bool sync) override
+    {
+        auto& batch{static_cast<TracingBatch&>(kvbatch)};
+        m_store->Write(*batch.m_batch, sync);
+        batch.m_ops.push_back({.type = DBTraceOp::Type::COMMIT, .value_size = sync});
+        m_trace->Append(batch.m_ops);
+        batch.m_ops.pop_back();
+    }
+
+    std::optional<std::string> Read(std::span<const std::byte> key) const override
+    {
+        m_trace->Append(DBTraceOp::Type::READ, key);
+        return m_store->Read(key);
+    }
+
+    bool Exists(std::span<const std::byte> key) const override
+    {
+        m_trace->Append(DBTraceOp::Type::EXISTS, key);
+        return m_store->Exists(key);
+    }
+
+    std::unique_ptr<KVIterator> NewIterator() const override
+    {
+        return std::make_unique<TracingIterator>(m_store->NewIterator(), m_trace);
+    }
+
+    size_t EstimateSize(std::span<const std::byte> begin, std::span<const std::byte> end) const override
+    {
+        return m_store->EstimateSize(begin, end);
+    }
+
+    size_t DynamicMemoryUsage() const override { return m_store->DynamicMemoryUsage(); }
+    DBStats GetStats() const override { return m_store->GetStats(); }
+    void CompactAll() override { m_store->CompactAll(); }
+};
+
+} // namespace
+
+std::unique_ptr<KVStore> MakeTracingKVStore(std::unique_ptr<KVStore> store, const fs::path& path)
+{
+    return std::make_unique<TracingStore>(std::move(store), path);
+}
+
+std::vector<DBTraceOp> ReadDBTrace(const fs::path& path)
+{
+    AutoFile file{fsbridge::fopen(path, "rb")};
+    if (file.IsNull()) throw std::ios_base::failure("Failed to open " + fs::PathToString(path));
+    std::vector<std::byte> data(file.size());
+    file.read(data);
+    (void)file.fclose();
+
+    std::vector<DBTraceOp> trace;
+    SpanReader reader{data};
+    while (!reader.empty()) reader >> trace.emplace_back();
+    return trace;
+}
+
+void ReplayDBTrace(KVStore& store, std::span<const DBTraceOp> trace)
+{
+    // Random values, like the obfuscated values of the database
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<std::byte> values;
+    std::unique_ptr<KVBatch> batch{store.NewBatch()};
+    std::unique_ptr<KVIterator> iterator;
+    for (const auto& op : trace) {
+        const auto key{MakeByteSpan(op.key)};
+        switch (op.type) {
+        case DBTraceOp::Type::READ:
+            (void)store.Read(key);
+            break;
+        case DBTraceOp::Type::EXISTS:
+            (void)store.Exists(key);
+            break;
+        case DBTraceOp::Type::PUT:
+            while (values.size() < op.value_size) values.push_back(std::byte(rng.rand32()));
+            batch->Put(key, std::span{values}.first(op.value_size));
+            break;
+        case DBTraceOp::Type::ERASE:
+            batch->Delete(key);
+            break;
+        case DBTraceOp::Type::COMMIT:
+            store.Write(*batch, /*sync=*/op.value_size != 0);
+            batch->Clear();
+            break;
+        case DBTraceOp::Type::SEEK:
+            iterator = store.NewIterator();
+            iterator->Seek(key);
+            break;
+        case DBTraceOp::Type::NEXT:
+            if (iterator && iterator->Valid()) iterator->Next();
+            break;
+        } // no default case, so the compiler can warn about missing cases
+    }
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef HYLIUM_DBTRACE_H
+#define HYLIUM_DBTRACE_H
+
+#include <serialize.h>
+#include <util/fs.h>
+
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+class KVStore;
+
+/**
+ * An operation on a database, as recorded with -dbtrace, so that the way a
+ * database is used can be replayed against other profiles (see DBOptions).
+ * Keys are recorded as they are stored. Values are not recorded, only their
+ * size.
+ */
+struct DBTraceOp {
+    enum class Type : uint8_t {
+        READ,
+        EXISTS,
+        //! Puts and erases of a batch, written by the COMMIT that follows them
+        PUT,
+        ERASE,
+        COMMIT,
+        //! Start an iterator at the key, or at the first key if empty
+        SEEK,
+        NEXT,
+    };
+
+    Type type{Type::READ};
+    std::string key{};
+    //! Size of the value of a PUT, and whether a COMMIT is synced
+    uint32_t value_size{0};
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        s << uint8_t(type) << key << VARINT(value_size);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        uint8_t raw_type;
+        s >> raw_type >> key >> VARINT(value_size);
+        if (raw_type > uint8_t(Type::NEXT)) throw std::ios_base::failure("Unknown database trace operation");
+        type = Type{raw_type};
+    }
+};
+
+//! Wrap store in one that records the operations on it to path
+std::unique_ptr<KVStore> MakeTracingKVStore(std::unique_ptr<KVStore> store, const fs::path& path);
+
+//! Read a trace recorded by a tracing store. Throws std::ios_base::failure if
+//! the file can't be read.
+std::vector<DBTraceOp> ReadDBTrace(const fs::path& path);
+
+//! Perform the operations of a trace on store, with values of the recorded sizes
+void ReplayDBTrace(KVStore& store, std::span<const DBTraceOp> trace);
+
+#endif // HYLIUM_DBTRACE_H
@@ -4,15 +4,19 @@
 
 #include <dbwrapper.h>
 
+#include <dbtrace.h>
+#include <kvstore.h>
 #include <logging.h>
 #include <random.h>
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
+#include <tinyformat.h>
 #include <util/fs.h>
 #include <util/fs_helpers.h>
 #include <util/obfuscation.h>
 #include <util/strencodings.h>
+#include <util/string.h>
 
 #include <algorithm>
 #include <cassert>
@@ -37,9 +41,26 @@ static auto CharCast(const std::byte* data) { return reinterpret_cast<const char
 
 bool DestroyDB(const std::string& path_str)
 {
+    if (IsLogDB(fs::PathFromString(path_str))) return DestroyLogDB(fs::PathFromString(path_str));
     return leveldb::DestroyDB(path_str, {}).ok();
 }
 
+std::optional<DBEngine> ParseDBEngine(std::string_view name)
+{
+    if (name == "leveldb") return DBEngine::LEVELDB;
+    if (name == "logdb") return DBEngine::LOGDB;
+    return std::nullopt;
+}
+
+std::string DBEngineName(DBEngine engine)
+{
+    switch (engine) {
+    case DBEngine::LEVELDB: return "leveldb";
+    case DBEngine::LOGDB: return "logdb";
+    } // no default case, so the compiler can warn about missing cases
+    assert(false);
+}
+
 /** Handle database error by throwing dbwrapper_error exception.
  */
 static void HandleError(const leveldb::Status& status)
@@ -135,13 +156,16 @@ static void SetMaxOpenFiles(leveldb::Options *options) {
              options->max_open_files, default_open_files);
 }
 
-static leveldb::Options GetOptions(size_t nCacheSize)
+static leveldb::Options GetOptions(size_t nCacheSize, const DBOptions& db_options)
 {
     leveldb::Options options;
-    options.block_cache = leveldb::NewLRUCache(nCacheSize / 2);
-    options.write_buffer_size = nCacheSize / 4; // up to two write buffers may be held in memory simultaneously
-    options.filter_policy = leveldb::NewBloomFilterPolicy(10);
-    options.compression = leveldb::kNoCompression;
+    const size_t block_cache_size{nCacheSize / 100 * std::clamp(db_options.block_cache_percent, 0, 100)};
+    options.block_cache = leveldb::NewLRUCache(block_cache_size);
+    // up to two write buffers may be held in memory simultaneously
+    options.write_buffer_size = db_options.write_buffer_size.value_or((nCacheSize - block_cache_size) / 2);
+    options.filter_policy = db_options.bloom_bits > 0 ? leveldb::NewBloomFilterPolicy(db_options.bloom_bits) : nullptr;
+    options.block_size = db_options.block_size;
+    options.compression = db_options.compression ? leveldb::kSnappyCompression : leveldb::kNoCompression;
     options.info_log = new CHyliumLevelDBLogger();
     if (leveldb::kMajorVersion > 1 || (leveldb::kMajorVersion == 1 && leveldb::kMinorVersion >= 16)) {
         // LevelDB versions before 1.16 consider short writes to be corruption. Only trigger error
@@ -149,50 +173,52 @@ static leveldb::Options GetOptions(size_t nCacheSize)
         options.paranoid_checks = true;
     }
     options.max_file_size = std::max(options.max_file_size, DBWRAPPER_MAX_FILE_SIZE);
-    SetMaxOpenFiles(&options);
+    options.max_subcompactions = DBWRAPPER_MAX_SUBCOMPACTIONS;
+    if (db_options.max_open_files > 0) {
+        options.max_open_files = db_options.max_open_files;
+    } else {
+        SetMaxOpenFiles(&options);
+    }
     return options;
 }
 
-struct CDBBatch::WriteBatchImpl {
-    leveldb::WriteBatch batch;
-};
+namespace {
 
-CDBBatch::CDBBatch(const CDBWrapper& _parent)
-    : parent{_parent},
-      m_impl_batch{std::make_unique<CDBBatch::WriteBatchImpl>()}
+class LevelDBBatch : public KVBatch
 {
-    Clear();
-};
-
-CDBBatch::~CDBBatch() = default;
+public:
+    leveldb::WriteBatch batch;
 
-void CDBBatch::Clear()
-{
-    m_impl_batch->batch.Clear();
-}
+    void Put(std::span<const std::byte> key, std::span<const std::byte> value) override
+    {
+        batch.Put({CharCast(key.data()), key.size()}, {CharCast(value.data()), value.size()});
+    }
+    void Delete(std::span<const std::byte> key) override { batch.Delete({CharCast(key.data()), key.size()}); }
+    void Clear() override { batch.Clear(); }
+    size_t ApproximateSize() const override { return batch.ApproximateSize(); }
+};
 
-void CDBBatch::WriteImpl(std::span<const std::byte> key, DataStream& ssValue)
+class LevelDBIterator : public KVIterator
 {
-    leveldb::Slice slKey(CharCast(key.data()), key.size());
-    dbwrapper_private::GetObfuscation(parent)(ssValue);
-    leveldb::Slice slValue(CharCast(ssValue.data()), ssValue.size());
-    m_impl_batch->batch.Put(slKey, slValue);
-}
+private:
+    const std::unique_ptr<leveldb::Iterator> iter;
 
-void CDBBatch::EraseImpl(std::span<const std::byte> key)
-{
-    leveldb::Slice slKey(CharCast(key.data()), key.size());
-    m_impl_batch->batch.Delete(slKey);
-}
+public:
+    explicit LevelDBIterator(leveldb::Iterator* _iter) : iter{_iter} {}
+
+    bool Valid() const override { return iter->Valid(); }
+    void SeekToFirst() override { iter->SeekToFirst(); }
+    void Seek(std::span<const std::byte> key) override { iter->Seek({CharCast(key.data()), key.size()}); }
+    void Next() override { iter->Next(); }
+    std::span<const std::byte> Key() const override { return MakeByteSpan(iter->key()); }
+    std::span<const std::byte> Value() const override { return MakeByteSpan(iter->value()); }
+};
 
-size_t CDBBatch::ApproximateSize() const
+class LevelDBStore : public KVStore
 {
-    return m_impl_batch->batch.ApproximateSize();
-}
-
-struct LevelDBContext {
+private:
     //! custom environment this database is using (may be nullptr in case of default environment)
-    leveldb::Env* penv;
+    leveldb::Env* penv{nullptr};
 
     //! database options used
     leveldb::Options options;
@@ -210,42 +236,220 @@ struct LevelDBContext {
     leveldb::WriteOptions syncoptions;
 
     //! the database itself
-    leveldb::DB* pdb;
+    leveldb::DB* pdb{nullptr};
+
+public:
+    explicit LevelDBStore(const DBParams& params)
+    {
+        readoptions.verify_checksums = true;
+        iteroptions.verify_checksums = true;
+        iteroptions.fill_cache = false;
+        syncoptions.sync = true;
+        options = GetOptions(params.cache_bytes, params.options);
+        options.create_if_missing = true;
+        if (params.memory_only) {
+            penv = leveldb::NewMemEnv(leveldb::Env::Default());
+            options.env = penv;
+        } else {
+            if (params.wipe_data) {
+                LogInfo("Wiping LevelDB in %s", fs::PathToString(params.path));
+                leveldb::Status result = leveldb::DestroyDB(fs::PathToString(params.path), options);
+                HandleError(result);
+            }
+            TryCreateDirectories(params.path);
+            LogInfo("Opening LevelDB in %s", fs::PathToString(params.path));
+        }
+        // PathToString() return value is safe to pass to leveldb open function,
+        // because on POSIX leveldb passes the byte string directly to ::open(), and
+        // on Windows it converts from UTF-8 to UTF-16 before calling ::CreateFileW
+        // (see env_posix.cc and env_windows.cc).
+        leveldb::Status status = leveldb::DB::Open(options, fs::PathToString(params.path), &pdb);
+        HandleError(status);
+        LogInfo("Opened LevelDB successfully");
+    }
+
+    ~LevelDBStore() override
+    {
+        delete pdb;
+        pdb = nullptr;
+        delete options.filter_policy;
+        options.filter_policy = nullptr;
+        delete options.info_log;
+        options.info_log = nullptr;
+        delete options.block_cache;
+        options.block_cache = nullptr;
+        delete penv;
+        options.env = nullptr;
+    }
+
+    std::unique_ptr<KVBatch> NewBatch() const override { return std::make_unique<LevelDBBatch>(); }
+
+    void Write(KVBatch& batch, bool sync) override
+    {
+        leveldb::Status status = pdb->Write(sync ? syncoptions : writeoptions, &static_cast<LevelDBBatch&>(batch).batch);
+        HandleError(status);
+    }
+
+    std::optional<std::string> Read(std::span<const std::byte> key) const override
+    {
+        leveldb::Slice slKey(CharCast(key.data()), key.size());
+        std::string strValue;
+        leveldb::Status status = pdb->Get(readoptions, slKey, &strValue);
+        if (!status.ok()) {
+            if (status.IsNotFound())
+                return std::nullopt;
+            LogError("LevelDB read failure: %s", status.ToString());
+            HandleError(status);
+        }
+        return strValue;
+    }
+
+    bool Exists(std::span<const std::byte> key) const override
+    {
+        return Read(key).has_value();
+    }
+
+    std::unique_ptr<KVIterator> NewIterator() const override
+    {
+        return std::make_unique<LevelDBIterator>(pdb->NewIterator(iteroptions));
+    }
+
+    size_t EstimateSize(std::span<const std::byte> key1, std::span<const std::byte> key2) const override
+    {
+        leveldb::Slice slKey1(CharCast(key1.data()), key1.size());
+        leveldb::Slice slKey2(CharCast(key2.data()), key2.size());
+        uint64_t size = 0;
+        leveldb::Range range(slKey1, slKey2);
+        pdb->GetApproximateSizes(&range, 1, &size);
+        return size;
+    }
+
+    size_t DynamicMemoryUsage() const override
+    {
+        std::string memory;
+        std::optional<size_t> parsed;
+        if (!pdb->GetProperty("leveldb.approximate-memory-usage", &memory) || !(parsed = ToIntegral<size_t>(memory))) {
+            LogDebug(BCLog::LEVELDB, "Failed to get approximate-memory-usage property\n");
+            return 0;
+        }
+        return parsed.value();
+    }
+
+    DBStats GetStats() const override
+    {
+        DBStats stats;
+        std::string value;
+        for (int level{0}; pdb->GetProperty(strprintf("leveldb.num-files-at-level%d", level), &value); ++level) {
+            auto& level_stats{stats.levels.emplace_back()};
+            level_stats.files = ToIntegral<uint64_t>(value).value_or(0);
+            if (pdb->GetProperty(strprintf("leveldb.bytes-at-level%d", level), &value)) {
+                level_stats.bytes = ToIntegral<uint64_t>(value).value_or(0);
+            }
+            if (pdb->GetProperty(strprintf("leveldb.compaction-stats-at-level%d", level), &value)) {
+                const auto fields{util::SplitString(value, ' ')};
+                if (fields.size() == 3) {
+                    level_stats.compaction_time = std::chrono::microseconds{ToIntegral<int64_t>(fields[0]).value_or(0)};
+                    level_stats.compaction_bytes_read = ToIntegral<uint64_t>(fields[1]).value_or(0);
+                    level_stats.compaction_bytes_written = ToIntegral<uint64_t>(fields[2]).value_or(0);
+                }
+            }
+        }
+        if (pdb->GetProperty("leveldb.write-stalls", &value)) {
+            const auto fields{util::SplitString(value, ' ')};
+            const char* const causes[]{"level0_slowdown", "memtable_full", "level0_stop"};
+            for (size_t i{0}; i < std::size(causes) && 2 * i + 1 < fields.size(); ++i) {
+                stats.write_stalls.push_back({.cause = causes[i],
+                                              .count = ToIntegral<uint64_t>(fields[2 * i]).value_or(0),
+                                              .time = std::chrono::microseconds{ToIntegral<int64_t>(fields[2 * i + 1]).value_or(0)}});
+            }
+        }
+        return stats;
+    }
+
+    void CompactAll() override { pdb->CompactRange(nullptr, nullptr); }
 };
 
+} // namespace
+
+std::unique_ptr<KVStore> OpenLevelDB(const DBParams& params)
+{
+    return std::make_unique<LevelDBStore>(params);
+}
+
+bool IsLevelDB(const fs::path& path)
+{
+    return fs::exists(path / "CURRENT");
+}
+
+bool DestroyLevelDB(const fs::path& path)
+{
+    return leveldb::DestroyDB(fs::PathToString(path), {}).ok();
+}
+
+CDBBatch::CDBBatch(const CDBWrapper& _parent)
+    : parent{_parent},
+      m_impl_batch{_parent.Store().NewBatch()}
+{
+    Clear();
+};
+
+CDBBatch::~CDBBatch() = default;
+
+void CDBBatch::Clear()
+{
+    m_impl_batch->Clear();
+}
+
+void CDBBatch::WriteImpl(std::span<const std::byte> key, DataStream& ssValue)
+{
+    dbwrapper_private::GetObfuscation(parent)(ssValue);
+    m_impl_batch->Put(key, ssValue);
+}
+
+void CDBBatch::EraseImpl(std::span<const std::byte> key)
+{
+    m_impl_batch->Delete(key);
+}
+
+size_t CDBBatch::ApproximateSize() const
+{
+    return m_impl_batch->ApproximateSize();
+}
+
 CDBWrapper::CDBWrapper(const DBParams& params)
-    : m_db_context{std::make_unique<LevelDBContext>()}, m_name{fs::PathToString(params.path.stem())}, m_path{params.path}, m_is_memory{params.memory_only}
+    : m_name{fs::PathToString(params.path.stem())}, m_path{params.path}, m_is_memory{params.memory_only}
 {
-    DBContext().penv = nullptr;
-    DBContext().readoptions.verify_checksums = true;
-    DBContext().iteroptions.verify_checksums = true;
-    DBContext().iteroptions.fill_cache = false;
-    DBContext().syncoptions.sync = true;
-    DBContext().options = GetOptions(params.cache_bytes);
-    DBContext().options.create_if_missing = true;
-    if (params.memory_only) {
-        DBContext().penv = leveldb::NewMemEnv(leveldb::Env::Default());
-        DBContext().options.env = DBContext().penv;
-    } else {
-        if (params.wipe_data) {
-            LogInfo("Wiping LevelDB in %s", fs::PathToString(params.path));
-            leveldb::Status result = leveldb::DestroyDB(fs::PathToString(params.path), DBContext().options);
-            HandleError(result);
+    DBEngine engine{params.options.engine};
+    if (!params.memory_only) {
+        std::optional<DBEngine> existing;
+        if (IsLogDB(params.path)) {
+            existing = DBEngine::LOGDB;
+        } else if (IsLevelDB(params.path)) {
+            existing = DBEngine::LEVELDB;
+        }
+        if (existing && *existing != engine) {
+            if (params.wipe_data) {
+                LogInfo("Wiping %s database in %s", DBEngineName(*existing), fs::PathToString(params.path));
+                if (!(*existing == DBEngine::LOGDB ? DestroyLogDB(params.path) : DestroyLevelDB(params.path))) {
+                    throw dbwrapper_error("Failed to wipe database in " + fs::PathToString(params.path));
+                }
+            } else {
+                LogInfo("Database in %s keeps the %s engine until it is rebuilt", fs::PathToString(params.path), DBEngineName(*existing));
+                engine = *existing;
+            }
         }
-        TryCreateDirectories(params.path);
-        LogInfo("Opening LevelDB in %s", fs::PathToString(params.path));
     }
-    // PathToString() return value is safe to pass to leveldb open function,
-    // because on POSIX leveldb passes the byte string directly to ::open(), and
-    // on Windows it converts from UTF-8 to UTF-16 before calling ::CreateFileW
-    // (see env_posix.cc and env_windows.cc).
-    leveldb::Status status = leveldb::DB::Open(DBContext().options, fs::PathToString(params.path), &DBContext().pdb);
-    HandleError(status);
-    LogInfo("Opened LevelDB successfully");
+    m_store = engine == DBEngine::LOGDB ? OpenLogDB(params) : OpenLevelDB(params);
+    m_engine = engine;
+    if (!params.options.trace_path.empty()) {
+        LogInfo("Recording the operations on %s to %s", fs::PathToString(params.path), fs::PathToString(params.options.trace_path));
+        TryCreateDirectories(params.options.trace_path.parent_path());
+        m_store = MakeTracingKVStore(std::move(m_store), params.options.trace_path);
+    }
 
     if (params.options.force_compact) {
         LogInfo("Starting database compaction of %s", fs::PathToString(params.path));
-        DBContext().pdb->CompactRange(nullptr, nullptr);
+        Store().CompactAll();
         LogInfo("Finished database compaction of %s", fs::PathToString(params.path));
     }
 
@@ -260,19 +464,7 @@ CDBWrapper::CDBWrapper(const DBParams& params)
     LogInfo("Using obfuscation key for %s: %s", fs::PathToString(params.path), m_obfuscation.HexKey());
 }
 
-CDBWrapper::~CDBWrapper()
-{
-    delete DBContext().pdb;
-    DBContext().pdb = nullptr;
-    delete DBContext().options.filter_policy;
-    DBContext().options.filter_policy = nullptr;
-    delete DBContext().options.info_log;
-    DBContext().options.info_log = nullptr;
-    delete DBContext().options.block_cache;
-    DBContext().options.block_cache = nullptr;
-    delete DBContext().penv;
-    DBContext().options.env = nullptr;
-}
+CDBWrapper::~CDBWrapper() = default;
 
 void CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
 {
@@ -281,8 +473,7 @@ void CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
     if (log_memory) {
         mem_before = DynamicMemoryUsage() / 1024.0 / 1024;
     }
-    leveldb::Status status = DBContext().pdb->Write(fSync ? DBContext().syncoptions : DBContext().writeoptions, &batch.m_impl_batch->batch);
-    HandleError(status);
+    Store().Write(*batch.m_impl_batch, fSync);
     if (log_memory) {
         double mem_after = DynamicMemoryUsage() / 1024.0 / 1024;
         LogDebug(BCLog::LEVELDB, "WriteBatch memory usage: db=%s, before=%.1fMiB, after=%.1fMiB\n",
@@ -292,52 +483,29 @@ void CDBWrapper::WriteBatch(CDBBatch& batch, bool fSync)
 
 size_t CDBWrapper::DynamicMemoryUsage() const
 {
-    std::string memory;
-    std::optional<size_t> parsed;
-    if (!DBContext().pdb->GetProperty("leveldb.approximate-memory-usage", &memory) || !(parsed = ToIntegral<size_t>(memory))) {
-        LogDebug(BCLog::LEVELDB, "Failed to get approximate-memory-usage property\n");
-        return 0;
-    }
-    return parsed.value();
+    return Store().DynamicMemoryUsage();
+}
+
+DBStats CDBWrapper::GetStats() const
+{
+    DBStats stats{Store().GetStats()};
+    stats.engine = m_engine;
+    return stats;
 }
 
 std::optional<std::string> CDBWrapper::ReadImpl(std::span<const std::byte> key) const
 {
-    leveldb::Slice slKey(CharCast(key.data()), key.size());
-    std::string strValue;
-    leveldb::Status status = DBContext().pdb->Get(DBContext().readoptions, slKey, &strValue);
-    if (!status.ok()) {
-        if (status.IsNotFound())
-            return std::nullopt;
-        LogError("LevelDB read failure: %s", status.ToString());
-        HandleError(status);
-    }
-    return strValue;
+    return Store().Read(key);
 }
 
 bool CDBWrapper::ExistsImpl(std::span<const std::byte> key) const
 {
-    leveldb::Slice slKey(CharCast(key.data()), key.size());
-
-    std::string strValue;
-    leveldb::Status status = DBContext().pdb->Get(DBContext().readoptions, slKey, &strValue);
-    if (!status.ok()) {
-        if (status.IsNotFound())
-            return false;
-        LogError("LevelDB read failure: %s", status.ToString());
-        HandleError(status);
-    }
-    return true;
+    return Store().Exists(key);
 }
 
 size_t CDBWrapper::EstimateSizeImpl(std::span<const std::byte> key1, std::span<const std::byte> key2) const
 {
-    leveldb::Slice slKey1(CharCast(key1.data()), key1.size());
-    leveldb::Slice slKey2(CharCast(key2.data()), key2.size());
-    uint64_t size = 0;
-    leveldb::Range range(slKey1, slKey2);
-    DBContext().pdb->GetApproximateSizes(&range, 1, &size);
-    return size;
+    return Store().EstimateSize(key1, key2);
 }
 
 bool CDBWrapper::IsEmpty()
@@ -347,40 +515,33 @@ bool CDBWrapper::IsEmpty()
     return !(it->Valid());
 }
 
-struct CDBIterator::IteratorImpl {
-    const std::unique_ptr<leveldb::Iterator> iter;
-
-    explicit IteratorImpl(leveldb::Iterator* _iter) : iter{_iter} {}
-};
-
-CDBIterator::CDBIterator(const CDBWrapper& _parent, std::unique_ptr<IteratorImpl> _piter) : parent(_parent),
-                                                                                            m_impl_iter(std::move(_piter)) {}
+CDBIterator::CDBIterator(const CDBWrapper& _parent, std::unique_ptr<KVIterator> _piter) : parent(_parent),
+                                                                                         m_impl_iter(std::move(_piter)) {}
 
 CDBIterator* CDBWrapper::NewIterator()
 {
-    return new CDBIterator{*this, std::make_unique<CDBIterator::IteratorImpl>(DBContext().pdb->NewIterator(DBContext().iteroptions))};
+    return new CDBIterator{*this, Store().NewIterator()};
 }
 
 void CDBIterator::SeekImpl(std::span<const std::byte> key)
 {
-    leveldb::Slice slKey(CharCast(key.data()), key.size());
-    m_impl_iter->iter->Seek(slKey);
+    m_impl_iter->Seek(key);
 }
 
 std::span<const std::byte> CDBIterator::GetKeyImpl() const
 {
-    return MakeByteSpan(m_impl_iter->iter->key());
+    return m_impl_iter->Key();
 }
 
 std::span<const std::byte> CDBIterator::GetValueImpl() const
 {
-    return MakeByteSpan(m_impl_iter->iter->value());
+    return m_impl_iter->Value();
 }
 
 CDBIterator::~CDBIterator() = default;
-bool CDBIterator::Valid() const { return m_impl_iter->iter->Valid(); }
-void CDBIterator::SeekToFirst() { m_impl_iter->iter->SeekToFirst(); }
-void CDBIterator::Next() { m_impl_iter->iter->Next(); }
+bool CDBIterator::Valid() const { return m_impl_iter->Valid(); }
+void CDBIterator::SeekToFirst() { m_impl_iter->SeekToFirst(); }
+void CDBIterator::Next() { m_impl_iter->Next(); }
 
 namespace dbwrapper_private {
 
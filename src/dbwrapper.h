@@ -12,21 +12,85 @@
 #include <util/check.h>
 #include <util/fs.h>
 
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <memory>
 #include <optional>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
 
 static const size_t DBWRAPPER_PREALLOC_KEY_SIZE = 64;
 static const size_t DBWRAPPER_PREALLOC_VALUE_SIZE = 1024;
 static const size_t DBWRAPPER_MAX_FILE_SIZE = 32 << 20; // 32 MiB
+//! Maximum number of threads a LevelDB compaction is split into. Compactions
+//! mostly wait for the disk, so this doesn't depend on the number of cores.
+static const int DBWRAPPER_MAX_SUBCOMPACTIONS = 4;
+
+//! Storage engine of a database, see kvstore.h.
+enum class DBEngine {
+    LEVELDB,
+    LOGDB,
+};
+
+std::optional<DBEngine> ParseDBEngine(std::string_view name);
+std::string DBEngineName(DBEngine engine);
+
+//! Where a storage engine spends its time, to tune the cache sizes by.
+struct DBStats {
+    //! Files of a level of LevelDB, or all the segments of LogDB
+    struct Level {
+        uint64_t files{0};
+        uint64_t bytes{0};
+        //! Totals of the compactions that wrote this level
+        std::chrono::microseconds compaction_time{0};
+        uint64_t compaction_bytes_read{0};
+        uint64_t compaction_bytes_written{0};
+    };
+    //! Writes held up until a compaction made room for them, or by the upkeep of the index of LogDB
+    struct WriteStall {
+        std::string cause;
+        uint64_t count{0};
+        std::chrono::microseconds time{0};
+    };
+
+    DBEngine engine{DBEngine::LEVELDB};
+    std::vector<Level> levels;
+    std::vector<WriteStall> write_stalls;
+};
 
 //! User-controlled performance and debug options.
 struct DBOptions {
     //! Compact database on startup.
     bool force_compact = false;
+    //! Engine of a new database. An existing database keeps its engine until it is wiped.
+    DBEngine engine = DBEngine::LEVELDB;
+
+    // The profile of a LevelDB database, set for the way it is used. The
+    // defaults suit a mix of reads and writes.
+
+    //! Share of the cache, in percent, for blocks recently read from the
+    //! files. The rest holds writes until they are written to a file.
+    int block_cache_percent = 50;
+    //! Bytes of writes held before they are written to a file. By default,
+    //! half the rest of the cache, as up to two can be held at once.
+    std::optional<size_t> write_buffer_size{};
+    //! Bits per key of the bloom filters, which spare reading a file for a
+    //! key it doesn't have. 0 disables them.
+    int bloom_bits = 10;
+    //! Approximate size of the blocks files are read in.
+    size_t block_size = 4096;
+    //! Compress the blocks of the files, which needs LevelDB built with
+    //! Snappy. It is not, so -dbprofile rejects compression=1.
+    bool compression = false;
+    //! Files kept open at once, or 0 for a default that suits the platform.
+    int max_open_files = 0;
+
+    //! Record the operations on the database to this file, see dbtrace.h.
+    fs::path trace_path{};
 };
 
 //! Application-specific storage settings.
@@ -53,6 +117,9 @@ public:
 };
 
 class CDBWrapper;
+class KVBatch;
+class KVIterator;
+class KVStore;
 
 /** These should be considered an implementation detail of the specific database.
  */
@@ -75,8 +142,7 @@ class CDBBatch
 private:
     const CDBWrapper &parent;
 
-    struct WriteBatchImpl;
-    const std::unique_ptr<WriteBatchImpl> m_impl_batch;
+    const std::unique_ptr<KVBatch> m_impl_batch;
 
     DataStream ssKey{};
     DataStream ssValue{};
@@ -118,12 +184,9 @@ public:
 
 class CDBIterator
 {
-public:
-    struct IteratorImpl;
-
 private:
     const CDBWrapper &parent;
-    const std::unique_ptr<IteratorImpl> m_impl_iter;
+    const std::unique_ptr<KVIterator> m_impl_iter;
 
     void SeekImpl(std::span<const std::byte> key);
     std::span<const std::byte> GetKeyImpl() const;
@@ -133,9 +196,9 @@ public:
 
     /**
      * @param[in] _parent          Parent CDBWrapper instance.
-     * @param[in] _piter           The original leveldb iterator.
+     * @param[in] _piter           The iterator of the storage engine.
      */
-    CDBIterator(const CDBWrapper& _parent, std::unique_ptr<IteratorImpl> _piter);
+    CDBIterator(const CDBWrapper& _parent, std::unique_ptr<KVIterator> _piter);
     ~CDBIterator();
 
     bool Valid() const;
@@ -173,14 +236,14 @@ public:
     }
 };
 
-struct LevelDBContext;
-
 class CDBWrapper
 {
+    friend class CDBBatch;
     friend const Obfuscation& dbwrapper_private::GetObfuscation(const CDBWrapper&);
 private:
-    //! holds all leveldb-specific fields of this class
-    std::unique_ptr<LevelDBContext> m_db_context;
+    //! the storage engine
+    std::unique_ptr<KVStore> m_store;
+    DBEngine m_engine;
 
     //! the name of this database
     std::string m_name;
@@ -200,7 +263,7 @@ private:
     std::optional<std::string> ReadImpl(std::span<const std::byte> key) const;
     bool ExistsImpl(std::span<const std::byte> key) const;
     size_t EstimateSizeImpl(std::span<const std::byte> key1, std::span<const std::byte> key2) const;
-    auto& DBContext() const LIFETIMEBOUND { return *Assert(m_db_context); }
+    KVStore& Store() const LIFETIMEBOUND { return *Assert(m_store); }
 
 public:
     CDBWrapper(const DBParams& params);
@@ -264,9 +327,11 @@ public:
 
     void WriteBatch(CDBBatch& batch, bool fSync = false);
 
-    // Get an estimate of LevelDB memory usage (in bytes).
+    // Get an estimate of the memory usage of the storage engine (in bytes).
     size_t DynamicMemoryUsage() const;
 
+    DBStats GetStats() const;
+
     CDBIterator* NewIterator();
 
     /**
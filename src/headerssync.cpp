@@ -25,6 +25,7 @@ HeadersSyncState::HeadersSyncState(NodeId id, const Consensus::Params& consensus
     m_minimum_required_work(minimum_required_work),
     m_current_chain_work(chain_start->nChainWork),
     m_last_header_received(m_chain_start->GetBlockHeader()),
+    m_last_header_received_hash(m_chain_start->GetBlockHash()),
     m_current_height(chain_start->nHeight)
 {
     // Estimate the number of blocks that could possibly exist on the peer's
@@ -50,6 +51,7 @@ void HeadersSyncState::Finalize()
     Assume(m_download_state != State::FINAL);
     ClearShrink(m_header_commitments);
     m_last_header_received.SetNull();
+    m_last_header_received_hash.SetNull();
     ClearShrink(m_redownloaded_headers);
     m_redownload_buffer_last_hash.SetNull();
     m_redownload_buffer_first_prev_hash.SetNull();
@@ -64,9 +66,22 @@ void HeadersSyncState::Finalize()
  *  see if we can switch to REDOWNLOAD mode.  */
 HeadersSyncState::ProcessingResult HeadersSyncState::ProcessNextHeaders(
         std::span<const CBlockHeader> received_headers, const bool full_headers_message)
+{
+    std::vector<uint256> received_hashes;
+    received_hashes.reserve(received_headers.size());
+    for (const auto& hdr : received_headers) received_hashes.push_back(hdr.GetHash());
+    return ProcessNextHeaders(received_headers, received_hashes, full_headers_message);
+}
+
+HeadersSyncState::ProcessingResult HeadersSyncState::ProcessNextHeaders(
+        std::span<const CBlockHeader> received_headers, std::span<const uint256> received_hashes,
+        const bool full_headers_message)
 {
     ProcessingResult ret;
 
+    Assume(received_hashes.size() == received_headers.size());
+    if (received_hashes.size() != received_headers.size()) return ret;
+
     Assume(!received_headers.empty());
     if (received_headers.empty()) return ret;
 
@@ -77,7 +92,7 @@ HeadersSyncState::ProcessingResult HeadersSyncState::ProcessNextHeaders(
         // During PRESYNC, we minimally validate block headers and
         // occasionally add commitments to them, until we reach our work
         // threshold (at which point m_download_state is updated to REDOWNLOAD).
-        ret.success = ValidateAndStoreHeadersCommitments(received_headers);
+        ret.success = ValidateAndStoreHeadersCommitments(received_headers, received_hashes);
         if (ret.success) {
             if (full_headers_message || m_download_state == State::REDOWNLOAD) {
                 // A full headers message means the peer may have more to give us;
@@ -98,8 +113,8 @@ HeadersSyncState::ProcessingResult HeadersSyncState::ProcessNextHeaders(
         // gets big enough (meaning that we've checked enough commitments),
         // we'll return a batch of headers to the caller for processing.
         ret.success = true;
-        for (const auto& hdr : received_headers) {
-            if (!ValidateAndStoreRedownloadedHeader(hdr)) {
+        for (size_t i{0}; i < received_headers.size(); ++i) {
+            if (!ValidateAndStoreRedownloadedHeader(received_headers[i], received_hashes[i])) {
                 // Something went wrong -- the peer gave us an unexpected chain.
                 // We could consider looking at the reason for failure and
                 // punishing the peer, but for now just give up on sync.
@@ -110,7 +125,7 @@ HeadersSyncState::ProcessingResult HeadersSyncState::ProcessNextHeaders(
 
         if (ret.success) {
             // Return any headers that are ready for acceptance.
-            ret.pow_validated_headers = PopHeadersReadyForAcceptance();
+            PopHeadersReadyForAcceptance(ret.pow_validated_headers, ret.pow_validated_hashes);
 
             // If we hit our target blockhash, then all remaining headers will be
             // returned and we can clear any leftover internal state.
@@ -133,7 +148,8 @@ HeadersSyncState::ProcessingResult HeadersSyncState::ProcessNextHeaders(
     return ret;
 }
 
-bool HeadersSyncState::ValidateAndStoreHeadersCommitments(std::span<const CBlockHeader> headers)
+bool HeadersSyncState::ValidateAndStoreHeadersCommitments(std::span<const CBlockHeader> headers,
+        std::span<const uint256> hashes)
 {
     // The caller should not give us an empty set of headers.
     Assume(headers.size() > 0);
@@ -142,7 +158,7 @@ bool HeadersSyncState::ValidateAndStoreHeadersCommitments(std::span<const CBlock
     Assume(m_download_state == State::PRESYNC);
     if (m_download_state != State::PRESYNC) return false;
 
-    if (headers[0].hashPrevBlock != m_last_header_received.GetHash()) {
+    if (headers[0].hashPrevBlock != m_last_header_received_hash) {
         // Somehow our peer gave us a header that doesn't connect.
         // This might be benign -- perhaps our peer reorged away from the chain
         // they were on. Give up on this sync for now (likely we will start a
@@ -153,8 +169,8 @@ bool HeadersSyncState::ValidateAndStoreHeadersCommitments(std::span<const CBlock
 
     // If it does connect, (minimally) validate and occasionally store
     // commitments.
-    for (const auto& hdr : headers) {
-        if (!ValidateAndProcessSingleHeader(hdr)) {
+    for (size_t i{0}; i < headers.size(); ++i) {
+        if (!ValidateAndProcessSingleHeader(headers[i], hashes[i])) {
             return false;
         }
     }
@@ -171,7 +187,7 @@ bool HeadersSyncState::ValidateAndStoreHeadersCommitments(std::span<const CBlock
     return true;
 }
 
-bool HeadersSyncState::ValidateAndProcessSingleHeader(const CBlockHeader& current)
+bool HeadersSyncState::ValidateAndProcessSingleHeader(const CBlockHeader& current, const uint256& hash)
 {
     Assume(m_download_state == State::PRESYNC);
     if (m_download_state != State::PRESYNC) return false;
@@ -191,7 +207,7 @@ bool HeadersSyncState::ValidateAndProcessSingleHeader(const CBlockHeader& curren
 
     if (next_height % m_params.commitment_period == m_commit_offset) {
         // Add a commitment.
-        m_header_commitments.push_back(m_hasher(current.GetHash()) & 1);
+        m_header_commitments.push_back(m_hasher(hash) & 1);
         if (m_header_commitments.size() > m_max_commitments) {
             // The peer's chain is too long; give up.
             // It's possible the chain grew since we started the sync; so
@@ -204,12 +220,13 @@ bool HeadersSyncState::ValidateAndProcessSingleHeader(const CBlockHeader& curren
 
     m_current_chain_work += GetBlockProof(CBlockIndex(current));
     m_last_header_received = current;
+    m_last_header_received_hash = hash;
     m_current_height = next_height;
 
     return true;
 }
 
-bool HeadersSyncState::ValidateAndStoreRedownloadedHeader(const CBlockHeader& header)
+bool HeadersSyncState::ValidateAndStoreRedownloadedHeader(const CBlockHeader& header, const uint256& hash)
 {
     Assume(m_download_state == State::REDOWNLOAD);
     if (m_download_state != State::REDOWNLOAD) return false;
@@ -257,7 +274,7 @@ bool HeadersSyncState::ValidateAndStoreRedownloadedHeader(const CBlockHeader& he
             // we've run out of commitments.
             return false;
         }
-        bool commitment = m_hasher(header.GetHash()) & 1;
+        bool commitment = m_hasher(hash) & 1;
         bool expected_commitment = m_header_commitments.front();
         m_header_commitments.pop_front();
         if (commitment != expected_commitment) {
@@ -269,25 +286,22 @@ bool HeadersSyncState::ValidateAndStoreRedownloadedHeader(const CBlockHeader& he
     // Store this header for later processing.
     m_redownloaded_headers.emplace_back(header);
     m_redownload_buffer_last_height = next_height;
-    m_redownload_buffer_last_hash = header.GetHash();
+    m_redownload_buffer_last_hash = hash;
 
     return true;
 }
 
-std::vector<CBlockHeader> HeadersSyncState::PopHeadersReadyForAcceptance()
+void HeadersSyncState::PopHeadersReadyForAcceptance(std::vector<CBlockHeader>& headers, std::vector<uint256>& hashes)
 {
-    std::vector<CBlockHeader> ret;
-
     Assume(m_download_state == State::REDOWNLOAD);
-    if (m_download_state != State::REDOWNLOAD) return ret;
+    if (m_download_state != State::REDOWNLOAD) return;
 
     while (m_redownloaded_headers.size() > m_params.redownload_buffer_size ||
             (m_redownloaded_headers.size() > 0 && m_process_all_remaining_headers)) {
-        ret.emplace_back(m_redownloaded_headers.front().GetFullHeader(m_redownload_buffer_first_prev_hash));
+        headers.emplace_back(m_redownloaded_headers.front().GetFullHeader(m_redownload_buffer_first_prev_hash));
         m_redownloaded_headers.pop_front();
-        m_redownload_buffer_first_prev_hash = ret.back().GetHash();
+        m_redownload_buffer_first_prev_hash = hashes.emplace_back(headers.back().GetHash());
     }
-    return ret;
 }
 
 CBlockLocator HeadersSyncState::NextHeadersRequestLocator() const
@@ -300,7 +314,7 @@ CBlockLocator HeadersSyncState::NextHeadersRequestLocator() const
 
     if (m_download_state == State::PRESYNC) {
         // During pre-synchronization, we continue from the last header received.
-        locator.push_back(m_last_header_received.GetHash());
+        locator.push_back(m_last_header_received_hash);
     }
 
     if (m_download_state == State::REDOWNLOAD) {
@@ -142,6 +142,8 @@ public:
     /** Result data structure for ProcessNextHeaders. */
     struct ProcessingResult {
         std::vector<CBlockHeader> pow_validated_headers;
+        //! Block hashes of pow_validated_headers.
+        std::vector<uint256> pow_validated_hashes;
         bool success{false};
         bool request_more{false};
     };
@@ -161,6 +163,7 @@ public:
      *                       headers that the caller can fully process and
      *                       validate now (because these returned headers are
      *                       on a chain with sufficient work)
+     * ProcessingResult.pow_validated_hashes: the block hashes of those headers
      * ProcessingResult.success: set to false if an error is detected and the sync is
      *                       aborted; true otherwise.
      * ProcessingResult.request_more: if true, the caller is suggested to call
@@ -169,6 +172,12 @@ public:
     ProcessingResult ProcessNextHeaders(std::span<const CBlockHeader>
             received_headers, bool full_headers_message);
 
+    /** Same as above, but reuses block hashes the caller already computed
+     * (received_hashes[i] must equal received_headers[i].GetHash()), so that
+     * each header in a batch is only hashed once. */
+    ProcessingResult ProcessNextHeaders(std::span<const CBlockHeader> received_headers,
+            std::span<const uint256> received_hashes, bool full_headers_message);
+
     /** Issue the next GETHEADERS message to our peer.
      *
      * This will return a locator appropriate for the current sync object, to continue the
@@ -196,17 +205,18 @@ private:
      *  processed headers.
      *  On failure, this invokes Finalize() and returns false.
      */
-    bool ValidateAndStoreHeadersCommitments(std::span<const CBlockHeader> headers);
+    bool ValidateAndStoreHeadersCommitments(std::span<const CBlockHeader> headers,
+            std::span<const uint256> hashes);
 
     /** In PRESYNC, process and update state for a single header */
-    bool ValidateAndProcessSingleHeader(const CBlockHeader& current);
+    bool ValidateAndProcessSingleHeader(const CBlockHeader& current, const uint256& hash);
 
     /** In REDOWNLOAD, check a header's commitment (if applicable) and add to
      * buffer for later processing */
-    bool ValidateAndStoreRedownloadedHeader(const CBlockHeader& header);
+    bool ValidateAndStoreRedownloadedHeader(const CBlockHeader& header, const uint256& hash);
 
-    /** Return a set of headers that satisfy our proof-of-work threshold */
-    std::vector<CBlockHeader> PopHeadersReadyForAcceptance();
+    /** Return a set of headers that satisfy our proof-of-work threshold, and their block hashes */
+    void PopHeadersReadyForAcceptance(std::vector<CBlockHeader>& headers, std::vector<uint256>& hashes);
 
 private:
     /** NodeId of the peer (used for log messages) **/
@@ -243,6 +253,10 @@ private:
     /** Store the latest header received while in PRESYNC (initialized to m_chain_start) */
     CBlockHeader m_last_header_received;
 
+    /** Hash of m_last_header_received, cached so that connecting the next
+     * batch and building locators don't need to rehash it */
+    uint256 m_last_header_received_hash;
+
     /** Height of m_last_header_received */
     int64_t m_current_height{0};
 
@@ -9,21 +9,34 @@
 #include <httpserver.h>
 #include <logging.h>
 #include <netaddress.h>
+#include <rpc/binary.h>
 #include <rpc/protocol.h>
 #include <rpc/server.h>
+#include <rpc/util.h>
+#include <streams.h>
+#include <sync.h>
 #include <util/fs.h>
 #include <util/fs_helpers.h>
+#include <util/result.h>
 #include <util/strencodings.h>
 #include <util/string.h>
+#include <util/time.h>
 #include <walletinitinterface.h>
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <ios>
 #include <iterator>
 #include <map>
 #include <memory>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using util::SplitString;
@@ -37,6 +50,8 @@ static std::vector<std::vector<std::string>> g_rpcauth;
 /* RPC Auth Whitelist */
 static std::map<std::string, std::set<std::string>> g_rpc_whitelist;
 static bool g_rpc_whitelist_default = false;
+/* Maximum number of calls of a batch running at once (-rpcbatchparallelism) */
+static int g_rpc_batch_parallelism{DEFAULT_RPC_BATCH_PARALLELISM};
 
 static void JSONErrorReply(HTTPRequest* req, UniValue objError, const JSONRPCRequest& jreq)
 {
@@ -101,7 +116,117 @@ static bool RPCAuthorized(const std::string& strAuth, std::string& strAuthUserna
     return CheckUserAuthorized(user, pass);
 }
 
-static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
+/** Reply to a single request with a result written in pieces, see RPCStreamedResult */
+static void StreamJSONRPCReply(HTTPRequest* req, const JSONRPCRequest& jreq, const RPCStreamedResult& result)
+{
+    req->WriteHeader("Content-Type", "application/json");
+    req->StartChunkedReply(HTTP_OK);
+    JSONStreamWriter writer{[req](std::string_view text) { req->WriteReplyChunk(text); }};
+    // Same fields as JSONRPCReplyObj, in the same order.
+    writer.BeginObject();
+    if (jreq.m_json_version == JSONRPCVersion::V2) {
+        writer.Key("jsonrpc");
+        writer.Value("2.0");
+    }
+    writer.Key("result");
+    try {
+        result.write(writer);
+    } catch (const std::exception& e) {
+        // The status was sent already, so the reply can only be cut short,
+        // without ending the body, so the client does not take the truncated
+        // JSON for a complete reply.
+        LogError("Failed to write the result of %s: %s", jreq.strMethod, e.what());
+        req->AbortChunkedReply();
+        return;
+    }
+    if (jreq.m_json_version == JSONRPCVersion::V1_LEGACY) {
+        writer.Key("error");
+        writer.Value(NullUniValue);
+    }
+    if (jreq.id.has_value()) {
+        writer.Key("id");
+        writer.Value(*jreq.id);
+    }
+    writer.EndObject();
+    writer.Raw("\n");
+    writer.Flush();
+    req->EndChunkedReply();
+}
+
+/** Registration of the event a suspended request waits for, dropped once the request resumes */
+struct SuspendedWait
+{
+    Mutex mutex;
+    //! Set once the request resumes, which may be before wait returned.
+    bool resumed GUARDED_BY(mutex){false};
+    std::function<void()> cancel GUARDED_BY(mutex);
+
+    void Resumed() EXCLUSIVE_LOCKS_REQUIRED(!mutex)
+    {
+        std::function<void()> cancel_wait;
+        {
+            LOCK(mutex);
+            resumed = true;
+            cancel_wait = std::move(cancel);
+        }
+        if (cancel_wait) cancel_wait();
+    }
+
+    void Registered(std::function<void()> cancel_wait) EXCLUSIVE_LOCKS_REQUIRED(!mutex)
+    {
+        {
+            LOCK(mutex);
+            if (!resumed) {
+                cancel = std::move(cancel_wait);
+                return;
+            }
+        }
+        cancel_wait();
+    }
+};
+
+/** Suspend a single request until its method resumes, see RPCSuspension */
+static void SuspendJSONRPC(HTTPRequest* req, const JSONRPCRequest& jreq, RPCSuspension suspension)
+{
+    const bool catch_errors{jreq.m_json_version == JSONRPCVersion::V2};
+    std::optional<std::chrono::milliseconds> timeout;
+    if (suspension.deadline) {
+        timeout = std::chrono::ceil<std::chrono::milliseconds>(*suspension.deadline - SteadyClock::now());
+    }
+    auto wait{std::make_shared<SuspendedWait>()};
+    auto handle{req->Suspend([jreq, catch_errors, wait, resume = std::move(suspension.resume)](HTTPRequest* req) {
+        // Whether woken, timed out or resumed at shutdown, the event is no
+        // longer waited for, and its callback holds this continuation.
+        wait->Resumed();
+        try {
+            UniValue reply;
+            try {
+                reply = JSONRPCResume(jreq, resume, catch_errors);
+            } catch (RPCSuspension& again) {
+                SuspendJSONRPC(req, jreq, std::move(again));
+                return;
+            } catch (const RPCStreamedResult& result) {
+                StreamJSONRPCReply(req, jreq, result);
+                return;
+            }
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReply(HTTP_OK, reply.write() + "\n");
+        } catch (UniValue& e) {
+            JSONErrorReply(req, std::move(e), jreq);
+        } catch (const std::exception& e) {
+            JSONErrorReply(req, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq);
+        }
+    }, timeout)};
+    if (!handle) {
+        // Rejected like a request that does not fit in the work queue
+        req->WriteReply(HTTP_SERVICE_UNAVAILABLE, util::ErrorString(handle).original);
+        return;
+    }
+    wait->Registered(suspension.wait([handle = *handle] { handle->Resume(); }));
+}
+
+/** Check the method and authorization of a request to the RPC server, replying with an error if they are not valid */
+static bool CheckRPCRequest(HTTPRequest* req, JSONRPCRequest& jreq)
 {
     // JSONRPC handles only POST
     if (req->GetRequestMethod() != HTTPRequest::POST) {
@@ -116,8 +241,6 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
         return false;
     }
 
-    JSONRPCRequest jreq;
-    jreq.context = context;
     jreq.peerAddr = req->GetPeer().ToStringAddrPort();
     if (!RPCAuthorized(authHeader.second, jreq.authUser)) {
         LogWarning("ThreadRPCServer incorrect password attempt from %s", jreq.peerAddr);
@@ -131,6 +254,106 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
         req->WriteReply(HTTP_UNAUTHORIZED);
         return false;
     }
+    return true;
+}
+
+/** Execute one call of a batch, and return its response, or null for a notification */
+static UniValue ExecuteBatchCall(JSONRPCRequest jreq, const UniValue& call)
+{
+    // Batches never throw HTTP errors, they are always just included
+    // in "HTTP OK" responses. Notifications never get any response.
+    UniValue response;
+    try {
+        jreq.parse(call);
+        response = JSONRPCExec(jreq, /*catch_errors=*/true);
+    } catch (UniValue& e) {
+        response = JSONRPCReplyObj(NullUniValue, std::move(e), jreq.id, jreq.m_json_version);
+    } catch (const std::exception& e) {
+        response = JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id, jreq.m_json_version);
+    }
+    if (jreq.IsNotification()) return NullUniValue;
+    return response;
+}
+
+static bool IsParallelSafeCall(const UniValue& call)
+{
+    if (!call.isObject()) return false;
+    const UniValue& method{call.find_value("method")};
+    return method.isStr() && tableRPC.IsParallelSafe(method.get_str());
+}
+
+/** Calls of a batch being executed in parallel, shared with the worker threads helping */
+struct ParallelBatchCalls
+{
+    std::function<void(size_t)> execute;
+    const size_t end;
+    std::atomic<size_t> next;
+    Mutex mutex;
+    std::condition_variable cv;
+    size_t remaining GUARDED_BY(mutex);
+
+    ParallelBatchCalls(std::function<void(size_t)> execute_in, size_t begin, size_t end_in)
+        : execute{std::move(execute_in)}, end{end_in}, next{begin}, remaining{end_in - begin} {}
+
+    /** Execute calls until none is left to take */
+    void Run() EXCLUSIVE_LOCKS_REQUIRED(!mutex)
+    {
+        for (size_t i{next++}; i < end; i = next++) {
+            execute(i);
+            LOCK(mutex);
+            if (--remaining == 0) cv.notify_all();
+        }
+    }
+};
+
+/**
+ * Execute the calls of a batch and return their responses, in order, with null
+ * for notifications. Consecutive calls to parallel safe methods are spread over
+ * worker threads, up to -rpcbatchparallelism at once, and no more than the
+ * -rpcmethodlimit of any of their methods, so that a batch that succeeds when
+ * executed in order is not failed for its own calls. This thread takes calls
+ * too, so the batch completes even if no worker thread is free; a worker that
+ * starts after all calls are taken has nothing to do. Other calls are executed
+ * alone, in order, as they may depend on the calls before them.
+ */
+static std::vector<UniValue> ExecuteBatch(const JSONRPCRequest& jreq, const UniValue& batch)
+{
+    std::vector<UniValue> responses(batch.size());
+    const auto execute{[&](size_t i) { responses[i] = ExecuteBatchCall(jreq, batch[i]); }};
+    for (size_t i{0}; i < batch.size();) {
+        size_t end{i};
+        if (g_rpc_batch_parallelism > 1) {
+            while (end < batch.size() && IsParallelSafeCall(batch[end])) ++end;
+        }
+        if (end - i < 2) {
+            execute(i++);
+            continue;
+        }
+        size_t parallelism{std::min<size_t>(g_rpc_batch_parallelism, end - i)};
+        std::set<std::string> methods;
+        for (size_t j{i}; j < end; ++j) {
+            const std::string& method{batch[j].find_value("method").get_str()};
+            if (!methods.insert(method).second) continue;
+            if (const auto limit{GetRPCMethodLimit(method)}) parallelism = std::min<size_t>(parallelism, *limit);
+        }
+        auto calls{std::make_shared<ParallelBatchCalls>(execute, i, end)};
+        const size_t helpers{parallelism - 1};
+        for (size_t h{0}; h < helpers; ++h) {
+            if (!QueueHTTPWork([calls] { calls->Run(); })) break;
+        }
+        calls->Run();
+        WAIT_LOCK(calls->mutex, lock);
+        calls->cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(calls->mutex) { return calls->remaining == 0; });
+        i = end;
+    }
+    return responses;
+}
+
+static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
+{
+    JSONRPCRequest jreq;
+    jreq.context = context;
+    if (!CheckRPCRequest(req, jreq)) return false;
 
     try {
         // Parse request
@@ -162,7 +385,20 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
             // 2.0 behavior is to catch exceptions and return HTTP success with
             // RPC errors, as long as there is not an actual HTTP server error.
             const bool catch_errors{jreq.m_json_version == JSONRPCVersion::V2};
-            reply = JSONRPCExec(jreq, catch_errors);
+            // Long-polling methods may suspend the request instead of holding
+            // this thread, and reply to it later. Methods with large results
+            // may write them in pieces instead of building them in memory.
+            jreq.m_allow_suspend = !jreq.IsNotification();
+            jreq.m_allow_stream = !jreq.IsNotification();
+            try {
+                reply = JSONRPCExec(jreq, catch_errors);
+            } catch (RPCSuspension& suspension) {
+                SuspendJSONRPC(req, jreq, std::move(suspension));
+                return true;
+            } catch (const RPCStreamedResult& result) {
+                StreamJSONRPCReply(req, jreq, result);
+                return true;
+            }
 
             if (jreq.IsNotification()) {
                 // Even though we do execute notifications, we do not respond to them
@@ -192,19 +428,8 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
 
             // Execute each request
             reply = UniValue::VARR;
-            for (size_t i{0}; i < valRequest.size(); ++i) {
-                // Batches never throw HTTP errors, they are always just included
-                // in "HTTP OK" responses. Notifications never get any response.
-                UniValue response;
-                try {
-                    jreq.parse(valRequest[i]);
-                    response = JSONRPCExec(jreq, /*catch_errors=*/true);
-                } catch (UniValue& e) {
-                    response = JSONRPCReplyObj(NullUniValue, std::move(e), jreq.id, jreq.m_json_version);
-                } catch (const std::exception& e) {
-                    response = JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_PARSE_ERROR, e.what()), jreq.id, jreq.m_json_version);
-                }
-                if (!jreq.IsNotification()) {
+            for (UniValue& response : ExecuteBatch(jreq, valRequest)) {
+                if (!response.isNull()) {
                     reply.push_back(std::move(response));
                 }
             }
@@ -237,6 +462,67 @@ static bool HTTPReq_JSONRPC(const std::any& context, HTTPRequest* req)
     return true;
 }
 
+/** Handle calls over the binary transport, see rpc/binary.h. The path is the
+ * rest of the URI, which can select a wallet like the URI of JSON-RPC calls. */
+static bool HTTPReq_BinaryRPC(const std::any& context, HTTPRequest* req, const std::string& path)
+{
+    JSONRPCRequest jreq;
+    jreq.context = context;
+    if (!CheckRPCRequest(req, jreq)) return false;
+    if (!path.empty() && !path.starts_with("/wallet/")) {
+        req->WriteReply(HTTP_NOT_FOUND);
+        return false;
+    }
+    jreq.URI = path;
+    jreq.m_binary = true;
+
+    std::vector<BinaryRPCRequest> requests;
+    try {
+        const std::string body{req->ReadBody()};
+        requests = ReadBinaryRPCRequests(std::as_bytes(std::span{body}));
+    } catch (const std::ios_base::failure& e) {
+        req->WriteReply(HTTP_BAD_REQUEST, strprintf("Invalid binary RPC request: %s", e.what()));
+        return false;
+    }
+
+    // Check authorization for each request's method, like for a JSON-RPC batch
+    const bool user_has_whitelist = g_rpc_whitelist.count(jreq.authUser);
+    if (!user_has_whitelist && g_rpc_whitelist_default) {
+        LogWarning("RPC User %s not allowed to call any methods", jreq.authUser);
+        req->WriteReply(HTTP_FORBIDDEN);
+        return false;
+    }
+    for (const BinaryRPCRequest& request : requests) {
+        if (user_has_whitelist && !g_rpc_whitelist[jreq.authUser].count(request.method)) {
+            LogWarning("RPC User %s not allowed to call method %s", jreq.authUser, request.method);
+            req->WriteReply(HTTP_FORBIDDEN);
+            return false;
+        }
+    }
+
+    DataStream reply_body;
+    for (BinaryRPCRequest& request : requests) {
+        jreq.id = request.id;
+        jreq.strMethod = std::move(request.method);
+        jreq.params = std::move(request.params);
+        LogDebug(BCLog::RPC, "ThreadRPCServer method=%s user=%s (binary)\n", SanitizeString(jreq.strMethod), jreq.authUser);
+
+        BinaryRPCReply reply;
+        reply.id = request.id;
+        try {
+            reply.result = tableRPC.execute(jreq);
+        } catch (UniValue& e) {
+            reply.error = std::move(e);
+        } catch (const std::exception& e) {
+            reply.error = JSONRPCError(RPC_MISC_ERROR, e.what());
+        }
+        WriteBinaryRPCReply(reply_body, reply);
+    }
+    req->WriteHeader("Content-Type", "application/octet-stream");
+    req->WriteReply(HTTP_OK, reply_body);
+    return true;
+}
+
 static bool InitRPCAuthentication()
 {
     std::string user;
@@ -333,12 +619,16 @@ bool StartHTTPRPC(const std::any& context)
     LogDebug(BCLog::RPC, "Starting HTTP RPC server\n");
     if (!InitRPCAuthentication())
         return false;
+    g_rpc_batch_parallelism = std::max<int64_t>(1, gArgs.GetIntArg("-rpcbatchparallelism", DEFAULT_RPC_BATCH_PARALLELISM));
 
     auto handle_rpc = [context](HTTPRequest* req, const std::string&) { return HTTPReq_JSONRPC(context, req); };
     RegisterHTTPHandler("/", true, handle_rpc);
     if (g_wallet_init_interface.HasWalletSupport()) {
         RegisterHTTPHandler("/wallet/", false, handle_rpc);
     }
+    if (gArgs.GetBoolArg("-rpcbinary", DEFAULT_RPC_BINARY)) {
+        RegisterHTTPHandler("/binary", false, [context](HTTPRequest* req, const std::string& path) { return HTTPReq_BinaryRPC(context, req, path); });
+    }
     struct event_base* eventBase = EventBase();
     assert(eventBase);
     return true;
@@ -356,4 +646,7 @@ void StopHTTPRPC()
     if (g_wallet_init_interface.HasWalletSupport()) {
         UnregisterHTTPHandler("/wallet/", false);
     }
+    if (gArgs.GetBoolArg("-rpcbinary", DEFAULT_RPC_BINARY)) {
+        UnregisterHTTPHandler("/binary", false);
+    }
 }
@@ -7,6 +7,11 @@
 
 #include <any>
 
+/** Default for -rpcbinary, whether to accept calls over the binary transport on /binary */
+static constexpr bool DEFAULT_RPC_BINARY{false};
+/** Default for -rpcbatchparallelism, the maximum number of calls of a JSON-RPC batch executed at once */
+static constexpr int DEFAULT_RPC_BATCH_PARALLELISM{4};
+
 /** Start HTTP RPC subsystem.
  * Precondition; HTTP and RPC has been started.
  */
@@ -14,21 +14,27 @@
 #include <rpc/protocol.h>
 #include <sync.h>
 #include <util/check.h>
+#include <util/result.h>
 #include <util/signalinterrupt.h>
 #include <util/strencodings.h>
 #include <util/threadnames.h>
+#include <util/time.h>
 #include <util/translation.h>
 
+#include <algorithm>
+#include <chrono>
 #include <condition_variable>
 #include <cstdio>
 #include <cstdlib>
 #include <deque>
+#include <future>
 #include <memory>
 #include <optional>
 #include <span>
 #include <string>
 #include <thread>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <sys/types.h>
@@ -53,20 +59,27 @@ static const size_t MAX_HEADERS_SIZE = 8192;
 class HTTPWorkItem final : public HTTPClosure
 {
 public:
-    HTTPWorkItem(std::unique_ptr<HTTPRequest> _req, const std::string &_path, const HTTPRequestHandler& _func):
-        req(std::move(_req)), path(_path), func(_func)
+    HTTPWorkItem(std::unique_ptr<HTTPRequest> _req, HTTPContinuation _func):
+        req(std::move(_req)), func(std::move(_func))
     {
     }
-    void operator()() override
-    {
-        func(req.get(), path);
-    }
+    void operator()() override;
 
     std::unique_ptr<HTTPRequest> req;
 
 private:
-    std::string path;
-    HTTPRequestHandler func;
+    HTTPContinuation func;
+};
+
+/** Work item not tied to a request, see QueueHTTPWork */
+class HTTPTaskItem final : public HTTPClosure
+{
+public:
+    explicit HTTPTaskItem(std::function<void()> work) : m_work(std::move(work)) {}
+    void operator()() override { m_work(); }
+
+private:
+    std::function<void()> m_work;
 };
 
 /** Simple work queue for distributing work over multiple threads.
@@ -76,11 +89,19 @@ template <typename WorkItem>
 class WorkQueue
 {
 private:
+    struct Entry {
+        std::unique_ptr<WorkItem> item;
+        SteadyClock::time_point enqueued;
+    };
     Mutex cs;
     std::condition_variable cond GUARDED_BY(cs);
-    std::deque<std::unique_ptr<WorkItem>> queue GUARDED_BY(cs);
+    std::deque<Entry> queue GUARDED_BY(cs);
     bool running GUARDED_BY(cs){true};
     const size_t maxDepth;
+    uint64_t m_dispatched GUARDED_BY(cs){0};
+    uint64_t m_rejected GUARDED_BY(cs){0};
+    std::chrono::microseconds m_total_wait GUARDED_BY(cs){0};
+    std::chrono::microseconds m_max_wait GUARDED_BY(cs){0};
 
 public:
     explicit WorkQueue(size_t _maxDepth) : maxDepth(_maxDepth)
@@ -93,10 +114,14 @@ public:
     bool Enqueue(WorkItem* item) EXCLUSIVE_LOCKS_REQUIRED(!cs)
     {
         LOCK(cs);
-        if (!running || queue.size() >= maxDepth) {
+        if (!running) {
+            return false;
+        }
+        if (queue.size() >= maxDepth) {
+            ++m_rejected;
             return false;
         }
-        queue.emplace_back(std::unique_ptr<WorkItem>(item));
+        queue.push_back({std::unique_ptr<WorkItem>(item), SteadyClock::now()});
         cond.notify_one();
         return true;
     }
@@ -111,7 +136,11 @@ public:
                     cond.wait(lock);
                 if (!running && queue.empty())
                     break;
-                i = std::move(queue.front());
+                const auto wait{std::chrono::duration_cast<std::chrono::microseconds>(SteadyClock::now() - queue.front().enqueued)};
+                ++m_dispatched;
+                m_total_wait += wait;
+                m_max_wait = std::max(m_max_wait, wait);
+                i = std::move(queue.front().item);
                 queue.pop_front();
             }
             (*i)();
@@ -124,6 +153,17 @@ public:
         running = false;
         cond.notify_all();
     }
+    /** Fill in the queue statistics */
+    void GetStats(HTTPWorkQueueStats& stats) EXCLUSIVE_LOCKS_REQUIRED(!cs)
+    {
+        LOCK(cs);
+        stats.depth = queue.size();
+        stats.max_depth = maxDepth;
+        stats.dispatched = m_dispatched;
+        stats.rejected = m_rejected;
+        stats.total_wait = m_total_wait;
+        stats.max_wait = m_max_wait;
+    }
 };
 
 struct HTTPPathHandler
@@ -153,6 +193,112 @@ static std::vector<HTTPPathHandler> pathHandlers GUARDED_BY(g_httppathhandlers_m
 //! Bound listening sockets
 static std::vector<evhttp_bound_socket *> boundSockets;
 
+/** Request suspended by its handler, see HTTPRequest::Suspend */
+class SuspendedRequest final : public HTTPSuspendedRequest, public std::enable_shared_from_this<SuspendedRequest>
+{
+private:
+    Mutex m_mutex;
+    //! The request, once the handler that suspended it has returned.
+    std::unique_ptr<HTTPRequest> m_req GUARDED_BY(m_mutex);
+    bool m_resumed GUARDED_BY(m_mutex){false};
+    //! Timeout event, until it runs. It is deleted after running.
+    HTTPEvent* m_timer GUARDED_BY(m_mutex){nullptr};
+    const HTTPContinuation m_continuation;
+
+    //! Queue the continuation, or reject the request if the queue is full or interrupted.
+    void Dispatch(std::unique_ptr<HTTPRequest> req) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+public:
+    explicit SuspendedRequest(HTTPContinuation continuation) : m_continuation(std::move(continuation)) {}
+    ~SuspendedRequest() override;
+
+    //! Resume the request once timeout has passed.
+    void StartTimer(std::chrono::milliseconds timeout) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    //! Take over the request once the handler that suspended it has returned.
+    void Park(std::unique_ptr<HTTPRequest> req) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    void Resume() override EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+};
+
+//! Suspended requests which have not been dispatched yet, resumed when interrupting the server
+static GlobalMutex g_suspended_mutex;
+static std::unordered_set<SuspendedRequest*> g_suspended GUARDED_BY(g_suspended_mutex);
+//! Limit on g_suspended, the same as the work queue depth, as each of them is queued once resumed
+static size_t g_max_suspended GUARDED_BY(g_suspended_mutex){0};
+static bool g_suspend_interrupted GUARDED_BY(g_suspended_mutex){false};
+
+SuspendedRequest::~SuspendedRequest()
+{
+    LOCK(g_suspended_mutex);
+    g_suspended.erase(this);
+}
+
+void SuspendedRequest::StartTimer(std::chrono::milliseconds timeout)
+{
+    LOCK(m_mutex);
+    if (m_resumed) return;
+    m_timer = new HTTPEvent(eventBase, /*deleteWhenTriggered=*/true, [self = shared_from_this()] {
+        WITH_LOCK(self->m_mutex, self->m_timer = nullptr);
+        self->Resume();
+    });
+    const auto ms{std::max(timeout, std::chrono::milliseconds{0}).count()};
+    struct timeval tv;
+    tv.tv_sec = ms / 1000;
+    tv.tv_usec = (ms % 1000) * 1000;
+    m_timer->trigger(&tv);
+}
+
+void SuspendedRequest::Park(std::unique_ptr<HTTPRequest> req)
+{
+    {
+        LOCK(m_mutex);
+        if (!m_resumed) {
+            m_req = std::move(req);
+            return;
+        }
+    }
+    Dispatch(std::move(req));
+}
+
+void SuspendedRequest::Resume()
+{
+    std::unique_ptr<HTTPRequest> req;
+    {
+        LOCK(m_mutex);
+        if (m_resumed) return;
+        m_resumed = true;
+        // Run the timer now rather than at the timeout, so that it is deleted;
+        // its call to Resume returns early, as m_resumed is set.
+        if (m_timer) m_timer->trigger(nullptr);
+        req = std::move(m_req);
+    }
+    // If the handler has not returned yet, Park dispatches the request.
+    if (req) Dispatch(std::move(req));
+}
+
+void SuspendedRequest::Dispatch(std::unique_ptr<HTTPRequest> req)
+{
+    const bool interrupted{WITH_LOCK(g_suspended_mutex, g_suspended.erase(this); return g_suspend_interrupted)};
+    auto item{std::make_unique<HTTPWorkItem>(std::move(req), m_continuation)};
+    assert(g_work_queue);
+    if (g_work_queue->Enqueue(item.get())) {
+        [[maybe_unused]] auto _{item.release()}; /* if true, queue took ownership */
+    } else if (interrupted) {
+        item->req->WriteReply(HTTP_SERVICE_UNAVAILABLE, "Shutting down");
+    } else {
+        LogWarning("Resumed request rejected because http work queue depth exceeded, it can be increased with the -rpcworkqueue= setting");
+        item->req->WriteReply(HTTP_SERVICE_UNAVAILABLE, "Work queue depth exceeded");
+    }
+}
+
+void HTTPWorkItem::operator()()
+{
+    func(req.get());
+    // If the handler suspended the request, hand it over until it is resumed.
+    if (auto suspension{std::move(req->m_suspension)}) {
+        static_cast<SuspendedRequest&>(*suspension).Park(std::move(req));
+    }
+}
+
 /**
  * @brief Helps keep track of open `evhttp_connection`s with active `evhttp_requests`
  *
@@ -327,7 +473,7 @@ static void http_request_cb(struct evhttp_request* req, void* arg)
 
     // Dispatch to worker thread
     if (i != iend) {
-        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), path, i->handler));
+        std::unique_ptr<HTTPWorkItem> item(new HTTPWorkItem(std::move(hreq), [path, handler = i->handler](HTTPRequest* req) { handler(req, path); }));
         assert(g_work_queue);
         if (g_work_queue->Enqueue(item.get())) {
             [[maybe_unused]] auto _{item.release()}; /* if true, queue took ownership */
@@ -479,6 +625,7 @@ bool InitHTTPServer(const util::SignalInterrupt& interrupt)
     LogDebug(BCLog::HTTP, "creating work queue of depth %d\n", workQueueDepth);
 
     g_work_queue = std::make_unique<WorkQueue<HTTPClosure>>(workQueueDepth);
+    WITH_LOCK(g_suspended_mutex, g_max_suspended = workQueueDepth);
     // transfer ownership to eventBase/HTTP via .release()
     eventBase = base_ctr.release();
     eventHTTP = http_ctr.release();
@@ -514,6 +661,19 @@ void InterruptHTTPServer()
         // Reject requests on current connections
         evhttp_set_gencb(eventHTTP, http_reject_request_cb, nullptr);
     }
+    // Resume suspended requests while their continuations can still be queued,
+    // and refuse to suspend any more.
+    std::vector<std::shared_ptr<SuspendedRequest>> suspended;
+    {
+        LOCK(g_suspended_mutex);
+        g_suspend_interrupted = true;
+        for (SuspendedRequest* request : g_suspended) {
+            if (auto ptr{request->weak_from_this().lock()}) suspended.push_back(std::move(ptr));
+        }
+    }
+    for (const auto& request : suspended) {
+        request->Resume();
+    }
     if (g_work_queue) {
         g_work_queue->Interrupt();
     }
@@ -565,6 +725,23 @@ struct event_base* EventBase()
     return eventBase;
 }
 
+HTTPWorkQueueStats GetHTTPWorkQueueStats()
+{
+    HTTPWorkQueueStats stats;
+    if (g_work_queue) g_work_queue->GetStats(stats);
+    stats.suspended = WITH_LOCK(g_suspended_mutex, return g_suspended.size());
+    return stats;
+}
+
+bool QueueHTTPWork(std::function<void()> work)
+{
+    if (!g_work_queue) return false;
+    auto item{std::make_unique<HTTPTaskItem>(std::move(work))};
+    if (!g_work_queue->Enqueue(item.get())) return false;
+    [[maybe_unused]] auto _{item.release()}; /* queue took ownership */
+    return true;
+}
+
 static void httpevent_callback_fn(evutil_socket_t, short, void* data)
 {
     // Static handler: simply call inner handler
@@ -598,7 +775,11 @@ HTTPRequest::HTTPRequest(struct evhttp_request* _req, const util::SignalInterrup
 
 HTTPRequest::~HTTPRequest()
 {
-    if (!replySent) {
+    if (m_chunked) {
+        // The status was already sent, so cut the reply short where it is
+        LogWarning("Unfinished chunked HTTP reply");
+        AbortChunkedReply();
+    } else if (!replySent) {
         // Keep track of whether reply was sent to avoid request leaks
         LogWarning("Unhandled HTTP request");
         WriteReply(HTTP_INTERNAL_SERVER_ERROR, "Unhandled request");
@@ -644,6 +825,21 @@ void HTTPRequest::WriteHeader(const std::string& hdr, const std::string& value)
     evhttp_add_header(headers, hdr.c_str(), value.c_str());
 }
 
+/** Re-enable reading from the socket, the second part of the libevent
+ * workaround in http_request_cb. */
+static void EnableRequestRead(evhttp_request* req)
+{
+    if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02010900) {
+        evhttp_connection* conn = evhttp_request_get_connection(req);
+        if (conn) {
+            bufferevent* bev = evhttp_connection_get_bufferevent(conn);
+            if (bev) {
+                bufferevent_enable(bev, EV_READ | EV_WRITE);
+            }
+        }
+    }
+}
+
 /** Closure sent to main thread to request a reply to be sent to
  * a HTTP request.
  * Replies must be sent in the main loop in the main http thread,
@@ -662,23 +858,119 @@ void HTTPRequest::WriteReply(int nStatus, std::span<const std::byte> reply)
     auto req_copy = req;
     HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus]{
         evhttp_send_reply(req_copy, nStatus, nullptr, nullptr);
-        // Re-enable reading from the socket. This is the second part of the libevent
-        // workaround above.
-        if (event_get_version_number() >= 0x02010600 && event_get_version_number() < 0x02010900) {
+        EnableRequestRead(req_copy);
+    });
+    ev->trigger(nullptr);
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+/* Like replies, the chunks of a chunked reply must be sent in the main http
+ * thread. Events triggered from one thread run in the order they were
+ * triggered, so the chunks are sent in order.
+ */
+void HTTPRequest::StartChunkedReply(int nStatus)
+{
+    assert(!replySent && !m_chunked && req);
+    if (m_interrupt) {
+        WriteHeader("Connection", "close");
+    }
+    m_chunked = true;
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, nStatus] {
+        evhttp_send_reply_start(req_copy, nStatus, nullptr);
+    });
+    ev->trigger(nullptr);
+}
+
+bool HTTPRequest::WriteReplyChunk(std::span<const std::byte> chunk)
+{
+    assert(m_chunked && req);
+    if (chunk.empty()) return true;
+    // The buffer is handed over to the main thread, which frees it once sent.
+    struct evbuffer* evb = evbuffer_new();
+    assert(evb);
+    evbuffer_add(evb, chunk.data(), chunk.size());
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy, evb] {
+        evhttp_send_reply_chunk(req_copy, evb);
+        evbuffer_free(evb);
+    });
+    ev->trigger(nullptr);
+
+    m_chunks_unsent += chunk.size();
+    if (m_chunks_unsent <= MAX_UNSENT_REPLY_CHUNKS) return true;
+    // Wait for the client to read half of the output not sent yet, which the
+    // main thread checks after writing the chunks queued before.
+    while (true) {
+        std::promise<std::optional<size_t>> unsent;
+        HTTPEvent* check = new HTTPEvent(eventBase, true, [req_copy, &unsent] {
             evhttp_connection* conn = evhttp_request_get_connection(req_copy);
-            if (conn) {
-                bufferevent* bev = evhttp_connection_get_bufferevent(conn);
-                if (bev) {
-                    bufferevent_enable(bev, EV_READ | EV_WRITE);
-                }
-            }
+            bufferevent* bev = conn ? evhttp_connection_get_bufferevent(conn) : nullptr;
+            unsent.set_value(bev ? std::optional{evbuffer_get_length(bufferevent_get_output(bev))} : std::nullopt);
+        });
+        check->trigger(nullptr);
+        const auto unsent_size{unsent.get_future().get()};
+        if (!unsent_size) return false;
+        m_chunks_unsent = *unsent_size;
+        // Do not hold up shutdown for a slow client.
+        if (m_chunks_unsent <= MAX_UNSENT_REPLY_CHUNKS / 2 || m_interrupt) return true;
+        UninterruptibleSleep(std::chrono::milliseconds{10});
+    }
+}
+
+void HTTPRequest::EndChunkedReply()
+{
+    assert(m_chunked && req);
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy] {
+        // Before ending the reply, which frees the request if the connection is closed.
+        EnableRequestRead(req_copy);
+        evhttp_send_reply_end(req_copy);
+    });
+    ev->trigger(nullptr);
+    m_chunked = false;
+    replySent = true;
+    req = nullptr; // transferred back to main thread
+}
+
+void HTTPRequest::AbortChunkedReply()
+{
+    assert(m_chunked && req);
+    auto req_copy = req;
+    HTTPEvent* ev = new HTTPEvent(eventBase, true, [req_copy] {
+        // Freeing the connection frees the request, and drops the chunks not
+        // sent yet, which the client would not be able to use anyway.
+        if (evhttp_connection* conn = evhttp_request_get_connection(req_copy)) {
+            evhttp_connection_free(conn);
+        } else {
+            evhttp_send_reply_end(req_copy);
         }
     });
     ev->trigger(nullptr);
+    m_chunked = false;
     replySent = true;
     req = nullptr; // transferred back to main thread
 }
 
+util::Result<std::shared_ptr<HTTPSuspendedRequest>> HTTPRequest::Suspend(HTTPContinuation continuation, std::optional<std::chrono::milliseconds> timeout)
+{
+    assert(!replySent && req && !m_suspension);
+    auto suspension{std::make_shared<SuspendedRequest>(std::move(continuation))};
+    {
+        LOCK(g_suspended_mutex);
+        if (g_suspend_interrupted) return util::Error{Untranslated("Shutting down")};
+        if (g_suspended.size() >= g_max_suspended) {
+            LogWarning("Request rejected because too many requests are suspended, the limit can be increased with the -rpcworkqueue= setting");
+            return util::Error{Untranslated("Too many suspended requests")};
+        }
+        g_suspended.insert(suspension.get());
+    }
+    if (timeout) suspension->StartTimer(*timeout);
+    m_suspension = suspension;
+    return std::shared_ptr<HTTPSuspendedRequest>{std::move(suspension)};
+}
+
 CService HTTPRequest::GetPeer() const
 {
     evhttp_connection* con = evhttp_request_get_connection(req);
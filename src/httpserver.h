@@ -5,10 +5,17 @@
 #ifndef HYLIUM_HTTPSERVER_H
 #define HYLIUM_HTTPSERVER_H
 
+#include <util/result.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <optional>
 #include <span>
 #include <string>
+#include <string_view>
 
 namespace util {
 class SignalInterrupt;
@@ -31,6 +38,7 @@ struct evhttp_request;
 struct event_base;
 class CService;
 class HTTPRequest;
+class HTTPSuspendedRequest;
 
 /** Initialize HTTP server.
  * Call this before RegisterHTTPHandler or EventBase().
@@ -49,8 +57,13 @@ void StopHTTPServer();
 /** Change logging level for libevent. */
 void UpdateHTTPServerLogging(bool enable);
 
+/** Size of the chunks of a reply waiting to be sent above which WriteReplyChunk waits */
+static constexpr size_t MAX_UNSENT_REPLY_CHUNKS{4 << 20};
+
 /** Handler for requests to a certain HTTP path */
 typedef std::function<bool(HTTPRequest* req, const std::string &)> HTTPRequestHandler;
+/** Continuation of a suspended request, see HTTPRequest::Suspend */
+typedef std::function<void(HTTPRequest* req)> HTTPContinuation;
 /** Register handler for prefix.
  * If multiple handlers match a prefix, the first-registered one will
  * be invoked.
@@ -64,6 +77,31 @@ void UnregisterHTTPHandler(const std::string &prefix, bool exactMatch);
  */
 struct event_base* EventBase();
 
+/** Statistics of the work queue, for getrpcinfo. */
+struct HTTPWorkQueueStats
+{
+    //! Number of requests waiting for a worker thread.
+    size_t depth{0};
+    //! Maximum number of requests waiting for a worker thread (-rpcworkqueue).
+    size_t max_depth{0};
+    //! Number of requests, and continuations of suspended requests, run by a worker thread.
+    uint64_t dispatched{0};
+    //! Number of requests rejected because the queue was full.
+    uint64_t rejected{0};
+    //! Total and maximum time the dispatched requests waited for a worker thread.
+    std::chrono::microseconds total_wait{0};
+    std::chrono::microseconds max_wait{0};
+    //! Number of suspended requests, which do not hold a worker thread.
+    size_t suspended{0};
+};
+
+/** Get statistics of the work queue. */
+HTTPWorkQueueStats GetHTTPWorkQueueStats();
+
+/** Queue work, not tied to a request, to run on a worker thread like a request.
+ * @returns false if the queue is full or the server is shutting down. */
+bool QueueHTTPWork(std::function<void()> work);
+
 /** In-flight HTTP request.
  * Thin C++ wrapper around evhttp_request.
  */
@@ -73,6 +111,14 @@ private:
     struct evhttp_request* req;
     const util::SignalInterrupt& m_interrupt;
     bool replySent;
+    //! Whether a chunked reply was started and not ended yet.
+    bool m_chunked{false};
+    //! Size of the chunks written since the output of the connection was last checked.
+    size_t m_chunks_unsent{0};
+    //! Set by Suspend, taken by the worker thread once the handler returns.
+    std::shared_ptr<HTTPSuspendedRequest> m_suspension;
+
+    friend class HTTPWorkItem;
 
 public:
     explicit HTTPRequest(struct evhttp_request* req, const util::SignalInterrupt& interrupt, bool replySent = false);
@@ -143,6 +189,68 @@ public:
         WriteReply(nStatus, std::as_bytes(std::span{reply}));
     }
     void WriteReply(int nStatus, std::span<const std::byte> reply);
+
+    /**
+     * Start a reply whose body is sent in chunks, with chunked transfer
+     * encoding, as it is written with WriteReplyChunk. This avoids holding
+     * large bodies as a whole. Call EndChunkedReply after the last chunk, or
+     * AbortChunkedReply if the body cannot be completed.
+     *
+     * @note Call this instead of WriteReply, and only once.
+     */
+    void StartChunkedReply(int nStatus);
+    /**
+     * Write a chunk of a reply started with StartChunkedReply. Once more than
+     * MAX_UNSENT_REPLY_CHUNKS bytes wait to be sent, this waits for the client
+     * to read them, so a slow client does not make the whole body buffered.
+     *
+     * @returns false if the connection is closed, so the rest of the reply
+     * can be skipped; it must still be ended with EndChunkedReply.
+     */
+    bool WriteReplyChunk(std::string_view chunk)
+    {
+        return WriteReplyChunk(std::as_bytes(std::span{chunk}));
+    }
+    bool WriteReplyChunk(std::span<const std::byte> chunk);
+    /**
+     * End a reply started with StartChunkedReply. As this will give the
+     * request back to the main thread, do not call any other HTTPRequest
+     * methods after calling this.
+     */
+    void EndChunkedReply();
+    /**
+     * Cut a reply started with StartChunkedReply short, closing the connection
+     * without ending the body, so the client sees that it is incomplete rather
+     * than a complete body of a successful reply. Like EndChunkedReply, this
+     * gives the request back to the main thread.
+     */
+    void AbortChunkedReply();
+
+    /**
+     * Suspend the request, so that the handler can return without replying and
+     * without holding a worker thread while it waits for an event.
+     *
+     * Once the returned handle is resumed, or the timeout (if any) passes,
+     * continuation is called with the request on a worker thread, and must
+     * reply to it or suspend it again.
+     *
+     * @returns an error if the request cannot be suspended, as the server is
+     * shutting down or as many requests are suspended as the work queue can
+     * hold (-rpcworkqueue).
+     * @note Call this only from the handler or continuation running the request,
+     * and do not call any other HTTPRequest methods after it succeeds.
+     */
+    util::Result<std::shared_ptr<HTTPSuspendedRequest>> Suspend(HTTPContinuation continuation, std::optional<std::chrono::milliseconds> timeout = std::nullopt);
+};
+
+/** Handle to a suspended request, see HTTPRequest::Suspend. */
+class HTTPSuspendedRequest
+{
+public:
+    virtual ~HTTPSuspendedRequest() = default;
+    /** Queue the continuation of the request. Can be called from any thread;
+     * only the first call, or the timeout passing, has an effect. */
+    virtual void Resume() = 0;
 };
 
 /** Get the query parameter value from request uri for a specified key, or std::nullopt if the key
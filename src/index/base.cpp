@@ -17,11 +17,14 @@
 #include <node/database_args.h>
 #include <node/interface_ui.h>
 #include <primitives/block.h>
+#include <primitives/block_view.h>
 #include <sync.h>
 #include <tinyformat.h>
 #include <uint256.h>
 #include <undo.h>
+#include <util/check.h>
 #include <util/fs.h>
+#include <util/result.h>
 #include <util/string.h>
 #include <util/thread.h>
 #include <util/threadinterrupt.h>
@@ -30,9 +33,15 @@
 #include <validation.h>
 #include <validationinterface.h>
 
+#include <algorithm>
+#include <any>
+#include <atomic>
 #include <cassert>
 #include <compare>
+#include <condition_variable>
 #include <cstdint>
+#include <functional>
+#include <ios>
 #include <memory>
 #include <optional>
 #include <span>
@@ -46,6 +55,8 @@ constexpr uint8_t DB_BEST_BLOCK{'B'};
 
 constexpr auto SYNC_LOG_INTERVAL{30s};
 constexpr auto SYNC_LOCATOR_WRITE_INTERVAL{30s};
+//! Number of blocks handed to each worker per window of a parallel sync, bounding the memory used by blocks read ahead.
+constexpr size_t SYNC_BLOCKS_PER_WORKER{8};
 
 template <typename... Args>
 void BaseIndex::FatalErrorf(util::ConstevalFormatString<sizeof...(Args)> fmt, const Args&... args)
@@ -63,6 +74,18 @@ CBlockLocator GetLocator(interfaces::Chain& chain, const uint256& block_hash)
     return locator;
 }
 
+//! Name of the index for -dbprofile, from its directory in indexes/
+static std::string IndexDBName(const fs::path& path)
+{
+    for (fs::path dir{path}; dir.has_parent_path() && dir != dir.parent_path(); dir = dir.parent_path()) {
+        if (dir.parent_path().filename() == "indexes") {
+            const std::string name{fs::PathToString(dir.filename())};
+            return name == "blockfilter" ? "blockfilterindex" : name;
+        }
+    }
+    return "";
+}
+
 BaseIndex::DB::DB(const fs::path& path, size_t n_cache_size, bool f_memory, bool f_wipe, bool f_obfuscate) :
     CDBWrapper{DBParams{
         .path = path,
@@ -70,7 +93,12 @@ BaseIndex::DB::DB(const fs::path& path, size_t n_cache_size, bool f_memory, bool
         .memory_only = f_memory,
         .wipe_data = f_wipe,
         .obfuscate = f_obfuscate,
-        .options = [] { DBOptions options; node::ReadDatabaseArgs(gArgs, options); return options; }()}}
+        .options = [&] {
+            DBOptions options;
+            // The arguments were checked on startup
+            (void)node::ReadDatabaseArgs(gArgs, options, IndexDBName(path));
+            return options;
+        }()}}
 {}
 
 CBlockLocator BaseIndex::DB::ReadBestBlock() const
@@ -163,31 +191,61 @@ static const CBlockIndex* NextSyncBlock(const CBlockIndex* pindex_prev, CChain&
     return chain.Next(chain.FindFork(pindex_prev));
 }
 
-bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data)
-{
-    interfaces::BlockInfo block_info = kernel::MakeBlockInfo(pindex, block_data);
-
+struct BaseIndex::BlockData {
     CBlock block;
-    if (!block_data) { // disk lookup if block data wasn't provided
-        if (!m_chainstate->m_blockman.ReadBlock(block, *pindex)) {
-            FatalErrorf("Failed to read block %s from disk",
-                        pindex->GetBlockHash().ToString());
-            return false;
-        }
-        block_info.data = &block;
+    std::vector<std::byte> raw_block;
+    std::optional<BlockView> view;
+    CBlockUndo block_undo;
+
+    /// The BlockInfo of the block, given block_data if the block wasn't read.
+    interfaces::BlockInfo Info(const CBlockIndex* pindex, const CBlock* block_data, bool read_undo) const
+    {
+        interfaces::BlockInfo block_info = kernel::MakeBlockInfo(pindex, block_data ? block_data : view ? nullptr : &block);
+        if (view) block_info.view = &*view;
+        if (read_undo) block_info.undo_data = &block_undo;
+        return block_info;
     }
+};
 
-    CBlockUndo block_undo;
-    if (CustomOptions().connect_undo_data) {
-        if (pindex->nHeight > 0 && !m_chainstate->m_blockman.ReadBlockUndo(block_undo, *pindex)) {
-            FatalErrorf("Failed to read undo block data %s from disk",
-                        pindex->GetBlockHash().ToString());
-            return false;
+util::Result<void> BaseIndex::ReadBlockData(const CBlockIndex& index, BlockData& data, bool read_block)
+{
+    if (read_block && UseBlockView()) {
+        auto raw_block{m_chainstate->m_blockman.ReadRawBlock(WITH_LOCK(::cs_main, return index.GetBlockPos()))};
+        if (raw_block) {
+            data.raw_block = std::move(*raw_block);
+            try {
+                data.view.emplace(data.raw_block);
+            } catch (const std::ios_base::failure& e) {
+                LogError("Deserialize error - %s while reading block %s", e.what(), index.GetBlockHash().ToString());
+            }
         }
-        block_info.undo_data = &block_undo;
+        if (!data.view || data.view->GetHash() != index.GetBlockHash()) {
+            return util::Error{Untranslated(strprintf("Failed to read block %s from disk",
+                                                      index.GetBlockHash().ToString()))};
+        }
+    } else if (read_block && !m_chainstate->m_blockman.ReadBlock(data.block, index)) {
+        return util::Error{Untranslated(strprintf("Failed to read block %s from disk",
+                                                  index.GetBlockHash().ToString()))};
+    }
+    if (CustomOptions().connect_undo_data && index.nHeight > 0 && !m_chainstate->m_blockman.ReadBlockUndo(data.block_undo, index)) {
+        return util::Error{Untranslated(strprintf("Failed to read undo block data %s from disk",
+                                                  index.GetBlockHash().ToString()))};
+    }
+    return {};
+}
+
+bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data)
+{
+    BlockData data;
+    const bool read_undo{CustomOptions().connect_undo_data};
+    // disk lookup if block data wasn't provided
+    if (auto res{ReadBlockData(*pindex, data, /*read_block=*/!block_data)}; !res) {
+        FatalErrorf("%s", util::ErrorString(res).original);
+        return false;
     }
+    const interfaces::BlockInfo block_info{data.Info(pindex, block_data, read_undo)};
 
-    if (!CustomAppend(block_info)) {
+    if (!CustomAppendProcessed(block_info, CustomProcessBlock(block_info))) {
         FatalErrorf("Failed to write block %s to index database",
                     pindex->GetBlockHash().ToString());
         return false;
@@ -196,12 +254,144 @@ bool BaseIndex::ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data
     return true;
 }
 
+class BaseIndex::SyncWorkers
+{
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    //! The job the workers are running, and how many of them have yet to finish it.
+    std::function<void()> m_job GUARDED_BY(m_mutex);
+    uint64_t m_job_id GUARDED_BY(m_mutex){0};
+    int m_running GUARDED_BY(m_mutex){0};
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_threads;
+
+    void Loop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        uint64_t done_id{0};
+        WAIT_LOCK(m_mutex, lock);
+        while (true) {
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || m_job_id != done_id; });
+            if (m_stop) return;
+            done_id = m_job_id;
+            {
+                REVERSE_LOCK(lock, m_mutex);
+                m_job();
+            }
+            if (--m_running == 0) m_cv.notify_all();
+        }
+    }
+
+public:
+    explicit SyncWorkers(int count)
+    {
+        for (int i = 0; i < count; ++i) m_threads.emplace_back(&SyncWorkers::Loop, this);
+    }
+
+    ~SyncWorkers()
+    {
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_cv.notify_all();
+        for (auto& thread : m_threads) thread.join();
+    }
+
+    size_t Count() const { return m_threads.size(); }
+
+    //! Have every worker run job, which must not throw. Must be followed by Wait() before the next job.
+    void Start(std::function<void()> job) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        {
+            LOCK(m_mutex);
+            Assume(m_running == 0);
+            m_job = std::move(job);
+            ++m_job_id;
+            m_running = m_threads.size();
+        }
+        m_cv.notify_all();
+    }
+
+    //! Wait for every worker to be done with the job.
+    void Wait() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_running == 0; });
+        m_job = nullptr;
+    }
+};
+
+bool BaseIndex::ProcessBlocksParallel(SyncWorkers& workers, std::span<const CBlockIndex* const> blocks, const std::function<void(const CBlockIndex*)>& appended)
+{
+    struct PreparedBlock {
+        BlockData data;
+        std::any processed;
+        //! Why the block could not be read or processed, if it could not.
+        std::optional<std::string> error;
+        bool ready{false};
+    };
+    std::vector<PreparedBlock> prepared(blocks.size());
+    std::atomic<size_t> next{0};
+    Mutex mutex;
+    std::condition_variable cv;
+    const bool read_undo{CustomOptions().connect_undo_data};
+
+    // Workers claim blocks in chain order, so that the block to be appended next is always being worked on.
+    // Their errors are left for this thread to report.
+    auto work = [&] {
+        for (size_t i; (i = next++) < blocks.size();) {
+            PreparedBlock& item{prepared[i]};
+            if (!m_interrupt) {
+                try {
+                    if (auto res{ReadBlockData(*blocks[i], item.data, /*read_block=*/true)}; !res) {
+                        item.error = util::ErrorString(res).original;
+                    } else {
+                        item.processed = CustomProcessBlock(item.data.Info(blocks[i], nullptr, read_undo));
+                    }
+                } catch (const std::exception& e) {
+                    item.error = strprintf("Failed to process block %s: %s", blocks[i]->GetBlockHash().ToString(), e.what());
+                }
+            }
+            WITH_LOCK(mutex, item.ready = true);
+            cv.notify_one();
+        }
+    };
+    workers.Start(work);
+
+    bool ok{true};
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        PreparedBlock& item{prepared[i]};
+        {
+            WAIT_LOCK(mutex, lock);
+            cv.wait(lock, [&] { return item.ready; });
+        }
+        if (m_interrupt) break;
+        if (item.error) {
+            FatalErrorf("%s", *item.error);
+            ok = false;
+            break;
+        }
+        if (!CustomAppendProcessed(item.data.Info(blocks[i], nullptr, read_undo), item.processed)) {
+            FatalErrorf("Failed to write block %s to index database",
+                        blocks[i]->GetBlockHash().ToString());
+            ok = false;
+            break;
+        }
+        // Release the block's memory as soon as it is appended.
+        item = PreparedBlock{};
+        appended(blocks[i]);
+    }
+
+    // Let the workers skip the blocks that remain if we stopped early.
+    next = blocks.size();
+    workers.Wait();
+    return ok;
+}
+
 void BaseIndex::Sync()
 {
     const CBlockIndex* pindex = m_best_block_index.load();
     if (!m_synced) {
         auto last_log_time{NodeClock::now()};
         auto last_locator_write_time{last_log_time};
+        std::unique_ptr<SyncWorkers> sync_workers;
         while (true) {
             if (m_interrupt) {
                 LogInfo("%s: m_interrupt set; exiting ThreadSync", GetName());
@@ -238,22 +428,42 @@ void BaseIndex::Sync()
                 FatalErrorf("Failed to rewind %s to a previous chain tip", GetName());
                 return;
             }
-            pindex = pindex_next;
 
+            auto block_appended = [&](const CBlockIndex* block) {
+                pindex = block;
 
-            if (!ProcessBlock(pindex)) return; // error logged internally
-
-            auto current_time{NodeClock::now()};
-            if (current_time - last_log_time >= SYNC_LOG_INTERVAL) {
-                LogInfo("Syncing %s with block chain from height %d", GetName(), pindex->nHeight);
-                last_log_time = current_time;
-            }
+                auto current_time{NodeClock::now()};
+                if (current_time - last_log_time >= SYNC_LOG_INTERVAL) {
+                    LogInfo("Syncing %s with block chain from height %d", GetName(), pindex->nHeight);
+                    last_log_time = current_time;
+                }
 
-            if (current_time - last_locator_write_time >= SYNC_LOCATOR_WRITE_INTERVAL) {
-                SetBestBlockIndex(pindex);
-                last_locator_write_time = current_time;
-                // No need to handle errors in Commit. See rationale above.
-                Commit();
+                if (current_time - last_locator_write_time >= SYNC_LOCATOR_WRITE_INTERVAL) {
+                    SetBestBlockIndex(pindex);
+                    last_locator_write_time = current_time;
+                    // No need to handle errors in Commit. See rationale above.
+                    Commit();
+                }
+            };
+
+            if (const int workers{m_sync_workers}; workers > 0 && AllowParallelSync()) {
+                // Started once, and kept until the index is synced.
+                if (!sync_workers) sync_workers = std::make_unique<SyncWorkers>(workers);
+                // Hand the workers a window of the blocks following pindex_next on the chain. A reorg
+                // while they are processed is handled once the window is done, as in the serial case.
+                std::vector<const CBlockIndex*> blocks{pindex_next};
+                {
+                    LOCK(cs_main);
+                    while (blocks.size() < sync_workers->Count() * SYNC_BLOCKS_PER_WORKER) {
+                        const CBlockIndex* next{m_chainstate->m_chain.Next(blocks.back())};
+                        if (!next) break;
+                        blocks.push_back(next);
+                    }
+                }
+                if (!ProcessBlocksParallel(*sync_workers, blocks, block_appended)) return; // error logged internally
+            } else {
+                if (!ProcessBlock(pindex_next)) return; // error logged internally
+                block_appended(pindex_next);
             }
         }
     }
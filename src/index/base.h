@@ -12,20 +12,30 @@
 #include <threadsafety.h>
 #include <uint256.h>
 #include <util/fs.h>
+#include <util/result.h>
 #include <util/threadinterrupt.h>
 #include <validationinterface.h>
 
+#include <any>
 #include <atomic>
 #include <cstddef>
+#include <functional>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <thread>
 
 class CBlock;
 class CBlockIndex;
+class CBlockUndo;
 class Chainstate;
 
+/** Default for -indexworkers, the number of threads reading and processing blocks during an index's initial sync. */
+static constexpr int DEFAULT_INDEX_WORKERS{4};
+/** Maximum for -indexworkers. */
+static constexpr int MAX_INDEX_WORKERS{16};
+
 struct CBlockLocator;
 struct IndexSummary {
     std::string name;
@@ -93,6 +103,9 @@ private:
     std::thread m_thread_sync;
     CThreadInterrupt m_interrupt;
 
+    /// Number of worker threads the initial sync may use if AllowParallelSync().
+    std::atomic<int> m_sync_workers{0};
+
     /// Write the current index state (eg. chain block locator and subclass-specific items) to disk.
     ///
     /// Recommendations for error handling:
@@ -106,10 +119,34 @@ private:
     /// Loop over disconnected blocks and call CustomRemove.
     bool Rewind(const CBlockIndex* current_tip, const CBlockIndex* new_tip);
 
+    /// The data of a block read from disk for the index.
+    struct BlockData;
+
+    /// Read the data of a block from disk: the block itself if read_block, as a CBlock or, if UseBlockView(),
+    /// as a BlockView of its serialization, and its undo data if CustomOptions().connect_undo_data.
+    /// Safe to call from any thread, as errors are returned rather than reported.
+    [[nodiscard]] util::Result<void> ReadBlockData(const CBlockIndex& index, BlockData& data, bool read_block);
+
     bool ProcessBlock(const CBlockIndex* pindex, const CBlock* block_data = nullptr);
 
+    /// Threads reading and processing blocks for the initial sync, kept for the whole of it.
+    class SyncWorkers;
+
+    /// Read and process consecutive blocks on the workers, appending them to the index in order.
+    /// Stops early if interrupted. Calls appended for each block once it is appended.
+    bool ProcessBlocksParallel(SyncWorkers& workers, std::span<const CBlockIndex* const> blocks, const std::function<void(const CBlockIndex*)>& appended);
+
     virtual bool AllowPrune() const = 0;
 
+    /// Whether CustomProcessBlock may be called for several blocks concurrently, and ahead of the blocks
+    /// before them being appended, during the initial sync.
+    virtual bool AllowParallelSync() const { return false; }
+
+    /// Whether the blocks the index syncs from disk are passed to it as a BlockView (BlockInfo::view) rather
+    /// than a CBlock (BlockInfo::data), which is cheaper for an index that only needs some of their data.
+    /// Blocks connected while the index is in sync are still passed as a CBlock.
+    virtual bool UseBlockView() const { return false; }
+
     template <typename... Args>
     void FatalErrorf(util::ConstevalFormatString<sizeof...(Args)> fmt, const Args&... args);
 
@@ -131,6 +168,15 @@ protected:
     /// Write update index entries for a newly connected block.
     [[nodiscard]] virtual bool CustomAppend(const interfaces::BlockInfo& block) { return true; }
 
+    /// Compute the index entries of a block that depend only on the block itself (e.g. a block filter), for
+    /// CustomAppendProcessed to write. If AllowParallelSync(), this must be thread safe, as it is called for
+    /// several blocks concurrently during the initial sync.
+    [[nodiscard]] virtual std::any CustomProcessBlock(const interfaces::BlockInfo& block) const { return {}; }
+
+    /// Write update index entries for a newly connected block, given the result of CustomProcessBlock for it.
+    /// Blocks are always appended in chain order. By default, the result is ignored and CustomAppend is called.
+    [[nodiscard]] virtual bool CustomAppendProcessed(const interfaces::BlockInfo& block, const std::any& processed) { return CustomAppend(block); }
+
     /// Virtual method called internally by Commit that can be overridden to atomically
     /// commit more index state.
     virtual bool CustomCommit(CDBBatch& batch) { return true; }
@@ -167,6 +213,10 @@ public:
     /// Starts the initial sync process on a background thread.
     [[nodiscard]] bool StartBackgroundSync();
 
+    /// Set the number of worker threads the initial sync may use to read and process blocks, if the index
+    /// allows it. 0 syncs serially.
+    void SetSyncWorkers(int workers) { m_sync_workers = workers; }
+
     /// Sync the index with the block index starting from the current best block.
     /// Intended to be run in its own thread, m_thread_sync, and can be
     /// interrupted with m_interrupt. Once the index gets in sync, the m_synced
@@ -23,6 +23,7 @@
 #include <util/hasher.h>
 #include <util/syserror.h>
 
+#include <any>
 #include <cerrno>
 #include <exception>
 #include <ios>
@@ -291,9 +292,14 @@ std::optional<uint256> BlockFilterIndex::ReadFilterHeader(int height, const uint
     return read_out.second.header;
 }
 
-bool BlockFilterIndex::CustomAppend(const interfaces::BlockInfo& block)
+std::any BlockFilterIndex::CustomProcessBlock(const interfaces::BlockInfo& block) const
 {
-    BlockFilter filter(m_filter_type, *Assert(block.data), *Assert(block.undo_data));
+    return BlockFilter(m_filter_type, *Assert(block.data), *Assert(block.undo_data));
+}
+
+bool BlockFilterIndex::CustomAppendProcessed(const interfaces::BlockInfo& block, const std::any& processed)
+{
+    const auto& filter{std::any_cast<const BlockFilter&>(processed)};
     const uint256& header = filter.ComputeHeader(m_last_header);
     bool res = Write(filter, block.height, header);
     if (res) m_last_header = header; // update last header
@@ -13,6 +13,7 @@
 #include <uint256.h>
 #include <util/hasher.h>
 
+#include <any>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
@@ -58,6 +59,8 @@ private:
 
     bool AllowPrune() const override { return true; }
 
+    bool AllowParallelSync() const override { return true; }
+
     bool Write(const BlockFilter& filter, uint32_t block_height, const uint256& filter_header);
 
     std::optional<uint256> ReadFilterHeader(int height, const uint256& expected_block_hash);
@@ -69,7 +72,9 @@ protected:
 
     bool CustomCommit(CDBBatch& batch) override;
 
-    bool CustomAppend(const interfaces::BlockInfo& block) override;
+    std::any CustomProcessBlock(const interfaces::BlockInfo& block) const override;
+
+    bool CustomAppendProcessed(const interfaces::BlockInfo& block, const std::any& processed) override;
 
     bool CustomRemove(const interfaces::BlockInfo& block) override;
 
@@ -0,0 +1,289 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <index/scripthashindex.h>
+
+#include <coins.h>
+#include <common/args.h>
+#include <crypto/sha256.h>
+#include <dbwrapper.h>
+#include <index/base.h>
+#include <interfaces/chain.h>
+#include <interfaces/types.h>
+#include <logging.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <serialize.h>
+#include <uint256.h>
+#include <undo.h>
+#include <util/check.h>
+#include <util/fs.h>
+
+#include <any>
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+constexpr uint8_t DB_HISTORY{'h'};
+constexpr uint8_t DB_SYNCED_BLOCK{'s'};
+constexpr uint8_t DB_UNSPENT{'u'};
+
+std::unique_ptr<ScriptHashIndex> g_scripthash_index;
+
+namespace {
+
+struct DBHistoryKey {
+    uint256 script_hash;
+    ScriptHistoryPosition pos;
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_HISTORY);
+        s << script_hash << pos;
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        const uint8_t prefix{ser_readdata8(s)};
+        if (prefix != DB_HISTORY) {
+            throw std::ios_base::failure("Invalid format for scripthashindex DB history key");
+        }
+        s >> script_hash >> pos;
+    }
+};
+
+struct DBHistoryValue {
+    Txid txid;
+    CAmount amount{0};
+    COutPoint outpoint;
+
+    SERIALIZE_METHODS(DBHistoryValue, obj) { READWRITE(obj.txid, obj.amount, obj.outpoint); }
+};
+
+struct DBUnspentKey {
+    uint256 script_hash;
+    COutPoint outpoint;
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata8(s, DB_UNSPENT);
+        s << script_hash << outpoint.hash;
+        // Big-endian, so that a transaction's outputs are ordered by index.
+        ser_writedata32be(s, outpoint.n);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        const uint8_t prefix{ser_readdata8(s)};
+        if (prefix != DB_UNSPENT) {
+            throw std::ios_base::failure("Invalid format for scripthashindex DB unspent key");
+        }
+        s >> script_hash >> outpoint.hash;
+        outpoint.n = ser_readdata32be(s);
+    }
+};
+
+struct DBUnspentValue {
+    CAmount amount{0};
+    int32_t height{0};
+
+    SERIALIZE_METHODS(DBUnspentValue, obj) { READWRITE(obj.amount, obj.height); }
+};
+
+/** The block the entries are as of. Unlike the best block of the index, it is written in the same batch as the
+ *  entries, so that a lookup reads both from the same snapshot of the database. */
+struct DBSyncedBlock {
+    uint256 hash;
+    int32_t height{-1};
+
+    SERIALIZE_METHODS(DBSyncedBlock, obj) { READWRITE(obj.hash, obj.height); }
+};
+
+/** Read the block the entries are as of, from the snapshot of the database an iterator reads. */
+bool ReadSyncedBlock(CDBIterator& db_it, interfaces::BlockRef& block)
+{
+    db_it.Seek(DB_SYNCED_BLOCK);
+    uint8_t key;
+    DBSyncedBlock value;
+    if (!db_it.Valid() || !db_it.GetKey(key) || key != DB_SYNCED_BLOCK || !db_it.GetValue(value)) return false;
+    block = {value.hash, value.height};
+    return true;
+}
+
+} // namespace
+
+uint256 ComputeScriptHash(const CScript& script)
+{
+    uint256 hash;
+    CSHA256().Write(script.data(), script.size()).Finalize(hash.begin());
+    return hash;
+}
+
+/** Access to the scripthashindex database (indexes/scripthashindex/) */
+class ScriptHashIndex::DB : public BaseIndex::DB
+{
+public:
+    explicit DB(size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+};
+
+ScriptHashIndex::DB::DB(size_t n_cache_size, bool f_memory, bool f_wipe) :
+    BaseIndex::DB(gArgs.GetDataDirNet() / "indexes" / "scripthashindex", n_cache_size, f_memory, f_wipe)
+{}
+
+ScriptHashIndex::ScriptHashIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory, bool f_wipe)
+    : BaseIndex(std::move(chain), "scripthashindex"), m_db(std::make_unique<ScriptHashIndex::DB>(n_cache_size, f_memory, f_wipe))
+{}
+
+ScriptHashIndex::~ScriptHashIndex() = default;
+
+BaseIndex::DB& ScriptHashIndex::GetDB() const { return *m_db; }
+
+interfaces::Chain::NotifyOptions ScriptHashIndex::CustomOptions()
+{
+    interfaces::Chain::NotifyOptions options;
+    options.connect_undo_data = true;
+    options.disconnect_data = true;
+    options.disconnect_undo_data = true;
+    return options;
+}
+
+std::any ScriptHashIndex::CustomProcessBlock(const interfaces::BlockInfo& block) const
+{
+    // The batch is only written, in chain order, by CustomAppendProcessed.
+    auto batch_ptr{std::make_shared<CDBBatch>(*m_db)};
+    batch_ptr->Write(DB_SYNCED_BLOCK, DBSyncedBlock{block.hash, block.height});
+    // Exclude genesis block transaction because outputs are not spendable.
+    if (block.height == 0) return batch_ptr;
+
+    assert(block.data);
+    const uint32_t height{static_cast<uint32_t>(block.height)};
+    CDBBatch& batch{*batch_ptr};
+    for (uint32_t i = 0; i < block.data->vtx.size(); ++i) {
+        const CTransaction& tx{*block.data->vtx[i]};
+        const Txid& txid{tx.GetHash()};
+
+        for (uint32_t j = 0; j < tx.vout.size(); ++j) {
+            const CTxOut& out{tx.vout[j]};
+            if (out.scriptPubKey.IsUnspendable()) continue;
+            const uint256 script_hash{ComputeScriptHash(out.scriptPubKey)};
+            const COutPoint outpoint{txid, j};
+            batch.Write(DBHistoryKey{script_hash, {height, i, /*spending=*/false, j}}, DBHistoryValue{txid, out.nValue, outpoint});
+            batch.Write(DBUnspentKey{script_hash, outpoint}, DBUnspentValue{out.nValue, block.height});
+        }
+
+        // The coinbase tx has no undo data since no former output is spent
+        if (tx.IsCoinBase()) continue;
+        const CTxUndo& tx_undo{Assert(block.undo_data)->vtxundo.at(i - 1)};
+        for (uint32_t j = 0; j < tx.vin.size(); ++j) {
+            const Coin& coin{tx_undo.vprevout.at(j)};
+            const uint256 script_hash{ComputeScriptHash(coin.out.scriptPubKey)};
+            const COutPoint& prevout{tx.vin[j].prevout};
+            batch.Write(DBHistoryKey{script_hash, {height, i, /*spending=*/true, j}}, DBHistoryValue{txid, coin.out.nValue, prevout});
+            // Outputs created earlier in the same block are erased again here, as batches apply in order.
+            batch.Erase(DBUnspentKey{script_hash, prevout});
+        }
+    }
+    return batch_ptr;
+}
+
+bool ScriptHashIndex::CustomAppendProcessed(const interfaces::BlockInfo& block, const std::any& processed)
+{
+    m_db->WriteBatch(*std::any_cast<const std::shared_ptr<CDBBatch>&>(processed));
+    return true;
+}
+
+bool ScriptHashIndex::CustomRemove(const interfaces::BlockInfo& block)
+{
+    if (block.height == 0) return true;
+
+    assert(block.data);
+    const uint32_t height{static_cast<uint32_t>(block.height)};
+    CDBBatch batch(*m_db);
+    batch.Write(DB_SYNCED_BLOCK, DBSyncedBlock{*Assert(block.prev_hash), block.height - 1});
+    // Undo the transactions in reverse order, so that outputs spent within the block end up erased.
+    for (uint32_t i = block.data->vtx.size(); i-- > 0;) {
+        const CTransaction& tx{*block.data->vtx[i]};
+
+        if (!tx.IsCoinBase()) {
+            const CTxUndo& tx_undo{Assert(block.undo_data)->vtxundo.at(i - 1)};
+            for (uint32_t j = 0; j < tx.vin.size(); ++j) {
+                const Coin& coin{tx_undo.vprevout.at(j)};
+                const uint256 script_hash{ComputeScriptHash(coin.out.scriptPubKey)};
+                batch.Erase(DBHistoryKey{script_hash, {height, i, /*spending=*/true, j}});
+                batch.Write(DBUnspentKey{script_hash, tx.vin[j].prevout}, DBUnspentValue{coin.out.nValue, static_cast<int32_t>(coin.nHeight)});
+            }
+        }
+
+        for (uint32_t j = 0; j < tx.vout.size(); ++j) {
+            const CTxOut& out{tx.vout[j]};
+            if (out.scriptPubKey.IsUnspendable()) continue;
+            const uint256 script_hash{ComputeScriptHash(out.scriptPubKey)};
+            batch.Erase(DBHistoryKey{script_hash, {height, i, /*spending=*/false, j}});
+            batch.Erase(DBUnspentKey{script_hash, COutPoint{tx.GetHash(), j}});
+        }
+    }
+    m_db->WriteBatch(batch);
+    return true;
+}
+
+std::optional<std::vector<ScriptHistoryEntry>> ScriptHashIndex::FindHistory(const uint256& script_hash,
+                                                                            const std::optional<ScriptHistoryPosition>& after,
+                                                                            size_t max_entries,
+                                                                            interfaces::BlockRef* synced_block) const
+{
+    std::vector<ScriptHistoryEntry> entries;
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    if (synced_block && !ReadSyncedBlock(*db_it, *synced_block)) {
+        LogError("unable to read the block %s is synced to", GetName());
+        return std::nullopt;
+    }
+    db_it->Seek(DBHistoryKey{script_hash, after.value_or(ScriptHistoryPosition{})});
+    for (; db_it->Valid() && entries.size() < max_entries; db_it->Next()) {
+        DBHistoryKey key;
+        // Keys of another type, or for another script, end the range.
+        if (!db_it->GetKey(key) || key.script_hash != script_hash) break;
+        if (after && key.pos <= *after) continue;
+        DBHistoryValue value;
+        if (!db_it->GetValue(value)) {
+            LogError("unable to read value in %s history of script %s", GetName(), script_hash.ToString());
+            return std::nullopt;
+        }
+        entries.push_back({key.pos, value.txid, value.amount, value.outpoint});
+    }
+    return entries;
+}
+
+std::optional<std::vector<ScriptUnspentEntry>> ScriptHashIndex::FindUnspent(const uint256& script_hash,
+                                                                            const std::optional<COutPoint>& after,
+                                                                            size_t max_entries,
+                                                                            interfaces::BlockRef* synced_block) const
+{
+    std::vector<ScriptUnspentEntry> entries;
+    std::unique_ptr<CDBIterator> db_it(m_db->NewIterator());
+    if (synced_block && !ReadSyncedBlock(*db_it, *synced_block)) {
+        LogError("unable to read the block %s is synced to", GetName());
+        return std::nullopt;
+    }
+    db_it->Seek(DBUnspentKey{script_hash, after.value_or(COutPoint{Txid{}, 0})});
+    for (; db_it->Valid() && entries.size() < max_entries; db_it->Next()) {
+        DBUnspentKey key;
+        if (!db_it->GetKey(key) || key.script_hash != script_hash) break;
+        if (after && key.outpoint == *after) continue;
+        DBUnspentValue value;
+        if (!db_it->GetValue(value)) {
+            LogError("unable to read value in %s unspent outputs of script %s", GetName(), script_hash.ToString());
+            return std::nullopt;
+        }
+        entries.push_back({key.outpoint, value.amount, value.height});
+    }
+    return entries;
+}
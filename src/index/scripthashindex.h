@@ -0,0 +1,141 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef HYLIUM_INDEX_SCRIPTHASHINDEX_H
+#define HYLIUM_INDEX_SCRIPTHASHINDEX_H
+
+#include <consensus/amount.h>
+#include <index/base.h>
+#include <interfaces/chain.h>
+#include <interfaces/types.h>
+#include <primitives/transaction.h>
+#include <serialize.h>
+#include <uint256.h>
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+class CScript;
+
+static constexpr bool DEFAULT_SCRIPTHASHINDEX{false};
+
+/** The key ScriptHashIndex files an output script under: its SHA256 hash. */
+uint256 ComputeScriptHash(const CScript& script);
+
+/** Position of an entry in a script's history. Entries are ordered by block height, position of the transaction in
+ *  the block, outputs before inputs, and output or input index. */
+struct ScriptHistoryPosition {
+    uint32_t height{0};
+    uint32_t tx_pos{0};
+    bool spending{false};
+    uint32_t index{0};
+
+    friend auto operator<=>(const ScriptHistoryPosition&, const ScriptHistoryPosition&) = default;
+
+    template <typename Stream>
+    void Serialize(Stream& s) const
+    {
+        ser_writedata32be(s, height);
+        ser_writedata32be(s, tx_pos);
+        ser_writedata8(s, spending);
+        ser_writedata32be(s, index);
+    }
+
+    template <typename Stream>
+    void Unserialize(Stream& s)
+    {
+        height = ser_readdata32be(s);
+        tx_pos = ser_readdata32be(s);
+        spending = ser_readdata8(s);
+        index = ser_readdata32be(s);
+    }
+};
+
+/** A transaction that paid to (funding) or spent from (spending) a script. */
+struct ScriptHistoryEntry {
+    ScriptHistoryPosition pos;
+    Txid txid;
+    /** Amount paid to the script, or spent from it. */
+    CAmount amount{0};
+    /** The output that was created (funding), or spent (spending). */
+    COutPoint outpoint;
+};
+
+/** An output paying to a script that is unspent at the index's best block. */
+struct ScriptUnspentEntry {
+    COutPoint outpoint;
+    CAmount amount{0};
+    int height{0};
+};
+
+/**
+ * ScriptHashIndex records, for every output script, the outputs paying to it
+ * and the inputs spending those outputs (its history), as well as which of
+ * those outputs are currently unspent. Entries are filed under the script's
+ * hash (see ComputeScriptHash), so that all entries for a script are
+ * contiguous in the database and can be paged through.
+ */
+class ScriptHashIndex final : public BaseIndex
+{
+protected:
+    class DB;
+
+private:
+    const std::unique_ptr<DB> m_db;
+
+    bool AllowPrune() const override { return true; }
+
+    bool AllowParallelSync() const override { return true; }
+
+protected:
+    interfaces::Chain::NotifyOptions CustomOptions() override;
+
+    std::any CustomProcessBlock(const interfaces::BlockInfo& block) const override;
+
+    bool CustomAppendProcessed(const interfaces::BlockInfo& block, const std::any& processed) override;
+
+    bool CustomRemove(const interfaces::BlockInfo& block) override;
+
+    BaseIndex::DB& GetDB() const override;
+
+public:
+    /// Constructs the index, which becomes available to be queried.
+    explicit ScriptHashIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size, bool f_memory = false, bool f_wipe = false);
+
+    // Destructor is declared because this class contains a unique_ptr to an incomplete type.
+    virtual ~ScriptHashIndex() override;
+
+    /// Look up the history of a script, in ScriptHistoryPosition order.
+    ///
+    /// @param[in]  script_hash  The hash of the output script (see ComputeScriptHash).
+    /// @param[in]  after        If set, only return entries positioned after this one (for paging).
+    /// @param[in]  max_entries  The maximum number of entries to return.
+    /// @param[out] synced_block If set, the block the entries are as of, read from the same snapshot of the database.
+    /// @return  The entries, or nullopt if the database could not be read.
+    std::optional<std::vector<ScriptHistoryEntry>> FindHistory(const uint256& script_hash,
+                                                               const std::optional<ScriptHistoryPosition>& after,
+                                                               size_t max_entries,
+                                                               interfaces::BlockRef* synced_block = nullptr) const;
+
+    /// Look up the unspent outputs paying to a script, in outpoint order.
+    ///
+    /// @param[in]  script_hash  The hash of the output script (see ComputeScriptHash).
+    /// @param[in]  after        If set, only return outputs ordered after this outpoint (for paging).
+    /// @param[in]  max_entries  The maximum number of entries to return.
+    /// @param[out] synced_block If set, the block the entries are as of, read from the same snapshot of the database.
+    /// @return  The entries, or nullopt if the database could not be read.
+    std::optional<std::vector<ScriptUnspentEntry>> FindUnspent(const uint256& script_hash,
+                                                               const std::optional<COutPoint>& after,
+                                                               size_t max_entries,
+                                                               interfaces::BlockRef* synced_block = nullptr) const;
+};
+
+/// The global script hash index. May be null.
+extern std::unique_ptr<ScriptHashIndex> g_scripthash_index;
+
+#endif // HYLIUM_INDEX_SCRIPTHASHINDEX_H
@@ -13,6 +13,7 @@
 #include <logging.h>
 #include <node/blockstorage.h>
 #include <primitives/block.h>
+#include <primitives/block_view.h>
 #include <primitives/transaction.h>
 #include <serialize.h>
 #include <streams.h>
@@ -20,7 +21,9 @@
 #include <util/fs.h>
 #include <validation.h>
 
+#include <any>
 #include <cassert>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <exception>
@@ -73,20 +76,36 @@ TxIndex::TxIndex(std::unique_ptr<interfaces::Chain> chain, size_t n_cache_size,
 
 TxIndex::~TxIndex() = default;
 
-bool TxIndex::CustomAppend(const interfaces::BlockInfo& block)
+std::any TxIndex::CustomProcessBlock(const interfaces::BlockInfo& block) const
 {
+    std::vector<std::pair<Txid, CDiskTxPos>> vPos;
     // Exclude genesis block transaction because outputs are not spendable.
-    if (block.height == 0) return true;
+    if (block.height == 0) return vPos;
+
+    if (block.view) {
+        // All at once, for the transactions to be hashed in parallel.
+        const std::vector<Txid> txids{block.view->GetTxids()};
+        vPos.reserve(txids.size());
+        for (size_t i{0}; i < txids.size(); ++i) {
+            vPos.emplace_back(txids[i], CDiskTxPos{{block.file_number, block.data_pos}, block.view->TxOffset(i)});
+        }
+        return vPos;
+    }
 
     assert(block.data);
     CDiskTxPos pos({block.file_number, block.data_pos}, GetSizeOfCompactSize(block.data->vtx.size()));
-    std::vector<std::pair<Txid, CDiskTxPos>> vPos;
     vPos.reserve(block.data->vtx.size());
     for (const auto& tx : block.data->vtx) {
         vPos.emplace_back(tx->GetHash(), pos);
         pos.nTxOffset += ::GetSerializeSize(TX_WITH_WITNESS(*tx));
     }
-    m_db->WriteTxs(vPos);
+    return vPos;
+}
+
+bool TxIndex::CustomAppendProcessed(const interfaces::BlockInfo& block, const std::any& processed)
+{
+    const auto& vPos{std::any_cast<const std::vector<std::pair<Txid, CDiskTxPos>>&>(processed)};
+    if (!vPos.empty()) m_db->WriteTxs(vPos);
     return true;
 }
 
@@ -8,6 +8,7 @@
 #include <index/base.h>
 #include <primitives/transaction.h>
 
+#include <any>
 #include <cstddef>
 #include <memory>
 
@@ -33,8 +34,14 @@ private:
 
     bool AllowPrune() const override { return false; }
 
+    bool AllowParallelSync() const override { return true; }
+
+    bool UseBlockView() const override { return true; }
+
 protected:
-    bool CustomAppend(const interfaces::BlockInfo& block) override;
+    std::any CustomProcessBlock(const interfaces::BlockInfo& block) const override;
+
+    bool CustomAppendProcessed(const interfaces::BlockInfo& block, const std::any& processed) override;
 
     BaseIndex::DB& GetDB() const override;
 
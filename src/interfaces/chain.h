@@ -21,6 +21,7 @@
 #include <vector>
 
 class ArgsManager;
+class BlockView;
 class CBlock;
 class CBlockUndo;
 class CFeeRate;
@@ -84,6 +85,8 @@ struct BlockInfo {
     int file_number = -1;
     unsigned data_pos = 0;
     const CBlock* data = nullptr;
+    //! The block as a view of its serialization, set instead of data where noted
+    const BlockView* view = nullptr;
     const CBlockUndo* undo_data = nullptr;
     // The maximum time in the chain up to and including this block.
     // A timestamp that can only move forward.
@@ -21,6 +21,7 @@
 #include <node/blockstorage.h>
 #include <node/chainstate.h>
 #include <primitives/block.h>
+#include <primitives/block_view.h>
 #include <primitives/transaction.h>
 #include <script/interpreter.h>
 #include <script/script.h>
@@ -96,6 +97,18 @@ public:
     }
 };
 
+//! A block view with the bytes it views
+class OwnedBlockView
+{
+private:
+    const std::vector<std::byte> m_block;
+
+public:
+    const BlockView view;
+
+    explicit OwnedBlockView(std::vector<std::byte> block) : m_block{std::move(block)}, view{m_block} {}
+};
+
 template <typename C, typename CPP>
 struct Handle {
     static C* ref(CPP* cpp_type)
@@ -141,6 +154,7 @@ struct Handle {
 
 struct hylk_BlockTreeEntry: Handle<hylk_BlockTreeEntry, CBlockIndex> {};
 struct hylk_Block : Handle<hylk_Block, std::shared_ptr<const CBlock>> {};
+struct hylk_BlockView : Handle<hylk_BlockView, std::shared_ptr<const OwnedBlockView>> {};
 struct hylk_BlockValidationState : Handle<hylk_BlockValidationState, BlockValidationState> {};
 
 namespace {
@@ -1107,6 +1121,84 @@ hylk_Block* hylk_block_read(const hylk_ChainstateManager* chainman, const hylk_B
     return hylk_Block::create(block);
 }
 
+hylk_BlockView* hylk_block_view_read(const hylk_ChainstateManager* chainman, const hylk_BlockTreeEntry* entry)
+{
+    const CBlockIndex& index{hylk_BlockTreeEntry::get(entry)};
+    const auto& blockman{hylk_ChainstateManager::get(chainman).m_chainman->m_blockman};
+    auto block_data{blockman.ReadRawBlock(WITH_LOCK(::cs_main, return index.GetBlockPos()))};
+    if (!block_data) {
+        LogError("Failed to read block.");
+        return nullptr;
+    }
+    try {
+        auto block_view{std::make_shared<const OwnedBlockView>(std::move(*block_data))};
+        if (block_view->view.GetHash() != index.GetBlockHash()) {
+            LogError("Failed to read block: hash mismatch.");
+            return nullptr;
+        }
+        return hylk_BlockView::create(std::move(block_view));
+    } catch (const std::exception& e) {
+        LogError("Failed to read block: %s", e.what());
+        return nullptr;
+    }
+}
+
+hylk_BlockView* hylk_block_view_create(const void* raw_block, size_t raw_block_length)
+{
+    if (raw_block == nullptr && raw_block_length != 0) {
+        return nullptr;
+    }
+    const auto bytes{reinterpret_cast<const std::byte*>(raw_block)};
+    try {
+        return hylk_BlockView::create(std::make_shared<const OwnedBlockView>(std::vector<std::byte>(bytes, bytes + raw_block_length)));
+    } catch (...) {
+        LogDebug(BCLog::KERNEL, "Block decode failed.");
+        return nullptr;
+    }
+}
+
+hylk_BlockView* hylk_block_view_copy(const hylk_BlockView* block_view)
+{
+    return hylk_BlockView::copy(block_view);
+}
+
+size_t hylk_block_view_count_transactions(const hylk_BlockView* block_view)
+{
+    return hylk_BlockView::get(block_view)->view.TxCount();
+}
+
+hylk_Txid* hylk_block_view_get_txid_at(const hylk_BlockView* block_view, size_t index)
+{
+    const BlockView& view{hylk_BlockView::get(block_view)->view};
+    assert(index < view.TxCount());
+    return hylk_Txid::create(view.GetTxid(index));
+}
+
+hylk_Transaction* hylk_block_view_get_transaction_at(const hylk_BlockView* block_view, size_t index)
+{
+    const BlockView& view{hylk_BlockView::get(block_view)->view};
+    assert(index < view.TxCount());
+    return hylk_Transaction::create(view.GetTransaction(index));
+}
+
+hylk_TransactionOutput* hylk_block_view_get_output_at(const hylk_BlockView* block_view, size_t index, size_t output_index)
+{
+    const BlockView& view{hylk_BlockView::get(block_view)->view};
+    assert(index < view.TxCount());
+    if (output_index >= view.OutputCount(index)) return nullptr;
+    return hylk_TransactionOutput::create(view.GetOutput(index, uint32_t(output_index)));
+}
+
+hylk_BlockHash* hylk_block_view_get_hash(const hylk_BlockView* block_view)
+{
+    return hylk_BlockHash::create(hylk_BlockView::get(block_view)->view.GetHash());
+}
+
+void hylk_block_view_destroy(hylk_BlockView* block_view)
+{
+    delete block_view;
+}
+
 int32_t hylk_block_tree_entry_get_height(const hylk_BlockTreeEntry* entry)
 {
     return hylk_BlockTreeEntry::get(entry).nHeight;
@@ -217,6 +217,14 @@ typedef struct hylk_ChainstateManager hylk_ChainstateManager;
  */
 typedef struct hylk_Block hylk_Block;
 
+/**
+ * Opaque data structure for holding a serialized block, read without
+ * deserializing its transactions. Its transactions, their txids and outputs
+ * are decoded from the serialization when asked for, so it is cheaper than a
+ * @ref hylk_Block for reading only some of them.
+ */
+typedef struct hylk_BlockView hylk_BlockView;
+
 /**
  * Opaque data structure for holding the state of a block during validation.
  *
@@ -1202,6 +1210,105 @@ HYLIUMKERNEL_API void hylk_block_destroy(hylk_Block* block);
 
 ///@}
 
+/** @name BlockView
+ * Functions for working with block views.
+ */
+///@{
+
+/**
+ * @brief Reads the block the passed in block tree entry points to from disk,
+ * without deserializing its transactions, and returns a view of it.
+ *
+ * @param[in] chainstate_manager Non-null.
+ * @param[in] block_tree_entry   Non-null.
+ * @return                       The block view, or null on error.
+ */
+HYLIUMKERNEL_API hylk_BlockView* HYLIUMKERNEL_WARN_UNUSED_RESULT hylk_block_view_read(
+    const hylk_ChainstateManager* chainstate_manager,
+    const hylk_BlockTreeEntry* block_tree_entry) HYLIUMKERNEL_ARG_NONNULL(1, 2);
+
+/**
+ * @brief Create a view of a copy of a serialized raw block. Fails for the
+ * same data @ref hylk_block_create fails for.
+ *
+ * @param[in] raw_block     Serialized block.
+ * @param[in] raw_block_len Length of the serialized block.
+ * @return                  The allocated block view, or null on error.
+ */
+HYLIUMKERNEL_API hylk_BlockView* HYLIUMKERNEL_WARN_UNUSED_RESULT hylk_block_view_create(
+    const void* raw_block, size_t raw_block_len);
+
+/**
+ * @brief Copy a block view. Block views are reference counted, so this just
+ * increments the reference count.
+ *
+ * @param[in] block_view Non-null.
+ * @return               The copied block view.
+ */
+HYLIUMKERNEL_API hylk_BlockView* HYLIUMKERNEL_WARN_UNUSED_RESULT hylk_block_view_copy(
+    const hylk_BlockView* block_view) HYLIUMKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Count the number of transactions contained in a block view.
+ *
+ * @param[in] block_view Non-null.
+ * @return               The number of transactions in the block.
+ */
+HYLIUMKERNEL_API size_t HYLIUMKERNEL_WARN_UNUSED_RESULT hylk_block_view_count_transactions(
+    const hylk_BlockView* block_view) HYLIUMKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Calculate the txid of the transaction at the provided index, without
+ * decoding the transaction.
+ *
+ * @param[in] block_view        Non-null.
+ * @param[in] transaction_index The index of the transaction.
+ * @return                      The txid.
+ */
+HYLIUMKERNEL_API hylk_Txid* HYLIUMKERNEL_WARN_UNUSED_RESULT hylk_block_view_get_txid_at(
+    const hylk_BlockView* block_view, size_t transaction_index) HYLIUMKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Decode the transaction at the provided index. The returned
+ * transaction is owned by the caller.
+ *
+ * @param[in] block_view        Non-null.
+ * @param[in] transaction_index The index of the transaction.
+ * @return                      The transaction.
+ */
+HYLIUMKERNEL_API hylk_Transaction* HYLIUMKERNEL_WARN_UNUSED_RESULT hylk_block_view_get_transaction_at(
+    const hylk_BlockView* block_view, size_t transaction_index) HYLIUMKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Decode an output of the transaction at the provided index, without
+ * decoding the rest of the transaction. The returned output is owned by the
+ * caller.
+ *
+ * @param[in] block_view        Non-null.
+ * @param[in] transaction_index The index of the transaction.
+ * @param[in] output_index      The index of the output in the transaction.
+ * @return                      The output, or null if the transaction has no
+ *                              such output.
+ */
+HYLIUMKERNEL_API hylk_TransactionOutput* HYLIUMKERNEL_WARN_UNUSED_RESULT hylk_block_view_get_output_at(
+    const hylk_BlockView* block_view, size_t transaction_index, size_t output_index) HYLIUMKERNEL_ARG_NONNULL(1);
+
+/**
+ * @brief Calculate and return the hash of the block of a block view.
+ *
+ * @param[in] block_view Non-null.
+ * @return               The block hash.
+ */
+HYLIUMKERNEL_API hylk_BlockHash* HYLIUMKERNEL_WARN_UNUSED_RESULT hylk_block_view_get_hash(
+    const hylk_BlockView* block_view) HYLIUMKERNEL_ARG_NONNULL(1);
+
+/**
+ * Destroy the block view.
+ */
+HYLIUMKERNEL_API void hylk_block_view_destroy(hylk_BlockView* block_view);
+
+///@}
+
 /** @name BlockValidationState
  * Functions for working with block validation states.
  */
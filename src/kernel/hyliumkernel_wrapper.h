@@ -448,6 +448,9 @@ public:
     explicit TransactionOutput(const ScriptPubkey& script_pubkey, int64_t amount)
         : Handle{hylk_transaction_output_create(script_pubkey.get(), amount)} {}
 
+    explicit TransactionOutput(hylk_TransactionOutput* output)
+        : Handle{output} {}
+
     TransactionOutput(const TransactionOutputView& view)
         : Handle(view) {}
 };
@@ -492,6 +495,9 @@ public:
 class Txid : public Handle<hylk_Txid, hylk_txid_copy, hylk_txid_destroy>, public TxidApi<Txid>
 {
 public:
+    explicit Txid(hylk_Txid* txid)
+        : Handle{txid} {}
+
     Txid(const TxidView& view)
         : Handle(view) {}
 };
@@ -622,6 +628,9 @@ public:
     explicit Transaction(std::span<const std::byte> raw_transaction)
         : Handle{hylk_transaction_create(raw_transaction.data(), raw_transaction.size())} {}
 
+    explicit Transaction(hylk_Transaction* transaction)
+        : Handle{transaction} {}
+
     Transaction(const TransactionView& view)
         : Handle{view} {}
 };
@@ -735,6 +744,44 @@ public:
     }
 };
 
+class BlockView : public Handle<hylk_BlockView, hylk_block_view_copy, hylk_block_view_destroy>
+{
+public:
+    BlockView(const std::span<const std::byte> raw_block)
+        : Handle{hylk_block_view_create(raw_block.data(), raw_block.size())}
+    {
+    }
+
+    BlockView(hylk_BlockView* block_view) : Handle{block_view} {}
+
+    size_t CountTransactions() const
+    {
+        return hylk_block_view_count_transactions(get());
+    }
+
+    Txid GetTxid(size_t index) const
+    {
+        return Txid{hylk_block_view_get_txid_at(get(), index)};
+    }
+
+    Transaction GetTransaction(size_t index) const
+    {
+        return Transaction{hylk_block_view_get_transaction_at(get(), index)};
+    }
+
+    std::optional<TransactionOutput> GetOutput(size_t index, size_t output_index) const
+    {
+        auto output{hylk_block_view_get_output_at(get(), index, output_index)};
+        if (!output) return std::nullopt;
+        return TransactionOutput{output};
+    }
+
+    BlockHash GetHash() const
+    {
+        return BlockHash{hylk_block_view_get_hash(get())};
+    }
+};
+
 inline void logging_disable()
 {
     hylk_logging_disable();
@@ -1147,6 +1194,13 @@ public:
         return block;
     }
 
+    std::optional<BlockView> ReadBlockView(const BlockTreeEntry& entry) const
+    {
+        auto block_view{hylk_block_view_read(get(), entry.get())};
+        if (!block_view) return std::nullopt;
+        return block_view;
+    }
+
     BlockSpentOutputs ReadBlockSpentOutputs(const BlockTreeEntry& entry) const
     {
         return hylk_block_spent_outputs_read(get(), entry.get());
@@ -11,6 +11,7 @@
 #include <policy/policy.h>
 #include <policy/settings.h>
 #include <primitives/transaction.h>
+#include <script/interpreter.h>
 #include <txgraph.h>
 #include <util/epochguard.h>
 #include <util/overflow.h>
@@ -82,6 +83,8 @@ private:
     const int64_t sigOpCost;        //!< Total sigop cost
     mutable CAmount m_modified_fee; //!< Used for determining the priority of the transaction for mining in a block
     mutable LockPoints lockPoints;  //!< Track the height and time at which tx was final
+    //! Sighash precomputations made when the tx was validated, reused when it is in a block
+    mutable std::shared_ptr<const PrecomputedTransactionData> m_precomputed_txdata;
 
 public:
     virtual ~CTxMemPoolEntry() = default;
@@ -90,10 +93,10 @@ public:
                     bool spends_coinbase,
                     int64_t sigops_cost, LockPoints lp)
         : TxGraph::Ref(std::move(ref)),
-          tx{tx},
+          tx{DetachFromArena(tx)},
           nFee{fee},
           nTxWeight{GetTransactionWeight(*tx)},
-          nUsageSize{RecursiveDynamicUsage(tx)},
+          nUsageSize{RecursiveDynamicUsage(this->tx)},
           nTime{time},
           entry_sequence{entry_sequence},
           entryHeight{entry_height},
@@ -120,8 +123,9 @@ public:
     uint64_t GetSequence() const { return entry_sequence; }
     int64_t GetSigOpCost() const { return sigOpCost; }
     CAmount GetModifiedFee() const { return m_modified_fee; }
-    size_t DynamicMemoryUsage() const { return nUsageSize; }
+    size_t DynamicMemoryUsage() const { return nUsageSize + memusage::DynamicUsage(m_precomputed_txdata); }
     const LockPoints& GetLockPoints() const { return lockPoints; }
+    const std::shared_ptr<const PrecomputedTransactionData>& GetPrecomputedTxData() const { return m_precomputed_txdata; }
 
     // Updates the modified fees with descendants/ancestors.
     void UpdateModifiedFee(CAmount fee_diff) const
@@ -135,6 +139,13 @@ public:
         lockPoints = lp;
     }
 
+    // Keep the precomputed hashes of the tx. Only set before the entry is added
+    // to the mempool, as its memory usage is accounted for then.
+    void SetPrecomputedTxData(std::shared_ptr<const PrecomputedTransactionData> txdata) const
+    {
+        m_precomputed_txdata = std::move(txdata);
+    }
+
     bool GetSpendsCoinbase() const { return spendsCoinbase; }
 
     mutable size_t idx_randomized; //!< Index in mempool's txns_randomized
@@ -0,0 +1,79 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef HYLIUM_KVSTORE_H
+#define HYLIUM_KVSTORE_H
+
+#include <dbwrapper.h>
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+
+/**
+ * The storage engines behind CDBWrapper. Keys are ordered bytewise, like in
+ * LevelDB. Errors are thrown as dbwrapper_error.
+ */
+
+/** Changes applied atomically by KVStore::Write */
+class KVBatch
+{
+public:
+    virtual ~KVBatch() = default;
+    virtual void Put(std::span<const std::byte> key, std::span<const std::byte> value) = 0;
+    virtual void Delete(std::span<const std::byte> key) = 0;
+    virtual void Clear() = 0;
+    virtual size_t ApproximateSize() const = 0;
+};
+
+/** Iterates over the store as it was when the iterator was created */
+class KVIterator
+{
+public:
+    virtual ~KVIterator() = default;
+    virtual bool Valid() const = 0;
+    virtual void SeekToFirst() = 0;
+    virtual void Seek(std::span<const std::byte> key) = 0;
+    virtual void Next() = 0;
+    virtual std::span<const std::byte> Key() const = 0;
+    virtual std::span<const std::byte> Value() const = 0;
+};
+
+class KVStore
+{
+public:
+    virtual ~KVStore() = default;
+    virtual std::unique_ptr<KVBatch> NewBatch() const = 0;
+    virtual void Write(KVBatch& batch, bool sync) = 0;
+    virtual std::optional<std::string> Read(std::span<const std::byte> key) const = 0;
+    virtual bool Exists(std::span<const std::byte> key) const = 0;
+    virtual std::unique_ptr<KVIterator> NewIterator() const = 0;
+    //! Approximate size on disk of the keys in [begin, end)
+    virtual size_t EstimateSize(std::span<const std::byte> begin, std::span<const std::byte> end) const = 0;
+    virtual size_t DynamicMemoryUsage() const = 0;
+    //! Statistics of the engine, but the engine field
+    virtual DBStats GetStats() const = 0;
+    //! Reclaim the space of overwritten and erased entries
+    virtual void CompactAll() = 0;
+};
+
+std::unique_ptr<KVStore> OpenLevelDB(const DBParams& params);
+//! Whether path holds a LevelDB database
+bool IsLevelDB(const fs::path& path);
+bool DestroyLevelDB(const fs::path& path);
+
+/**
+ * LogDB, an engine for the coins workload: entries are appended to log
+ * segments, and found through a sorted in-memory index of the keys. Space of
+ * overwritten and erased entries is reclaimed by rewriting the live entries
+ * of old segments, split into key ranges rewritten in parallel.
+ */
+std::unique_ptr<KVStore> OpenLogDB(const DBParams& params);
+//! Whether path holds a LogDB database
+bool IsLogDB(const fs::path& path);
+bool DestroyLogDB(const fs::path& path);
+
+#endif // HYLIUM_KVSTORE_H
@@ -11,6 +11,7 @@
 #include <atomic>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "db/builder.h"
@@ -65,6 +66,8 @@ struct DBImpl::CompactionState {
   explicit CompactionState(Compaction* c)
       : compaction(c),
         smallest_snapshot(0),
+        begin(nullptr),
+        end(nullptr),
         outfile(nullptr),
         builder(nullptr),
         total_bytes(0) {}
@@ -77,6 +80,12 @@ struct DBImpl::CompactionState {
   // we can drop all entries for the same key with sequence numbers < S.
   SequenceNumber smallest_snapshot;
 
+  // Range of user keys (*begin, *end] compacted by a subcompaction.  Null
+  // means unbounded.
+  const std::string* begin;
+  const std::string* end;
+  Compaction::Cursor cursor;
+
   std::vector<Output> outputs;
 
   // State kept for output being generated
@@ -103,6 +112,7 @@ Options SanitizeOptions(const std::string& dbname,
   ClipToRange(&result.write_buffer_size, 64 << 10, 1 << 30);
   ClipToRange(&result.max_file_size, 1 << 20, 1 << 30);
   ClipToRange(&result.block_size, 1 << 10, 4 << 20);
+  ClipToRange(&result.max_subcompactions, 1, 64);
   if (result.info_log == nullptr) {
     // Open a log file in the same directory as the db
     src.env->CreateDir(dbname);  // In case it does not exist
@@ -885,6 +895,16 @@ Status DBImpl::InstallCompactionResults(CompactionState* compact) {
   return versions_->LogAndApply(compact->compaction->edit(), &mutex_);
 }
 
+// Whether "internal_key" is for a user key after "user_key".  Keys that can't
+// be parsed are in no particular place.
+static bool IsAfterUserKey(const Comparator* user_cmp,
+                           const Slice& internal_key,
+                           const std::string& user_key) {
+  ParsedInternalKey ikey;
+  return ParseInternalKey(internal_key, &ikey) &&
+         user_cmp->Compare(ikey.user_key, user_key) > 0;
+}
+
 Status DBImpl::DoCompactionWork(CompactionState* compact) {
   const uint64_t start_micros = env_->NowMicros();
   int64_t imm_micros = 0;  // Micros spent doing imm_ compactions
@@ -903,12 +923,109 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
     compact->smallest_snapshot = snapshots_.oldest()->sequence_number();
   }
 
+  // Split the compaction into key ranges compacted in parallel.  The first
+  // range is compacted by this thread, into "compact", and the others into
+  // their own state, whose outputs are added to "compact" when done.
+  std::vector<std::string> boundaries;
+  compact->compaction->GetSubcompactionBoundaries(options_.max_subcompactions,
+                                                  &boundaries);
+  std::vector<CompactionState*> subcompacts;
+  for (size_t i = 0; i < boundaries.size(); i++) {
+    CompactionState* sub = new CompactionState(compact->compaction);
+    sub->smallest_snapshot = compact->smallest_snapshot;
+    sub->begin = &boundaries[i];
+    subcompacts.push_back(sub);
+  }
+  if (!subcompacts.empty()) {
+    Log(options_.info_log, "Compacting in %d subcompactions",
+        static_cast<int>(subcompacts.size() + 1));
+    compact->end = subcompacts[0]->begin;
+    for (size_t i = 0; i + 1 < subcompacts.size(); i++) {
+      subcompacts[i]->end = subcompacts[i + 1]->begin;
+    }
+  }
+
   Iterator* input = versions_->MakeInputIterator(compact->compaction);
+  std::vector<Iterator*> sub_inputs;
+  for (size_t i = 0; i < subcompacts.size(); i++) {
+    sub_inputs.push_back(versions_->MakeInputIterator(compact->compaction));
+  }
 
   // Release mutex while we're actually doing the compaction work
   mutex_.Unlock();
 
-  input->SeekToFirst();
+  std::vector<Status> sub_status(subcompacts.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < subcompacts.size(); i++) {
+    threads.emplace_back([this, &subcompacts, &sub_inputs, &sub_status, i] {
+      sub_status[i] =
+          DoSubcompactionWork(subcompacts[i], sub_inputs[i], nullptr);
+    });
+  }
+  Status status = DoSubcompactionWork(compact, input, &imm_micros);
+  delete input;
+  input = nullptr;
+  for (size_t i = 0; i < threads.size(); i++) {
+    threads[i].join();
+    delete sub_inputs[i];
+  }
+
+  mutex_.Lock();
+  for (size_t i = 0; i < subcompacts.size(); i++) {
+    CompactionState* sub = subcompacts[i];
+    if (status.ok()) {
+      status = sub_status[i];
+    }
+    // Hand the outputs over to "compact", so that CleanupCompaction()
+    // releases them.
+    if (sub->builder != nullptr) {
+      sub->builder->Abandon();
+      delete sub->builder;
+    }
+    delete sub->outfile;
+    compact->outputs.insert(compact->outputs.end(), sub->outputs.begin(),
+                            sub->outputs.end());
+    compact->total_bytes += sub->total_bytes;
+    delete sub;
+  }
+
+  CompactionStats stats;
+  stats.micros = env_->NowMicros() - start_micros - imm_micros;
+  for (int which = 0; which < 2; which++) {
+    for (int i = 0; i < compact->compaction->num_input_files(which); i++) {
+      stats.bytes_read += compact->compaction->input(which, i)->file_size;
+    }
+  }
+  for (size_t i = 0; i < compact->outputs.size(); i++) {
+    stats.bytes_written += compact->outputs[i].file_size;
+  }
+
+  stats_[compact->compaction->level() + 1].Add(stats);
+
+  if (status.ok()) {
+    status = InstallCompactionResults(compact);
+  }
+  if (!status.ok()) {
+    RecordBackgroundError(status);
+  }
+  VersionSet::LevelSummaryStorage tmp;
+  Log(options_.info_log, "compacted to: %s", versions_->LevelSummary(&tmp));
+  return status;
+}
+
+Status DBImpl::DoSubcompactionWork(CompactionState* compact, Iterator* input,
+                                   int64_t* imm_micros) {
+  if (compact->begin == nullptr) {
+    input->SeekToFirst();
+  } else {
+    // Skip to the first entry past the user key *begin.
+    InternalKey start(*compact->begin, 0, kTypeDeletion);
+    input->Seek(start.Encode());
+    while (input->Valid() &&
+           !IsAfterUserKey(user_comparator(), input->key(), *compact->begin)) {
+      input->Next();
+    }
+  }
   Status status;
   ParsedInternalKey ikey;
   std::string current_user_key;
@@ -916,7 +1033,7 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
   SequenceNumber last_sequence_for_key = kMaxSequenceNumber;
   while (input->Valid() && !shutting_down_.load(std::memory_order_acquire)) {
     // Prioritize immutable compaction work
-    if (has_imm_.load(std::memory_order_relaxed)) {
+    if (imm_micros != nullptr && has_imm_.load(std::memory_order_relaxed)) {
       const uint64_t imm_start = env_->NowMicros();
       mutex_.Lock();
       if (imm_ != nullptr) {
@@ -925,11 +1042,16 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
         background_work_finished_signal_.SignalAll();
       }
       mutex_.Unlock();
-      imm_micros += (env_->NowMicros() - imm_start);
+      *imm_micros += (env_->NowMicros() - imm_start);
     }
 
     Slice key = input->key();
-    if (compact->compaction->ShouldStopBefore(key) &&
+    if (compact->end != nullptr &&
+        IsAfterUserKey(user_comparator(), key, *compact->end)) {
+      // Past the range of this subcompaction
+      break;
+    }
+    if (compact->compaction->ShouldStopBefore(key, &compact->cursor) &&
         compact->builder != nullptr) {
       status = FinishCompactionOutputFile(compact, input);
       if (!status.ok()) {
@@ -959,7 +1081,8 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
         drop = true;  // (A)
       } else if (ikey.type == kTypeDeletion &&
                  ikey.sequence <= compact->smallest_snapshot &&
-                 compact->compaction->IsBaseLevelForKey(ikey.user_key)) {
+                 compact->compaction->IsBaseLevelForKey(ikey.user_key,
+                                                        &compact->cursor)) {
         // For this user key:
         // (1) there is no data in higher levels
         // (2) data in lower levels will have larger sequence numbers
@@ -978,7 +1101,7 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
         "%d smallest_snapshot: %d",
         ikey.user_key.ToString().c_str(),
         (int)ikey.sequence, ikey.type, kTypeValue, drop,
-        compact->compaction->IsBaseLevelForKey(ikey.user_key),
+        compact->compaction->IsBaseLevelForKey(ikey.user_key, &compact->cursor),
         (int)last_sequence_for_key, (int)compact->smallest_snapshot);
 #endif
 
@@ -1018,31 +1141,6 @@ Status DBImpl::DoCompactionWork(CompactionState* compact) {
   if (status.ok()) {
     status = input->status();
   }
-  delete input;
-  input = nullptr;
-
-  CompactionStats stats;
-  stats.micros = env_->NowMicros() - start_micros - imm_micros;
-  for (int which = 0; which < 2; which++) {
-    for (int i = 0; i < compact->compaction->num_input_files(which); i++) {
-      stats.bytes_read += compact->compaction->input(which, i)->file_size;
-    }
-  }
-  for (size_t i = 0; i < compact->outputs.size(); i++) {
-    stats.bytes_written += compact->outputs[i].file_size;
-  }
-
-  mutex_.Lock();
-  stats_[compact->compaction->level() + 1].Add(stats);
-
-  if (status.ok()) {
-    status = InstallCompactionResults(compact);
-  }
-  if (!status.ok()) {
-    RecordBackgroundError(status);
-  }
-  VersionSet::LevelSummaryStorage tmp;
-  Log(options_.info_log, "compacted to: %s", versions_->LevelSummary(&tmp));
   return status;
 }
 
@@ -1336,10 +1434,12 @@ Status DBImpl::MakeRoomForWrite(bool force) {
       // individual write by 1ms to reduce latency variance.  Also,
       // this delay hands over some CPU to the compaction thread in
       // case it is sharing the same core as the writer.
+      const uint64_t stall_start = env_->NowMicros();
       mutex_.Unlock();
       env_->SleepForMicroseconds(1000);
       allow_delay = false;  // Do not delay a single write more than once
       mutex_.Lock();
+      RecordWriteStall(kL0Slowdown, stall_start);
     } else if (!force &&
                (mem_->ApproximateMemoryUsage() <= options_.write_buffer_size)) {
       // There is room in current memtable
@@ -1348,11 +1448,15 @@ Status DBImpl::MakeRoomForWrite(bool force) {
       // We have filled up the current memtable, but the previous
       // one is still being compacted, so we wait.
       Log(options_.info_log, "Current memtable full; waiting...\n");
+      const uint64_t stall_start = env_->NowMicros();
       background_work_finished_signal_.Wait();
+      RecordWriteStall(kMemTableFull, stall_start);
     } else if (versions_->NumLevelFiles(0) >= config::kL0_StopWritesTrigger) {
       // There are too many level-0 files.
       Log(options_.info_log, "Too many L0 files; waiting...\n");
+      const uint64_t stall_start = env_->NowMicros();
       background_work_finished_signal_.Wait();
+      RecordWriteStall(kL0Stop, stall_start);
     } else {
       // Attempt to switch to a new memtable and trigger compaction of old
       assert(versions_->PrevLogNumber() == 0);
@@ -1380,6 +1484,12 @@ Status DBImpl::MakeRoomForWrite(bool force) {
   return s;
 }
 
+void DBImpl::RecordWriteStall(WriteStall cause, uint64_t start_micros) {
+  mutex_.AssertHeld();
+  write_stalls_[cause].count++;
+  write_stalls_[cause].micros += env_->NowMicros() - start_micros;
+}
+
 bool DBImpl::GetProperty(const Slice& property, std::string* value) {
   value->clear();
 
@@ -1420,6 +1530,58 @@ bool DBImpl::GetProperty(const Slice& property, std::string* value) {
         value->append(buf);
       }
     }
+    static const char* const kWriteStallNames[kNumWriteStalls] = {
+        "L0 slowdown", "memtable full", "L0 stop"};
+    snprintf(buf, sizeof(buf),
+             "\n                 Write stalls\n"
+             "Cause             Count Time(sec)\n"
+             "---------------------------------\n");
+    value->append(buf);
+    for (int cause = 0; cause < kNumWriteStalls; cause++) {
+      snprintf(buf, sizeof(buf), "%-13s %9lld %9.0f\n",
+               kWriteStallNames[cause],
+               static_cast<long long>(write_stalls_[cause].count),
+               write_stalls_[cause].micros / 1e6);
+      value->append(buf);
+    }
+    return true;
+  } else if (in.starts_with("bytes-at-level")) {
+    in.remove_prefix(strlen("bytes-at-level"));
+    uint64_t level;
+    bool ok = ConsumeDecimalNumber(&in, &level) && in.empty();
+    if (!ok || level >= config::kNumLevels) {
+      return false;
+    } else {
+      char buf[100];
+      snprintf(buf, sizeof(buf), "%lld",
+               static_cast<long long>(
+                   versions_->NumLevelBytes(static_cast<int>(level))));
+      *value = buf;
+      return true;
+    }
+  } else if (in.starts_with("compaction-stats-at-level")) {
+    in.remove_prefix(strlen("compaction-stats-at-level"));
+    uint64_t level;
+    bool ok = ConsumeDecimalNumber(&in, &level) && in.empty();
+    if (!ok || level >= config::kNumLevels) {
+      return false;
+    } else {
+      char buf[100];
+      snprintf(buf, sizeof(buf), "%lld %lld %lld",
+               static_cast<long long>(stats_[level].micros),
+               static_cast<long long>(stats_[level].bytes_read),
+               static_cast<long long>(stats_[level].bytes_written));
+      *value = buf;
+      return true;
+    }
+  } else if (in == "write-stalls") {
+    for (int cause = 0; cause < kNumWriteStalls; cause++) {
+      char buf[100];
+      snprintf(buf, sizeof(buf), "%s%lld %lld", cause == 0 ? "" : " ",
+               static_cast<long long>(write_stalls_[cause].count),
+               static_cast<long long>(write_stalls_[cause].micros));
+      value->append(buf);
+    }
     return true;
   } else if (in == "sstables") {
     *value = versions_->current()->DebugString();
@@ -101,6 +101,16 @@ class DBImpl : public DB {
     int64_t bytes_written;
   };
 
+  // Causes of writes delayed or stopped by MakeRoomForWrite()
+  enum WriteStall { kL0Slowdown, kMemTableFull, kL0Stop, kNumWriteStalls };
+
+  struct WriteStallStats {
+    WriteStallStats() : count(0), micros(0) {}
+
+    int64_t count;
+    int64_t micros;
+  };
+
   Iterator* NewInternalIterator(const ReadOptions&,
                                 SequenceNumber* latest_snapshot,
                                 uint32_t* seed);
@@ -136,6 +146,8 @@ class DBImpl : public DB {
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   void RecordBackgroundError(const Status& s);
+  void RecordWriteStall(WriteStall cause, uint64_t start_micros)
+      EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   void MaybeScheduleCompaction() EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   static void BGWork(void* db);
@@ -145,6 +157,11 @@ class DBImpl : public DB {
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
   Status DoCompactionWork(CompactionState* compact)
       EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  // Compact the inputs from "input" in the key range of "compact", with
+  // mutex_ released.  If "imm_micros" is not null, compactions of imm_ are
+  // done in between, and the time they take is added to it.
+  Status DoSubcompactionWork(CompactionState* compact, Iterator* input,
+                             int64_t* imm_micros) LOCKS_EXCLUDED(mutex_);
 
   Status OpenCompactionOutputFile(CompactionState* compact);
   Status FinishCompactionOutputFile(CompactionState* compact, Iterator* input);
@@ -203,6 +220,8 @@ class DBImpl : public DB {
   Status bg_error_ GUARDED_BY(mutex_);
 
   CompactionStats stats_[config::kNumLevels] GUARDED_BY(mutex_);
+
+  WriteStallStats write_stalls_[kNumWriteStalls] GUARDED_BY(mutex_);
 };
 
 // Sanitize db options.  The caller should delete result.info_log if
@@ -1474,12 +1474,12 @@ Compaction* VersionSet::CompactRange(int level, const InternalKey* begin,
 Compaction::Compaction(const Options* options, int level)
     : level_(level),
       max_output_file_size_(MaxFileSizeForLevel(options, level)),
-      input_version_(nullptr),
-      grandparent_index_(0),
-      seen_key_(false),
-      overlapped_bytes_(0) {
+      input_version_(nullptr) {}
+
+Compaction::Cursor::Cursor()
+    : grandparent_index(0), seen_key(false), overlapped_bytes(0) {
   for (int i = 0; i < config::kNumLevels; i++) {
-    level_ptrs_[i] = 0;
+    level_ptrs[i] = 0;
   }
 }
 
@@ -1507,13 +1507,14 @@ void Compaction::AddInputDeletions(VersionEdit* edit) {
   }
 }
 
-bool Compaction::IsBaseLevelForKey(const Slice& user_key) {
+bool Compaction::IsBaseLevelForKey(const Slice& user_key,
+                                   Cursor* cursor) const {
   // Maybe use binary search to find right entry instead of linear search?
   const Comparator* user_cmp = input_version_->vset_->icmp_.user_comparator();
   for (int lvl = level_ + 2; lvl < config::kNumLevels; lvl++) {
     const std::vector<FileMetaData*>& files = input_version_->files_[lvl];
-    while (level_ptrs_[lvl] < files.size()) {
-      FileMetaData* f = files[level_ptrs_[lvl]];
+    while (cursor->level_ptrs[lvl] < files.size()) {
+      FileMetaData* f = files[cursor->level_ptrs[lvl]];
       if (user_cmp->Compare(user_key, f->largest.user_key()) <= 0) {
         // We've advanced far enough
         if (user_cmp->Compare(user_key, f->smallest.user_key()) >= 0) {
@@ -1522,36 +1523,72 @@ bool Compaction::IsBaseLevelForKey(const Slice& user_key) {
         }
         break;
       }
-      level_ptrs_[lvl]++;
+      cursor->level_ptrs[lvl]++;
     }
   }
   return true;
 }
 
-bool Compaction::ShouldStopBefore(const Slice& internal_key) {
+bool Compaction::ShouldStopBefore(const Slice& internal_key,
+                                  Cursor* cursor) const {
   const VersionSet* vset = input_version_->vset_;
   // Scan to find earliest grandparent file that contains key.
   const InternalKeyComparator* icmp = &vset->icmp_;
-  while (grandparent_index_ < grandparents_.size() &&
+  while (cursor->grandparent_index < grandparents_.size() &&
          icmp->Compare(internal_key,
-                       grandparents_[grandparent_index_]->largest.Encode()) >
-             0) {
-    if (seen_key_) {
-      overlapped_bytes_ += grandparents_[grandparent_index_]->file_size;
+                       grandparents_[cursor->grandparent_index]
+                           ->largest.Encode()) > 0) {
+    if (cursor->seen_key) {
+      cursor->overlapped_bytes +=
+          grandparents_[cursor->grandparent_index]->file_size;
     }
-    grandparent_index_++;
+    cursor->grandparent_index++;
   }
-  seen_key_ = true;
+  cursor->seen_key = true;
 
-  if (overlapped_bytes_ > MaxGrandParentOverlapBytes(vset->options_)) {
+  if (cursor->overlapped_bytes > MaxGrandParentOverlapBytes(vset->options_)) {
     // Too much overlap for current output; start new output
-    overlapped_bytes_ = 0;
+    cursor->overlapped_bytes = 0;
     return true;
   } else {
     return false;
   }
 }
 
+void Compaction::GetSubcompactionBoundaries(
+    int max, std::vector<std::string>* boundaries) const {
+  boundaries->clear();
+  const int num_files = num_input_files(0) + num_input_files(1);
+  // A subcompaction of less than two input files is not worth a thread.
+  const int n = std::min(max, num_files / 2);
+  if (n <= 1) {
+    return;
+  }
+
+  const Comparator* user_cmp = input_version_->vset_->icmp_.user_comparator();
+  std::vector<Slice> keys;
+  for (int which = 0; which < 2; which++) {
+    for (FileMetaData* f : inputs_[which]) {
+      keys.push_back(f->largest.user_key());
+    }
+  }
+  std::sort(keys.begin(), keys.end(),
+            [user_cmp](const Slice& a, const Slice& b) {
+              return user_cmp->Compare(a, b) < 0;
+            });
+  keys.erase(std::unique(keys.begin(), keys.end(),
+                         [user_cmp](const Slice& a, const Slice& b) {
+                           return user_cmp->Compare(a, b) == 0;
+                         }),
+             keys.end());
+  // Nothing follows the largest key, so it can't end a range but the last.
+  keys.pop_back();
+  const size_t ranges = std::min<size_t>(n, keys.size() + 1);
+  for (size_t i = 1; i < ranges; i++) {
+    boundaries->push_back(keys[i * keys.size() / ranges].ToString());
+  }
+}
+
 void Compaction::ReleaseInputs() {
   if (input_version_ != nullptr) {
     input_version_->Unref();
@@ -121,6 +121,15 @@ class LEVELDB_EXPORT DB {
   //     of the sstables that make up the db contents.
   //  "leveldb.approximate-memory-usage" - returns the approximate number of
   //     bytes of memory in use by the DB.
+  //  "leveldb.bytes-at-level<N>" - return the total size of the files at
+  //     level <N>.
+  //  "leveldb.compaction-stats-at-level<N>" - return the microseconds spent,
+  //     bytes read and bytes written by the compactions that produced level
+  //     <N>, separated by spaces.
+  //  "leveldb.write-stalls" - return the number of times, and microseconds,
+  //     writes were delayed because level-0 is nearly full, waited for the
+  //     compaction of a full memtable, and waited because level-0 is full,
+  //     separated by spaces.
   virtual bool GetProperty(const Slice& property, std::string* value) = 0;
 
   // For each i in [0,n-1], store in "sizes[i]", the approximate
@@ -114,6 +114,12 @@ struct LEVELDB_EXPORT Options {
   // initially populating a large database.
   size_t max_file_size = 2 * 1024 * 1024;
 
+  // A compaction of many files is split into up to this many key ranges,
+  // which are compacted in parallel threads.  The compaction that follows
+  // a large batch of writes then takes less time, and so writers are less
+  // often stalled waiting for it.
+  int max_subcompactions = 1;
+
   // Compress blocks using the specified compression algorithm.  This
   // parameter can be changed dynamically.
   //
@@ -0,0 +1,995 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <kvstore.h>
+
+#include <crypto/common.h>
+#include <logging.h>
+#include <memusage.h>
+#include <serialize.h>
+#include <span.h>
+#include <streams.h>
+#include <sync.h>
+#include <tinyformat.h>
+#include <util/check.h>
+#include <util/fs.h>
+#include <util/fs_helpers.h>
+#include <util/strencodings.h>
+#include <util/string.h>
+#include <util/thread.h>
+#include <util/time.h>
+
+#include <crc32c/crc32c.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <ios>
+#include <limits>
+#include <map>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A LogDB directory holds the marker file, the compaction record and the
+// segments, named <order>-<part>.seg. Writes are appended to the active segment, which is
+// synced, sealed and replaced once it reaches SEGMENT_SIZE. Each batch is a frame:
+// - 4-byte little-endian payload size
+// - 4-byte little-endian CRC32C of the payload
+// - payload: the operations, each a type byte, the key (CompactSize length
+//   and bytes) and, for puts, the value (CompactSize length and bytes)
+//
+// On open, the segments are replayed in order to rebuild the index. A frame
+// that is incomplete or fails its checksum ends the replay of its segment,
+// which is only expected of the last segment, after a crash, and of the
+// outputs of an interrupted compaction.
+//
+// A compaction seals the active segment and rewrites the live entries of all
+// sealed segments to new segments, which get the order of the last one sealed
+// and parts from 1, so that they replay after the entries they copy and
+// before anything written since. Once the new ones are synced, the order is
+// written to the compaction record, replacing it atomically, and the old
+// segments are removed. On open, the segments of a lower order, and the first
+// part of that order, are left over from a removal cut short: they are removed
+// rather than replayed, as replaying some of them without the others could
+// bring back entries erased in the others.
+
+namespace {
+
+//! Segments are sealed once they reach this size
+constexpr uint64_t SEGMENT_SIZE{64 << 20};
+//! Compaction writes frames of about this size
+constexpr size_t COMPACTION_FRAME_SIZE{1 << 20};
+//! Compaction starts when overwritten and erased entries take more space than this, and than the live ones
+constexpr uint64_t MIN_GARBAGE_BYTES{SEGMENT_SIZE};
+constexpr unsigned MAX_COMPACTION_THREADS{8};
+//! Changes are merged into the sorted index once there are more than this, and than an eighth of it
+constexpr size_t MIN_DELTA_ENTRIES{1 << 16};
+//! Approximate size of an entry in a frame, besides its key and value
+constexpr uint64_t ENTRY_OVERHEAD{3};
+constexpr size_t FRAME_HEADER_SIZE{8};
+constexpr std::string_view MARKER_FILE{"LOGDB"};
+constexpr std::string_view COMPACTED_FILE{"COMPACTED"};
+constexpr std::string_view SEGMENT_EXTENSION{".seg"};
+
+enum class EntryType : uint8_t {
+    PUT = 0,
+    DELETE = 1,
+};
+
+/** Where the value of an entry is */
+struct Slot {
+    uint32_t segment;
+    uint32_t size;
+    uint64_t offset;
+
+    bool operator==(const Slot&) const = default;
+};
+
+//! Segment of the slots of erased entries, in the delta
+constexpr uint32_t ERASED{std::numeric_limits<uint32_t>::max()};
+
+uint64_t EntryBytes(size_t key_size, uint32_t value_size)
+{
+    return key_size + value_size + ENTRY_OVERHEAD;
+}
+
+std::string_view AsStringView(std::span<const std::byte> bytes)
+{
+    return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+}
+
+[[noreturn]] void Fail(const std::string& message)
+{
+    LogError("Fatal LogDB error: %s", message);
+    throw dbwrapper_error("Fatal LogDB error: " + message);
+}
+
+/** Appends to a byte vector, for the serialization helpers */
+struct ByteVectorWriter {
+    std::vector<std::byte>& bytes;
+
+    void write(std::span<const std::byte> data) { bytes.insert(bytes.end(), data.begin(), data.end()); }
+};
+
+/** A log file, or a buffer for in-memory databases */
+class Segment
+{
+public:
+    const uint32_t m_id;
+    const uint32_t m_order;
+    const uint32_t m_part;
+
+private:
+    //! empty for in-memory databases
+    const fs::path m_path;
+    mutable Mutex m_mutex;
+    FILE* m_file GUARDED_BY(m_mutex){nullptr};
+    std::vector<std::byte> m_memory GUARDED_BY(m_mutex);
+    uint64_t m_size GUARDED_BY(m_mutex){0};
+    //! Remove the file once the last reference is gone
+    std::atomic<bool> m_obsolete{false};
+
+public:
+    Segment(uint32_t id, uint32_t order, uint32_t part, fs::path path)
+        : m_id{id}, m_order{order}, m_part{part}, m_path{std::move(path)}
+    {
+        if (m_path.empty()) return;
+        LOCK(m_mutex);
+        m_file = fsbridge::fopen(m_path, "a+b");
+        if (!m_file || std::fseek(m_file, 0, SEEK_END) != 0) Fail("Failed to open " + fs::PathToString(m_path));
+        m_size = std::ftell(m_file);
+    }
+
+    ~Segment()
+    {
+        if (m_file) std::fclose(m_file);
+        if (m_obsolete && !m_path.empty()) {
+            std::error_code error;
+            fs::remove(m_path, error);
+            if (error) LogWarning("Failed to remove %s: %s", fs::PathToString(m_path), error.message());
+        }
+    }
+
+    Segment(const Segment&) = delete;
+    Segment& operator=(const Segment&) = delete;
+
+    uint64_t Size() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) { return WITH_LOCK(m_mutex, return m_size); }
+
+    void MarkObsolete() { m_obsolete = true; }
+
+    void Append(std::span<const std::byte> data) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        if (m_path.empty()) {
+            m_memory.insert(m_memory.end(), data.begin(), data.end());
+        } else if (std::fseek(m_file, 0, SEEK_END) != 0 || std::fwrite(data.data(), 1, data.size(), m_file) != data.size()) {
+            Fail("Failed to write to " + fs::PathToString(m_path));
+        }
+        m_size += data.size();
+    }
+
+    void Flush(bool sync) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        if (m_path.empty()) return;
+        if (std::fflush(m_file) != 0 || (sync && !FileCommit(m_file))) Fail("Failed to flush " + fs::PathToString(m_path));
+    }
+
+    std::string Read(uint64_t offset, size_t size) const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        if (offset + size > m_size) Fail(strprintf("Read past the end of segment %u-%u", m_order, m_part));
+        std::string data(size, '\0');
+        if (m_path.empty()) {
+            std::memcpy(data.data(), m_memory.data() + offset, size);
+        } else if (offset > uint64_t(std::numeric_limits<long>::max()) ||
+                   std::fseek(m_file, long(offset), SEEK_SET) != 0 ||
+                   std::fread(data.data(), 1, size, m_file) != size) {
+            Fail("Failed to read from " + fs::PathToString(m_path));
+        }
+        return data;
+    }
+
+    //! Drop an incomplete frame at the end, found by the replay
+    void Truncate(uint64_t size) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        LOCK(m_mutex);
+        if (!m_path.empty() && (std::fflush(m_file) != 0 || !TruncateFile(m_file, size))) {
+            Fail("Failed to truncate " + fs::PathToString(m_path));
+        }
+        m_size = size;
+    }
+};
+
+using SegmentMap = std::map<uint32_t, std::shared_ptr<Segment>>;
+
+/** The entries that are not in the delta, sorted by key, with the keys one after the other */
+struct BaseIndex {
+    std::vector<char> keys;
+    //! Where the key of each entry starts in keys, and where the last one ends
+    std::vector<uint64_t> key_starts{0};
+    std::vector<Slot> slots;
+
+    size_t size() const { return slots.size(); }
+
+    std::string_view Key(size_t i) const
+    {
+        return {keys.data() + key_starts[i], size_t(key_starts[i + 1] - key_starts[i])};
+    }
+
+    //! Position of the first entry not less than key
+    size_t LowerBound(std::string_view key) const
+    {
+        size_t begin{0}, end{size()};
+        while (begin < end) {
+            const size_t mid{begin + (end - begin) / 2};
+            if (Key(mid) < key) {
+                begin = mid + 1;
+            } else {
+                end = mid;
+            }
+        }
+        return begin;
+    }
+
+    void Add(std::string_view key, const Slot& slot)
+    {
+        keys.insert(keys.end(), key.begin(), key.end());
+        key_starts.push_back(keys.size());
+        slots.push_back(slot);
+    }
+
+    size_t DynamicMemoryUsage() const
+    {
+        return memusage::DynamicUsage(keys) + memusage::DynamicUsage(key_starts) + memusage::DynamicUsage(slots);
+    }
+};
+
+//! Changes since the last merge into the base, with ERASED slots for entries erased from the base
+using DeltaIndex = std::map<std::string, Slot, std::less<>>;
+
+class LogDBBatch : public KVBatch
+{
+public:
+    struct Entry {
+        EntryType type;
+        size_t key_pos;
+        size_t key_size;
+        size_t value_pos;
+        uint32_t value_size;
+    };
+
+    //! The frame, with room for the header
+    std::vector<std::byte> m_frame;
+    std::vector<Entry> m_entries;
+
+    LogDBBatch() { Clear(); }
+
+    void Put(std::span<const std::byte> key, std::span<const std::byte> value) override
+    {
+        if (value.size() >= ERASED) throw dbwrapper_error("LogDB value too large");
+        Entry& entry{Add(EntryType::PUT, key)};
+        ByteVectorWriter writer{m_frame};
+        WriteCompactSize(writer, value.size());
+        entry.value_pos = m_frame.size();
+        entry.value_size = value.size();
+        writer.write(value);
+    }
+
+    void Delete(std::span<const std::byte> key) override
+    {
+        Add(EntryType::DELETE, key);
+    }
+
+    void Clear() override
+    {
+        m_frame.assign(FRAME_HEADER_SIZE, std::byte{0});
+        m_entries.clear();
+    }
+
+    size_t ApproximateSize() const override { return m_frame.size(); }
+
+private:
+    Entry& Add(EntryType type, std::span<const std::byte> key)
+    {
+        ByteVectorWriter writer{m_frame};
+        ser_writedata8(writer, uint8_t(type));
+        WriteCompactSize(writer, key.size());
+        Entry& entry{m_entries.emplace_back(type, m_frame.size(), key.size(), 0, 0)};
+        writer.write(key);
+        return entry;
+    }
+};
+
+/** Fill in the header of a frame, and check that it fits */
+void SealFrame(std::vector<std::byte>& frame)
+{
+    const size_t payload_size{frame.size() - FRAME_HEADER_SIZE};
+    if (payload_size > std::numeric_limits<uint32_t>::max()) throw dbwrapper_error("LogDB batch too large");
+    const std::span<const std::byte> payload{std::span{frame}.subspan(FRAME_HEADER_SIZE)};
+    WriteLE32(UCharCast(frame.data()), payload_size);
+    WriteLE32(UCharCast(frame.data() + 4), crc32c::Crc32c(UCharCast(payload.data()), payload.size()));
+}
+
+class LogDBIterator : public KVIterator
+{
+private:
+    const std::shared_ptr<const BaseIndex> m_base;
+    const std::shared_ptr<const DeltaIndex> m_delta;
+    const SegmentMap m_segments;
+
+    size_t m_base_pos{0};
+    DeltaIndex::const_iterator m_delta_it;
+
+    bool m_valid{false};
+    bool m_from_delta{false};
+    std::string_view m_key;
+    Slot m_slot{};
+    mutable std::optional<std::string> m_value;
+
+    //! Make the current entry the first of base and delta, where the delta overrides the base
+    void Settle()
+    {
+        m_value.reset();
+        while (true) {
+            const bool in_base{m_base_pos < m_base->size()};
+            const bool in_delta{m_delta_it != m_delta->end()};
+            if (!in_base && !in_delta) {
+                m_valid = false;
+                return;
+            }
+            if (in_delta && (!in_base || m_delta_it->first <= m_base->Key(m_base_pos))) {
+                if (in_base && m_delta_it->first == m_base->Key(m_base_pos)) ++m_base_pos;
+                if (m_delta_it->second.segment == ERASED) {
+                    ++m_delta_it;
+                    continue;
+                }
+                m_key = m_delta_it->first;
+                m_slot = m_delta_it->second;
+                m_from_delta = true;
+            } else {
+                m_key = m_base->Key(m_base_pos);
+                m_slot = m_base->slots[m_base_pos];
+                m_from_delta = false;
+            }
+            m_valid = true;
+            return;
+        }
+    }
+
+public:
+    LogDBIterator(std::shared_ptr<const BaseIndex> base, std::shared_ptr<const DeltaIndex> delta, SegmentMap segments)
+        : m_base{std::move(base)}, m_delta{std::move(delta)}, m_segments{std::move(segments)}, m_delta_it{m_delta->end()} {}
+
+    bool Valid() const override { return m_valid; }
+
+    void SeekToFirst() override
+    {
+        m_base_pos = 0;
+        m_delta_it = m_delta->begin();
+        Settle();
+    }
+
+    void Seek(std::span<const std::byte> key) override
+    {
+        m_base_pos = m_base->LowerBound(AsStringView(key));
+        m_delta_it = m_delta->lower_bound(AsStringView(key));
+        Settle();
+    }
+
+    void Next() override
+    {
+        if (m_from_delta) {
+            ++m_delta_it;
+        } else {
+            ++m_base_pos;
+        }
+        Settle();
+    }
+
+    std::span<const std::byte> Key() const override { return MakeByteSpan(m_key); }
+
+    std::span<const std::byte> Value() const override
+    {
+        if (!m_value) m_value = m_segments.at(m_slot.segment)->Read(m_slot.offset, m_slot.size);
+        return MakeByteSpan(*m_value);
+    }
+};
+
+std::optional<std::pair<uint32_t, uint32_t>> ParseSegmentName(const fs::path& path)
+{
+    const std::string name{fs::PathToString(path.filename())};
+    if (!name.ends_with(SEGMENT_EXTENSION)) return std::nullopt;
+    const auto parts{util::SplitString(std::string_view{name}.substr(0, name.size() - SEGMENT_EXTENSION.size()), '-')};
+    if (parts.size() != 2) return std::nullopt;
+    const auto order{ToIntegral<uint32_t>(parts[0])};
+    const auto part{ToIntegral<uint32_t>(parts[1])};
+    if (!order || !part) return std::nullopt;
+    return std::pair{*order, *part};
+}
+
+class LogDBStore : public KVStore
+{
+private:
+    //! empty for in-memory databases
+    const fs::path m_path;
+
+    mutable Mutex m_mutex;
+    std::shared_ptr<const BaseIndex> m_base GUARDED_BY(m_mutex){std::make_shared<BaseIndex>()};
+    //! Copied on write while iterators share it
+    std::shared_ptr<DeltaIndex> m_delta GUARDED_BY(m_mutex){std::make_shared<DeltaIndex>()};
+    SegmentMap m_segments GUARDED_BY(m_mutex);
+    std::shared_ptr<Segment> m_active GUARDED_BY(m_mutex);
+    uint32_t m_next_order GUARDED_BY(m_mutex){0};
+    //! Size of the entries in the index, and of all segments
+    uint64_t m_live_bytes GUARDED_BY(m_mutex){0};
+    uint64_t m_file_bytes GUARDED_BY(m_mutex){0};
+    bool m_compacting GUARDED_BY(m_mutex){false};
+    bool m_compaction_failed GUARDED_BY(m_mutex){false};
+    //! Totals of the compactions, for GetStats
+    std::chrono::microseconds m_compaction_time GUARDED_BY(m_mutex){0};
+    uint64_t m_compaction_bytes_read GUARDED_BY(m_mutex){0};
+    uint64_t m_compaction_bytes_written GUARDED_BY(m_mutex){0};
+    //! The end of a compaction is rebuilding the index from m_base, which must not be replaced until it is done
+    bool m_rebasing GUARDED_BY(m_mutex){false};
+    //! Writes held up by merges of the delta, and by syncs of the sealed segments, for GetStats
+    DBStats::WriteStall m_merge_stalls GUARDED_BY(m_mutex){.cause = "index_merge"};
+    DBStats::WriteStall m_sync_stalls GUARDED_BY(m_mutex){.cause = "segment_sync"};
+    std::atomic<uint32_t> m_next_segment_id{0};
+
+    //! Serializes compactions
+    Mutex m_compaction_mutex;
+    std::condition_variable m_compaction_cv;
+    std::atomic<bool> m_stop{false};
+    std::thread m_compaction_thread;
+
+    std::shared_ptr<Segment> NewSegment(uint32_t order, uint32_t part)
+    {
+        fs::path path;
+        if (!m_path.empty()) path = m_path / fs::u8path(strprintf("%06u-%04u%s", order, part, SEGMENT_EXTENSION));
+        return std::make_shared<Segment>(m_next_segment_id++, order, part, std::move(path));
+    }
+
+    //! Sync and seal the active segment, and start a new one
+    void Rotate() EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        // A sealed segment cut short by a crash could not be told from a
+        // corrupted one, as replaying the segments after it would skip its
+        // lost writes.
+        if (m_active) {
+            const auto start{SteadyClock::now()};
+            m_active->Flush(/*sync=*/true);
+            AddStall(m_sync_stalls, SteadyClock::now() - start);
+        }
+        m_active = NewSegment(m_next_order++, 0);
+        m_segments.emplace(m_active->m_id, m_active);
+    }
+
+    std::optional<Slot> FindSlot(std::string_view key) const EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        if (const auto it{m_delta->find(key)}; it != m_delta->end()) {
+            if (it->second.segment == ERASED) return std::nullopt;
+            return it->second;
+        }
+        const size_t pos{m_base->LowerBound(key)};
+        if (pos < m_base->size() && m_base->Key(pos) == key) return m_base->slots[pos];
+        return std::nullopt;
+    }
+
+    DeltaIndex& MutableDelta() EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        if (m_delta.use_count() > 1) m_delta = std::make_shared<DeltaIndex>(*m_delta);
+        return *m_delta;
+    }
+
+    void ApplyPut(std::string_view key, const Slot& slot) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        if (const auto old{FindSlot(key)}) m_live_bytes -= EntryBytes(key.size(), old->size);
+        m_live_bytes += EntryBytes(key.size(), slot.size);
+        DeltaIndex& delta{MutableDelta()};
+        if (const auto it{delta.find(key)}; it != delta.end()) {
+            it->second = slot;
+        } else {
+            delta.emplace(key, slot);
+        }
+    }
+
+    void ApplyDelete(std::string_view key) EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        const auto old{FindSlot(key)};
+        if (!old) return;
+        m_live_bytes -= EntryBytes(key.size(), old->size);
+        const size_t pos{m_base->LowerBound(key)};
+        const bool in_base{pos < m_base->size() && m_base->Key(pos) == key};
+        DeltaIndex& delta{MutableDelta()};
+        if (in_base) {
+            delta.insert_or_assign(std::string{key}, Slot{.segment = ERASED, .size = 0, .offset = 0});
+        } else {
+            delta.erase(delta.find(key));
+        }
+    }
+
+    static void AddStall(DBStats::WriteStall& stall, SteadyClock::duration time)
+    {
+        ++stall.count;
+        stall.time += std::chrono::duration_cast<std::chrono::microseconds>(time);
+    }
+
+    void MergeDelta() EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        if (m_delta->empty()) return;
+        Assume(!m_rebasing);
+        const auto start{SteadyClock::now()};
+        auto base{std::make_shared<BaseIndex>()};
+        base->keys.reserve(m_base->keys.size());
+        base->key_starts.reserve(m_base->size() + m_delta->size() + 1);
+        base->slots.reserve(m_base->size() + m_delta->size());
+        size_t pos{0};
+        for (const auto& [key, slot] : *m_delta) {
+            for (; pos < m_base->size() && m_base->Key(pos) < key; ++pos) {
+                base->Add(m_base->Key(pos), m_base->slots[pos]);
+            }
+            if (pos < m_base->size() && m_base->Key(pos) == key) ++pos;
+            if (slot.segment != ERASED) base->Add(key, slot);
+        }
+        for (; pos < m_base->size(); ++pos) {
+            base->Add(m_base->Key(pos), m_base->slots[pos]);
+        }
+        m_base = std::move(base);
+        m_delta = std::make_shared<DeltaIndex>();
+        AddStall(m_merge_stalls, SteadyClock::now() - start);
+    }
+
+    void MaybeMergeDelta() EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        if (!m_rebasing && m_delta->size() > std::max(MIN_DELTA_ENTRIES, m_base->size() / 8)) MergeDelta();
+    }
+
+    bool NeedsCompaction() const EXCLUSIVE_LOCKS_REQUIRED(m_mutex)
+    {
+        const uint64_t garbage{m_file_bytes - std::min(m_file_bytes, m_live_bytes)};
+        return !m_compacting && !m_compaction_failed && garbage > MIN_GARBAGE_BYTES && garbage > m_live_bytes;
+    }
+
+    //! Apply the frames of a segment to index, and return the size of the complete ones
+    uint64_t Replay(const Segment& segment, std::map<std::string, Slot, std::less<>>& index)
+    {
+        const uint64_t size{segment.Size()};
+        uint64_t pos{0};
+        while (pos + FRAME_HEADER_SIZE <= size) {
+            const std::string header{segment.Read(pos, FRAME_HEADER_SIZE)};
+            const uint32_t payload_size{ReadLE32(UCharCast(header.data()))};
+            if (pos + FRAME_HEADER_SIZE + payload_size > size) break;
+            const uint64_t payload_pos{pos + FRAME_HEADER_SIZE};
+            const std::string payload{segment.Read(payload_pos, payload_size)};
+            if (crc32c::Crc32c(payload) != ReadLE32(UCharCast(header.data() + 4))) break;
+
+            std::vector<std::pair<std::string_view, std::optional<Slot>>> changes;
+            try {
+                SpanReader reader{MakeByteSpan(payload)};
+                while (!reader.empty()) {
+                    const auto type{EntryType(ser_readdata8(reader))};
+                    const uint64_t key_size{ReadCompactSize(reader, /*range_check=*/false)};
+                    if (key_size > reader.size()) throw std::ios_base::failure("Truncated key");
+                    const std::string_view key{std::string_view{payload}.substr(payload.size() - reader.size(), key_size)};
+                    reader.ignore(key_size);
+                    if (type == EntryType::DELETE) {
+                        changes.emplace_back(key, std::nullopt);
+                        continue;
+                    }
+                    if (type != EntryType::PUT) throw std::ios_base::failure("Invalid entry type");
+                    const uint64_t value_size{ReadCompactSize(reader, /*range_check=*/false)};
+                    if (value_size > reader.size()) throw std::ios_base::failure("Truncated value");
+                    changes.emplace_back(key, Slot{.segment = segment.m_id, .size = uint32_t(value_size), .offset = payload_pos + payload.size() - reader.size()});
+                    reader.ignore(value_size);
+                }
+            } catch (const std::ios_base::failure&) {
+                break;
+            }
+            for (const auto& [key, slot] : changes) {
+                if (slot) {
+                    index.insert_or_assign(std::string{key}, *slot);
+                } else if (const auto it{index.find(key)}; it != index.end()) {
+                    index.erase(it);
+                }
+            }
+            pos += FRAME_HEADER_SIZE + payload_size;
+        }
+        return pos;
+    }
+
+    fs::path CompactedPath() const { return m_path / fs::u8path(std::string{COMPACTED_FILE}); }
+
+    //! Record that the outputs of the compaction of order replace the segments before them
+    void CommitCompaction(uint32_t order)
+    {
+        const fs::path temp_path{m_path / fs::u8path(strprintf("%s.tmp", COMPACTED_FILE))};
+        unsigned char data[4];
+        WriteLE32(data, order);
+        FILE* file{fsbridge::fopen(temp_path, "wb")};
+        if (!file) Fail("Failed to create " + fs::PathToString(temp_path));
+        const bool written{std::fwrite(data, 1, sizeof(data), file) == sizeof(data) && FileCommit(file)};
+        if (std::fclose(file) != 0 || !written) Fail("Failed to write " + fs::PathToString(temp_path));
+        if (!RenameOver(temp_path, CompactedPath())) Fail("Failed to rename " + fs::PathToString(temp_path));
+        DirectoryCommit(m_path);
+    }
+
+    //! The order of the last compaction committed, if any
+    std::optional<uint32_t> ReadCompacted() const
+    {
+        FILE* file{fsbridge::fopen(CompactedPath(), "rb")};
+        if (!file) return std::nullopt;
+        unsigned char data[4];
+        const bool read{std::fread(data, 1, sizeof(data), file) == sizeof(data)};
+        std::fclose(file);
+        if (!read) Fail("Failed to read " + fs::PathToString(CompactedPath()));
+        return ReadLE32(data);
+    }
+
+    void Open()
+    {
+        const std::optional<uint32_t> compacted{ReadCompacted()};
+        std::vector<std::shared_ptr<Segment>> segments;
+        for (const auto& entry : fs::directory_iterator(m_path)) {
+            const auto name{ParseSegmentName(entry.path())};
+            if (!name) continue;
+            if (compacted && (name->first < *compacted || (name->first == *compacted && name->second == 0))) {
+                LogInfo("Removing LogDB segment %u-%u, replaced by a compaction", name->first, name->second);
+                std::error_code error;
+                fs::remove(entry.path(), error);
+                if (error) Fail("Failed to remove " + fs::PathToString(entry.path()) + ": " + error.message());
+                continue;
+            }
+            segments.push_back(NewSegment(name->first, name->second));
+        }
+        std::ranges::sort(segments, {}, [](const auto& segment) { return std::pair{segment->m_order, segment->m_part}; });
+
+        std::map<std::string, Slot, std::less<>> index;
+        for (const auto& segment : segments) {
+            const uint64_t size{Replay(*segment, index)};
+            if (size < segment->Size()) {
+                // Only the last segment, and the output of a compaction, may be cut short by a crash.
+                if (segment != segments.back() && segment->m_part == 0) {
+                    Fail(strprintf("Corrupted segment %u-%u in %s", segment->m_order, segment->m_part, fs::PathToString(m_path)));
+                }
+                LogInfo("Dropping %u bytes of incomplete writes at the end of LogDB segment %u-%u", segment->Size() - size, segment->m_order, segment->m_part);
+                segment->Truncate(size);
+            }
+        }
+
+        LOCK(m_mutex);
+        auto base{std::make_shared<BaseIndex>()};
+        base->key_starts.reserve(index.size() + 1);
+        base->slots.reserve(index.size());
+        for (const auto& [key, slot] : index) {
+            base->Add(key, slot);
+            m_live_bytes += EntryBytes(key.size(), slot.size);
+        }
+        m_base = std::move(base);
+        for (const auto& segment : segments) {
+            m_file_bytes += segment->Size();
+            m_segments.emplace(segment->m_id, segment);
+        }
+        if (compacted) m_next_order = *compacted + 1;
+        if (!segments.empty()) m_next_order = std::max(m_next_order, segments.back()->m_order + 1);
+    }
+
+    void ThreadCompaction() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex, !m_compaction_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        while (!m_stop) {
+            if (!NeedsCompaction()) {
+                m_compaction_cv.wait(lock);
+                continue;
+            }
+            REVERSE_LOCK(lock, m_mutex);
+            try {
+                Compact();
+            } catch (const std::exception& e) {
+                // Leave it to the next CompactAll, or the next start.
+                if (!m_stop) LogError("LogDB compaction of %s failed: %s", fs::PathToString(m_path), e.what());
+                WITH_LOCK(m_mutex, m_compaction_failed = true);
+            }
+        }
+    }
+
+    //! Rewrite the live entries of all sealed segments
+    void Compact() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex, !m_compaction_mutex)
+    {
+        LOCK(m_compaction_mutex);
+        std::shared_ptr<const BaseIndex> base;
+        SegmentMap old_segments;
+        uint32_t order;
+        uint64_t live_bytes;
+        {
+            LOCK(m_mutex);
+            MergeDelta();
+            order = m_active->m_order;
+            Rotate();
+            base = m_base;
+            old_segments = m_segments;
+            old_segments.erase(m_active->m_id);
+            live_bytes = m_live_bytes;
+            m_compacting = true;
+        }
+        const auto start{SteadyClock::now()};
+
+        const unsigned threads{unsigned(std::clamp<uint64_t>(live_bytes / SEGMENT_SIZE, 1, std::min(MAX_COMPACTION_THREADS, std::max(1U, std::thread::hardware_concurrency()))))};
+        std::vector<Slot> slots(base->size());
+        std::atomic<uint32_t> next_part{1};
+        Mutex outputs_mutex;
+        std::vector<std::shared_ptr<Segment>> outputs;
+        std::vector<std::exception_ptr> errors(threads);
+
+        const auto rewrite{[&](size_t begin, size_t end) {
+            std::shared_ptr<Segment> output;
+            std::vector<std::byte> frame(FRAME_HEADER_SIZE);
+            std::vector<std::pair<size_t, size_t>> pending; // entry and position of its value in the frame
+            const auto write_frame{[&] {
+                if (pending.empty()) return;
+                if (!output || output->Size() >= SEGMENT_SIZE) {
+                    if (output) output->Flush(/*sync=*/true);
+                    output = NewSegment(order, next_part++);
+                    WITH_LOCK(outputs_mutex, outputs.push_back(output));
+                }
+                SealFrame(frame);
+                const uint64_t frame_pos{output->Size()};
+                output->Append(frame);
+                for (const auto& [entry, value_pos] : pending) {
+                    slots[entry] = {.segment = output->m_id, .size = base->slots[entry].size, .offset = frame_pos + value_pos};
+                }
+                frame.resize(FRAME_HEADER_SIZE);
+                pending.clear();
+            }};
+            for (size_t i{begin}; i < end; ++i) {
+                if (m_stop) throw std::runtime_error("Interrupted");
+                const std::string_view key{base->Key(i)};
+                const Slot& slot{base->slots[i]};
+                const std::string value{old_segments.at(slot.segment)->Read(slot.offset, slot.size)};
+                ByteVectorWriter writer{frame};
+                ser_writedata8(writer, uint8_t(EntryType::PUT));
+                WriteCompactSize(writer, key.size());
+                writer.write(MakeByteSpan(key));
+                WriteCompactSize(writer, value.size());
+                pending.emplace_back(i, frame.size());
+                writer.write(MakeByteSpan(value));
+                if (frame.size() >= COMPACTION_FRAME_SIZE) write_frame();
+            }
+            write_frame();
+            if (output) output->Flush(/*sync=*/true);
+        }};
+
+        std::vector<std::thread> workers;
+        for (unsigned t{0}; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                try {
+                    rewrite(base->size() * t / threads, base->size() * (t + 1) / threads);
+                } catch (...) {
+                    errors[t] = std::current_exception();
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        if (!m_path.empty() && std::ranges::none_of(errors, [](const auto& error) { return bool(error); })) {
+            try {
+                CommitCompaction(order);
+            } catch (...) {
+                errors[0] = std::current_exception();
+            }
+        }
+
+        std::shared_ptr<const BaseIndex> current_base;
+        {
+            LOCK(m_mutex);
+            for (const auto& error : errors) {
+                if (!error) continue;
+                m_compacting = false;
+                for (const auto& output : outputs) output->MarkObsolete();
+                std::rethrow_exception(error);
+            }
+            current_base = m_base;
+            m_rebasing = true;
+        }
+
+        // Entries of the base not changed since it was taken point to their
+        // copies. The changes made since are in the base, if merged since,
+        // or in the delta, which overrides it and is not merged until the
+        // new base replaces the current one.
+        auto new_base{std::make_shared<BaseIndex>()};
+        new_base->keys = current_base->keys;
+        new_base->key_starts = current_base->key_starts;
+        new_base->slots = current_base->slots;
+        for (size_t i{0}, pos{0}; i < new_base->size(); ++i) {
+            const std::string_view key{new_base->Key(i)};
+            for (; pos < base->size() && base->Key(pos) < key; ++pos) {}
+            if (pos < base->size() && base->Key(pos) == key && base->slots[pos] == new_base->slots[i]) new_base->slots[i] = slots[pos];
+        }
+
+        LOCK(m_mutex);
+        Assume(m_base == current_base);
+        m_base = std::move(new_base);
+        m_rebasing = false;
+        m_compacting = false;
+        uint64_t bytes_read{0}, bytes_written{0};
+        for (const auto& [id, segment] : old_segments) {
+            m_segments.erase(id);
+            m_file_bytes -= segment->Size();
+            bytes_read += segment->Size();
+            segment->MarkObsolete();
+        }
+        for (const auto& output : outputs) {
+            m_segments.emplace(output->m_id, output);
+            m_file_bytes += output->Size();
+            bytes_written += output->Size();
+        }
+        MaybeMergeDelta();
+        const auto elapsed{SteadyClock::now() - start};
+        m_compaction_time += std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+        m_compaction_bytes_read += bytes_read;
+        m_compaction_bytes_written += bytes_written;
+        LogDebug(BCLog::LEVELDB, "LogDB compaction of %s rewrote %u entries on %u threads in %dms, reclaiming %.1fMiB\n",
+                 fs::PathToString(m_path), base->size(), threads, Ticks<std::chrono::milliseconds>(elapsed),
+                 (bytes_read - std::min(bytes_read, bytes_written)) / 1024.0 / 1024);
+    }
+
+public:
+    explicit LogDBStore(const DBParams& params)
+        : m_path{params.memory_only ? fs::path{} : params.path}
+    {
+        if (!m_path.empty()) {
+            if (params.wipe_data && IsLogDB(m_path)) {
+                LogInfo("Wiping LogDB in %s", fs::PathToString(m_path));
+                if (!DestroyLogDB(m_path)) Fail("Failed to wipe " + fs::PathToString(m_path));
+            }
+            TryCreateDirectories(m_path);
+            LogInfo("Opening LogDB in %s", fs::PathToString(m_path));
+            if (!IsLogDB(m_path)) {
+                FILE* marker{fsbridge::fopen(m_path / fs::u8path(std::string{MARKER_FILE}), "wb")};
+                if (!marker || std::fclose(marker) != 0) Fail("Failed to create " + fs::PathToString(m_path / fs::u8path(std::string{MARKER_FILE})));
+            }
+            Open();
+            LogInfo("Opened LogDB successfully");
+        }
+        WITH_LOCK(m_mutex, Rotate());
+        m_compaction_thread = std::thread{&util::TraceThread, "logdbcompact", [this] { ThreadCompaction(); }};
+    }
+
+    ~LogDBStore() override
+    {
+        {
+            LOCK(m_mutex);
+            m_stop = true;
+            m_compaction_cv.notify_all();
+        }
+        m_compaction_thread.join();
+        try {
+            WITH_LOCK(m_mutex, return m_active)->Flush(/*sync=*/true);
+        } catch (const dbwrapper_error&) {
+            // Logged already
+        }
+    }
+
+    std::unique_ptr<KVBatch> NewBatch() const override { return std::make_unique<LogDBBatch>(); }
+
+    void Write(KVBatch& kvbatch, bool sync) override
+    {
+        auto& batch{static_cast<LogDBBatch&>(kvbatch)};
+        LOCK(m_mutex);
+        if (!batch.m_entries.empty()) {
+            if (m_active->Size() >= SEGMENT_SIZE) Rotate();
+            SealFrame(batch.m_frame);
+            const uint64_t frame_pos{m_active->Size()};
+            m_active->Append(batch.m_frame);
+            m_file_bytes += batch.m_frame.size();
+            for (const auto& entry : batch.m_entries) {
+                const std::string_view key{AsStringView(std::span{batch.m_frame}.subspan(entry.key_pos, entry.key_size))};
+                if (entry.type == EntryType::PUT) {
+                    ApplyPut(key, {.segment = m_active->m_id, .size = entry.value_size, .offset = frame_pos + entry.value_pos});
+                } else {
+                    ApplyDelete(key);
+                }
+            }
+            MaybeMergeDelta();
+            if (NeedsCompaction()) m_compaction_cv.notify_all();
+        }
+        m_active->Flush(sync);
+    }
+
+    std::optional<std::string> Read(std::span<const std::byte> key) const override
+    {
+        std::shared_ptr<Segment> segment;
+        Slot slot;
+        {
+            LOCK(m_mutex);
+            const auto found{FindSlot(AsStringView(key))};
+            if (!found) return std::nullopt;
+            slot = *found;
+            segment = m_segments.at(slot.segment);
+        }
+        return segment->Read(slot.offset, slot.size);
+    }
+
+    bool Exists(std::span<const std::byte> key) const override
+    {
+        return WITH_LOCK(m_mutex, return FindSlot(AsStringView(key)).has_value());
+    }
+
+    std::unique_ptr<KVIterator> NewIterator() const override
+    {
+        LOCK(m_mutex);
+        return std::make_unique<LogDBIterator>(m_base, m_delta, m_segments);
+    }
+
+    size_t EstimateSize(std::span<const std::byte> begin, std::span<const std::byte> end) const override
+    {
+        LOCK(m_mutex);
+        const size_t first{m_base->LowerBound(AsStringView(begin))};
+        const size_t last{m_base->LowerBound(AsStringView(end))};
+        if (last <= first) return 0;
+        return (last - first) * (m_live_bytes / m_base->size());
+    }
+
+    size_t DynamicMemoryUsage() const override
+    {
+        LOCK(m_mutex);
+        return m_base->DynamicMemoryUsage() + memusage::DynamicUsage(*m_delta);
+    }
+
+    DBStats GetStats() const override
+    {
+        LOCK(m_mutex);
+        DBStats stats;
+        // Compactions rewrite sealed segments only, and do not hold up writes.
+        // Merging the changes into the sorted index, and syncing a segment as
+        // it is sealed, do.
+        stats.levels.push_back({.files = m_segments.size(),
+                                .bytes = m_file_bytes,
+                                .compaction_time = m_compaction_time,
+                                .compaction_bytes_read = m_compaction_bytes_read,
+                                .compaction_bytes_written = m_compaction_bytes_written});
+        stats.write_stalls = {m_merge_stalls, m_sync_stalls};
+        return stats;
+    }
+
+    void CompactAll() override
+    {
+        Compact();
+        WITH_LOCK(m_mutex, m_compaction_failed = false);
+    }
+};
+
+} // namespace
+
+std::unique_ptr<KVStore> OpenLogDB(const DBParams& params)
+{
+    return std::make_unique<LogDBStore>(params);
+}
+
+bool IsLogDB(const fs::path& path)
+{
+    return fs::exists(path / fs::u8path(std::string{MARKER_FILE}));
+}
+
+bool DestroyLogDB(const fs::path& path)
+{
+    std::error_code error;
+    for (const auto& entry : fs::directory_iterator(path, error)) {
+        if (ParseSegmentName(entry.path())) fs::remove(entry.path(), error);
+        if (error) return false;
+    }
+    for (const auto& name : {std::string{COMPACTED_FILE}, strprintf("%s.tmp", COMPACTED_FILE)}) {
+        fs::remove(path / fs::u8path(name), error);
+        if (error) return false;
+    }
+    fs::remove(path / fs::u8path(std::string{MARKER_FILE}), error);
+    return !error;
+}
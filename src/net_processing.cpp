@@ -32,6 +32,7 @@
 #include <netmessagemaker.h>
 #include <node/blockstorage.h>
 #include <node/connection_types.h>
+#include <node/minisketchwrapper.h>
 #include <node/protocol_version.h>
 #include <node/timeoffsets.h>
 #include <node/txdownloadman.h>
@@ -124,8 +125,16 @@ static const unsigned int MAX_LOCATOR_SZ = 101;
 static const unsigned int MAX_INV_SZ = 50000;
 /** Limit to avoid sending big packets. Not used in processing incoming GETDATA for compatibility */
 static const unsigned int MAX_GETDATA_SZ = 1000;
-/** Number of blocks that can be requested at any given time from a single peer. */
+/** Number of blocks that can be requested at any given time from a single peer,
+ *  until we have measured how quickly it delivers blocks (see GetBlocksInTransitLimit()). */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
+/** Lower and upper bound of the adaptive per-peer in-flight block limit. */
+static constexpr int MIN_BLOCKS_IN_TRANSIT_PER_PEER{2};
+static constexpr int MAX_BLOCKS_IN_TRANSIT_PER_PEER_ADAPTIVE{32};
+/** The adaptive in-flight limit aims to keep roughly this much download time queued at each peer. */
+static constexpr auto BLOCK_DOWNLOAD_QUEUE_TARGET{4s};
+/** Log a peer's block download statistics every this many delivered blocks. */
+static constexpr uint64_t BLOCK_DOWNLOAD_STATS_LOG_INTERVAL{500};
 /** Default time during which a peer must stall block download progress before being disconnected.
  * the actual timeout is increased temporarily if peers are disconnected for hitting the timeout */
 static constexpr auto BLOCK_STALLING_TIMEOUT_DEFAULT{2s};
@@ -449,6 +458,12 @@ struct CNodeState {
     std::list<QueuedBlock> vBlocksInFlight;
     //! When the first entry in vBlocksInFlight started downloading. Don't care when vBlocksInFlight is empty.
     std::chrono::microseconds m_downloading_since{0us};
+    //! Moving average of the time this peer takes to deliver a block once it
+    //! reached the front of vBlocksInFlight. Unset until the first delivery.
+    std::optional<std::chrono::microseconds> m_avg_block_download_time;
+    //! Number and total size of requested blocks this peer delivered.
+    uint64_t m_blocks_downloaded{0};
+    uint64_t m_block_bytes_downloaded{0};
     //! Whether we consider this a preferred download peer.
     bool fPreferredDownload{false};
     /** Whether this peer wants invs or cmpctblocks (when possible) for block announcements. */
@@ -497,6 +512,21 @@ struct CNodeState {
     int64_t m_last_block_announcement{0};
 };
 
+/** Return how many blocks we are willing to have in flight from a peer at once.
+ *
+ * Until the peer delivered a block we use MAX_BLOCKS_IN_TRANSIT_PER_PEER.
+ * Afterwards the limit is sized to keep about BLOCK_DOWNLOAD_QUEUE_TARGET
+ * worth of blocks queued at the peer's measured delivery rate, so slow peers
+ * hold fewer blocks of the download window and fast peers more.
+ */
+int GetBlocksInTransitLimit(const CNodeState& state)
+{
+    if (!state.m_avg_block_download_time) return MAX_BLOCKS_IN_TRANSIT_PER_PEER;
+    const auto per_block{std::max<std::chrono::microseconds>(*state.m_avg_block_download_time, 1ms)};
+    return std::clamp<int64_t>(BLOCK_DOWNLOAD_QUEUE_TARGET / per_block,
+                               MIN_BLOCKS_IN_TRANSIT_PER_PEER, MAX_BLOCKS_IN_TRANSIT_PER_PEER_ADAPTIVE);
+}
+
 class PeerManagerImpl final : public PeerManager
 {
 public:
@@ -520,12 +550,12 @@ public:
 
     /** Implement NetEventsInterface */
     void InitializeNode(const CNode& node, ServiceFlags our_services) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_tx_download_mutex);
-    void FinalizeNode(const CNode& node) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_headers_presync_mutex, !m_tx_download_mutex);
+    void FinalizeNode(const CNode& node) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_headers_presync_mutex, !m_tx_download_mutex, !m_tx_inventory_snapshot_mutex);
     bool HasAllDesirableServiceFlags(ServiceFlags services) const override;
     bool ProcessMessages(CNode* pfrom, std::atomic<bool>& interrupt) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, !m_headers_presync_mutex, g_msgproc_mutex, !m_tx_download_mutex);
     bool SendMessages(CNode* pto) override
-        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, g_msgproc_mutex, !m_tx_download_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_most_recent_block_mutex, g_msgproc_mutex, !m_tx_download_mutex, !m_tx_inventory_snapshot_mutex);
 
     /** Implement PeerManager */
     void StartScheduledTasks(CScheduler& scheduler) override;
@@ -536,7 +566,7 @@ public:
     std::vector<node::TxOrphanage::OrphanInfo> GetOrphanTransactions() override EXCLUSIVE_LOCKS_REQUIRED(!m_tx_download_mutex);
     PeerManagerInfo GetInfo() const override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     void SendPings() override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
-    void RelayTransaction(const Txid& txid, const Wtxid& wtxid) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
+    void RelayTransaction(const Txid& txid, const Wtxid& wtxid) override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_tx_inventory_snapshot_mutex);
     void SetBestBlock(int height, std::chrono::seconds time) override
     {
         m_best_height = height;
@@ -644,7 +674,7 @@ private:
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !m_headers_presync_mutex, g_msgproc_mutex);
     /** Various helpers for headers processing, invoked by ProcessHeadersMessage() */
     /** Return true if headers are continuous and have valid proof-of-work (DoS points assigned on failure) */
-    bool CheckHeadersPoW(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams, Peer& peer);
+    bool CheckHeadersPoW(const std::vector<CBlockHeader>& headers, std::span<const uint256> hashes, const Consensus::Params& consensusParams, Peer& peer);
     /** Calculate an anti-DoS work threshold for headers chains */
     arith_uint256 GetAntiDoSWorkThreshold();
     /** Deal with state tracking and headers sync for peers that send
@@ -652,7 +682,7 @@ private:
      * announcements for blocks interacting with the 2hr (MAX_FUTURE_BLOCK_TIME) rule). */
     void HandleUnconnectingHeaders(CNode& pfrom, Peer& peer, const std::vector<CBlockHeader>& headers) EXCLUSIVE_LOCKS_REQUIRED(g_msgproc_mutex);
     /** Return true if the headers connect to each other, false otherwise */
-    bool CheckHeadersAreContinuous(const std::vector<CBlockHeader>& headers) const;
+    bool CheckHeadersAreContinuous(const std::vector<CBlockHeader>& headers, std::span<const uint256> hashes) const;
     /** Try to continue a low-work headers sync that has already begun.
      * Assumes the caller has already verified the headers connect, and has
      * checked that each header satisfies the proof-of-work target included in
@@ -660,6 +690,7 @@ private:
      *  @param[in]  peer                            The peer we're syncing with.
      *  @param[in]  pfrom                           CNode of the peer
      *  @param[in,out] headers                      The headers to be processed.
+     *  @param[in,out] hashes                       Block hashes of the headers, replaced along with them.
      *  @return     True if the passed in headers were successfully processed
      *              as the continuation of a low-work headers sync in progress;
      *              false otherwise.
@@ -672,7 +703,7 @@ private:
      *              acceptance by the caller).
      */
     bool IsContinuationOfLowWorkHeadersSync(Peer& peer, CNode& pfrom,
-            std::vector<CBlockHeader>& headers)
+            std::vector<CBlockHeader>& headers, std::vector<uint256>& hashes)
         EXCLUSIVE_LOCKS_REQUIRED(peer.m_headers_sync_mutex, !m_headers_presync_mutex, g_msgproc_mutex);
     /** Check work on a headers chain to be processed, and if insufficient,
      * initiate our anti-DoS headers sync mechanism.
@@ -681,13 +712,15 @@ private:
      * @param[in]   pfrom               CNode of the peer
      * @param[in]   chain_start_header  Where these headers connect in our index.
      * @param[in,out]   headers             The headers to be processed.
+     * @param[in,out]   hashes              Block hashes of the headers, replaced along with them.
      *
      * @return      True if chain was low work (headers will be empty after
      *              calling); false otherwise.
      */
     bool TryLowWorkHeadersSync(Peer& peer, CNode& pfrom,
                                   const CBlockIndex* chain_start_header,
-                                  std::vector<CBlockHeader>& headers)
+                                  std::vector<CBlockHeader>& headers,
+                                  std::vector<uint256>& hashes)
         EXCLUSIVE_LOCKS_REQUIRED(!peer.m_headers_sync_mutex, !m_peer_mutex, !m_headers_presync_mutex, g_msgproc_mutex);
 
     /** Return true if the given header is an ancestor of
@@ -872,6 +905,39 @@ private:
     /** The m_headers_presync_stats improved, and needs signalling. */
     std::atomic_bool m_headers_presync_should_signal{false};
 
+    // Transaction announcement data shared by all peers' inventory trickles.
+    /** Mutex guarding the m_tx_inventory_* variables. Acquired after a peer's TxRelay mutexes. */
+    Mutex m_tx_inventory_snapshot_mutex;
+    /** For every wtxid in any peer's TxRelay::m_tx_inventory_to_send, the number of peers it is queued for. */
+    std::unordered_map<Wtxid, int, SaltedWtxidHasher> m_tx_inventory_queued GUARDED_BY(m_tx_inventory_snapshot_mutex);
+    /** Wtxids added to m_tx_inventory_queued since m_tx_inventory_snapshot was last brought up to date. */
+    std::vector<Wtxid> m_tx_inventory_queued_new GUARDED_BY(m_tx_inventory_snapshot_mutex);
+    /** Mempool information about the queued transactions, looked up and sorted once and then shared by all peers
+     *  that trickle announcements while the mempool does not change. */
+    struct TxInventorySnapshot {
+        /** Positions of consecutive transactions when the snapshot is built, leaving room for the transactions
+         *  queued later to be placed between them. */
+        static constexpr uint64_t POSITION_SPACING{uint64_t{1} << 32};
+        /** The mempool sequence number this snapshot was built for. */
+        uint64_t m_mempool_sequence{0};
+        /** For every queued transaction that is in the mempool, its position in announcement order (topological
+         *  and by mining score, see CTxMemPool::CompareMiningScoreWithTopology) and its mempool info. */
+        std::unordered_map<Wtxid, std::pair<uint64_t, TxMempoolInfo>, SaltedWtxidHasher> m_txs;
+        /** The wtxids of m_txs, in announcement order. */
+        std::vector<Wtxid> m_order;
+    };
+    TxInventorySnapshot m_tx_inventory_snapshot GUARDED_BY(m_tx_inventory_snapshot_mutex);
+
+    /** Account for wtxid having been added to, or removed from, a peer's TxRelay::m_tx_inventory_to_send. */
+    void TxInventoryQueued(const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(m_tx_inventory_snapshot_mutex);
+    void TxInventoryDequeued(const Wtxid& wtxid) EXCLUSIVE_LOCKS_REQUIRED(m_tx_inventory_snapshot_mutex);
+    /** Return m_tx_inventory_snapshot, after rebuilding it if the mempool changed, or else adding the
+     *  transactions queued since it was built. */
+    const TxInventorySnapshot& GetTxInventorySnapshot() EXCLUSIVE_LOCKS_REQUIRED(m_tx_inventory_snapshot_mutex);
+    /** Add the transactions in m_tx_inventory_queued_new to m_tx_inventory_snapshot, which is for the current
+     *  mempool. Returns false if they could not all be given a position, and the snapshot must be rebuilt. */
+    bool AddToTxInventorySnapshot() EXCLUSIVE_LOCKS_REQUIRED(m_tx_inventory_snapshot_mutex, m_mempool.cs);
+
     /** Height of the highest block announced using BIP 152 high-bandwidth mode. */
     int m_highest_fast_announce GUARDED_BY(::cs_main){0};
 
@@ -890,6 +956,10 @@ private:
      */
     void RemoveBlockRequest(const uint256& hash, std::optional<NodeId> from_peer) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /** Update a peer's block download statistics for a requested block it
+     *  just delivered. Must be called before the block request is removed. */
+    void RecordBlockDelivery(NodeId nodeid, const uint256& hash, size_t block_size) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
     /* Mark a block as in flight
      * Returns false, still setting pit, if the block was already in flight from the same peer
      * pit will only be valid as long as the same cs_main lock is being held
@@ -901,7 +971,7 @@ private:
     /** Update pindexLastCommonBlock and add not-in-flight missing successors to vBlocks, until it has
      *  at most count entries.
      */
-    void FindNextBlocksToDownload(const Peer& peer, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, NodeId& nodeStaller) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    void FindNextBlocksToDownload(const Peer& peer, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, NodeId& nodeStaller, const CBlockIndex** staller_block = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     /** Request blocks for the background chainstate, if one is in use. */
     void TryDownloadingHistoricalBlocks(const Peer& peer, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, const CBlockIndex* from_tip, const CBlockIndex* target_block) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
@@ -933,7 +1003,11 @@ private:
     *                     block in the window is in flight and no other peer is
     *                     trying to download the next block).
     */
-    void FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, const Peer& peer, CNodeState *state, const CBlockIndex *pindexWalk, unsigned int count, int nWindowEnd, const CChain* activeChain=nullptr, NodeId* nodeStaller=nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+    void FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, const Peer& peer, CNodeState *state, const CBlockIndex *pindexWalk, unsigned int count, int nWindowEnd, const CChain* activeChain=nullptr, NodeId* nodeStaller=nullptr, const CBlockIndex** staller_block=nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /** Whether a block that is stalling the download window at staller should
+     *  additionally be requested from the (faster) peer in state. */
+    bool ShouldRerequestStalledBlock(const CNodeState& state, NodeId staller, const CBlockIndex& block, std::chrono::microseconds now) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
     /* Multimap used to preserve insertion order */
     typedef std::multimap<uint256, std::pair<NodeId, std::list<QueuedBlock>::iterator>> BlockDownloadMap;
@@ -1209,6 +1283,54 @@ void PeerManagerImpl::RemoveBlockRequest(const uint256& hash, std::optional<Node
     }
 }
 
+void PeerManagerImpl::RecordBlockDelivery(NodeId nodeid, const uint256& hash, size_t block_size)
+{
+    CNodeState* state = State(nodeid);
+    if (state == nullptr) return;
+
+    auto range = mapBlocksInFlight.equal_range(hash);
+    const bool requested{std::any_of(range.first, range.second, [&](const auto& entry) { return entry.second.first == nodeid; })};
+    if (!requested) return;
+
+    ++state->m_blocks_downloaded;
+    state->m_block_bytes_downloaded += block_size;
+
+    // Only blocks delivered from the front of the queue give a meaningful
+    // per-block delivery time: m_downloading_since is when the peer could
+    // start working on that block.
+    if (state->vBlocksInFlight.front().pindex->GetBlockHash() == hash) {
+        const auto sample{std::max(GetTime<std::chrono::microseconds>() - state->m_downloading_since, 0us)};
+        state->m_avg_block_download_time = state->m_avg_block_download_time ?
+            (*state->m_avg_block_download_time * 7 + sample) / 8 : sample;
+    }
+
+    if (state->m_blocks_downloaded % BLOCK_DOWNLOAD_STATS_LOG_INTERVAL == 0) {
+        LogDebug(BCLog::NET, "Block download stats peer=%d: blocks=%u bytes=%u avg_block_time=%dms in_flight=%u limit=%d peers_downloading=%d\n",
+                 nodeid, state->m_blocks_downloaded, state->m_block_bytes_downloaded,
+                 Ticks<std::chrono::milliseconds>(state->m_avg_block_download_time.value_or(0us)),
+                 state->vBlocksInFlight.size(), GetBlocksInTransitLimit(*state), m_peers_downloading_from);
+    }
+}
+
+bool PeerManagerImpl::ShouldRerequestStalledBlock(const CNodeState& state, NodeId staller, const CBlockIndex& block, std::chrono::microseconds now)
+{
+    // Never download a block from more than two peers at once.
+    if (mapBlocksInFlight.count(block.GetBlockHash()) != 1) return false;
+
+    const CNodeState* staller_state = State(staller);
+    if (staller_state == nullptr || staller_state->m_stalling_since == 0us) return false;
+
+    // Only hand the block to a peer that has proven to be faster than the
+    // staller (a staller that never delivered a block from the front of its
+    // queue counts as slower than any measured peer).
+    if (!state.m_avg_block_download_time) return false;
+    if (staller_state->m_avg_block_download_time &&
+        *staller_state->m_avg_block_download_time <= *state.m_avg_block_download_time) return false;
+
+    // Give the staller at least twice the time this peer would need for it.
+    return now - staller_state->m_stalling_since >= 2 * *state.m_avg_block_download_time;
+}
+
 bool PeerManagerImpl::BlockRequested(NodeId nodeid, const CBlockIndex& block, std::list<QueuedBlock>::iterator** pit)
 {
     const uint256& hash{block.GetBlockHash()};
@@ -1367,7 +1489,7 @@ void PeerManagerImpl::UpdateBlockAvailability(NodeId nodeid, const uint256 &hash
 }
 
 // Logic for calculating which blocks to download from a given peer, given our current tip.
-void PeerManagerImpl::FindNextBlocksToDownload(const Peer& peer, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, NodeId& nodeStaller)
+void PeerManagerImpl::FindNextBlocksToDownload(const Peer& peer, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, NodeId& nodeStaller, const CBlockIndex** staller_block)
 {
     if (count == 0)
         return;
@@ -1412,7 +1534,7 @@ void PeerManagerImpl::FindNextBlocksToDownload(const Peer& peer, unsigned int co
     // download that next block if the window were 1 larger.
     int nWindowEnd = state->pindexLastCommonBlock->nHeight + BLOCK_DOWNLOAD_WINDOW;
 
-    FindNextBlocks(vBlocks, peer, state, pindexWalk, count, nWindowEnd, &m_chainman.ActiveChain(), &nodeStaller);
+    FindNextBlocks(vBlocks, peer, state, pindexWalk, count, nWindowEnd, &m_chainman.ActiveChain(), &nodeStaller, staller_block);
 }
 
 void PeerManagerImpl::TryDownloadingHistoricalBlocks(const Peer& peer, unsigned int count, std::vector<const CBlockIndex*>& vBlocks, const CBlockIndex *from_tip, const CBlockIndex* target_block)
@@ -1444,12 +1566,13 @@ void PeerManagerImpl::TryDownloadingHistoricalBlocks(const Peer& peer, unsigned
     FindNextBlocks(vBlocks, peer, state, from_tip, count, std::min<int>(from_tip->nHeight + BLOCK_DOWNLOAD_WINDOW, target_block->nHeight));
 }
 
-void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, const Peer& peer, CNodeState *state, const CBlockIndex *pindexWalk, unsigned int count, int nWindowEnd, const CChain* activeChain, NodeId* nodeStaller)
+void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, const Peer& peer, CNodeState *state, const CBlockIndex *pindexWalk, unsigned int count, int nWindowEnd, const CChain* activeChain, NodeId* nodeStaller, const CBlockIndex** staller_block)
 {
     std::vector<const CBlockIndex*> vToFetch;
     int nMaxHeight = std::min<int>(state->pindexBestKnownBlock->nHeight, nWindowEnd + 1);
     bool is_limited_peer = IsLimitedPeer(peer);
     NodeId waitingfor = -1;
+    const CBlockIndex* waitingfor_block{nullptr};
     while (pindexWalk->nHeight < nMaxHeight) {
         // Read up to 128 (or more, if more blocks than that are needed) successors of pindexWalk (towards
         // pindexBestKnownBlock) into vToFetch. We fetch 128, because CBlockIndex::GetAncestor may be as expensive
@@ -1489,6 +1612,7 @@ void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, c
                 if (waitingfor == -1) {
                     // This is the first already-in-flight block.
                     waitingfor = mapBlocksInFlight.lower_bound(pindex->GetBlockHash())->second.first;
+                    waitingfor_block = pindex;
                 }
                 continue;
             }
@@ -1499,6 +1623,7 @@ void PeerManagerImpl::FindNextBlocks(std::vector<const CBlockIndex*>& vBlocks, c
                 if (vBlocks.size() == 0 && waitingfor != peer.m_id) {
                     // We aren't able to fetch anything, but we would be if the download window was one larger.
                     if (nodeStaller) *nodeStaller = waitingfor;
+                    if (staller_block) *staller_block = waitingfor_block;
                 }
                 return;
             }
@@ -1605,6 +1730,10 @@ void PeerManagerImpl::FinalizeNode(const CNode& node)
         assert(peer != nullptr);
         m_wtxid_relay_peers -= peer->m_wtxid_relay;
         assert(m_wtxid_relay_peers >= 0);
+        if (auto tx_relay = peer->GetTxRelay(); tx_relay != nullptr) {
+            LOCK2(tx_relay->m_tx_inventory_mutex, m_tx_inventory_snapshot_mutex);
+            for (const Wtxid& wtxid : tx_relay->m_tx_inventory_to_send) TxInventoryDequeued(wtxid);
+        }
     }
     CNodeState *state = State(nodeid);
     assert(state != nullptr);
@@ -1644,6 +1773,7 @@ void PeerManagerImpl::FinalizeNode(const CNode& node)
         assert(m_outbound_peers_with_protect_from_disconnect == 0);
         assert(m_wtxid_relay_peers == 0);
         WITH_LOCK(m_tx_download_mutex, m_txdownloadman.CheckIsEmpty());
+        WITH_LOCK(m_tx_inventory_snapshot_mutex, assert(m_tx_inventory_queued.empty()));
     }
     } // cs_main
     if (node.fSuccessfullyConnected &&
@@ -1906,6 +2036,9 @@ PeerManagerImpl::PeerManagerImpl(CConnman& connman, AddrMan& addrman,
     // This argument can go away after Erlay support is complete.
     if (opts.reconcile_txs) {
         m_txreconciliation = std::make_unique<TxReconciliationTracker>(TXRECONCILIATION_VERSION);
+        // Benchmark the Minisketch implementations now, rather than on the message handler thread when the first
+        // sketch is needed.
+        node::Minisketch32Implementation();
     }
 }
 
@@ -2140,12 +2273,81 @@ void PeerManagerImpl::RelayTransaction(const Txid& txid, const Wtxid& wtxid)
         if (tx_relay->m_next_inv_send_time == 0s) continue;
 
         const uint256& hash{peer.m_wtxid_relay ? wtxid.ToUint256() : txid.ToUint256()};
-        if (!tx_relay->m_tx_inventory_known_filter.contains(hash)) {
-            tx_relay->m_tx_inventory_to_send.insert(wtxid);
+        if (!tx_relay->m_tx_inventory_known_filter.contains(hash) && tx_relay->m_tx_inventory_to_send.insert(wtxid).second) {
+            WITH_LOCK(m_tx_inventory_snapshot_mutex, TxInventoryQueued(wtxid));
         }
     }
 }
 
+void PeerManagerImpl::TxInventoryQueued(const Wtxid& wtxid)
+{
+    AssertLockHeld(m_tx_inventory_snapshot_mutex);
+    if (m_tx_inventory_queued[wtxid]++ == 0) m_tx_inventory_queued_new.push_back(wtxid);
+}
+
+void PeerManagerImpl::TxInventoryDequeued(const Wtxid& wtxid)
+{
+    AssertLockHeld(m_tx_inventory_snapshot_mutex);
+    auto it = m_tx_inventory_queued.find(wtxid);
+    assert(it != m_tx_inventory_queued.end());
+    if (--it->second == 0) m_tx_inventory_queued.erase(it);
+}
+
+const PeerManagerImpl::TxInventorySnapshot& PeerManagerImpl::GetTxInventorySnapshot()
+{
+    AssertLockHeld(m_tx_inventory_snapshot_mutex);
+    TxInventorySnapshot& snapshot{m_tx_inventory_snapshot};
+    // Hold the mempool lock so the snapshot matches the sequence number it is tagged with.
+    LOCK(m_mempool.cs);
+    const uint64_t mempool_sequence{m_mempool.GetSequence()};
+    if (snapshot.m_mempool_sequence == mempool_sequence && AddToTxInventorySnapshot()) {
+        return snapshot;
+    }
+
+    std::vector<Wtxid> wtxids;
+    wtxids.reserve(m_tx_inventory_queued.size());
+    for (const auto& [wtxid, _] : m_tx_inventory_queued) wtxids.push_back(wtxid);
+    std::vector<TxMempoolInfo> txinfos{m_mempool.infoSorted(wtxids)};
+
+    m_tx_inventory_queued_new.clear();
+    snapshot.m_mempool_sequence = mempool_sequence;
+    snapshot.m_txs.clear();
+    snapshot.m_txs.reserve(txinfos.size());
+    snapshot.m_order.clear();
+    snapshot.m_order.reserve(txinfos.size());
+    for (size_t i = 0; i < txinfos.size(); ++i) {
+        const Wtxid wtxid{txinfos[i].tx->GetWitnessHash()};
+        snapshot.m_txs.try_emplace(wtxid, (i + 1) * TxInventorySnapshot::POSITION_SPACING, std::move(txinfos[i]));
+        snapshot.m_order.push_back(wtxid);
+    }
+    return snapshot;
+}
+
+bool PeerManagerImpl::AddToTxInventorySnapshot()
+{
+    AssertLockHeld(m_tx_inventory_snapshot_mutex);
+    AssertLockHeld(m_mempool.cs);
+    TxInventorySnapshot& snapshot{m_tx_inventory_snapshot};
+    // As the mempool has not changed, the transactions already in the snapshot keep their order, and each new one
+    // is placed among them by a binary search. Transactions are queued without the mempool changing when they
+    // are relayed again, or when a trickle builds the snapshot between their acceptance and their relay.
+    for (const Wtxid& wtxid : m_tx_inventory_queued_new) {
+        if (!m_tx_inventory_queued.contains(wtxid) || snapshot.m_txs.contains(wtxid)) continue;
+        TxMempoolInfo txinfo{m_mempool.info(wtxid)};
+        if (!txinfo.tx) continue;
+        const auto next{std::upper_bound(snapshot.m_order.begin(), snapshot.m_order.end(), wtxid,
+            [&](const Wtxid& a, const Wtxid& b) { return m_mempool.CompareMiningScoreWithTopology(a, b); })};
+        const uint64_t prev_position{next == snapshot.m_order.begin() ? 0 : snapshot.m_txs.at(*std::prev(next)).first};
+        const uint64_t next_position{next == snapshot.m_order.end() ? prev_position + 2 * TxInventorySnapshot::POSITION_SPACING : snapshot.m_txs.at(*next).first};
+        // Out of room between the neighbours, which takes about 32 insertions at the same place.
+        if (next_position - prev_position < 2) return false;
+        snapshot.m_txs.try_emplace(wtxid, prev_position + (next_position - prev_position) / 2, std::move(txinfo));
+        snapshot.m_order.insert(next, wtxid);
+    }
+    m_tx_inventory_queued_new.clear();
+    return true;
+}
+
 void PeerManagerImpl::RelayAddress(NodeId originator,
                                    const CAddress& addr,
                                    bool fReachable)
@@ -2484,16 +2686,16 @@ void PeerManagerImpl::SendBlockTransactions(CNode& pfrom, Peer& peer, const CBlo
     MakeAndPushMessage(pfrom, NetMsgType::BLOCKTXN, resp);
 }
 
-bool PeerManagerImpl::CheckHeadersPoW(const std::vector<CBlockHeader>& headers, const Consensus::Params& consensusParams, Peer& peer)
+bool PeerManagerImpl::CheckHeadersPoW(const std::vector<CBlockHeader>& headers, std::span<const uint256> hashes, const Consensus::Params& consensusParams, Peer& peer)
 {
     // Do these headers have proof-of-work matching what's claimed?
-    if (!HasValidProofOfWork(headers, consensusParams)) {
+    if (!HasValidProofOfWork(headers, hashes, consensusParams)) {
         Misbehaving(peer, "header with invalid proof of work");
         return false;
     }
 
     // Are these headers connected to each other?
-    if (!CheckHeadersAreContinuous(headers)) {
+    if (!CheckHeadersAreContinuous(headers, hashes)) {
         Misbehaving(peer, "non-continuous headers sequence");
         return false;
     }
@@ -2538,22 +2740,20 @@ void PeerManagerImpl::HandleUnconnectingHeaders(CNode& pfrom, Peer& peer,
     WITH_LOCK(cs_main, UpdateBlockAvailability(pfrom.GetId(), headers.back().GetHash()));
 }
 
-bool PeerManagerImpl::CheckHeadersAreContinuous(const std::vector<CBlockHeader>& headers) const
+bool PeerManagerImpl::CheckHeadersAreContinuous(const std::vector<CBlockHeader>& headers, std::span<const uint256> hashes) const
 {
-    uint256 hashLastBlock;
-    for (const CBlockHeader& header : headers) {
-        if (!hashLastBlock.IsNull() && header.hashPrevBlock != hashLastBlock) {
+    for (size_t i{1}; i < headers.size(); ++i) {
+        if (headers[i].hashPrevBlock != hashes[i - 1]) {
             return false;
         }
-        hashLastBlock = header.GetHash();
     }
     return true;
 }
 
-bool PeerManagerImpl::IsContinuationOfLowWorkHeadersSync(Peer& peer, CNode& pfrom, std::vector<CBlockHeader>& headers)
+bool PeerManagerImpl::IsContinuationOfLowWorkHeadersSync(Peer& peer, CNode& pfrom, std::vector<CBlockHeader>& headers, std::vector<uint256>& hashes)
 {
     if (peer.m_headers_sync) {
-        auto result = peer.m_headers_sync->ProcessNextHeaders(headers, headers.size() == m_opts.max_headers_result);
+        auto result = peer.m_headers_sync->ProcessNextHeaders(headers, hashes, headers.size() == m_opts.max_headers_result);
         // If it is a valid continuation, we should treat the existing getheaders request as responded to.
         if (result.success) peer.m_last_getheaders_timestamp = {};
         if (result.request_more) {
@@ -2622,6 +2822,7 @@ bool PeerManagerImpl::IsContinuationOfLowWorkHeadersSync(Peer& peer, CNode& pfro
             // We only overwrite the headers passed in if processing was
             // successful.
             headers.swap(result.pow_validated_headers);
+            hashes.swap(result.pow_validated_hashes);
         }
 
         return result.success;
@@ -2632,7 +2833,7 @@ bool PeerManagerImpl::IsContinuationOfLowWorkHeadersSync(Peer& peer, CNode& pfro
     return false;
 }
 
-bool PeerManagerImpl::TryLowWorkHeadersSync(Peer& peer, CNode& pfrom, const CBlockIndex* chain_start_header, std::vector<CBlockHeader>& headers)
+bool PeerManagerImpl::TryLowWorkHeadersSync(Peer& peer, CNode& pfrom, const CBlockIndex* chain_start_header, std::vector<CBlockHeader>& headers, std::vector<uint256>& hashes)
 {
     // Calculate the claimed total work on this chain.
     arith_uint256 total_work = chain_start_header->nChainWork + CalculateClaimedHeadersWork(headers);
@@ -2664,7 +2865,7 @@ bool PeerManagerImpl::TryLowWorkHeadersSync(Peer& peer, CNode& pfrom, const CBlo
             // Now a HeadersSyncState object for tracking this synchronization
             // is created, process the headers using it as normal. Failures are
             // handled inside of IsContinuationOfLowWorkHeadersSync.
-            (void)IsContinuationOfLowWorkHeadersSync(peer, pfrom, headers);
+            (void)IsContinuationOfLowWorkHeadersSync(peer, pfrom, headers, hashes);
         } else {
             LogDebug(BCLog::NET, "Ignoring low-work chain (height=%u) from peer=%d\n", chain_start_header->nHeight + headers.size(), pfrom.GetId());
         }
@@ -2672,6 +2873,7 @@ bool PeerManagerImpl::TryLowWorkHeadersSync(Peer& peer, CNode& pfrom, const CBlo
         // The peer has not yet given us a chain that meets our work threshold,
         // so we want to prevent further processing of the headers in any case.
         headers = {};
+        hashes = {};
         return true;
     }
 
@@ -2715,10 +2917,12 @@ void PeerManagerImpl::HeadersDirectFetchBlocks(CNode& pfrom, const Peer& peer, c
     CNodeState *nodestate = State(pfrom.GetId());
 
     if (CanDirectFetch() && last_header.IsValid(BLOCK_VALID_TREE) && m_chainman.ActiveChain().Tip()->nChainWork <= last_header.nChainWork) {
+        // The same limit as for the parallel download, so that fetching directly doesn't undo its adapting.
+        const size_t blocks_in_transit_limit{static_cast<size_t>(GetBlocksInTransitLimit(*nodestate))};
         std::vector<const CBlockIndex*> vToFetch;
         const CBlockIndex* pindexWalk{&last_header};
         // Calculate all the blocks we'd need to switch to last_header, up to a limit.
-        while (pindexWalk && !m_chainman.ActiveChain().Contains(pindexWalk) && vToFetch.size() <= MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+        while (pindexWalk && !m_chainman.ActiveChain().Contains(pindexWalk) && vToFetch.size() <= blocks_in_transit_limit) {
             if (!(pindexWalk->nStatus & BLOCK_HAVE_DATA) &&
                     !IsBlockRequested(pindexWalk->GetBlockHash()) &&
                     (!DeploymentActiveAt(*pindexWalk, m_chainman, Consensus::DEPLOYMENT_SEGWIT) || CanServeWitnesses(peer))) {
@@ -2739,7 +2943,7 @@ void PeerManagerImpl::HeadersDirectFetchBlocks(CNode& pfrom, const Peer& peer, c
             std::vector<CInv> vGetData;
             // Download as much as possible, from earliest to latest.
             for (const CBlockIndex* pindex : vToFetch | std::views::reverse) {
-                if (nodestate->vBlocksInFlight.size() >= MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+                if (nodestate->vBlocksInFlight.size() >= blocks_in_transit_limit) {
                     // Can't download any more from this peer
                     break;
                 }
@@ -2852,7 +3056,15 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, Peer& peer,
     // We'll rely on headers having valid proof-of-work further down, as an
     // anti-DoS criteria (note: this check is required before passing any
     // headers into HeadersSyncState).
-    if (!CheckHeadersPoW(headers, m_chainparams.GetConsensus(), peer)) {
+    // Each header is hashed once here; the hashes are shared by the
+    // proof-of-work and continuity checks, any low-work headers sync in
+    // progress and the block index, which would otherwise each rehash the
+    // whole batch. Headers a low-work sync releases for processing come with
+    // the hashes it computed for them.
+    std::vector<uint256> hashes;
+    hashes.reserve(nCount);
+    for (const CBlockHeader& header : headers) hashes.push_back(header.GetHash());
+    if (!CheckHeadersPoW(headers, hashes, m_chainparams.GetConsensus(), peer)) {
         // Misbehaving() calls are handled within CheckHeadersPoW(), so we can
         // just return. (Note that even if a header is announced via compact
         // block, the header itself should be valid, so this type of error can
@@ -2874,7 +3086,7 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, Peer& peer,
     {
         LOCK(peer.m_headers_sync_mutex);
 
-        already_validated_work = IsContinuationOfLowWorkHeadersSync(peer, pfrom, headers);
+        already_validated_work = IsContinuationOfLowWorkHeadersSync(peer, pfrom, headers, hashes);
 
         // The headers we passed in may have been:
         // - untouched, perhaps if no headers-sync was in progress, or some
@@ -2917,7 +3129,7 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, Peer& peer,
     const CBlockIndex *last_received_header{nullptr};
     {
         LOCK(cs_main);
-        last_received_header = m_chainman.m_blockman.LookupBlockIndex(headers.back().GetHash());
+        last_received_header = m_chainman.m_blockman.LookupBlockIndex(hashes.back());
         if (IsAncestorOfBestHeaderOrTip(last_received_header)) {
             already_validated_work = true;
         }
@@ -2934,7 +3146,7 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, Peer& peer,
     // Do anti-DoS checks to determine if we should process or store for later
     // processing.
     if (!already_validated_work && TryLowWorkHeadersSync(peer, pfrom,
-                chain_start_header, headers)) {
+                chain_start_header, headers, hashes)) {
         // If we successfully started a low-work headers sync, then there
         // should be no headers to process any further.
         Assume(headers.empty());
@@ -2952,7 +3164,7 @@ void PeerManagerImpl::ProcessHeadersMessage(CNode& pfrom, Peer& peer,
     BlockValidationState state;
     const bool processed{m_chainman.ProcessNewBlockHeaders(headers,
                                                            /*min_pow_checked=*/true,
-                                                           state, &pindexLast)};
+                                                           state, &pindexLast, hashes)};
     if (!processed) {
         if (state.IsInvalid()) {
             if (!pfrom.IsInboundConn() && state.GetResult() == BlockValidationResult::BLOCK_CACHED_INVALID) {
@@ -4449,7 +4661,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
         // We want to be a bit conservative just to be extra careful about DoS
         // possibilities in compact block processing...
         if (pindex->nHeight <= m_chainman.ActiveChain().Height() + 2) {
-            if ((already_in_flight < MAX_CMPCTBLOCKS_INFLIGHT_PER_BLOCK && nodestate->vBlocksInFlight.size() < MAX_BLOCKS_IN_TRANSIT_PER_PEER) ||
+            if ((already_in_flight < MAX_CMPCTBLOCKS_INFLIGHT_PER_BLOCK && nodestate->vBlocksInFlight.size() < static_cast<size_t>(GetBlocksInTransitLimit(*nodestate))) ||
                  requested_block_from_this_peer) {
                 std::list<QueuedBlock>::iterator* queuedBlockIt = nullptr;
                 if (!BlockRequested(pfrom.GetId(), *pindex, &queuedBlockIt)) {
@@ -4649,8 +4861,11 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             return;
         }
 
+        const size_t block_size{vRecv.size()};
         std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
-        vRecv >> TX_WITH_WITNESS(*pblock);
+        ChunkArena arena{TX_ARENA_CHUNK_SIZE};
+        const TransactionSerParams params{.allow_witness = true, .arena = &arena};
+        vRecv >> params(*pblock);
 
         LogDebug(BCLog::NET, "received block %s peer=%d\n", pblock->GetHash().ToString(), pfrom.GetId());
 
@@ -4673,6 +4888,7 @@ void PeerManagerImpl::ProcessMessage(CNode& pfrom, const std::string& msg_type,
             // Always process the block if we requested it, since we may
             // need it even when it's not a candidate for a new best tip.
             forceProcessing = IsBlockRequested(hash);
+            RecordBlockDelivery(pfrom.GetId(), hash, block_size);
             RemoveBlockRequest(hash, pfrom.GetId());
             // mapBlockSource is only used for punishing peers and setting
             // which peers send us compact blocks, so the race between here and
@@ -5432,22 +5648,6 @@ void PeerManagerImpl::MaybeSendFeefilter(CNode& pto, Peer& peer, std::chrono::mi
     }
 }
 
-namespace {
-class CompareInvMempoolOrder
-{
-    const CTxMemPool* m_mempool;
-public:
-    explicit CompareInvMempoolOrder(CTxMemPool* mempool) : m_mempool{mempool} {}
-
-    bool operator()(std::set<Wtxid>::iterator a, std::set<Wtxid>::iterator b)
-    {
-        /* As std::make_heap produces a max-heap, we want the entries with the
-         * higher mining score to sort later. */
-        return m_mempool->CompareMiningScoreWithTopology(*b, *a);
-    }
-};
-} // namespace
-
 bool PeerManagerImpl::RejectIncomingTxs(const CNode& peer) const
 {
     // block-relay-only peers may never send txs to us
@@ -5743,7 +5943,11 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                 // Time to send but the peer has requested we not relay transactions.
                 if (fSendTrickle) {
                     LOCK(tx_relay->m_bloom_filter_mutex);
-                    if (!tx_relay->m_relay_txs) tx_relay->m_tx_inventory_to_send.clear();
+                    if (!tx_relay->m_relay_txs) {
+                        LOCK(m_tx_inventory_snapshot_mutex);
+                        for (const Wtxid& wtxid : tx_relay->m_tx_inventory_to_send) TxInventoryDequeued(wtxid);
+                        tx_relay->m_tx_inventory_to_send.clear();
+                    }
                 }
 
                 // Respond to BIP35 mempool requests
@@ -5752,7 +5956,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     tx_relay->m_send_mempool = false;
                     const CFeeRate filterrate{tx_relay->m_fee_filter_received.load()};
 
-                    LOCK(tx_relay->m_bloom_filter_mutex);
+                    LOCK2(tx_relay->m_bloom_filter_mutex, m_tx_inventory_snapshot_mutex);
 
                     for (const auto& txinfo : vtxinfo) {
                         const Txid& txid{txinfo.tx->GetHash()};
@@ -5760,7 +5964,7 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                         const auto inv = peer->m_wtxid_relay ?
                                              CInv{MSG_WTX, wtxid.ToUint256()} :
                                              CInv{MSG_TX, txid.ToUint256()};
-                        tx_relay->m_tx_inventory_to_send.erase(wtxid);
+                        if (tx_relay->m_tx_inventory_to_send.erase(wtxid)) TxInventoryDequeued(wtxid);
 
                         // Don't send transactions that peers will not put into their mempool
                         if (txinfo.fee < filterrate.GetFee(txinfo.vsize)) {
@@ -5780,36 +5984,45 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
 
                 // Determine transactions to relay
                 if (fSendTrickle) {
-                    // Produce a vector with all candidates for sending
-                    std::vector<std::set<Wtxid>::iterator> vInvTx;
-                    vInvTx.reserve(tx_relay->m_tx_inventory_to_send.size());
-                    for (std::set<Wtxid>::iterator it = tx_relay->m_tx_inventory_to_send.begin(); it != tx_relay->m_tx_inventory_to_send.end(); it++) {
-                        vInvTx.push_back(it);
-                    }
-                    const CFeeRate filterrate{tx_relay->m_fee_filter_received.load()};
-                    // Topologically and fee-rate sort the inventory we send for privacy and priority reasons.
-                    // A heap is used so that not all items need sorting if only a few are being sent.
-                    CompareInvMempoolOrder compareInvMempoolOrder(&m_mempool);
-                    std::make_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
                     // No reason to drain out at many times the network's capacity,
                     // especially since we have many peers and some will draw much shorter delays.
-                    unsigned int nRelayedTransactions = 0;
-                    LOCK(tx_relay->m_bloom_filter_mutex);
                     size_t broadcast_max{INVENTORY_BROADCAST_TARGET + (tx_relay->m_tx_inventory_to_send.size()/1000)*5};
                     broadcast_max = std::min<size_t>(INVENTORY_BROADCAST_MAX, broadcast_max);
+                    const CFeeRate filterrate{tx_relay->m_fee_filter_received.load()};
+                    LOCK2(tx_relay->m_bloom_filter_mutex, m_tx_inventory_snapshot_mutex);
+                    // The mempool lookups and ordering are shared with all other peers trickling in the same
+                    // interval, see TxInventorySnapshot.
+                    const TxInventorySnapshot& snapshot{GetTxInventorySnapshot()};
+                    // Produce a vector with all candidates for sending, along with their position in the
+                    // topological and fee-rate order we send inventory in for privacy and priority reasons.
+                    using InvCandidate = const std::pair<uint64_t, TxMempoolInfo>*;
+                    std::vector<InvCandidate> vInvTx;
+                    vInvTx.reserve(tx_relay->m_tx_inventory_to_send.size());
+                    for (auto it = tx_relay->m_tx_inventory_to_send.begin(); it != tx_relay->m_tx_inventory_to_send.end();) {
+                        const auto snapshot_it{snapshot.m_txs.find(*it)};
+                        if (snapshot_it == snapshot.m_txs.end()) {
+                            // Not in the mempool anymore? don't bother sending it.
+                            TxInventoryDequeued(*it);
+                            it = tx_relay->m_tx_inventory_to_send.erase(it);
+                        } else {
+                            vInvTx.push_back(&snapshot_it->second);
+                            ++it;
+                        }
+                    }
+                    // A heap is used so that not all items need sorting if only a few are being sent. As
+                    // std::make_heap produces a max-heap, entries that are to be sent first must sort later.
+                    const auto compare_inv_order{[](InvCandidate a, InvCandidate b) { return a->first > b->first; }};
+                    std::make_heap(vInvTx.begin(), vInvTx.end(), compare_inv_order);
+                    unsigned int nRelayedTransactions = 0;
                     while (!vInvTx.empty() && nRelayedTransactions < broadcast_max) {
                         // Fetch the top element from the heap
-                        std::pop_heap(vInvTx.begin(), vInvTx.end(), compareInvMempoolOrder);
-                        std::set<Wtxid>::iterator it = vInvTx.back();
+                        std::pop_heap(vInvTx.begin(), vInvTx.end(), compare_inv_order);
+                        const TxMempoolInfo& txinfo{vInvTx.back()->second};
                         vInvTx.pop_back();
-                        auto wtxid = *it;
+                        const Wtxid& wtxid{txinfo.tx->GetWitnessHash()};
                         // Remove it from the to-be-sent set
-                        tx_relay->m_tx_inventory_to_send.erase(it);
-                        // Not in the mempool anymore? don't bother sending it.
-                        auto txinfo = m_mempool.info(wtxid);
-                        if (!txinfo.tx) {
-                            continue;
-                        }
+                        tx_relay->m_tx_inventory_to_send.erase(wtxid);
+                        TxInventoryDequeued(wtxid);
                         // `TxRelay::m_tx_inventory_known_filter` contains either txids or wtxids
                         // depending on whether our peer supports wtxid-relay. Therefore, first
                         // construct the inv and then use its hash for the filter check.
@@ -5914,16 +6127,18 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
         // Message: getdata (blocks)
         //
         std::vector<CInv> vGetData;
-        if (CanServeBlocks(*peer) && ((sync_blocks_and_headers_from_peer && !IsLimitedPeer(*peer)) || !m_chainman.IsInitialBlockDownload()) && state.vBlocksInFlight.size() < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+        const int blocks_in_transit_limit{GetBlocksInTransitLimit(state)};
+        if (CanServeBlocks(*peer) && ((sync_blocks_and_headers_from_peer && !IsLimitedPeer(*peer)) || !m_chainman.IsInitialBlockDownload()) && state.vBlocksInFlight.size() < static_cast<size_t>(blocks_in_transit_limit)) {
             std::vector<const CBlockIndex*> vToDownload;
             NodeId staller = -1;
-            auto get_inflight_budget = [&state]() {
-                return std::max(0, MAX_BLOCKS_IN_TRANSIT_PER_PEER - static_cast<int>(state.vBlocksInFlight.size()));
+            const CBlockIndex* staller_block{nullptr};
+            auto get_inflight_budget = [&state, blocks_in_transit_limit]() {
+                return std::max(0, blocks_in_transit_limit - static_cast<int>(state.vBlocksInFlight.size()));
             };
 
             // If a snapshot chainstate is in use, we want to find its next blocks
             // before the background chainstate to prioritize getting to network tip.
-            FindNextBlocksToDownload(*peer, get_inflight_budget(), vToDownload, staller);
+            FindNextBlocksToDownload(*peer, get_inflight_budget(), vToDownload, staller, &staller_block);
             if (m_chainman.BackgroundSyncInProgress() && !IsLimitedPeer(*peer)) {
                 // If the background tip is not an ancestor of the snapshot block,
                 // we need to start requesting blocks from their last common ancestor.
@@ -5946,6 +6161,15 @@ bool PeerManagerImpl::SendMessages(CNode* pto)
                     State(staller)->m_stalling_since = current_time;
                     LogDebug(BCLog::NET, "Stall started peer=%d\n", staller);
                 }
+                // Rather than waiting for the stalling timeout to disconnect
+                // the staller, also ask this faster peer for the block that
+                // holds back the download window.
+                if (staller_block && ShouldRerequestStalledBlock(state, staller, *staller_block, current_time)) {
+                    vGetData.emplace_back(MSG_BLOCK | GetFetchFlags(*peer), staller_block->GetBlockHash());
+                    BlockRequested(pto->GetId(), *staller_block);
+                    LogDebug(BCLog::NET, "Re-requesting stalled block %s (%d) from peer=%d (stalled by peer=%d)\n",
+                             staller_block->GetBlockHash().ToString(), staller_block->nHeight, pto->GetId(), staller);
+                }
             }
         }
 
@@ -35,7 +35,7 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, BlockManager::Op
 
     if (auto value{args.GetBoolArg("-fastprune")}) opts.fast_prune = *value;
 
-    ReadDatabaseArgs(args, opts.block_tree_db_params.options);
+    if (auto result{ReadDatabaseArgs(args, opts.block_tree_db_params.options, "blockindex")}; !result) return result;
 
     return {};
 }
@@ -212,10 +212,15 @@ const CBlockIndex* BlockManager::LookupBlockIndex(const uint256& hash) const
 }
 
 CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block, CBlockIndex*& best_header)
+{
+    return AddToBlockIndex(block, block.GetHash(), best_header);
+}
+
+CBlockIndex* BlockManager::AddToBlockIndex(const CBlockHeader& block, const uint256& hash, CBlockIndex*& best_header)
 {
     AssertLockHeld(cs_main);
 
-    auto [mi, inserted] = m_block_index.try_emplace(block.GetHash(), block);
+    auto [mi, inserted] = m_block_index.try_emplace(hash, block);
     if (!inserted) {
         return &mi->second;
     }
@@ -1013,8 +1018,10 @@ bool BlockManager::ReadBlock(CBlock& block, const FlatFilePos& pos, const std::o
     }
 
     try {
-        // Read block
-        SpanReader{*block_data} >> TX_WITH_WITNESS(block);
+        // Read block, with its transactions in an arena
+        ChunkArena arena{TX_ARENA_CHUNK_SIZE};
+        const TransactionSerParams params{.allow_witness = true, .arena = &arena};
+        SpanReader{*block_data} >> params(block);
     } catch (const std::exception& e) {
         LogError("Deserialize or I/O error - %s at %s while reading block", e.what(), pos.ToString());
         return false;
@@ -7,6 +7,7 @@
 #include <arith_uint256.h>
 #include <common/args.h>
 #include <common/system.h>
+#include <dbwrapper.h>
 #include <logging.h>
 #include <node/coins_view_args.h>
 #include <node/database_args.h>
@@ -47,7 +48,14 @@ util::Result<void> ApplyArgsManOptions(const ArgsManager& args, ChainstateManage
 
     if (auto value{args.GetIntArg("-maxtipage")}) opts.max_tip_age = std::chrono::seconds{*value};
 
-    ReadDatabaseArgs(args, opts.coins_db);
+    if (auto result{ReadDatabaseArgs(args, opts.coins_db, "chainstate")}; !result) return result;
+    if (auto value{args.GetArg("-chainstatedbengine")}) {
+        if (auto engine{ParseDBEngine(*value)}) {
+            opts.coins_db.engine = *engine;
+        } else {
+            return util::Error{Untranslated(strprintf("Invalid -chainstatedbengine=%s, must be leveldb or logdb", *value))};
+        }
+    }
     ReadCoinsViewArgs(args, opts.coins_view);
 
     int script_threads = args.GetIntArg("-par", DEFAULT_SCRIPTCHECK_THREADS);
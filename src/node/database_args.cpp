@@ -6,13 +6,88 @@
 
 #include <common/args.h>
 #include <dbwrapper.h>
+#include <tinyformat.h>
+#include <util/fs.h>
+#include <util/strencodings.h>
+#include <util/string.h>
+#include <util/translation.h>
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <string>
+
+using util::SplitString;
 
 namespace node {
-void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options)
+namespace {
+constexpr std::array<std::string_view, 4> INDEX_DBS{"txindex", "blockfilterindex", "coinstatsindex", "scripthashindex"};
+
+bool IsKnownDatabase(std::string_view db)
+{
+    return db == "chainstate" || db == "blockindex" || db == "indexes" || std::ranges::count(INDEX_DBS, db);
+}
+
+//! Apply a setting=value of a -dbprofile
+util::Result<void> ApplyProfileSetting(DBOptions& options, std::string_view setting, std::string_view value)
+{
+    const auto number{ToIntegral<int64_t>(value)};
+    if (!number || *number < 0) {
+        return util::Error{Untranslated(strprintf("Invalid value %s for %s, must be a non-negative number", value, setting))};
+    }
+    if (setting == "blockcache" && *number <= 100) {
+        options.block_cache_percent = *number;
+    } else if (setting == "writebuffer" && *number >= 1 && *number <= 1024) {
+        options.write_buffer_size = size_t(*number) << 20;
+    } else if (setting == "bloombits" && *number <= 64) {
+        options.bloom_bits = *number;
+    } else if (setting == "blocksize" && *number >= 1 && *number <= 4096) {
+        options.block_size = size_t(*number) << 10;
+    } else if (setting == "compression" && *number == 1) {
+        // Snappy is not part of the LevelDB build.
+        return util::Error{Untranslated("Invalid setting compression=1, LevelDB is built without compression")};
+    } else if (setting == "compression" && *number == 0) {
+        options.compression = false;
+    } else if (setting == "maxopenfiles" && *number >= 1 && *number <= 50000) {
+        options.max_open_files = *number;
+    } else {
+        return util::Error{Untranslated(strprintf("Invalid setting %s=%s", setting, value))};
+    }
+    return {};
+}
+} // namespace
+
+util::Result<void> ReadDatabaseArgs(const ArgsManager& args, DBOptions& options, std::string_view db)
 {
-    // Settings here apply to all databases (chainstate, blocks, and index
-    // databases), but it'd be easy to parse database-specific options by adding
-    // a database_type string or enum parameter to this function.
     if (auto value = args.GetBoolArg("-forcecompactdb")) options.force_compact = *value;
+
+    // Profiles for all indexes first, so that those of an index override them
+    const bool is_index{std::ranges::count(INDEX_DBS, db) > 0};
+    for (const bool all_indexes : {true, false}) {
+        for (const std::string& profile : args.GetArgs("-dbprofile")) {
+            const auto name_end{profile.find(':')};
+            const std::string_view name{std::string_view{profile}.substr(0, name_end)};
+            if (name_end == std::string::npos || !IsKnownDatabase(name)) {
+                return util::Error{Untranslated(strprintf("Invalid -dbprofile=%s, must start with chainstate:, blockindex:, indexes:, or the name of an index followed by :", profile))};
+            }
+            const bool applies{all_indexes ? is_index && name == "indexes" : name == db};
+            for (const std::string& setting : SplitString(std::string_view{profile}.substr(name_end + 1), ',')) {
+                const auto value_start{setting.find('=')};
+                if (value_start == std::string::npos) {
+                    return util::Error{Untranslated(strprintf("Invalid -dbprofile=%s: %s must be <setting>=<value>", profile, setting))};
+                }
+                // Settings of other databases are checked too
+                DBOptions ignored;
+                if (auto result{ApplyProfileSetting(applies ? options : ignored, setting.substr(0, value_start), setting.substr(value_start + 1))}; !result) {
+                    return util::Error{Untranslated(strprintf("Invalid -dbprofile=%s: ", profile)) + util::ErrorString(result)};
+                }
+            }
+        }
+    }
+
+    if (const fs::path dir{args.GetPathArg("-dbtrace")}; !dir.empty()) {
+        options.trace_path = dir / fs::u8path(strprintf("%s.dbtrace", db));
+    }
+    return {};
 }
 } // namespace node
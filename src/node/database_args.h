@@ -5,11 +5,18 @@
 #ifndef HYLIUM_NODE_DATABASE_ARGS_H
 #define HYLIUM_NODE_DATABASE_ARGS_H
 
+#include <util/result.h>
+
+#include <string_view>
+
 class ArgsManager;
 struct DBOptions;
 
 namespace node {
-void ReadDatabaseArgs(const ArgsManager& args, DBOptions& options);
+//! Read the options of a database: chainstate, blockindex, or one of the
+//! indexes (txindex, blockfilterindex, coinstatsindex or scripthashindex).
+//! Errors are for any -dbprofile, not only those of this database.
+[[nodiscard]] util::Result<void> ReadDatabaseArgs(const ArgsManager& args, DBOptions& options, std::string_view db);
 } // namespace node
 
 #endif // HYLIUM_NODE_DATABASE_ARGS_H
@@ -24,6 +24,8 @@
 #include <cstdint>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 using util::ReplaceAll;
 
@@ -50,12 +52,20 @@ namespace node {
 
 kernel::InterruptResult KernelNotifications::blockTip(SynchronizationState state, const CBlockIndex& index, double verification_progress)
 {
+    std::vector<std::function<void()>> woken;
     {
         LOCK(m_tip_block_mutex);
         Assume(index.GetBlockHash() != uint256::ZERO);
         m_tip_block = index.GetBlockHash();
         m_tip_block_cv.notify_all();
+        std::erase_if(m_tip_waiters, [&](auto& entry) {
+            auto& waiter{entry.second};
+            if (waiter.tip == *m_tip_block) return false;
+            woken.push_back(std::move(waiter.wake));
+            return true;
+        });
     }
+    for (const auto& wake : woken) wake();
 
     uiInterface.NotifyBlockTip(state, index, verification_progress);
     if (m_stop_at_height && index.nHeight >= m_stop_at_height) {
@@ -106,6 +116,34 @@ std::optional<uint256> KernelNotifications::TipBlock()
     return m_tip_block;
 };
 
+uint64_t KernelNotifications::WaitTipChangedAsync(const uint256& current_tip, std::function<void()> wake)
+{
+    uint64_t id;
+    {
+        LOCK(m_tip_block_mutex);
+        id = m_next_tip_waiter++;
+        if (!m_tip_block || *m_tip_block == current_tip) {
+            m_tip_waiters.emplace(id, TipWaiter{.tip = current_tip, .wake = std::move(wake)});
+            return id;
+        }
+    }
+    wake();
+    return id;
+}
+
+void KernelNotifications::CancelTipWaiter(uint64_t id)
+{
+    std::function<void()> wake;
+    {
+        LOCK(m_tip_block_mutex);
+        auto it{m_tip_waiters.find(id)};
+        if (it == m_tip_waiters.end()) return;
+        // Destroy the callback, and what it holds, outside of the lock
+        wake = std::move(it->second.wake);
+        m_tip_waiters.erase(it);
+    }
+}
+
 
 void ReadNotificationArgs(const ArgsManager& args, KernelNotifications& notifications)
 {
@@ -14,6 +14,8 @@
 #include <atomic>
 #include <cstdint>
 #include <functional>
+#include <map>
+#include <optional>
 
 class ArgsManager;
 class CBlockIndex;
@@ -61,12 +63,29 @@ public:
     //! Might be unset during an early shutdown.
     std::optional<uint256> TipBlock() EXCLUSIVE_LOCKS_REQUIRED(m_tip_block_mutex);
 
+    //! Call wake once the tip is set and differs from current_tip: right away
+    //! if it already does, or else from the blockTip notification changing it.
+    //! This waits for the tip to change without holding a thread.
+    //! Returns an id to pass to CancelTipWaiter once the wait is over for
+    //! another reason, so that wake is not kept until the next tip change.
+    uint64_t WaitTipChangedAsync(const uint256& current_tip, std::function<void()> wake) EXCLUSIVE_LOCKS_REQUIRED(!m_tip_block_mutex);
+    //! Drop the wake callback of a WaitTipChangedAsync call, if not yet called.
+    void CancelTipWaiter(uint64_t id) EXCLUSIVE_LOCKS_REQUIRED(!m_tip_block_mutex);
+
 private:
     const std::function<bool()>& m_shutdown_request;
     std::atomic<int>& m_exit_status;
     node::Warnings& m_warnings;
 
     std::optional<uint256> m_tip_block GUARDED_BY(m_tip_block_mutex);
+    struct TipWaiter {
+        //! The tip to wait to change from.
+        uint256 tip;
+        std::function<void()> wake;
+    };
+    //! Callbacks of WaitTipChangedAsync, by the id it returned.
+    std::map<uint64_t, TipWaiter> m_tip_waiters GUARDED_BY(m_tip_block_mutex);
+    uint64_t m_next_tip_waiter GUARDED_BY(m_tip_block_mutex){0};
 };
 
 void ReadNotificationArgs(const ArgsManager& args, KernelNotifications& notifications);
@@ -57,6 +57,8 @@ uint32_t FindBestImplementation()
     return best->second;
 }
 
+} // namespace
+
 uint32_t Minisketch32Implementation()
 {
     // Fast compute-once idiom.
@@ -64,9 +66,6 @@ uint32_t Minisketch32Implementation()
     return best;
 }
 
-} // namespace
-
-
 Minisketch MakeMinisketch32(size_t capacity)
 {
     return Minisketch(BITS, Minisketch32Implementation(), capacity);
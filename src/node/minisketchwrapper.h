@@ -11,6 +11,9 @@
 #include <cstdint>
 
 namespace node {
+/** The fastest Minisketch implementation for 32-bit elements on this machine. All supported implementations are
+ *  benchmarked on the first call; later calls return the cached choice. */
+uint32_t Minisketch32Implementation();
 /** Wrapper around Minisketch::Minisketch(32, implementation, capacity). */
 Minisketch MakeMinisketch32(size_t capacity);
 /** Wrapper around Minisketch::CreateFP. */
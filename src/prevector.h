@@ -26,7 +26,8 @@
  *      (only the first _size are initialized).
  *  - Indirect allocation:
  *    - Size _size: the number of used elements plus N + 1
- *    - Size capacity: the number of allocated elements
+ *    - Size capacity: the number of allocated elements, with the top bit set
+ *      if the array is borrowed (see borrow_uninitialized) rather than owned
  *    - T* indirect: a pointer to an array of capacity elements of type T
  *      (only the first _size are initialized).
  *
@@ -116,6 +117,8 @@ private:
     alignas(char*) direct_or_indirect _union = {};
     size_type _size = 0;
 
+    static constexpr size_type BORROWED{size_type(size_type{1} << (sizeof(size_type) * 8 - 1))};
+
     static_assert(alignof(char*) % alignof(size_type) == 0 && sizeof(char*) % alignof(size_type) == 0, "size_type cannot have more restrictive alignment requirement than pointer");
     static_assert(alignof(char*) % alignof(T) == 0, "value_type T cannot have more restrictive alignment requirement than pointer");
 
@@ -124,6 +127,7 @@ private:
     T* indirect_ptr(difference_type pos) { return reinterpret_cast<T*>(_union.indirect_contents.indirect) + pos; }
     const T* indirect_ptr(difference_type pos) const { return reinterpret_cast<const T*>(_union.indirect_contents.indirect) + pos; }
     bool is_direct() const { return _size <= N; }
+    bool owns_indirect() const { return !is_direct() && !(_union.indirect_contents.capacity & BORROWED); }
 
     void change_capacity(size_type new_capacity) {
         if (new_capacity <= N) {
@@ -132,11 +136,11 @@ private:
                 T* src = indirect;
                 T* dst = direct_ptr(0);
                 memcpy(dst, src, size() * sizeof(T));
-                free(indirect);
+                if (owns_indirect()) free(indirect);
                 _size -= N + 1;
             }
         } else {
-            if (!is_direct()) {
+            if (owns_indirect()) {
                 /* FIXME: Because malloc/realloc here won't call new_handler if allocation fails, assert
                     success. These should instead use an allocator or new/delete so that handlers
                     are called as necessary, but performance would be slightly degraded by doing so. */
@@ -146,12 +150,12 @@ private:
             } else {
                 char* new_indirect = static_cast<char*>(malloc(((size_t)sizeof(T)) * new_capacity));
                 assert(new_indirect);
-                T* src = direct_ptr(0);
+                T* src = item_ptr(0);
                 T* dst = reinterpret_cast<T*>(new_indirect);
                 memcpy(dst, src, size() * sizeof(T));
+                if (is_direct()) _size += N + 1;
                 _union.indirect_contents.indirect = new_indirect;
                 _union.indirect_contents.capacity = new_capacity;
-                _size += N + 1;
             }
         }
     }
@@ -235,7 +239,7 @@ public:
     }
 
     prevector& operator=(prevector<N, T, Size, Diff>&& other) noexcept {
-        if (!is_direct()) {
+        if (owns_indirect()) {
             free(_union.indirect_contents.indirect);
         }
         _union = std::move(other._union);
@@ -261,7 +265,7 @@ public:
         if (is_direct()) {
             return N;
         } else {
-            return _union.indirect_contents.capacity;
+            return _union.indirect_contents.capacity & ~BORROWED;
         }
     }
 
@@ -361,6 +365,25 @@ public:
         }
     }
 
+    /** Resize to n uninitialized elements, like resize_uninitialized, but
+     *  stored in storage if they don't fit directly. The caller keeps storage
+     *  allocated for as long as this prevector uses it. Growing past n moves
+     *  the elements to memory of its own. */
+    void borrow_uninitialized(T* storage, size_type n) {
+        if (n <= N) {
+            resize_uninitialized(n);
+            return;
+        }
+        assert(n < BORROWED);
+        if (owns_indirect()) free(_union.indirect_contents.indirect);
+        _union.indirect_contents.indirect = reinterpret_cast<char*>(storage);
+        _union.indirect_contents.capacity = n | BORROWED;
+        _size = n + N + 1;
+    }
+
+    //! Whether the elements are in storage given to borrow_uninitialized
+    bool is_borrowed() const { return !is_direct() && !owns_indirect(); }
+
     iterator erase(iterator pos) {
         return erase(pos, pos + 1);
     }
@@ -420,7 +443,7 @@ public:
     }
 
     ~prevector() {
-        if (!is_direct()) {
+        if (owns_indirect()) {
             free(_union.indirect_contents.indirect);
             _union.indirect_contents.indirect = nullptr;
         }
@@ -470,7 +493,7 @@ public:
         if (is_direct()) {
             return 0;
         } else {
-            return ((size_t)(sizeof(T))) * _union.indirect_contents.capacity;
+            return ((size_t)(sizeof(T))) * capacity();
         }
     }
 
@@ -0,0 +1,229 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <primitives/block_view.h>
+
+#include <consensus/consensus.h>
+#include <crypto/sha256.h>
+#include <hash.h>
+#include <serialize.h>
+#include <span.h>
+#include <streams.h>
+
+#include <algorithm>
+#include <ios>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+
+//! Serialized size of a transaction without inputs and outputs
+constexpr size_t MIN_TX_SIZE{4 + 1 + 1 + 4};
+
+void Skip(SpanReader& reader, uint64_t n)
+{
+    if (n > reader.size()) throw std::ios_base::failure("BlockView: end of data");
+    reader.ignore(n);
+}
+
+void SkipInput(SpanReader& reader)
+{
+    Skip(reader, 32 + 4);
+    Skip(reader, ReadCompactSize(reader));
+    Skip(reader, 4);
+}
+
+void SkipOutput(SpanReader& reader)
+{
+    Skip(reader, 8);
+    Skip(reader, ReadCompactSize(reader));
+}
+
+//! Skip the witness stack of an input, and return whether it is empty
+bool SkipWitness(SpanReader& reader)
+{
+    const uint64_t items{ReadCompactSize(reader)};
+    for (uint64_t i{0}; i < items; ++i) Skip(reader, ReadCompactSize(reader));
+    return items == 0;
+}
+
+} // namespace
+
+BlockView::BlockView(std::span<const std::byte> block) : m_block{block}
+{
+    if (block.size() > std::numeric_limits<uint32_t>::max()) throw std::ios_base::failure("BlockView: block too large");
+    SpanReader reader{block};
+    const auto pos{[&] { return uint32_t(block.size() - reader.size()); }};
+    reader >> m_header;
+    const uint64_t tx_count{ReadCompactSize(reader)};
+    // Don't let a bogus count reserve more than the block could hold
+    m_txs.reserve(std::min<uint64_t>(tx_count, reader.size() / MIN_TX_SIZE));
+    for (uint64_t t{0}; t < tx_count; ++t) {
+        // As in UnserializeTransaction, with witnesses allowed
+        TxLayout& tx{m_txs.emplace_back()};
+        tx.begin = pos();
+        Skip(reader, 4);
+        tx.inputs = pos();
+        uint64_t inputs{ReadCompactSize(reader)};
+        uint8_t flags{0};
+        if (inputs == 0) {
+            // An empty input vector, or the marker of a witness transaction.
+            // Without the flag, the transaction has no outputs either, and the
+            // flag is read as the empty output vector.
+            tx.outputs = pos();
+            reader >> flags;
+            if (flags != 0) {
+                tx.inputs = pos();
+                inputs = ReadCompactSize(reader);
+                for (uint64_t i{0}; i < inputs; ++i) SkipInput(reader);
+                tx.outputs = pos();
+                const uint64_t outputs{ReadCompactSize(reader)};
+                for (uint64_t i{0}; i < outputs; ++i) SkipOutput(reader);
+            }
+        } else {
+            for (uint64_t i{0}; i < inputs; ++i) SkipInput(reader);
+            tx.outputs = pos();
+            const uint64_t outputs{ReadCompactSize(reader)};
+            for (uint64_t i{0}; i < outputs; ++i) SkipOutput(reader);
+        }
+        tx.witnesses = pos();
+        if (flags & 1) {
+            flags ^= 1;
+            bool all_empty{true};
+            for (uint64_t i{0}; i < inputs; ++i) all_empty &= SkipWitness(reader);
+            if (all_empty) throw std::ios_base::failure("Superfluous witness record");
+        }
+        if (flags) throw std::ios_base::failure("Unknown transaction optional data");
+        Skip(reader, 4);
+        tx.end = pos();
+    }
+}
+
+std::span<const std::byte> BlockView::TxBytes(size_t i) const
+{
+    const TxLayout& tx{m_txs.at(i)};
+    return m_block.subspan(tx.begin, tx.end - tx.begin);
+}
+
+uint32_t BlockView::TxOffset(size_t i) const
+{
+    return m_txs.at(i).begin - uint32_t(::GetSerializeSize(m_header));
+}
+
+std::array<std::span<const std::byte>, 3> BlockView::StrippedTx(size_t i) const
+{
+    const TxLayout& tx{m_txs.at(i)};
+    if (!tx.HasWitness()) return {TxBytes(i), {}, {}};
+    return {
+        m_block.subspan(tx.begin, 4),
+        m_block.subspan(tx.inputs, tx.witnesses - tx.inputs),
+        m_block.subspan(tx.end - 4, 4),
+    };
+}
+
+Txid BlockView::GetTxid(size_t i) const
+{
+    HashWriter hasher{};
+    for (const auto piece : StrippedTx(i)) hasher.write(piece);
+    return Txid::FromUint256(hasher.GetHash());
+}
+
+Wtxid BlockView::GetWtxid(size_t i) const
+{
+    return Wtxid::FromUint256(Hash(TxBytes(i)));
+}
+
+std::vector<uint256> BlockView::HashTxs(bool stripped) const
+{
+    std::vector<std::array<std::span<const unsigned char>, 3>> pieces(m_txs.size());
+    std::vector<SHA256Message> messages(m_txs.size());
+    for (size_t i{0}; i < m_txs.size(); ++i) {
+        if (stripped) {
+            std::ranges::transform(StrippedTx(i), pieces[i].begin(), [](auto piece) { return UCharSpanCast(piece); });
+            messages[i] = pieces[i];
+        } else {
+            pieces[i][0] = UCharSpanCast(TxBytes(i));
+            messages[i] = std::span{pieces[i]}.first(1);
+        }
+    }
+    std::vector<uint256> hashes(m_txs.size());
+    static_assert(sizeof(uint256) == CSHA256::OUTPUT_SIZE);
+    SHA256DMulti(reinterpret_cast<unsigned char*>(hashes.data()), messages);
+    return hashes;
+}
+
+std::vector<Txid> BlockView::GetTxids() const
+{
+    std::vector<Txid> txids;
+    txids.reserve(m_txs.size());
+    for (const uint256& hash : HashTxs(/*stripped=*/true)) txids.push_back(Txid::FromUint256(hash));
+    return txids;
+}
+
+std::vector<Wtxid> BlockView::GetWtxids() const
+{
+    std::vector<Wtxid> wtxids;
+    wtxids.reserve(m_txs.size());
+    for (const uint256& hash : HashTxs(/*stripped=*/false)) wtxids.push_back(Wtxid::FromUint256(hash));
+    return wtxids;
+}
+
+uint32_t BlockView::InputCount(size_t i) const
+{
+    SpanReader reader{m_block.subspan(m_txs.at(i).inputs)};
+    return uint32_t(ReadCompactSize(reader));
+}
+
+uint32_t BlockView::OutputCount(size_t i) const
+{
+    SpanReader reader{m_block.subspan(m_txs.at(i).outputs)};
+    return uint32_t(ReadCompactSize(reader));
+}
+
+CTxIn BlockView::GetInput(size_t i, uint32_t n) const
+{
+    SpanReader reader{m_block.subspan(m_txs.at(i).inputs)};
+    if (n >= ReadCompactSize(reader)) throw std::out_of_range("BlockView: no such input");
+    for (uint32_t skipped{0}; skipped < n; ++skipped) SkipInput(reader);
+    CTxIn input;
+    reader >> input;
+    return input;
+}
+
+CTxOut BlockView::GetOutput(size_t i, uint32_t n) const
+{
+    SpanReader reader{m_block.subspan(m_txs.at(i).outputs)};
+    if (n >= ReadCompactSize(reader)) throw std::out_of_range("BlockView: no such output");
+    for (uint32_t skipped{0}; skipped < n; ++skipped) SkipOutput(reader);
+    CTxOut output;
+    reader >> output;
+    return output;
+}
+
+CTransactionRef BlockView::GetTransaction(size_t i) const
+{
+    CTransactionRef tx;
+    SpanReader{TxBytes(i)} >> TX_WITH_WITNESS(tx);
+    return tx;
+}
+
+size_t BlockView::Size() const
+{
+    return m_txs.empty() ? ::GetSerializeSize(m_header) + GetSizeOfCompactSize(0) : m_txs.back().end;
+}
+
+size_t BlockView::StrippedSize() const
+{
+    size_t size{Size()};
+    for (const TxLayout& tx : m_txs) {
+        // The marker, flag and witnesses
+        if (tx.HasWitness()) size -= (tx.inputs - tx.begin - 4) + (tx.end - 4 - tx.witnesses);
+    }
+    return size;
+}
+
+int64_t BlockView::Weight() const
+{
+    return int64_t(StrippedSize()) * (WITNESS_SCALE_FACTOR - 1) + int64_t(Size());
+}
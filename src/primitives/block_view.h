@@ -0,0 +1,96 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef HYLIUM_PRIMITIVES_BLOCK_VIEW_H
+#define HYLIUM_PRIMITIVES_BLOCK_VIEW_H
+
+#include <attributes.h>
+#include <primitives/block.h>
+#include <primitives/transaction.h>
+#include <primitives/transaction_identifier.h>
+#include <uint256.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/**
+ * A read-only view of a serialized block (with witnesses), for callers that
+ * only need its header, txids or a few of its transactions or outputs, like
+ * indexes and REST. Unlike deserializing a CBlock, it allocates nothing per
+ * transaction: the block is walked once on construction, to find where each
+ * transaction and its parts are, and the rest is decoded from the bytes when
+ * asked for.
+ *
+ * The view doesn't own the bytes, which must outlive it. Construction throws
+ * std::ios_base::failure for what deserializing a CBlock would throw for, so a
+ * view of a block is valid iff the CBlock is.
+ */
+class BlockView
+{
+public:
+    //! Offsets of a transaction and its parts in the block
+    struct TxLayout {
+        uint32_t begin;
+        //! The input count, after the marker and flag of a witness transaction
+        uint32_t inputs;
+        //! The output count
+        uint32_t outputs;
+        //! The witnesses, or the lock time of a transaction without any
+        uint32_t witnesses;
+        uint32_t end;
+
+        bool HasWitness() const { return inputs != begin + 4; }
+    };
+
+private:
+    std::span<const std::byte> m_block;
+    CBlockHeader m_header;
+    std::vector<TxLayout> m_txs;
+
+    //! Serialization of transaction i without its witnesses, in pieces
+    std::array<std::span<const std::byte>, 3> StrippedTx(size_t i) const;
+    //! Double-SHA256 of each transaction, with or without witnesses, hashed
+    //! several at a time (see SHA256DMulti)
+    std::vector<uint256> HashTxs(bool stripped) const;
+
+public:
+    explicit BlockView(std::span<const std::byte> block LIFETIMEBOUND);
+
+    const CBlockHeader& Header() const { return m_header; }
+    uint256 GetHash() const { return m_header.GetHash(); }
+
+    size_t TxCount() const { return m_txs.size(); }
+    const TxLayout& Layout(size_t i) const { return m_txs.at(i); }
+    //! Serialization of transaction i, with its witnesses
+    std::span<const std::byte> TxBytes(size_t i) const;
+    //! Offset of transaction i from the end of the header, as in CDiskTxPos
+    uint32_t TxOffset(size_t i) const;
+
+    Txid GetTxid(size_t i) const;
+    Wtxid GetWtxid(size_t i) const;
+    //! All txids or wtxids, faster than one at a time
+    std::vector<Txid> GetTxids() const;
+    std::vector<Wtxid> GetWtxids() const;
+
+    //! Decode an input (without its witness) or output of transaction i.
+    //! Throws std::out_of_range if it has no such input or output.
+    CTxIn GetInput(size_t i, uint32_t n) const;
+    CTxOut GetOutput(size_t i, uint32_t n) const;
+    uint32_t InputCount(size_t i) const;
+    uint32_t OutputCount(size_t i) const;
+
+    //! Decode transaction i
+    CTransactionRef GetTransaction(size_t i) const;
+
+    //! Serialized size of the block with and without witnesses, and its weight,
+    //! as in GetSerializeSize and GetBlockWeight for the CBlock
+    size_t Size() const;
+    size_t StrippedSize() const;
+    int64_t Weight() const;
+};
+
+#endif // HYLIUM_PRIMITIVES_BLOCK_VIEW_H
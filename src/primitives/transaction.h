@@ -11,14 +11,17 @@
 #include <primitives/transaction_identifier.h> // IWYU pragma: export
 #include <script/script.h>
 #include <serialize.h>
+#include <support/allocators/chunk_arena.h>
 #include <uint256.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <ios>
 #include <limits>
 #include <memory>
 #include <numeric>
+#include <span>
 #include <string>
 #include <tuple>
 #include <utility>
@@ -175,11 +178,69 @@ struct CMutableTransaction;
 
 struct TransactionSerParams {
     const bool allow_witness;
+    //! Deserialize each CTransactionRef, with its scripts, in this arena (see
+    //! ChunkArena), which spares most of the allocations of deserializing a
+    //! block. Its chunks stay allocated while their transactions are.
+    ChunkArena* const arena{nullptr};
     SER_PARAMS_OPFUNC
 };
 static constexpr TransactionSerParams TX_WITH_WITNESS{.allow_witness = true};
 static constexpr TransactionSerParams TX_NO_WITNESS{.allow_witness = false};
 
+//! Size of the chunks of an arena for the transactions of a block
+static constexpr size_t TX_ARENA_CHUNK_SIZE{32 << 10};
+//! A transaction starts a new chunk of the arena if less than this is left
+static constexpr size_t TX_ARENA_MIN_FREE{1 << 10};
+
+/** Read a script, into arena if it doesn't fit in the CScript and the arena has room */
+template <typename Stream>
+void UnserializeScript(Stream& s, CScript& script, ChunkArena& arena)
+{
+    const unsigned int size = ReadCompactSize(s);
+    if (void* storage{size > CScriptBase::STATIC_SIZE ? arena.Allocate(size, 1) : nullptr}) {
+        script.borrow_uninitialized(static_cast<unsigned char*>(storage), size);
+        s.read(std::as_writable_bytes(std::span{script.data(), size}));
+        return;
+    }
+    // As the deserialization of a prevector, limiting the size per read so a bogus size won't cause out of memory
+    script.clear();
+    for (unsigned int i = 0; i < size;) {
+        const unsigned int blk = std::min(size - i, 5000000U);
+        script.resize_uninitialized(i + blk);
+        s.read(std::as_writable_bytes(std::span{&script[i], blk}));
+        i += blk;
+    }
+}
+
+template <typename Stream>
+void UnserializeInArena(Stream& s, CTxIn& txin, ChunkArena& arena)
+{
+    s >> txin.prevout;
+    UnserializeScript(s, txin.scriptSig, arena);
+    s >> txin.nSequence;
+}
+
+template <typename Stream>
+void UnserializeInArena(Stream& s, CTxOut& txout, ChunkArena& arena)
+{
+    s >> txout.nValue;
+    UnserializeScript(s, txout.scriptPubKey, arena);
+}
+
+/** Read the inputs or outputs of a transaction, as VectorFormatter does, with their scripts in arena */
+template <typename Stream, typename T>
+void UnserializeInArena(Stream& s, std::vector<T>& v, ChunkArena& arena)
+{
+    v.clear();
+    const size_t size{ReadCompactSize(s)};
+    size_t allocated{0};
+    while (allocated < size) {
+        allocated = std::min(size, allocated + MAX_VECTOR_ALLOCATE / sizeof(T));
+        v.reserve(allocated);
+        while (v.size() < allocated) UnserializeInArena(s, v.emplace_back(), arena);
+    }
+}
+
 /**
  * Basic transaction serialization format:
  * - uint32_t version
@@ -198,26 +259,27 @@ static constexpr TransactionSerParams TX_NO_WITNESS{.allow_witness = false};
  * - uint32_t nLockTime
  */
 template<typename Stream, typename TxType>
-void UnserializeTransaction(TxType& tx, Stream& s, const TransactionSerParams& params)
+void UnserializeTransaction(TxType& tx, Stream& s, const TransactionSerParams& params, ChunkArena* arena = nullptr)
 {
     const bool fAllowWitness = params.allow_witness;
+    const auto read{[&](auto& v) { if (arena) UnserializeInArena(s, v, *arena); else s >> v; }};
 
     s >> tx.version;
     unsigned char flags = 0;
     tx.vin.clear();
     tx.vout.clear();
     /* Try to read the vin. In case the dummy is there, this will be read as an empty vector. */
-    s >> tx.vin;
+    read(tx.vin);
     if (tx.vin.size() == 0 && fAllowWitness) {
         /* We read a dummy or an empty vin. */
         s >> flags;
         if (flags != 0) {
-            s >> tx.vin;
-            s >> tx.vout;
+            read(tx.vin);
+            read(tx.vout);
         }
     } else {
         /* We read a non-empty vin. Assume a normal vout follows. */
-        s >> tx.vout;
+        read(tx.vout);
     }
     if ((flags & 1) && fAllowWitness) {
         /* The witness flag is present, and we support witnesses. */
@@ -296,6 +358,8 @@ public:
 private:
     /** Memory only. */
     const bool m_has_witness;
+    //! Whether scripts may be borrowed from the arena of a block (see ChunkArena)
+    const bool m_in_arena;
     const Txid hash;
     const Wtxid m_witness_hash;
 
@@ -304,6 +368,8 @@ private:
 
     bool ComputeHasWitness() const;
 
+    CTransaction(CMutableTransaction&& tx, bool in_arena);
+
 public:
     /** Convert a CMutableTransaction into a CTransaction. */
     explicit CTransaction(const CMutableTransaction& tx);
@@ -320,6 +386,9 @@ public:
     CTransaction(deserialize_type, const TransactionSerParams& params, Stream& s) : CTransaction(CMutableTransaction(deserialize, params, s)) {}
     template <typename Stream>
     CTransaction(deserialize_type, Stream& s) : CTransaction(CMutableTransaction(deserialize, s)) {}
+    //! Deserialize with the scripts in arena, for a CTransactionRef created in it
+    template <typename Stream>
+    CTransaction(deserialize_type, ChunkArena& arena, Stream& s) : CTransaction(CMutableTransaction(deserialize, arena, s), /*in_arena=*/true) {}
 
     bool IsNull() const {
         return vin.empty() && vout.empty();
@@ -351,6 +420,7 @@ public:
     std::string ToString() const;
 
     bool HasWitness() const { return m_has_witness; }
+    bool IsInArena() const { return m_in_arena; }
 };
 
 /** A mutable version of CTransaction. */
@@ -384,6 +454,11 @@ struct CMutableTransaction
         Unserialize(s);
     }
 
+    template <typename Stream>
+    CMutableTransaction(deserialize_type, ChunkArena& arena, Stream& s) {
+        UnserializeTransaction(*this, s, s.template GetParams<TransactionSerParams>(), &arena);
+    }
+
     /** Compute the hash of this CMutableTransaction. This is computed on the
      * fly, as opposed to GetHash() in CTransaction, which uses a cached result.
      */
@@ -403,4 +478,24 @@ struct CMutableTransaction
 typedef std::shared_ptr<const CTransaction> CTransactionRef;
 template <typename Tx> static inline CTransactionRef MakeTransactionRef(Tx&& txIn) { return std::make_shared<const CTransaction>(std::forward<Tx>(txIn)); }
 
+/** Return tx, or a copy of it owning its scripts if it is in the arena of a
+ *  block, for keeping it after the block without pinning an arena chunk. */
+inline CTransactionRef DetachFromArena(CTransactionRef tx)
+{
+    if (!tx || !tx->IsInArena()) return tx;
+    return MakeTransactionRef(CMutableTransaction{*tx});
+}
+
+/** Deserialize a transaction, in the arena of the serialization parameters if they have one */
+template <typename Stream>
+void Unserialize(Stream& s, CTransactionRef& tx)
+{
+    ChunkArena* const arena{s.template GetParams<TransactionSerParams>().arena};
+    if (!arena) {
+        tx = std::make_shared<const CTransaction>(deserialize, s);
+        return;
+    }
+    tx = std::allocate_shared<const CTransaction>(arena->StartObject<CTransaction>(TX_ARENA_MIN_FREE), deserialize, *arena, s);
+}
+
 #endif // HYLIUM_PRIMITIVES_TRANSACTION_H
@@ -10,12 +10,14 @@
 #include <chainparams.h>
 #include <core_io.h>
 #include <flatfile.h>
+#include <logging.h>
 #include <httpserver.h>
 #include <index/blockfilterindex.h>
 #include <index/txindex.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <primitives/block.h>
+#include <primitives/block_view.h>
 #include <primitives/transaction.h>
 #include <rpc/blockchain.h>
 #include <rpc/mempool.h>
@@ -32,6 +34,10 @@
 #include <validation.h>
 
 #include <any>
+#include <ios>
+#include <memory>
+#include <span>
+#include <utility>
 #include <vector>
 
 #include <univalue.h>
@@ -42,6 +48,9 @@ using util::SplitString;
 
 static const size_t MAX_GETUTXOS_OUTPOINTS = 15; //allow a max of 15 outpoints to be queried at once
 static constexpr unsigned int MAX_REST_HEADERS_RESULTS = 2000;
+static constexpr unsigned int MAX_REST_BLOCKS_RESULTS = 1000;
+//! Size of the chunks of streamed replies (/rest/blocks/ and /rest/utxoset)
+static constexpr size_t REST_REPLY_CHUNK_SIZE{1 << 20};
 
 static const struct {
     RESTResponseFormat rf;
@@ -74,6 +83,46 @@ static bool RESTERR(HTTPRequest* req, enum HTTPStatusCode status, std::string me
     return false;
 }
 
+/**
+ * Stream of serialized data written to a chunked reply, in chunks of about
+ * REST_REPLY_CHUNK_SIZE bytes, in hex if requested.
+ */
+class ChunkedReplyStream
+{
+    HTTPRequest& m_req;
+    const bool m_hex;
+    DataStream m_buffer;
+    bool m_open{true};
+
+public:
+    ChunkedReplyStream(HTTPRequest& req, bool hex) : m_req{req}, m_hex{hex} {}
+
+    void write(std::span<const std::byte> src)
+    {
+        m_buffer.write(src);
+        if (m_buffer.size() >= REST_REPLY_CHUNK_SIZE) Flush();
+    }
+
+    template <typename T>
+    ChunkedReplyStream& operator<<(const T& obj)
+    {
+        ::Serialize(*this, obj);
+        return *this;
+    }
+
+    /** Write out the buffered data */
+    void Flush()
+    {
+        if (m_open && !m_buffer.empty()) {
+            m_open = m_hex ? m_req.WriteReplyChunk(HexStr(m_buffer)) : m_req.WriteReplyChunk(m_buffer);
+        }
+        m_buffer.clear();
+    }
+
+    /** Whether the client is still connected, so that there is a point in writing more */
+    bool IsOpen() const { return m_open; }
+};
+
 /**
  * Get the node context.
  *
@@ -275,7 +324,8 @@ static bool rest_headers(const std::any& context,
 /**
  * Serialize spent outputs as a list of per-transaction CTxOut lists using binary format.
  */
-static void SerializeBlockUndo(DataStream& stream, const CBlockUndo& block_undo)
+template <typename Stream>
+static void SerializeBlockUndo(Stream& stream, const CBlockUndo& block_undo)
 {
     WriteCompactSize(stream, block_undo.vtxundo.size() + 1);
     WriteCompactSize(stream, 0); // block_undo.vtxundo doesn't contain coinbase tx
@@ -449,6 +499,14 @@ static bool rest_block(const std::any& context,
     }
 
     case RESTResponseFormat::JSON: {
+        if (tx_verbosity == TxVerbosity::SHOW_TXID) {
+            // Only the txids are needed, so the transactions aren't deserialized.
+            UniValue objBlock = blockToJSON(BlockView{*block_data}, *tip, *pblockindex, chainman.GetConsensus().powLimit);
+            std::string strJSON = objBlock.write() + "\n";
+            req->WriteHeader("Content-Type", "application/json");
+            req->WriteReply(HTTP_OK, strJSON);
+            return true;
+        }
         if (tx_verbosity) {
             CBlock block{};
             DataStream block_stream{*block_data};
@@ -497,6 +555,145 @@ static bool rest_block_part(const std::any& context, HTTPRequest* req, const std
     }
 }
 
+/**
+ * Stream consecutive blocks of the active chain, from block files, each
+ * followed by its spent outputs (like /rest/spenttxouts/) if undo=true.
+ */
+static bool rest_blocks(const std::any& context, HTTPRequest* req, const std::string& uri_part)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string hashStr;
+    const RESTResponseFormat rf = ParseDataFormat(hashStr, uri_part);
+    if (rf != RESTResponseFormat::BINARY && rf != RESTResponseFormat::HEX) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: .bin, .hex)");
+    }
+
+    std::string raw_count;
+    std::string raw_undo;
+    try {
+        raw_count = req->GetQueryParameter("count").value_or("");
+        raw_undo = req->GetQueryParameter("undo").value_or("false");
+    } catch (const std::runtime_error& e) {
+        return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+    }
+    const auto count{ToIntegral<size_t>(raw_count)};
+    if (!count || *count < 1 || *count > MAX_REST_BLOCKS_RESULTS) {
+        return RESTERR(req, HTTP_BAD_REQUEST, strprintf("Block count is invalid or out of acceptable range (1-%u): %s", MAX_REST_BLOCKS_RESULTS, raw_count));
+    }
+    if (raw_undo != "true" && raw_undo != "false") {
+        return RESTERR(req, HTTP_BAD_REQUEST, "The \"undo\" query parameter must be either \"true\" or \"false\".");
+    }
+    const bool with_undo{raw_undo == "true"};
+
+    auto hash{uint256::FromHex(hashStr)};
+    if (!hash) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid hash: " + hashStr);
+    }
+
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    ChainstateManager& chainman = *maybe_chainman;
+    std::vector<std::pair<const CBlockIndex*, FlatFilePos>> blocks;
+    {
+        LOCK(cs_main);
+        const CChain& active_chain = chainman.ActiveChain();
+        const CBlockIndex* pindex{chainman.m_blockman.LookupBlockIndex(*hash)};
+        if (!pindex || !active_chain.Contains(pindex)) {
+            return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found in the active chain");
+        }
+        for (; pindex && blocks.size() < *count; pindex = active_chain.Next(pindex)) {
+            const bool missing_undo{with_undo && pindex->nHeight > 0 && !(pindex->nStatus & BLOCK_HAVE_UNDO)};
+            if (!(pindex->nStatus & BLOCK_HAVE_DATA) || missing_undo) {
+                if (chainman.m_blockman.IsBlockPruned(*pindex)) {
+                    return RESTERR(req, HTTP_NOT_FOUND, pindex->GetBlockHash().ToString() + " not available (pruned data)");
+                }
+                return RESTERR(req, HTTP_NOT_FOUND, pindex->GetBlockHash().ToString() + " not available (not fully downloaded)");
+            }
+            blocks.emplace_back(pindex, pindex->GetBlockPos());
+        }
+    }
+
+    req->WriteHeader("Content-Type", rf == RESTResponseFormat::BINARY ? "application/octet-stream" : "text/plain");
+    req->StartChunkedReply(HTTP_OK);
+    ChunkedReplyStream stream{*req, /*hex=*/rf == RESTResponseFormat::HEX};
+    for (const auto& [pindex, pos] : blocks) {
+        const auto block_data{chainman.m_blockman.ReadRawBlock(pos)};
+        CBlockUndo block_undo;
+        if (!block_data || (with_undo && pindex->nHeight > 0 && !chainman.m_blockman.ReadBlockUndo(block_undo, *pindex))) {
+            // The reply has started, so it can only be cut short, without
+            // ending the body, so the client can tell it is incomplete.
+            LogWarning("REST: cutting /rest/blocks/ reply short, block %s could not be read", pindex->GetBlockHash().ToString());
+            req->AbortChunkedReply();
+            return true;
+        }
+        stream.write(*block_data);
+        if (with_undo) SerializeBlockUndo(stream, block_undo);
+        if (!stream.IsOpen()) break;
+    }
+    stream.Flush();
+    if (rf == RESTResponseFormat::HEX && stream.IsOpen()) req->WriteReplyChunk("\n");
+    req->EndChunkedReply();
+    return true;
+}
+
+/**
+ * Stream the UTXO set from a snapshot of the coins database: the hash and
+ * height of its best block, followed by the coins like in the body of a UTXO
+ * snapshot (see dumptxoutset). The coins cache is not flushed for this, so the
+ * best block is the tip as of the last flush, which may be behind the tip.
+ */
+static bool rest_utxoset(const std::any& context, HTTPRequest* req, const std::string& uri_part)
+{
+    if (!CheckWarmup(req))
+        return false;
+    std::string param;
+    const RESTResponseFormat rf = ParseDataFormat(param, uri_part);
+    if (!param.empty()) {
+        return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/utxoset.<bin|hex>");
+    }
+    if (rf != RESTResponseFormat::BINARY && rf != RESTResponseFormat::HEX) {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: .bin, .hex)");
+    }
+
+    ChainstateManager* maybe_chainman = GetChainman(context, req);
+    if (!maybe_chainman) return false;
+    std::unique_ptr<CCoinsViewCursor> cursor;
+    const CBlockIndex* tip{nullptr};
+    {
+        LOCK(cs_main);
+        Chainstate& chainstate = maybe_chainman->ActiveChainstate();
+        // The cursor iterates over a snapshot of the database, unaffected by
+        // later flushes.
+        cursor = chainstate.CoinsDB().Cursor();
+        if (cursor) tip = chainstate.m_blockman.LookupBlockIndex(cursor->GetBestBlock());
+    }
+    if (!cursor || !tip) {
+        return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, "Unable to read UTXO set");
+    }
+
+    req->WriteHeader("Content-Type", rf == RESTResponseFormat::BINARY ? "application/octet-stream" : "text/plain");
+    req->StartChunkedReply(HTTP_OK);
+    ChunkedReplyStream stream{*req, /*hex=*/rf == RESTResponseFormat::HEX};
+    stream << tip->GetBlockHash();
+    ser_writedata32(stream, tip->nHeight);
+    try {
+        WriteUTXOSetCoins(stream, *cursor, [&] {
+            if (!stream.IsOpen() || !IsRPCRunning()) throw std::ios_base::failure("reply interrupted");
+        });
+    } catch (const std::exception& e) {
+        // The reply has started, so it can only be cut short, without ending
+        // the body, so the client can tell it is incomplete.
+        LogDebug(BCLog::HTTP, "REST: cutting /rest/utxoset reply short: %s", e.what());
+        req->AbortChunkedReply();
+        return true;
+    }
+    stream.Flush();
+    if (rf == RESTResponseFormat::HEX && stream.IsOpen()) req->WriteReplyChunk("\n");
+    req->EndChunkedReply();
+    return true;
+}
+
 static bool rest_filter_header(const std::any& context, HTTPRequest* req, const std::string& uri_part)
 {
     if (!CheckWarmup(req)) return false;
@@ -779,6 +976,73 @@ static bool rest_deploymentinfo(const std::any& context, HTTPRequest* req, const
 
 }
 
+// Dependencies on functions defined in rpc/blockchain.cpp
+RPCHelpMan getscripthistory();
+RPCHelpMan getscriptunspent();
+
+/** Serve a paged script hash index lookup, forwarding the "count" and "cursor" query parameters to the RPC. */
+static bool rest_script_index(const std::any& context, HTTPRequest* req, const std::string& uri_part, RPCHelpMan (*rpc)())
+{
+    if (!CheckWarmup(req)) return false;
+
+    std::string script_str;
+    const RESTResponseFormat rf = ParseDataFormat(script_str, uri_part);
+
+    switch (rf) {
+    case RESTResponseFormat::JSON: {
+        if (script_str.empty()) {
+            return RESTERR(req, HTTP_BAD_REQUEST, "Invalid URI format. Expected /rest/<scripthistory|scriptunspent>/<address|hexscript>.json");
+        }
+        JSONRPCRequest jsonRequest;
+        jsonRequest.context = context;
+        jsonRequest.params = UniValue(UniValue::VARR);
+        jsonRequest.params.push_back(script_str);
+        std::optional<std::string> raw_count, cursor;
+        try {
+            raw_count = req->GetQueryParameter("count");
+            cursor = req->GetQueryParameter("cursor");
+        } catch (const std::runtime_error& e) {
+            return RESTERR(req, HTTP_BAD_REQUEST, e.what());
+        }
+        if (raw_count) {
+            const auto count{ToIntegral<int>(*raw_count)};
+            if (!count) return RESTERR(req, HTTP_BAD_REQUEST, "Invalid count: " + *raw_count);
+            jsonRequest.params.push_back(*count);
+        } else {
+            jsonRequest.params.push_back(UniValue{});
+        }
+        if (cursor) jsonRequest.params.push_back(*cursor);
+
+        UniValue result;
+        try {
+            result = rpc().HandleRequest(jsonRequest);
+        } catch (const UniValue& error) {
+            const int code{error.find_value("code").getInt<int>()};
+            const HTTPStatusCode status{code == RPC_MISC_ERROR || code == RPC_INTERNAL_ERROR ? HTTP_SERVICE_UNAVAILABLE : HTTP_BAD_REQUEST};
+            return RESTERR(req, status, error.find_value("message").get_str());
+        } catch (const std::exception& e) {
+            return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR, e.what());
+        }
+        req->WriteHeader("Content-Type", "application/json");
+        req->WriteReply(HTTP_OK, result.write() + "\n");
+        return true;
+    }
+    default: {
+        return RESTERR(req, HTTP_NOT_FOUND, "output format not found (available: json)");
+    }
+    }
+}
+
+static bool rest_script_history(const std::any& context, HTTPRequest* req, const std::string& uri_part)
+{
+    return rest_script_index(context, req, uri_part, getscripthistory);
+}
+
+static bool rest_script_unspent(const std::any& context, HTTPRequest* req, const std::string& uri_part)
+{
+    return rest_script_index(context, req, uri_part, getscriptunspent);
+}
+
 static bool rest_mempool(const std::any& context, HTTPRequest* req, const std::string& str_uri_part)
 {
     if (!CheckWarmup(req))
@@ -1146,16 +1410,20 @@ static const struct {
       {"/rest/block/notxdetails/", rest_block_notxdetails},
       {"/rest/block/", rest_block_extended},
       {"/rest/blockpart/", rest_block_part},
+      {"/rest/blocks/", rest_blocks},
       {"/rest/blockfilter/", rest_block_filter},
       {"/rest/blockfilterheaders/", rest_filter_header},
       {"/rest/chaininfo", rest_chaininfo},
       {"/rest/mempool/", rest_mempool},
       {"/rest/headers/", rest_headers},
       {"/rest/getutxos", rest_getutxos},
+      {"/rest/utxoset", rest_utxoset},
       {"/rest/deploymentinfo/", rest_deploymentinfo},
       {"/rest/deploymentinfo", rest_deploymentinfo},
       {"/rest/blockhashbyheight/", rest_blockhash_by_height},
       {"/rest/spenttxouts/", rest_spent_txouts},
+      {"/rest/scripthistory/", rest_script_history},
+      {"/rest/scriptunspent/", rest_script_unspent},
 };
 
 void StartREST(const std::any& context)
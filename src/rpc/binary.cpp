@@ -0,0 +1,177 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <rpc/binary.h>
+
+#include <crypto/common.h>
+#include <serialize.h>
+#include <streams.h>
+
+#include <ios>
+#include <limits>
+#include <utility>
+
+/** Like the JSON parser, to bound the recursion */
+static constexpr size_t MAX_BINARY_DEPTH{512};
+
+void EncodeBinaryValue(DataStream& stream, const UniValue& value)
+{
+    switch (value.getType()) {
+    case UniValue::VNULL:
+        ser_writedata8(stream, uint8_t(BinaryValueTag::NUL));
+        break;
+    case UniValue::VBOOL:
+        ser_writedata8(stream, uint8_t(value.get_bool() ? BinaryValueTag::BOOL_TRUE : BinaryValueTag::BOOL_FALSE));
+        break;
+    case UniValue::VNUM:
+        ser_writedata8(stream, uint8_t(BinaryValueTag::NUMBER));
+        stream << value.getValStr();
+        break;
+    case UniValue::VSTR:
+        ser_writedata8(stream, uint8_t(BinaryValueTag::STRING));
+        stream << value.get_str();
+        break;
+    case UniValue::VARR:
+        ser_writedata8(stream, uint8_t(BinaryValueTag::ARRAY));
+        WriteCompactSize(stream, value.size());
+        for (const UniValue& item : value.getValues()) {
+            EncodeBinaryValue(stream, item);
+        }
+        break;
+    case UniValue::VOBJ:
+        ser_writedata8(stream, uint8_t(BinaryValueTag::OBJECT));
+        WriteCompactSize(stream, value.size());
+        for (size_t i{0}; i < value.size(); ++i) {
+            stream << value.getKeys()[i];
+            EncodeBinaryValue(stream, value.getValues()[i]);
+        }
+        break;
+    }
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+static UniValue ReadBinaryValue(SpanReader& stream, size_t depth)
+{
+    if (depth > MAX_BINARY_DEPTH) throw std::ios_base::failure("Binary value nested too deeply");
+    std::string str;
+    switch (BinaryValueTag(ser_readdata8(stream))) {
+    case BinaryValueTag::NUL:
+        return NullUniValue;
+    case BinaryValueTag::BOOL_FALSE:
+        return false;
+    case BinaryValueTag::BOOL_TRUE:
+        return true;
+    case BinaryValueTag::NUMBER: {
+        stream >> str;
+        // Numbers are checked like any JSON number.
+        UniValue number;
+        if (!number.read(str) || !number.isNum()) throw std::ios_base::failure("Invalid binary number");
+        return number;
+    }
+    case BinaryValueTag::STRING:
+        stream >> str;
+        return str;
+    case BinaryValueTag::ARRAY: {
+        UniValue array{UniValue::VARR};
+        // Not reserved, as the count is not checked against the data yet.
+        for (uint64_t count{ReadCompactSize(stream)}; count > 0; --count) {
+            array.push_back(ReadBinaryValue(stream, depth + 1));
+        }
+        return array;
+    }
+    case BinaryValueTag::OBJECT: {
+        UniValue object{UniValue::VOBJ};
+        for (uint64_t count{ReadCompactSize(stream)}; count > 0; --count) {
+            std::string key;
+            stream >> key;
+            object.pushKVEnd(std::move(key), ReadBinaryValue(stream, depth + 1));
+        }
+        return object;
+    }
+    } // no default case, so the compiler can warn about missing cases
+    throw std::ios_base::failure("Invalid binary value tag");
+}
+
+UniValue DecodeBinaryValue(std::span<const std::byte> data)
+{
+    SpanReader stream{data};
+    UniValue value{ReadBinaryValue(stream, 0)};
+    if (!stream.empty()) throw std::ios_base::failure("Trailing data after binary value");
+    return value;
+}
+
+/** Append a frame, whose payload is written by write_payload, and fill in its length after */
+template <typename F>
+static void WriteFrame(DataStream& body, F write_payload)
+{
+    const size_t start{body.size()};
+    ser_writedata32(body, 0);
+    write_payload();
+    const size_t length{body.size() - start - sizeof(uint32_t)};
+    if (length > std::numeric_limits<uint32_t>::max()) throw std::ios_base::failure("Binary RPC frame too large");
+    WriteLE32(UCharCast(&body[start]), length);
+}
+
+/** Split a body into the payloads of its frames */
+static std::vector<SpanReader> ReadFrames(std::span<const std::byte> body)
+{
+    std::vector<SpanReader> frames;
+    SpanReader stream{body};
+    while (!stream.empty()) {
+        const uint32_t length{ser_readdata32(stream)};
+        if (length > stream.size()) throw std::ios_base::failure("Truncated binary RPC frame");
+        frames.emplace_back(body.last(stream.size()).first(length));
+        stream.ignore(length);
+    }
+    return frames;
+}
+
+void WriteBinaryRPCRequest(DataStream& body, const BinaryRPCRequest& request)
+{
+    WriteFrame(body, [&] {
+        ser_writedata32(body, request.id);
+        body << request.method;
+        EncodeBinaryValue(body, request.params);
+    });
+}
+
+std::vector<BinaryRPCRequest> ReadBinaryRPCRequests(std::span<const std::byte> body)
+{
+    std::vector<BinaryRPCRequest> requests;
+    for (SpanReader& frame : ReadFrames(body)) {
+        BinaryRPCRequest& request{requests.emplace_back()};
+        request.id = ser_readdata32(frame);
+        frame >> request.method;
+        request.params = ReadBinaryValue(frame, 0);
+        if (!request.params.isArray() && !request.params.isObject()) {
+            throw std::ios_base::failure("Params must be an array or object");
+        }
+        if (!frame.empty()) throw std::ios_base::failure("Trailing data in binary RPC frame");
+    }
+    return requests;
+}
+
+void WriteBinaryRPCReply(DataStream& body, const BinaryRPCReply& reply)
+{
+    WriteFrame(body, [&] {
+        ser_writedata32(body, reply.id);
+        const bool failed{!reply.error.isNull()};
+        ser_writedata8(body, failed);
+        EncodeBinaryValue(body, failed ? reply.error : reply.result);
+    });
+}
+
+std::vector<BinaryRPCReply> ReadBinaryRPCReplies(std::span<const std::byte> body)
+{
+    std::vector<BinaryRPCReply> replies;
+    for (SpanReader& frame : ReadFrames(body)) {
+        BinaryRPCReply& reply{replies.emplace_back()};
+        reply.id = ser_readdata32(frame);
+        const uint8_t failed{ser_readdata8(frame)};
+        if (failed > 1) throw std::ios_base::failure("Invalid binary RPC reply status");
+        (failed ? reply.error : reply.result) = ReadBinaryValue(frame, 0);
+        if (!frame.empty()) throw std::ios_base::failure("Trailing data in binary RPC frame");
+    }
+    return replies;
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef HYLIUM_RPC_BINARY_H
+#define HYLIUM_RPC_BINARY_H
+
+#include <univalue.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+class DataStream;
+
+/**
+ * The binary RPC transport (-rpcbinary) carries the same calls as JSON-RPC, in
+ * a compact encoding, see doc/JSON-RPC-interface.md. A request or reply body
+ * is a sequence of frames, each a 4-byte little-endian length and a payload:
+ * - request: 4-byte id, method name, params (an array or object value)
+ * - reply: 4-byte id, 0 and the result or 1 and the error object
+ *
+ * Values are a tag byte followed by, for numbers and strings, their text and,
+ * for arrays and objects, the number of elements and the elements (key and
+ * value for objects). Text and counts are encoded like in the P2P protocol.
+ */
+enum class BinaryValueTag : uint8_t {
+    NUL = 0,
+    BOOL_FALSE = 1,
+    BOOL_TRUE = 2,
+    NUMBER = 3,
+    STRING = 4,
+    ARRAY = 5,
+    OBJECT = 6,
+};
+
+struct BinaryRPCRequest {
+    uint32_t id{0};
+    std::string method;
+    UniValue params{UniValue::VARR};
+};
+
+struct BinaryRPCReply {
+    uint32_t id{0};
+    //! Null if the call failed.
+    UniValue result;
+    //! The JSON-RPC error object if the call failed, null otherwise.
+    UniValue error;
+};
+
+/** Append a value in the compact encoding */
+void EncodeBinaryValue(DataStream& stream, const UniValue& value);
+/** Decode a whole value. Throws std::ios_base::failure if it is malformed. */
+UniValue DecodeBinaryValue(std::span<const std::byte> data);
+
+/** Append a frame to a request body */
+void WriteBinaryRPCRequest(DataStream& body, const BinaryRPCRequest& request);
+/** Decode the frames of a request body. Throws std::ios_base::failure if it is malformed. */
+std::vector<BinaryRPCRequest> ReadBinaryRPCRequests(std::span<const std::byte> body);
+
+/** Append a frame to a reply body */
+void WriteBinaryRPCReply(DataStream& body, const BinaryRPCReply& reply);
+/** Decode the frames of a reply body. Throws std::ios_base::failure if it is malformed. */
+std::vector<BinaryRPCReply> ReadBinaryRPCReplies(std::span<const std::byte> body);
+
+#endif // HYLIUM_RPC_BINARY_H
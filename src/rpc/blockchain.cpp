@@ -16,22 +16,27 @@
 #include <consensus/params.h>
 #include <consensus/validation.h>
 #include <core_io.h>
+#include <dbwrapper.h>
 #include <deploymentinfo.h>
 #include <deploymentstatus.h>
 #include <flatfile.h>
 #include <hash.h>
 #include <index/blockfilterindex.h>
 #include <index/coinstatsindex.h>
+#include <index/scripthashindex.h>
 #include <interfaces/mining.h>
+#include <key_io.h>
 #include <kernel/coinstats.h>
 #include <logging/timer.h>
 #include <net.h>
 #include <net_processing.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
+#include <node/kernel_notifications.h>
 #include <node/transaction.h>
 #include <node/utxo_snapshot.h>
 #include <node/warnings.h>
+#include <primitives/block_view.h>
 #include <primitives/transaction.h>
 #include <rpc/server.h>
 #include <rpc/server_util.h>
@@ -47,8 +52,10 @@
 #include <univalue.h>
 #include <util/check.h>
 #include <util/fs.h>
+#include <util/signalinterrupt.h>
 #include <util/strencodings.h>
 #include <util/syserror.h>
+#include <util/time.h>
 #include <util/translation.h>
 #include <validation.h>
 #include <validationinterface.h>
@@ -181,40 +188,78 @@ UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex
     return result;
 }
 
-UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit)
+/** Block header, sizes and weight to JSON, the description of a block without its transactions */
+static UniValue BlockSummaryToJSON(const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256 pow_limit)
 {
     UniValue result = blockheaderToJSON(tip, blockindex, pow_limit);
 
     result.pushKV("strippedsize", ::GetSerializeSize(TX_NO_WITNESS(block)));
     result.pushKV("size", ::GetSerializeSize(TX_WITH_WITNESS(block)));
     result.pushKV("weight", ::GetBlockWeight(block));
+    return result;
+}
+
+static UniValue BlockSummaryToJSON(const BlockView& block, const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256 pow_limit)
+{
+    UniValue result = blockheaderToJSON(tip, blockindex, pow_limit);
+
+    result.pushKV("strippedsize", block.StrippedSize());
+    result.pushKV("size", block.Size());
+    result.pushKV("weight", block.Weight());
+    return result;
+}
+
+/** The i-th transaction of a block to JSON */
+static UniValue BlockTxToJSON(const CBlock& block, size_t i, const CBlockUndo* block_undo, TxVerbosity verbosity)
+{
+    const CTransactionRef& tx = block.vtx.at(i);
+    if (verbosity == TxVerbosity::SHOW_TXID) return tx->GetHash().GetHex();
+    // coinbase transaction (i.e. i == 0) doesn't have undo data
+    const CTxUndo* txundo = (block_undo && i > 0) ? &block_undo->vtxundo.at(i - 1) : nullptr;
+    UniValue objTx(UniValue::VOBJ);
+    TxToUniv(*tx, /*block_hash=*/uint256(), /*entry=*/objTx, /*include_hex=*/true, txundo, verbosity);
+    return objTx;
+}
+
+std::optional<CBlockUndo> ReadBlockUndoForJSON(BlockManager& blockman, const CBlockIndex& blockindex)
+{
+    const bool is_not_pruned{WITH_LOCK(::cs_main, return !blockman.IsBlockPruned(blockindex))};
+    bool have_undo{is_not_pruned && WITH_LOCK(::cs_main, return blockindex.nStatus & BLOCK_HAVE_UNDO)};
+    if (!have_undo) return std::nullopt;
+    CBlockUndo blockUndo;
+    if (!blockman.ReadBlockUndo(blockUndo, blockindex)) {
+        throw JSONRPCError(RPC_INTERNAL_ERROR, "Undo data expected but can't be read. This could be due to disk corruption or a conflict with a pruning event.");
+    }
+    return blockUndo;
+}
+
+UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit)
+{
+    UniValue result = BlockSummaryToJSON(block, tip, blockindex, pow_limit);
+
+    std::optional<CBlockUndo> block_undo;
+    if (verbosity != TxVerbosity::SHOW_TXID) block_undo = ReadBlockUndoForJSON(blockman, blockindex);
     UniValue txs(UniValue::VARR);
     txs.reserve(block.vtx.size());
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        txs.push_back(BlockTxToJSON(block, i, block_undo ? &*block_undo : nullptr, verbosity));
+    }
 
-    switch (verbosity) {
-        case TxVerbosity::SHOW_TXID:
-            for (const CTransactionRef& tx : block.vtx) {
-                txs.push_back(tx->GetHash().GetHex());
-            }
-            break;
-
-        case TxVerbosity::SHOW_DETAILS:
-        case TxVerbosity::SHOW_DETAILS_AND_PREVOUT:
-            CBlockUndo blockUndo;
-            const bool is_not_pruned{WITH_LOCK(::cs_main, return !blockman.IsBlockPruned(blockindex))};
-            bool have_undo{is_not_pruned && WITH_LOCK(::cs_main, return blockindex.nStatus & BLOCK_HAVE_UNDO)};
-            if (have_undo && !blockman.ReadBlockUndo(blockUndo, blockindex)) {
-                throw JSONRPCError(RPC_INTERNAL_ERROR, "Undo data expected but can't be read. This could be due to disk corruption or a conflict with a pruning event.");
-            }
-            for (size_t i = 0; i < block.vtx.size(); ++i) {
-                const CTransactionRef& tx = block.vtx.at(i);
-                // coinbase transaction (i.e. i == 0) doesn't have undo data
-                const CTxUndo* txundo = (have_undo && i > 0) ? &blockUndo.vtxundo.at(i - 1) : nullptr;
-                UniValue objTx(UniValue::VOBJ);
-                TxToUniv(*tx, /*block_hash=*/uint256(), /*entry=*/objTx, /*include_hex=*/true, txundo, verbosity);
-                txs.push_back(std::move(objTx));
-            }
-            break;
+    result.pushKV("tx", std::move(txs));
+
+    return result;
+}
+
+UniValue blockToJSON(const BlockView& block, const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256 pow_limit)
+{
+    UniValue result = BlockSummaryToJSON(block, tip, blockindex, pow_limit);
+
+    // All at once, for the transactions to be hashed in parallel.
+    const std::vector<Txid> txids{block.GetTxids()};
+    UniValue txs(UniValue::VARR);
+    txs.reserve(txids.size());
+    for (const Txid& txid : txids) {
+        txs.push_back(txid.GetHex());
     }
 
     result.pushKV("tx", std::move(txs));
@@ -222,6 +267,20 @@ UniValue blockToJSON(BlockManager& blockman, const CBlock& block, const CBlockIn
     return result;
 }
 
+void WriteBlockJSON(JSONStreamWriter& writer, const CBlock& block, const CBlockUndo* block_undo, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit)
+{
+    writer.BeginObject();
+    writer.Fields(BlockSummaryToJSON(block, tip, blockindex, pow_limit));
+    // Only one transaction at a time is described in memory.
+    writer.Key("tx");
+    writer.BeginArray();
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        writer.Value(BlockTxToJSON(block, i, block_undo, verbosity));
+    }
+    writer.EndArray();
+    writer.EndObject();
+}
+
 static RPCHelpMan getblockcount()
 {
     return RPCHelpMan{
@@ -265,6 +324,52 @@ static RPCHelpMan getbestblockhash()
     };
 }
 
+/** Deadline of a wait with a timeout in milliseconds, where 0 means no timeout */
+static std::optional<SteadyClock::time_point> WaitDeadline(int timeout)
+{
+    if (timeout == 0) return std::nullopt;
+    return SteadyClock::now() + std::chrono::milliseconds{timeout};
+}
+
+/**
+ * Wait until done holds for the chain tip, the deadline passes or the node
+ * shuts down, and return the tip then. If allow_suspend, the request is
+ * suspended while it waits, rather than holding the RPC thread.
+ */
+static UniValue WaitForTip(NodeContext& node, bool allow_suspend, const std::function<bool(const BlockRef&)>& done, std::optional<SteadyClock::time_point> deadline)
+{
+    Mining& miner = EnsureMining(node);
+    ChainstateManager& chainman = EnsureChainman(node);
+
+    // Abort if RPC came out of warmup too early
+    BlockRef current_block{CHECK_NONFATAL(miner.getTip()).value()};
+
+    while (!done(current_block) && !chainman.m_interrupt) {
+        const auto now{SteadyClock::now()};
+        if (deadline && now >= *deadline) break;
+        if (allow_suspend) {
+            throw RPCSuspension{
+                .wait = [&notifications = *Assert(node.notifications), tip = current_block.hash](std::function<void()> wake) -> std::function<void()> {
+                    const uint64_t id{notifications.WaitTipChangedAsync(tip, std::move(wake))};
+                    return [&notifications, id] { notifications.CancelTipWaiter(id); };
+                },
+                .deadline = deadline,
+                .resume = [&node, done, deadline] { return WaitForTip(node, /*allow_suspend=*/true, done, deadline); },
+            };
+        }
+        std::optional<BlockRef> block{deadline ? miner.waitTipChanged(current_block.hash, MillisecondsDouble{*deadline - now}) :
+                                                 miner.waitTipChanged(current_block.hash)};
+        // Return current block upon shutdown
+        if (!block) break;
+        current_block = *block;
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("hash", current_block.hash.GetHex());
+    ret.pushKV("height", current_block.height);
+    return ret;
+}
+
 static RPCHelpMan waitfornewblock()
 {
     return RPCHelpMan{
@@ -296,30 +401,21 @@ static RPCHelpMan waitfornewblock()
     NodeContext& node = EnsureAnyNodeContext(request.context);
     Mining& miner = EnsureMining(node);
 
-    // If the caller provided a current_tip value, pass it to waitTipChanged().
+    // If the caller provided a current_tip value, wait for the tip to differ
+    // from it.
     //
     // If the caller did not provide a current tip hash, call getTip() to get
     // one and wait for the tip to be different from this value. This mode is
     // less reliable because if the tip changed between waitfornewblock calls,
     // it will need to change a second time before this call returns.
-    BlockRef current_block{CHECK_NONFATAL(miner.getTip()).value()};
-
-    uint256 tip_hash{request.params[1].isNull()
-        ? current_block.hash
-        : ParseHashV(request.params[1], "current_tip")};
-
+    //
     // If the user provided an invalid current_tip then this call immediately
     // returns the current tip.
-    std::optional<BlockRef> block = timeout ? miner.waitTipChanged(tip_hash, std::chrono::milliseconds(timeout)) :
-                                              miner.waitTipChanged(tip_hash);
-
-    // Return current block upon shutdown
-    if (block) current_block = *block;
+    const uint256 tip_hash{request.params[1].isNull()
+        ? CHECK_NONFATAL(miner.getTip()).value().hash
+        : ParseHashV(request.params[1], "current_tip")};
 
-    UniValue ret(UniValue::VOBJ);
-    ret.pushKV("hash", current_block.hash.GetHex());
-    ret.pushKV("height", current_block.height);
-    return ret;
+    return WaitForTip(node, request.m_allow_suspend, [tip_hash](const BlockRef& block) { return block.hash != tip_hash; }, WaitDeadline(timeout));
 },
     };
 }
@@ -356,31 +452,8 @@ static RPCHelpMan waitforblock()
     if (timeout < 0) throw JSONRPCError(RPC_MISC_ERROR, "Negative timeout");
 
     NodeContext& node = EnsureAnyNodeContext(request.context);
-    Mining& miner = EnsureMining(node);
-
-    // Abort if RPC came out of warmup too early
-    BlockRef current_block{CHECK_NONFATAL(miner.getTip()).value()};
 
-    const auto deadline{std::chrono::steady_clock::now() + 1ms * timeout};
-    while (current_block.hash != hash) {
-        std::optional<BlockRef> block;
-        if (timeout) {
-            auto now{std::chrono::steady_clock::now()};
-            if (now >= deadline) break;
-            const MillisecondsDouble remaining{deadline - now};
-            block = miner.waitTipChanged(current_block.hash, remaining);
-        } else {
-            block = miner.waitTipChanged(current_block.hash);
-        }
-        // Return current block upon shutdown
-        if (!block) break;
-        current_block = *block;
-    }
-
-    UniValue ret(UniValue::VOBJ);
-    ret.pushKV("hash", current_block.hash.GetHex());
-    ret.pushKV("height", current_block.height);
-    return ret;
+    return WaitForTip(node, request.m_allow_suspend, [hash](const BlockRef& block) { return block.hash == hash; }, WaitDeadline(timeout));
 },
     };
 }
@@ -418,32 +491,8 @@ static RPCHelpMan waitforblockheight()
     if (timeout < 0) throw JSONRPCError(RPC_MISC_ERROR, "Negative timeout");
 
     NodeContext& node = EnsureAnyNodeContext(request.context);
-    Mining& miner = EnsureMining(node);
-
-    // Abort if RPC came out of warmup too early
-    BlockRef current_block{CHECK_NONFATAL(miner.getTip()).value()};
-
-    const auto deadline{std::chrono::steady_clock::now() + 1ms * timeout};
 
-    while (current_block.height < height) {
-        std::optional<BlockRef> block;
-        if (timeout) {
-            auto now{std::chrono::steady_clock::now()};
-            if (now >= deadline) break;
-            const MillisecondsDouble remaining{deadline - now};
-            block = miner.waitTipChanged(current_block.hash, remaining);
-        } else {
-            block = miner.waitTipChanged(current_block.hash);
-        }
-        // Return current block on shutdown
-        if (!block) break;
-        current_block = *block;
-    }
-
-    UniValue ret(UniValue::VOBJ);
-    ret.pushKV("hash", current_block.hash.GetHex());
-    ret.pushKV("height", current_block.height);
-    return ret;
+    return WaitForTip(node, request.m_allow_suspend, [height](const BlockRef& block) { return block.height >= height; }, WaitDeadline(timeout));
 },
     };
 }
@@ -829,22 +878,41 @@ static RPCHelpMan getblock()
     const std::vector<std::byte> block_data{GetRawBlockChecked(chainman.m_blockman, *pblockindex)};
 
     if (verbosity <= 0) {
+        // The serialized block as is, over the binary transport
+        if (request.m_binary) return std::string{reinterpret_cast<const char*>(block_data.data()), block_data.size()};
         return HexStr(block_data);
     }
 
+    if (verbosity == 1) {
+        // Only the txids are needed, so the transactions aren't deserialized.
+        return blockToJSON(BlockView{block_data}, *tip, *pblockindex, chainman.GetConsensus().powLimit);
+    }
+
     DataStream block_stream{block_data};
     CBlock block{};
     block_stream >> TX_WITH_WITNESS(block);
 
     TxVerbosity tx_verbosity;
-    if (verbosity == 1) {
-        tx_verbosity = TxVerbosity::SHOW_TXID;
-    } else if (verbosity == 2) {
+    if (verbosity == 2) {
         tx_verbosity = TxVerbosity::SHOW_DETAILS;
     } else {
         tx_verbosity = TxVerbosity::SHOW_DETAILS_AND_PREVOUT;
     }
 
+    if (tx_verbosity != TxVerbosity::SHOW_TXID && request.m_allow_stream) {
+        // Write the transactions one by one instead of building the whole
+        // result, which can be many times the size of the block. Errors must
+        // be thrown before, so the undo data is read here.
+        auto block_ptr{std::make_shared<const CBlock>(std::move(block))};
+        std::shared_ptr<const CBlockUndo> block_undo;
+        if (auto undo{ReadBlockUndoForJSON(chainman.m_blockman, *pblockindex)}) {
+            block_undo = std::make_shared<const CBlockUndo>(std::move(*undo));
+        }
+        throw RPCStreamedResult{[block_ptr, block_undo, tip, pblockindex, tx_verbosity, pow_limit = chainman.GetConsensus().powLimit](JSONStreamWriter& writer) {
+            WriteBlockJSON(writer, *block_ptr, block_undo.get(), *tip, *pblockindex, tx_verbosity, pow_limit);
+        }};
+    }
+
     return blockToJSON(chainman.m_blockman, block, *tip, *pblockindex, tx_verbosity, chainman.GetConsensus().powLimit);
 },
     };
@@ -2979,6 +3047,229 @@ static RPCHelpMan getblockfilter()
     };
 }
 
+//! Default and maximum number of entries returned by getscripthistory and getscriptunspent per call.
+static constexpr int DEFAULT_SCRIPT_INDEX_PAGE_SIZE{1000};
+static constexpr int MAX_SCRIPT_INDEX_PAGE_SIZE{10000};
+
+static const RPCArg script_index_script_arg{"script", RPCArg::Type::STR, RPCArg::Optional::NO, "The address, or hex-encoded output script, to look up"};
+static const RPCArg script_index_count_arg{"count", RPCArg::Type::NUM, RPCArg::Default{DEFAULT_SCRIPT_INDEX_PAGE_SIZE}, strprintf("The maximum number of entries to return (at most %d)", MAX_SCRIPT_INDEX_PAGE_SIZE)};
+
+/** Parse an address or hex-encoded output script argument. */
+static CScript ParseScriptOrAddress(const UniValue& param)
+{
+    const std::string& str{param.get_str()};
+    const CTxDestination dest{DecodeDestination(str)};
+    if (IsValidDestination(dest)) return GetScriptForDestination(dest);
+    if (!str.empty() && IsHex(str)) {
+        const std::vector<unsigned char> script{ParseHex(str)};
+        return CScript(script.begin(), script.end());
+    }
+    throw JSONRPCError(RPC_INVALID_ADDRESS_OR_KEY, "Invalid address or output script: " + str);
+}
+
+/** Return the script hash index, making sure it is enabled and synced. */
+static const ScriptHashIndex& EnsureSyncedScriptHashIndex()
+{
+    if (!g_scripthash_index) {
+        throw JSONRPCError(RPC_MISC_ERROR, "Requires scripthashindex. Restart with -scripthashindex.");
+    }
+    if (!g_scripthash_index->BlockUntilSyncedToCurrentChain()) {
+        throw JSONRPCError(RPC_MISC_ERROR, strprintf("Unable to get data because scripthashindex is still syncing. Current height: %d",
+                                                     g_scripthash_index->GetSummary().best_block_height));
+    }
+    return *g_scripthash_index;
+}
+
+/** Encode the position of the last returned entry as the opaque cursor of the next page. */
+template <typename Position>
+static std::string EncodeScriptIndexCursor(const Position& pos)
+{
+    DataStream cursor;
+    cursor << pos;
+    return HexStr(cursor);
+}
+
+/** Decode a cursor returned by EncodeScriptIndexCursor, if one was passed. */
+template <typename Position>
+static std::optional<Position> ParseScriptIndexCursor(const UniValue& param)
+{
+    if (param.isNull()) return std::nullopt;
+    const std::vector<unsigned char> cursor_data{ParseHexV(param, "cursor")};
+    SpanReader cursor{cursor_data};
+    Position pos;
+    try {
+        cursor >> pos;
+    } catch (const std::ios_base::failure&) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+    }
+    if (!cursor.empty()) throw JSONRPCError(RPC_INVALID_PARAMETER, "Invalid cursor");
+    return pos;
+}
+
+static size_t ParseScriptIndexCount(const UniValue& param)
+{
+    const int count{param.isNull() ? DEFAULT_SCRIPT_INDEX_PAGE_SIZE : param.getInt<int>()};
+    if (count < 1 || count > MAX_SCRIPT_INDEX_PAGE_SIZE) {
+        throw JSONRPCError(RPC_INVALID_PARAMETER, strprintf("count must be between 1 and %d", MAX_SCRIPT_INDEX_PAGE_SIZE));
+    }
+    return count;
+}
+
+RPCHelpMan getscripthistory()
+{
+    return RPCHelpMan{
+        "getscripthistory",
+        "Returns the transactions that paid to or spent from an output script, oldest first.\n"
+        "Requires -scripthashindex. Results are paged: if more entries exist than were returned, pass the returned\n"
+        "\"cursor\" to a subsequent call to continue after the last returned entry.\n",
+        {
+            script_index_script_arg,
+            script_index_count_arg,
+            {"cursor", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "The cursor returned by a previous call"},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::STR_HEX, "scripthash", "The SHA256 hash of the output script, in reversed byte order"},
+                {RPCResult::Type::NUM, "height", "The height of the block the result is as of"},
+                {RPCResult::Type::STR_HEX, "bestblock", "The hash of the block the result is as of"},
+                {RPCResult::Type::ARR, "history", "",
+                {
+                    {RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::STR, "type", "\"receive\" for an output paying to the script, \"spend\" for an input spending from it"},
+                        {RPCResult::Type::STR_HEX, "txid", "The transaction id"},
+                        {RPCResult::Type::NUM, "height", "The height of the block containing the transaction"},
+                        {RPCResult::Type::NUM, "vout", /*optional=*/true, "The index of the output (type \"receive\")"},
+                        {RPCResult::Type::NUM, "vin", /*optional=*/true, "The index of the input (type \"spend\")"},
+                        {RPCResult::Type::STR_HEX, "prevout_txid", /*optional=*/true, "The transaction id of the spent output (type \"spend\")"},
+                        {RPCResult::Type::NUM, "prevout_vout", /*optional=*/true, "The index of the spent output (type \"spend\")"},
+                        {RPCResult::Type::STR_AMOUNT, "amount", "The amount received or spent in " + CURRENCY_UNIT},
+                    }},
+                }},
+                {RPCResult::Type::STR_HEX, "cursor", /*optional=*/true, "Pass to a subsequent call to get the next page (only if more entries exist)"},
+            }},
+        RPCExamples{
+            HelpExampleCli("getscripthistory", "\"" + EXAMPLE_ADDRESS[0] + "\"")
+          + HelpExampleCli("getscripthistory", "\"" + EXAMPLE_ADDRESS[0] + "\" 100 \"cursor\"")
+          + HelpExampleRpc("getscripthistory", "\"" + EXAMPLE_ADDRESS[0] + "\", 100")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const CScript script{ParseScriptOrAddress(request.params[0])};
+    const size_t count{ParseScriptIndexCount(request.params[1])};
+    const auto after{ParseScriptIndexCursor<ScriptHistoryPosition>(request.params[2])};
+
+    const ScriptHashIndex& index{EnsureSyncedScriptHashIndex()};
+    const uint256 script_hash{ComputeScriptHash(script)};
+    // Fetch one more entry than requested, to know whether there is another page.
+    interfaces::BlockRef synced_block;
+    auto entries{index.FindHistory(script_hash, after, count + 1, &synced_block)};
+    if (!entries) throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read scripthashindex");
+
+    UniValue history(UniValue::VARR);
+    for (size_t i = 0; i < std::min(count, entries->size()); ++i) {
+        const ScriptHistoryEntry& entry{(*entries)[i]};
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("type", entry.pos.spending ? "spend" : "receive");
+        obj.pushKV("txid", entry.txid.GetHex());
+        obj.pushKV("height", entry.pos.height);
+        if (entry.pos.spending) {
+            obj.pushKV("vin", entry.pos.index);
+            obj.pushKV("prevout_txid", entry.outpoint.hash.GetHex());
+            obj.pushKV("prevout_vout", entry.outpoint.n);
+        } else {
+            obj.pushKV("vout", entry.pos.index);
+        }
+        obj.pushKV("amount", ValueFromAmount(entry.amount));
+        history.push_back(std::move(obj));
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("scripthash", script_hash.GetHex());
+    ret.pushKV("height", synced_block.height);
+    ret.pushKV("bestblock", synced_block.hash.GetHex());
+    ret.pushKV("history", std::move(history));
+    if (entries->size() > count) {
+        ret.pushKV("cursor", EncodeScriptIndexCursor((*entries)[count - 1].pos));
+    }
+    return ret;
+},
+    };
+}
+
+RPCHelpMan getscriptunspent()
+{
+    return RPCHelpMan{
+        "getscriptunspent",
+        "Returns the unspent outputs paying to an output script, ordered by outpoint.\n"
+        "Requires -scripthashindex. Unlike scantxoutset this does not scan the UTXO set, and does not consider the mempool.\n"
+        "Results are paged: if more entries exist than were returned, pass the returned \"cursor\" to a subsequent call\n"
+        "to continue after the last returned entry.\n",
+        {
+            script_index_script_arg,
+            script_index_count_arg,
+            {"cursor", RPCArg::Type::STR_HEX, RPCArg::Optional::OMITTED, "The cursor returned by a previous call"},
+        },
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::STR_HEX, "scripthash", "The SHA256 hash of the output script, in reversed byte order"},
+                {RPCResult::Type::NUM, "height", "The height of the block the result is as of"},
+                {RPCResult::Type::STR_HEX, "bestblock", "The hash of the block the result is as of"},
+                {RPCResult::Type::ARR, "unspents", "",
+                {
+                    {RPCResult::Type::OBJ, "", "",
+                    {
+                        {RPCResult::Type::STR_HEX, "txid", "The transaction id"},
+                        {RPCResult::Type::NUM, "vout", "The vout value"},
+                        {RPCResult::Type::STR_AMOUNT, "amount", "The amount in " + CURRENCY_UNIT + " of the unspent output"},
+                        {RPCResult::Type::NUM, "height", "Height of the unspent transaction output"},
+                    }},
+                }},
+                {RPCResult::Type::STR_HEX, "cursor", /*optional=*/true, "Pass to a subsequent call to get the next page (only if more entries exist)"},
+            }},
+        RPCExamples{
+            HelpExampleCli("getscriptunspent", "\"" + EXAMPLE_ADDRESS[0] + "\"")
+          + HelpExampleRpc("getscriptunspent", "\"" + EXAMPLE_ADDRESS[0] + "\", 100")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    const CScript script{ParseScriptOrAddress(request.params[0])};
+    const size_t count{ParseScriptIndexCount(request.params[1])};
+    const auto after{ParseScriptIndexCursor<COutPoint>(request.params[2])};
+
+    const ScriptHashIndex& index{EnsureSyncedScriptHashIndex()};
+    const uint256 script_hash{ComputeScriptHash(script)};
+    // Fetch one more entry than requested, to know whether there is another page.
+    interfaces::BlockRef synced_block;
+    auto entries{index.FindUnspent(script_hash, after, count + 1, &synced_block)};
+    if (!entries) throw JSONRPCError(RPC_INTERNAL_ERROR, "Unable to read scripthashindex");
+
+    UniValue unspents(UniValue::VARR);
+    for (size_t i = 0; i < std::min(count, entries->size()); ++i) {
+        const ScriptUnspentEntry& entry{(*entries)[i]};
+        UniValue obj(UniValue::VOBJ);
+        obj.pushKV("txid", entry.outpoint.hash.GetHex());
+        obj.pushKV("vout", entry.outpoint.n);
+        obj.pushKV("amount", ValueFromAmount(entry.amount));
+        obj.pushKV("height", entry.height);
+        unspents.push_back(std::move(obj));
+    }
+
+    UniValue ret(UniValue::VOBJ);
+    ret.pushKV("scripthash", script_hash.GetHex());
+    ret.pushKV("height", synced_block.height);
+    ret.pushKV("bestblock", synced_block.hash.GetHex());
+    ret.pushKV("unspents", std::move(unspents));
+    if (entries->size() > count) {
+        ret.pushKV("cursor", EncodeScriptIndexCursor((*entries)[count - 1].outpoint));
+    }
+    return ret;
+},
+    };
+}
+
 /**
  * RAII class that disables the network in its constructor and enables it in its
  * destructor.
@@ -3232,49 +3523,7 @@ UniValue WriteUTXOSnapshot(
 
     afile << metadata;
 
-    COutPoint key;
-    Txid last_hash;
-    Coin coin;
-    unsigned int iter{0};
-    size_t written_coins_count{0};
-    std::vector<std::pair<uint32_t, Coin>> coins;
-
-    // To reduce space the serialization format of the snapshot avoids
-    // duplication of tx hashes. The code takes advantage of the guarantee by
-    // leveldb that keys are lexicographically sorted.
-    // In the coins vector we collect all coins that belong to a certain tx hash
-    // (key.hash) and when we have them all (key.hash != last_hash) we write
-    // them to file using the below lambda function.
-    // See also https://github.com/hylium/hylium/issues/25675
-    auto write_coins_to_file = [&](AutoFile& afile, const Txid& last_hash, const std::vector<std::pair<uint32_t, Coin>>& coins, size_t& written_coins_count) {
-        afile << last_hash;
-        WriteCompactSize(afile, coins.size());
-        for (const auto& [n, coin] : coins) {
-            WriteCompactSize(afile, n);
-            afile << coin;
-            ++written_coins_count;
-        }
-    };
-
-    pcursor->GetKey(key);
-    last_hash = key.hash;
-    while (pcursor->Valid()) {
-        if (iter % 5000 == 0) interruption_point();
-        ++iter;
-        if (pcursor->GetKey(key) && pcursor->GetValue(coin)) {
-            if (key.hash != last_hash) {
-                write_coins_to_file(afile, last_hash, coins, written_coins_count);
-                last_hash = key.hash;
-                coins.clear();
-            }
-            coins.emplace_back(key.n, coin);
-        }
-        pcursor->Next();
-    }
-
-    if (!coins.empty()) {
-        write_coins_to_file(afile, last_hash, coins, written_coins_count);
-    }
+    const size_t written_coins_count{WriteUTXOSetCoins(afile, *pcursor, interruption_point)};
 
     CHECK_NONFATAL(written_coins_count == maybe_stats->coins_count);
 
@@ -3465,23 +3714,103 @@ return RPCHelpMan{
     };
 }
 
+static const std::vector<RPCResult> RPCHelpForDBStats{
+    {RPCResult::Type::STR, "engine", "the storage engine (leveldb or logdb)"},
+    {RPCResult::Type::ARR, "levels", "the levels of LevelDB, or a single one holding the segments of LogDB",
+    {
+        {RPCResult::Type::OBJ, "", "",
+        {
+            {RPCResult::Type::NUM, "files", "number of files"},
+            {RPCResult::Type::NUM, "bytes", "total size of the files"},
+            {RPCResult::Type::NUM, "compaction_time", "seconds spent by the compactions that wrote this level"},
+            {RPCResult::Type::NUM, "compaction_bytes_read", "bytes read by the compactions that wrote this level"},
+            {RPCResult::Type::NUM, "compaction_bytes_written", "bytes written by the compactions that wrote this level"},
+        }},
+    }},
+    {RPCResult::Type::ARR, "write_stalls", "writes held up by the engine, by cause",
+    {
+        {RPCResult::Type::OBJ, "", "",
+        {
+            {RPCResult::Type::STR, "cause", "level0_slowdown (each write delayed by 1ms as level 0 is nearly full), memtable_full (waiting for the write buffer to be compacted), level0_stop (waiting as level 0 is full), index_merge (merging the changes into the sorted index of LogDB), or segment_sync (syncing a LogDB segment as it is sealed)"},
+            {RPCResult::Type::NUM, "count", "number of times writes were held up"},
+            {RPCResult::Type::NUM, "time", "seconds writes were held up"},
+        }},
+    }},
+};
+
+static UniValue DBStatsToJSON(const DBStats& stats)
+{
+    UniValue obj{UniValue::VOBJ};
+    obj.pushKV("engine", DBEngineName(stats.engine));
+    UniValue levels{UniValue::VARR};
+    for (const auto& level : stats.levels) {
+        UniValue level_obj{UniValue::VOBJ};
+        level_obj.pushKV("files", level.files);
+        level_obj.pushKV("bytes", level.bytes);
+        level_obj.pushKV("compaction_time", Ticks<SecondsDouble>(level.compaction_time));
+        level_obj.pushKV("compaction_bytes_read", level.compaction_bytes_read);
+        level_obj.pushKV("compaction_bytes_written", level.compaction_bytes_written);
+        levels.push_back(std::move(level_obj));
+    }
+    obj.pushKV("levels", std::move(levels));
+    UniValue write_stalls{UniValue::VARR};
+    for (const auto& stall : stats.write_stalls) {
+        UniValue stall_obj{UniValue::VOBJ};
+        stall_obj.pushKV("cause", stall.cause);
+        stall_obj.pushKV("count", stall.count);
+        stall_obj.pushKV("time", Ticks<SecondsDouble>(stall.time));
+        write_stalls.push_back(std::move(stall_obj));
+    }
+    obj.pushKV("write_stalls", std::move(write_stalls));
+    return obj;
+}
+
+static RPCHelpMan getdbstats()
+{
+    return RPCHelpMan{
+        "getdbstats",
+        "Return statistics of the databases of the chainstate and the block index, to help tune -dbcache.\n"
+        "Compactions of LevelDB merge the files written by flushes of the cache in the background. When they\n"
+        "fall behind, writes are held up until they catch up (write stalls).\n",
+        {},
+        RPCResult{
+            RPCResult::Type::OBJ, "", "",
+            {
+                {RPCResult::Type::OBJ, "chainstate", "the coins database of the active chainstate", RPCHelpForDBStats},
+                {RPCResult::Type::OBJ, "blockindex", "the block index database", RPCHelpForDBStats},
+            }},
+        RPCExamples{
+            HelpExampleCli("getdbstats", "")
+            + HelpExampleRpc("getdbstats", "")
+        },
+        [&](const RPCHelpMan& self, const JSONRPCRequest& request) -> UniValue
+{
+    ChainstateManager& chainman = EnsureAnyChainman(request.context);
+    LOCK(cs_main);
+    UniValue obj{UniValue::VOBJ};
+    obj.pushKV("chainstate", DBStatsToJSON(chainman.ActiveChainstate().CoinsDB().GetDBStats()));
+    obj.pushKV("blockindex", DBStatsToJSON(chainman.m_blockman.m_block_tree_db->GetStats()));
+    return obj;
+},
+    };
+}
 
 void RegisterBlockchainRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
         {"blockchain", &getblockchaininfo},
         {"blockchain", &getchaintxstats},
-        {"blockchain", &getblockstats},
-        {"blockchain", &getbestblockhash},
-        {"blockchain", &getblockcount},
-        {"blockchain", &getblock},
+        {"blockchain", &getblockstats, /*is_parallel_safe=*/true},
+        {"blockchain", &getbestblockhash, /*is_parallel_safe=*/true},
+        {"blockchain", &getblockcount, /*is_parallel_safe=*/true},
+        {"blockchain", &getblock, /*is_parallel_safe=*/true},
         {"blockchain", &getblockfrompeer},
-        {"blockchain", &getblockhash},
-        {"blockchain", &getblockheader},
+        {"blockchain", &getblockhash, /*is_parallel_safe=*/true},
+        {"blockchain", &getblockheader, /*is_parallel_safe=*/true},
         {"blockchain", &getchaintips},
         {"blockchain", &getdifficulty},
         {"blockchain", &getdeploymentinfo},
-        {"blockchain", &gettxout},
+        {"blockchain", &gettxout, /*is_parallel_safe=*/true},
         {"blockchain", &gettxoutsetinfo},
         {"blockchain", &pruneblockchain},
         {"blockchain", &verifychain},
@@ -3489,10 +3818,13 @@ void RegisterBlockchainRPCCommands(CRPCTable& t)
         {"blockchain", &scantxoutset},
         {"blockchain", &scanblocks},
         {"blockchain", &getdescriptoractivity},
-        {"blockchain", &getblockfilter},
+        {"blockchain", &getblockfilter, /*is_parallel_safe=*/true},
+        {"blockchain", &getscripthistory, /*is_parallel_safe=*/true},
+        {"blockchain", &getscriptunspent, /*is_parallel_safe=*/true},
         {"blockchain", &dumptxoutset},
         {"blockchain", &loadtxoutset},
         {"blockchain", &getchainstates},
+        {"blockchain", &getdbstats},
         {"hidden", &invalidateblock},
         {"hidden", &reconsiderblock},
         {"blockchain", &waitfornewblock},
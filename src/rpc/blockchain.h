@@ -14,11 +14,17 @@
 
 #include <any>
 #include <cstdint>
+#include <functional>
+#include <optional>
+#include <utility>
 #include <vector>
 
+class BlockView;
 class CBlock;
 class CBlockIndex;
+class CBlockUndo;
 class Chainstate;
+class JSONStreamWriter;
 class UniValue;
 namespace node {
 class BlockManager;
@@ -38,6 +44,15 @@ double GetDifficulty(const CBlockIndex& blockindex);
 /** Block description to JSON */
 UniValue blockToJSON(node::BlockManager& blockman, const CBlock& block, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
 
+/** Block description to JSON, with the txids of its transactions (as for TxVerbosity::SHOW_TXID), from a view of the block */
+UniValue blockToJSON(const BlockView& block, const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
+
+/** Block description to JSON, written in pieces, given the undo data of the block if available */
+void WriteBlockJSON(JSONStreamWriter& writer, const CBlock& block, const CBlockUndo* block_undo, const CBlockIndex& tip, const CBlockIndex& blockindex, TxVerbosity verbosity, const uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
+
+/** Read the undo data of a block, to describe the prevouts of its transactions, if it is not pruned. Throws if it can't be read. */
+std::optional<CBlockUndo> ReadBlockUndoForJSON(node::BlockManager& blockman, const CBlockIndex& blockindex) LOCKS_EXCLUDED(cs_main);
+
 /** Block header to JSON */
 UniValue blockheaderToJSON(const CBlockIndex& tip, const CBlockIndex& blockindex, const uint256 pow_limit) LOCKS_EXCLUDED(cs_main);
 
@@ -55,6 +70,60 @@ UniValue CreateUTXOSnapshot(
     const fs::path& path,
     const fs::path& tmppath);
 
+/**
+ * Write the coins of a cursor like in the body of a UTXO snapshot: for each
+ * txid, the txid, the number of its coins, and the output index and coin of
+ * each. Returns the number of coins written.
+ */
+template <typename Stream>
+size_t WriteUTXOSetCoins(Stream& stream, CCoinsViewCursor& cursor, const std::function<void()>& interruption_point = {})
+{
+    COutPoint key;
+    Txid last_hash;
+    Coin coin;
+    unsigned int iter{0};
+    size_t written_coins_count{0};
+    std::vector<std::pair<uint32_t, Coin>> coins;
+
+    // To reduce space the serialization format of the snapshot avoids
+    // duplication of tx hashes. The code takes advantage of the guarantee by
+    // leveldb that keys are lexicographically sorted.
+    // In the coins vector we collect all coins that belong to a certain tx hash
+    // (key.hash) and when we have them all (key.hash != last_hash) we write
+    // them to the stream using the below lambda function.
+    // See also https://github.com/hylium/hylium/issues/25675
+    auto write_coins = [&]() {
+        stream << last_hash;
+        WriteCompactSize(stream, coins.size());
+        for (const auto& [n, coin] : coins) {
+            WriteCompactSize(stream, n);
+            stream << coin;
+            ++written_coins_count;
+        }
+    };
+
+    cursor.GetKey(key);
+    last_hash = key.hash;
+    while (cursor.Valid()) {
+        if (iter % 5000 == 0 && interruption_point) interruption_point();
+        ++iter;
+        if (cursor.GetKey(key) && cursor.GetValue(coin)) {
+            if (key.hash != last_hash) {
+                write_coins();
+                last_hash = key.hash;
+                coins.clear();
+            }
+            coins.emplace_back(key.n, coin);
+        }
+        cursor.Next();
+    }
+
+    if (!coins.empty()) {
+        write_coins();
+    }
+    return written_coins_count;
+}
+
 //! Return height of highest block that has been pruned, or std::nullopt if no blocks have been pruned
 std::optional<int> GetPruneHeight(const node::BlockManager& blockman, const CChain& chain) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 void CheckBlockDataAvailability(node::BlockManager& blockman, const CBlockIndex& blockindex, bool check_for_undo) EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
@@ -20,6 +20,7 @@
 #include <rpc/server.h>
 #include <rpc/server_util.h>
 #include <rpc/util.h>
+#include <span.h>
 #include <txmempool.h>
 #include <univalue.h>
 #include <util/fs.h>
@@ -78,7 +79,9 @@ static RPCHelpMan sendrawtransaction()
             const CAmount max_burn_amount = request.params[2].isNull() ? 0 : AmountFromValue(request.params[2]);
 
             CMutableTransaction mtx;
-            if (!DecodeHexTx(mtx, request.params[0].get_str())) {
+            // Over the binary transport, the transaction is passed as is.
+            const std::string& tx_data{request.params[0].get_str()};
+            if (request.m_binary ? !DecodeRawTx(mtx, MakeUCharSpan(tx_data)) : !DecodeHexTx(mtx, tx_data)) {
                 throw JSONRPCError(RPC_DESERIALIZATION_ERROR, "TX decode failed. Make sure the tx has at least one input.");
             }
 
@@ -460,6 +463,20 @@ UniValue MempoolToJSON(const CTxMemPool& pool, bool verbose, bool include_mempoo
     }
 }
 
+/** Verbose MempoolToJSON, written in pieces */
+static void WriteMempoolJSON(JSONStreamWriter& writer, const CTxMemPool& pool)
+{
+    LOCK(pool.cs);
+    writer.BeginObject();
+    for (const CTxMemPoolEntry& e : pool.entryAll()) {
+        UniValue info(UniValue::VOBJ);
+        entryToJSON(pool, info, e);
+        writer.Key(e.GetTx().GetHash().ToString());
+        writer.Value(info);
+    }
+    writer.EndObject();
+}
+
 static RPCHelpMan getmempoolfeeratediagram()
 {
     return RPCHelpMan{"getmempoolfeeratediagram",
@@ -549,7 +566,13 @@ static RPCHelpMan getrawmempool()
         include_mempool_sequence = request.params[1].get_bool();
     }
 
-    return MempoolToJSON(EnsureAnyMemPool(request.context), fVerbose, include_mempool_sequence);
+    const CTxMemPool& mempool{EnsureAnyMemPool(request.context)};
+    if (fVerbose && !include_mempool_sequence && request.m_allow_stream) {
+        // Write the entries one by one instead of building the whole result.
+        throw RPCStreamedResult{[&mempool](JSONStreamWriter& writer) { WriteMempoolJSON(writer, mempool); }};
+    }
+
+    return MempoolToJSON(mempool, fVerbose, include_mempool_sequence);
 },
     };
 }
@@ -1306,11 +1329,11 @@ void RegisterMempoolRPCCommands(CRPCTable& t)
     static const CRPCCommand commands[]{
         {"rawtransactions", &sendrawtransaction},
         {"rawtransactions", &testmempoolaccept},
-        {"blockchain", &getmempoolancestors},
-        {"blockchain", &getmempooldescendants},
-        {"blockchain", &getmempoolentry},
+        {"blockchain", &getmempoolancestors, /*is_parallel_safe=*/true},
+        {"blockchain", &getmempooldescendants, /*is_parallel_safe=*/true},
+        {"blockchain", &getmempoolentry, /*is_parallel_safe=*/true},
         {"blockchain", &getmempoolcluster},
-        {"blockchain", &gettxspendingprevout},
+        {"blockchain", &gettxspendingprevout, /*is_parallel_safe=*/true},
         {"blockchain", &getmempoolinfo},
         {"hidden", &getmempoolfeeratediagram},
         {"blockchain", &getrawmempool},
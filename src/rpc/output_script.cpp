@@ -344,10 +344,10 @@ static RPCHelpMan deriveaddresses()
 void RegisterOutputScriptRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
-        {"util", &validateaddress},
+        {"util", &validateaddress, /*is_parallel_safe=*/true},
         {"util", &createmultisig},
-        {"util", &deriveaddresses},
-        {"util", &getdescriptorinfo},
+        {"util", &deriveaddresses, /*is_parallel_safe=*/true},
+        {"util", &getdescriptorinfo, /*is_parallel_safe=*/true},
     };
     for (const auto& c : commands) {
         t.appendCommand(c.name, &c);
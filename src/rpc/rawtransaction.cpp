@@ -32,6 +32,7 @@
 #include <script/sign.h>
 #include <script/signingprovider.h>
 #include <script/solver.h>
+#include <streams.h>
 #include <uint256.h>
 #include <undo.h>
 #include <util/bip32.h>
@@ -330,6 +331,12 @@ static RPCHelpMan getrawtransaction()
     }
 
     if (verbosity <= 0) {
+        if (request.m_binary) {
+            // The serialized transaction as is, over the binary transport
+            DataStream ss_tx;
+            ss_tx << TX_WITH_WITNESS(*tx);
+            return ss_tx.str();
+        }
         return EncodeHexTx(*tx);
     }
 
@@ -2077,13 +2084,13 @@ RPCHelpMan descriptorprocesspsbt()
 void RegisterRawTransactionRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
-        {"rawtransactions", &getrawtransaction},
+        {"rawtransactions", &getrawtransaction, /*is_parallel_safe=*/true},
         {"rawtransactions", &createrawtransaction},
-        {"rawtransactions", &decoderawtransaction},
-        {"rawtransactions", &decodescript},
+        {"rawtransactions", &decoderawtransaction, /*is_parallel_safe=*/true},
+        {"rawtransactions", &decodescript, /*is_parallel_safe=*/true},
         {"rawtransactions", &combinerawtransaction},
         {"rawtransactions", &signrawtransactionwithkey},
-        {"rawtransactions", &decodepsbt},
+        {"rawtransactions", &decodepsbt, /*is_parallel_safe=*/true},
         {"rawtransactions", &combinepsbt},
         {"rawtransactions", &finalizepsbt},
         {"rawtransactions", &createpsbt},
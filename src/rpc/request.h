@@ -61,6 +61,13 @@ public:
     std::string peerAddr;
     std::any context;
     JSONRPCVersion m_json_version = JSONRPCVersion::V1_LEGACY;
+    //! Whether the method may throw RPCSuspension to wait without holding a thread.
+    bool m_allow_suspend = false;
+    //! Whether the method may throw RPCStreamedResult to write a large result in pieces.
+    bool m_allow_stream = false;
+    //! Whether the request came over the binary transport (-rpcbinary), so
+    //! that methods may take and return raw bytes instead of hex strings.
+    bool m_binary = false;
 
     void parse(const UniValue& valRequest);
     [[nodiscard]] bool IsNotification() const { return !id.has_value() && m_json_version == JSONRPCVersion::V2; };
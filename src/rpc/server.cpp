@@ -9,6 +9,7 @@
 
 #include <common/args.h>
 #include <common/system.h>
+#include <httpserver.h>
 #include <logging.h>
 #include <node/context.h>
 #include <node/kernel_notifications.h>
@@ -35,6 +36,7 @@ static GlobalMutex g_rpc_warmup_mutex;
 static std::atomic<bool> g_rpc_running{false};
 static bool fRPCInWarmup GUARDED_BY(g_rpc_warmup_mutex) = true;
 static std::string rpcWarmupStatus GUARDED_BY(g_rpc_warmup_mutex) = "RPC server started";
+
 static bool ExecuteCommand(const CRPCCommand& command, const JSONRPCRequest& request, UniValue& result, bool last_handler);
 
 struct RPCCommandExecutionInfo
@@ -43,10 +45,18 @@ struct RPCCommandExecutionInfo
     SteadyClock::time_point start;
 };
 
+struct RPCMethodLimit
+{
+    int max{0};
+    int active{0};
+};
+
 struct RPCServerInfo
 {
     Mutex mutex;
     std::list<RPCCommandExecutionInfo> active_commands GUARDED_BY(mutex);
+    //! Methods with a -rpcmethodlimit, and how many of their calls are running.
+    std::unordered_map<std::string, RPCMethodLimit> method_limits GUARDED_BY(mutex);
 };
 
 static RPCServerInfo g_rpc_server_info;
@@ -66,6 +76,29 @@ struct RPCCommandExecution
     }
 };
 
+/** Slot of a method with a -rpcmethodlimit, held while one of its calls is running */
+struct RPCMethodSlot
+{
+    RPCMethodLimit* limit{nullptr};
+    explicit RPCMethodSlot(const std::string& method)
+    {
+        LOCK(g_rpc_server_info.mutex);
+        const auto it{g_rpc_server_info.method_limits.find(method)};
+        if (it == g_rpc_server_info.method_limits.end()) return;
+        if (it->second.active >= it->second.max) {
+            throw JSONRPCError(RPC_MISC_ERROR, strprintf("Too many concurrent %s calls, the limit can be increased with the -rpcmethodlimit setting", method));
+        }
+        ++it->second.active;
+        limit = &it->second;
+    }
+    ~RPCMethodSlot()
+    {
+        if (!limit) return;
+        LOCK(g_rpc_server_info.mutex);
+        --limit->active;
+    }
+};
+
 std::string CRPCTable::help(std::string_view strCommand, const JSONRPCRequest& helpreq) const
 {
     std::string strRet;
@@ -206,6 +239,24 @@ static RPCHelpMan getrpcinfo()
                                  {RPCResult::Type::NUM, "duration", "The running time in microseconds"},
                             }},
                         }},
+                        {RPCResult::Type::OBJ, "work_queue", "Statistics of the queue of requests waiting for an RPC thread",
+                        {
+                            {RPCResult::Type::NUM, "depth", "The number of requests waiting"},
+                            {RPCResult::Type::NUM, "max_depth", "The maximum number of requests waiting (-rpcworkqueue)"},
+                            {RPCResult::Type::NUM, "dispatched", "The number of requests run by an RPC thread"},
+                            {RPCResult::Type::NUM, "rejected", "The number of requests rejected because the queue was full"},
+                            {RPCResult::Type::NUM, "total_wait", "The total time the dispatched requests waited, in microseconds"},
+                            {RPCResult::Type::NUM, "max_wait", "The longest time a dispatched request waited, in microseconds"},
+                            {RPCResult::Type::NUM, "suspended", "The number of long-polling requests waiting without holding an RPC thread"},
+                        }},
+                        {RPCResult::Type::OBJ_DYN, "method_limits", "The methods limited with -rpcmethodlimit",
+                        {
+                            {RPCResult::Type::OBJ, "method", "The name of the RPC command",
+                            {
+                                {RPCResult::Type::NUM, "limit", "The maximum number of concurrent calls"},
+                                {RPCResult::Type::NUM, "active", "The number of running calls"},
+                            }},
+                        }},
                         {RPCResult::Type::STR, "logpath", "The complete file path to the debug log"},
                     }
                 },
@@ -223,8 +274,28 @@ static RPCHelpMan getrpcinfo()
         active_commands.push_back(std::move(entry));
     }
 
+    UniValue method_limits(UniValue::VOBJ);
+    for (const auto& [method, limit] : g_rpc_server_info.method_limits) {
+        UniValue entry(UniValue::VOBJ);
+        entry.pushKV("limit", limit.max);
+        entry.pushKV("active", limit.active);
+        method_limits.pushKV(method, std::move(entry));
+    }
+
+    const HTTPWorkQueueStats stats{GetHTTPWorkQueueStats()};
+    UniValue work_queue(UniValue::VOBJ);
+    work_queue.pushKV("depth", uint64_t{stats.depth});
+    work_queue.pushKV("max_depth", uint64_t{stats.max_depth});
+    work_queue.pushKV("dispatched", stats.dispatched);
+    work_queue.pushKV("rejected", stats.rejected);
+    work_queue.pushKV("total_wait", int64_t{stats.total_wait.count()});
+    work_queue.pushKV("max_wait", int64_t{stats.max_wait.count()});
+    work_queue.pushKV("suspended", uint64_t{stats.suspended});
+
     UniValue result(UniValue::VOBJ);
     result.pushKV("active_commands", std::move(active_commands));
+    result.pushKV("work_queue", std::move(work_queue));
+    result.pushKV("method_limits", std::move(method_limits));
 
     const std::string path = LogInstance().m_file_path.utf8string();
     UniValue log_path(UniValue::VSTR, path);
@@ -270,10 +341,36 @@ bool CRPCTable::removeCommand(const std::string& name, const CRPCCommand* pcmd)
     return false;
 }
 
-void StartRPC()
+bool SetRPCMethodLimits(const std::vector<std::string>& method_limits)
+{
+    LOCK(g_rpc_server_info.mutex);
+    g_rpc_server_info.method_limits.clear();
+    for (const std::string& method_limit : method_limits) {
+        const auto pos{method_limit.rfind(':')};
+        const auto max{pos == std::string::npos ? std::nullopt : ToIntegral<int>(method_limit.substr(pos + 1))};
+        if (!max || *max < 1 || pos == 0) {
+            LogError("Invalid -rpcmethodlimit=%s; must be <method>:<n>, with n at least 1", method_limit);
+            return false;
+        }
+        g_rpc_server_info.method_limits[method_limit.substr(0, pos)].max = *max;
+    }
+    return true;
+}
+
+std::optional<int> GetRPCMethodLimit(const std::string& method)
+{
+    LOCK(g_rpc_server_info.mutex);
+    const auto it{g_rpc_server_info.method_limits.find(method)};
+    if (it == g_rpc_server_info.method_limits.end()) return std::nullopt;
+    return it->second.max;
+}
+
+bool StartRPC()
 {
     LogDebug(BCLog::RPC, "Starting RPC\n");
+    if (!SetRPCMethodLimits(gArgs.GetArgs("-rpcmethodlimit"))) return false;
     g_rpc_running = true;
+    return true;
 }
 
 void InterruptRPC()
@@ -343,24 +440,49 @@ bool IsDeprecatedRPCEnabled(const std::string& method)
     return find(enabled_methods.begin(), enabled_methods.end(), method) != enabled_methods.end();
 }
 
-UniValue JSONRPCExec(const JSONRPCRequest& jreq, bool catch_errors)
+static UniValue JSONRPCExecWith(const JSONRPCRequest& jreq, bool catch_errors, const std::function<UniValue()>& execute)
 {
     UniValue result;
     if (catch_errors) {
         try {
-            result = tableRPC.execute(jreq);
+            result = execute();
         } catch (UniValue& e) {
             return JSONRPCReplyObj(NullUniValue, std::move(e), jreq.id, jreq.m_json_version);
         } catch (const std::exception& e) {
             return JSONRPCReplyObj(NullUniValue, JSONRPCError(RPC_MISC_ERROR, e.what()), jreq.id, jreq.m_json_version);
         }
     } else {
-        result = tableRPC.execute(jreq);
+        result = execute();
     }
 
     return JSONRPCReplyObj(std::move(result), NullUniValue, jreq.id, jreq.m_json_version);
 }
 
+UniValue JSONRPCExec(const JSONRPCRequest& jreq, bool catch_errors)
+{
+    return JSONRPCExecWith(jreq, catch_errors, [&] { return tableRPC.execute(jreq); });
+}
+
+UniValue JSONRPCResume(const JSONRPCRequest& jreq, const std::function<UniValue()>& resume, bool catch_errors)
+{
+    return JSONRPCExecWith(jreq, catch_errors, [&] {
+        // Errors are converted like in ExecuteCommand
+        try {
+            auto execution{std::make_shared<RPCCommandExecution>(jreq.strMethod)};
+            try {
+                return resume();
+            } catch (RPCStreamedResult& result) {
+                result.call_state.push_back(std::move(execution));
+                throw;
+            }
+        } catch (const UniValue::type_error& e) {
+            throw JSONRPCError(RPC_TYPE_ERROR, e.what());
+        } catch (const std::exception& e) {
+            throw JSONRPCError(RPC_MISC_ERROR, e.what());
+        }
+    });
+}
+
 /**
  * Process named arguments into a vector of positional arguments, based on the
  * passed-in specification for the RPC call's arguments.
@@ -491,23 +613,42 @@ UniValue CRPCTable::execute(const JSONRPCRequest &request) const
     // Find method
     auto it = mapCommands.find(request.strMethod);
     if (it != mapCommands.end()) {
+        auto slot{std::make_shared<RPCMethodSlot>(request.strMethod)};
         UniValue result;
-        if (ExecuteCommands(it->second, request, result)) {
-            return result;
+        try {
+            if (ExecuteCommands(it->second, request, result)) {
+                return result;
+            }
+        } catch (RPCStreamedResult& streamed) {
+            streamed.call_state.push_back(std::move(slot));
+            throw;
         }
     }
     throw JSONRPCError(RPC_METHOD_NOT_FOUND, "Method not found");
 }
 
+bool CRPCTable::IsParallelSafe(const std::string& method) const
+{
+    auto it = mapCommands.find(method);
+    if (it == mapCommands.end()) return false;
+    return std::ranges::all_of(it->second, [](const CRPCCommand* command) { return command->parallel_safe; });
+}
+
 static bool ExecuteCommand(const CRPCCommand& command, const JSONRPCRequest& request, UniValue& result, bool last_handler)
 {
     try {
-        RPCCommandExecution execution(request.strMethod);
-        // Execute, convert arguments to array if necessary
-        if (request.params.isObject()) {
-            return command.actor(transformNamedArguments(request, command.argNames), result, last_handler);
-        } else {
-            return command.actor(request, result, last_handler);
+        auto execution{std::make_shared<RPCCommandExecution>(request.strMethod)};
+        try {
+            // Execute, convert arguments to array if necessary
+            if (request.params.isObject()) {
+                return command.actor(transformNamedArguments(request, command.argNames), result, last_handler);
+            } else {
+                return command.actor(request, result, last_handler);
+            }
+        } catch (RPCStreamedResult& streamed) {
+            // Still running until the result is written, see RPCStreamedResult
+            streamed.call_state.push_back(std::move(execution));
+            throw;
         }
     } catch (const UniValue::type_error& e) {
         throw JSONRPCError(RPC_TYPE_ERROR, e.what());
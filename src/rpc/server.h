@@ -12,9 +12,13 @@
 #include <cstdint>
 #include <functional>
 #include <map>
+#include <memory>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include <univalue.h>
+#include <util/time.h>
 
 class CRPCCommand;
 
@@ -36,6 +40,41 @@ void SetRPCWarmupFinished();
 /* returns the current warmup state.  */
 bool RPCIsInWarmup(std::string *outStatus);
 
+/**
+ * Thrown by an RPC method, if the request allows it (m_allow_suspend), to wait
+ * for an event without holding an RPC thread. The method registers the event
+ * with wait, which is called once with a callback to call when it happens, and
+ * returns a function unregistering it. Once it happens, the deadline passes or
+ * the server shuts down, the registration is dropped and resume is called on
+ * an RPC thread, returning the result of the method, or throwing like it,
+ * including another RPCSuspension to keep waiting.
+ *
+ * This does not derive from std::exception, so that it is not turned into an
+ * RPC error on its way to the server.
+ */
+struct RPCSuspension
+{
+    std::function<std::function<void()>(std::function<void()> wake)> wait;
+    std::optional<SteadyClock::time_point> deadline;
+    std::function<UniValue()> resume;
+};
+
+/**
+ * Thrown by an RPC method, if the request allows it (m_allow_stream), instead
+ * of returning a result too large to be built in memory as a whole. The server
+ * calls write to write the result, after the reply has started, so any error
+ * must be thrown by the method before, and write must not fail.
+ *
+ * Like RPCSuspension, this does not derive from std::exception.
+ */
+struct RPCStreamedResult
+{
+    std::function<void(JSONStreamWriter& writer)> write;
+    //! State of the call kept until the result is written, as the call runs
+    //! until then: its -rpcmethodlimit slot and its getrpcinfo entry.
+    std::vector<std::shared_ptr<void>> call_state{};
+};
+
 typedef RPCHelpMan (*RpcMethodFnType)();
 
 class CRPCCommand
@@ -54,7 +93,7 @@ public:
     }
 
     //! Simplified constructor taking plain RpcMethodFnType function pointer.
-    CRPCCommand(std::string category, RpcMethodFnType fn)
+    CRPCCommand(std::string category, RpcMethodFnType fn, bool is_parallel_safe = false)
         : CRPCCommand(
               category,
               fn().m_name,
@@ -62,6 +101,7 @@ public:
               fn().GetArgNames(),
               intptr_t(fn))
     {
+        parallel_safe = is_parallel_safe;
     }
 
     std::string category;
@@ -78,6 +118,9 @@ public:
     //! appended after other arguments, see transformNamedArguments for details.
     std::vector<std::pair<std::string, bool>> argNames;
     intptr_t unique_id;
+    //! Whether calls only read state, so that the calls in a JSON-RPC batch
+    //! can run concurrently, and complete in any order, on worker threads.
+    bool parallel_safe{false};
 };
 
 /**
@@ -99,6 +142,12 @@ public:
      */
     UniValue execute(const JSONRPCRequest &request) const;
 
+    /**
+     * Whether calls to a method can run in parallel with other calls of a
+     * batch, see CRPCCommand::parallel_safe. False for unknown methods.
+     */
+    bool IsParallelSafe(const std::string& method) const;
+
     /**
     * Returns a list of registered commands
     * @returns List of registered commands.
@@ -130,9 +179,16 @@ bool IsDeprecatedRPCEnabled(const std::string& method);
 
 extern CRPCTable tableRPC;
 
-void StartRPC();
+/** Set the -rpcmethodlimit limits, as <method>:<n>, returning false if one is invalid. */
+bool SetRPCMethodLimits(const std::vector<std::string>& method_limits);
+/** The -rpcmethodlimit of a method, the number of its calls that may run at once, if it has one. */
+std::optional<int> GetRPCMethodLimit(const std::string& method);
+/** Start the RPC server, returning false if its settings are invalid. */
+bool StartRPC();
 void InterruptRPC();
 void StopRPC();
 UniValue JSONRPCExec(const JSONRPCRequest& jreq, bool catch_errors);
+/** Like JSONRPCExec, for the continuation of a request suspended by its method (see RPCSuspension). */
+UniValue JSONRPCResume(const JSONRPCRequest& jreq, const std::function<UniValue()>& resume, bool catch_errors);
 
 #endif // HYLIUM_RPC_SERVER_H
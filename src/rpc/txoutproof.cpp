@@ -178,8 +178,8 @@ static RPCHelpMan verifytxoutproof()
 void RegisterTxoutProofRPCCommands(CRPCTable& t)
 {
     static const CRPCCommand commands[]{
-        {"blockchain", &gettxoutproof},
-        {"blockchain", &verifytxoutproof},
+        {"blockchain", &gettxoutproof, /*is_parallel_safe=*/true},
+        {"blockchain", &verifytxoutproof, /*is_parallel_safe=*/true},
     };
     for (const auto& c : commands) {
         t.appendCommand(c.name, &c);
@@ -1403,3 +1403,93 @@ uint256 GetTarget(const CBlockIndex& blockindex, const uint256 pow_limit)
     arith_uint256 target{*CHECK_NONFATAL(DeriveTarget(blockindex.nBits, pow_limit))};
     return ArithToUint256(target);
 }
+
+JSONStreamWriter::JSONStreamWriter(Sink sink, size_t buffer_size)
+    : m_sink{std::move(sink)}, m_buffer_size{buffer_size}
+{
+    m_buffer.reserve(m_buffer_size);
+}
+
+void JSONStreamWriter::Separate()
+{
+    if (m_after_key) {
+        m_after_key = false;
+        return;
+    }
+    if (m_empty.empty()) return;
+    if (!m_empty.back()) m_buffer += ',';
+    m_empty.back() = false;
+}
+
+void JSONStreamWriter::MaybeFlush()
+{
+    if (m_buffer.size() >= m_buffer_size) Flush();
+}
+
+void JSONStreamWriter::BeginObject()
+{
+    Separate();
+    m_buffer += '{';
+    m_empty.push_back(true);
+}
+
+void JSONStreamWriter::EndObject()
+{
+    CHECK_NONFATAL(!m_empty.empty() && !m_after_key);
+    m_empty.pop_back();
+    m_buffer += '}';
+    MaybeFlush();
+}
+
+void JSONStreamWriter::BeginArray()
+{
+    Separate();
+    m_buffer += '[';
+    m_empty.push_back(true);
+}
+
+void JSONStreamWriter::EndArray()
+{
+    CHECK_NONFATAL(!m_empty.empty() && !m_after_key);
+    m_empty.pop_back();
+    m_buffer += ']';
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Key(std::string_view key)
+{
+    Separate();
+    m_buffer += UniValue{std::string{key}}.write();
+    m_buffer += ':';
+    m_after_key = true;
+}
+
+void JSONStreamWriter::Value(const UniValue& value)
+{
+    Separate();
+    m_buffer += value.write();
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Fields(const UniValue& object)
+{
+    const std::vector<std::string>& keys{object.getKeys()};
+    const std::vector<UniValue>& values{object.getValues()};
+    for (size_t i{0}; i < keys.size(); ++i) {
+        Key(keys[i]);
+        Value(values[i]);
+    }
+}
+
+void JSONStreamWriter::Raw(std::string_view text)
+{
+    m_buffer += text;
+    MaybeFlush();
+}
+
+void JSONStreamWriter::Flush()
+{
+    if (m_buffer.empty()) return;
+    m_sink(m_buffer);
+    m_buffer.clear();
+}
@@ -529,4 +529,46 @@ std::vector<RPCResult> ScriptPubKeyDoc();
  */
 uint256 GetTarget(const CBlockIndex& blockindex, const uint256 pow_limit);
 
+/**
+ * Writer of JSON text in pieces, for results too large to be built as a whole
+ * UniValue and string. The structure is written with Begin/End calls and the
+ * values with UniValue, so that only one value at a time needs to be held,
+ * and the text is passed to the sink in pieces of about buffer_size bytes.
+ */
+class JSONStreamWriter
+{
+public:
+    using Sink = std::function<void(std::string_view text)>;
+    static constexpr size_t DEFAULT_BUFFER_SIZE{64 << 10};
+
+    explicit JSONStreamWriter(Sink sink, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+    //! Write the key of the next value, in an object.
+    void Key(std::string_view key);
+    void Value(const UniValue& value);
+    //! Write the keys and values of an object into the current object.
+    void Fields(const UniValue& object);
+    //! Write text as is, e.g. a newline after the top level value.
+    void Raw(std::string_view text);
+    //! Pass the buffered text to the sink.
+    void Flush();
+
+private:
+    //! Write the separator before a value or key.
+    void Separate();
+    void MaybeFlush();
+
+    const Sink m_sink;
+    const size_t m_buffer_size;
+    std::string m_buffer;
+    //! For each open object or array, whether nothing has been written in it yet.
+    std::vector<bool> m_empty;
+    //! Whether a key was just written, so that its value follows without separator.
+    bool m_after_key{false};
+};
+
 #endif // HYLIUM_RPC_UTIL_H
@@ -13,6 +13,8 @@
 #include <tinyformat.h>
 #include <uint256.h>
 
+#include <algorithm>
+
 typedef std::vector<unsigned char> valtype;
 
 namespace {
@@ -54,7 +56,8 @@ bool CastToBool(const valtype& vch)
  */
 #define stacktop(i) (stack.at(size_t(int64_t(stack.size()) + int64_t{i})))
 #define altstacktop(i) (altstack.at(size_t(int64_t(altstack.size()) + int64_t{i})))
-static inline void popstack(std::vector<valtype>& stack)
+template <typename Stack>
+static inline void popstack(Stack& stack)
 {
     if (stack.empty())
         throw std::runtime_error("popstack(): stack empty");
@@ -326,7 +329,9 @@ static bool EvalChecksigPreTapscript(const valtype& vchSig, const valtype& vchPu
     CScript scriptCode(pbegincodehash, pend);
 
     // Drop the signature in pre-segwit scripts but not segwit scripts
-    if (sigversion == SigVersion::BASE) {
+    // (a push of the signature is longer than it, so it cannot be in a shorter
+    // scriptCode, and the push is not built then)
+    if (sigversion == SigVersion::BASE && scriptCode.size() > vchSig.size()) {
         int found = FindAndDelete(scriptCode, CScript() << vchSig);
         if (found > 0 && (flags & SCRIPT_VERIFY_CONST_SCRIPTCODE))
             return set_error(serror, SCRIPT_ERR_SIG_FINDANDDELETE);
@@ -404,7 +409,8 @@ static bool EvalChecksig(const valtype& sig, const valtype& pubkey, CScript::con
     assert(false);
 }
 
-bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, script_verify_flags flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
+template <typename Stack>
+static bool EvalScriptImpl(Stack& stack, const CScript& script, script_verify_flags flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
 {
     static const CScriptNum bnZero(0);
     static const CScriptNum bnOne(1);
@@ -423,7 +429,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
     opcodetype opcode;
     valtype vchPushValue;
     ConditionStack vfExec;
-    std::vector<valtype> altstack;
+    Stack altstack;
     set_error(serror, SCRIPT_ERR_UNKNOWN_ERROR);
     if ((sigversion == SigVersion::BASE || sigversion == SigVersion::WITNESS_V0) && script.size() > MAX_SCRIPT_SIZE) {
         return set_error(serror, SCRIPT_ERR_SCRIPT_SIZE);
@@ -707,10 +713,10 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 -- x1 x2 x1 x2)
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch1 = stacktop(-2);
-                    valtype vch2 = stacktop(-1);
-                    stack.push_back(vch1);
-                    stack.push_back(vch2);
+                    // Items are pushed from the stack without copying them first
+                    // (see ScriptStack::push_back)
+                    stack.push_back(stacktop(-2));
+                    stack.push_back(stacktop(-2));
                 }
                 break;
 
@@ -719,12 +725,9 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 x3 -- x1 x2 x3 x1 x2 x3)
                     if (stack.size() < 3)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch1 = stacktop(-3);
-                    valtype vch2 = stacktop(-2);
-                    valtype vch3 = stacktop(-1);
-                    stack.push_back(vch1);
-                    stack.push_back(vch2);
-                    stack.push_back(vch3);
+                    stack.push_back(stacktop(-3));
+                    stack.push_back(stacktop(-3));
+                    stack.push_back(stacktop(-3));
                 }
                 break;
 
@@ -733,10 +736,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 x3 x4 -- x1 x2 x3 x4 x1 x2)
                     if (stack.size() < 4)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch1 = stacktop(-4);
-                    valtype vch2 = stacktop(-3);
-                    stack.push_back(vch1);
-                    stack.push_back(vch2);
+                    stack.push_back(stacktop(-4));
+                    stack.push_back(stacktop(-4));
                 }
                 break;
 
@@ -745,11 +746,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 x3 x4 x5 x6 -- x3 x4 x5 x6 x1 x2)
                     if (stack.size() < 6)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch1 = stacktop(-6);
-                    valtype vch2 = stacktop(-5);
-                    stack.erase(stack.end()-6, stack.end()-4);
-                    stack.push_back(vch1);
-                    stack.push_back(vch2);
+                    std::rotate(stack.end()-6, stack.end()-4, stack.end());
                 }
                 break;
 
@@ -768,9 +765,8 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x - 0 | x x)
                     if (stack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-1);
-                    if (CastToBool(vch))
-                        stack.push_back(vch);
+                    if (CastToBool(stacktop(-1)))
+                        stack.push_back(stacktop(-1));
                 }
                 break;
 
@@ -796,8 +792,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x -- x x)
                     if (stack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-1);
-                    stack.push_back(vch);
+                    stack.push_back(stacktop(-1));
                 }
                 break;
 
@@ -815,8 +810,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 -- x1 x2 x1)
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-2);
-                    stack.push_back(vch);
+                    stack.push_back(stacktop(-2));
                 }
                 break;
 
@@ -831,10 +825,10 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     popstack(stack);
                     if (n < 0 || n >= (int)stack.size())
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-n-1);
                     if (opcode == OP_ROLL)
-                        stack.erase(stack.end()-n-1);
-                    stack.push_back(vch);
+                        std::rotate(stack.end()-n-1, stack.end()-n, stack.end());
+                    else
+                        stack.push_back(stacktop(-n-1));
                 }
                 break;
 
@@ -864,8 +858,7 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     // (x1 x2 -- x2 x1 x2)
                     if (stack.size() < 2)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
-                    valtype vch = stacktop(-1);
-                    stack.insert(stack.end()-2, vch);
+                    stack.insert(stack.end()-2, stacktop(-1));
                 }
                 break;
 
@@ -1029,19 +1022,21 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
                     if (stack.size() < 1)
                         return set_error(serror, SCRIPT_ERR_INVALID_STACK_OPERATION);
                     valtype& vch = stacktop(-1);
-                    valtype vchHash((opcode == OP_RIPEMD160 || opcode == OP_SHA1 || opcode == OP_HASH160) ? 20 : 32);
+                    // Hashed into a local array, so that pushing it can reuse a popped item (see ScriptStack)
+                    unsigned char vchHash[CSHA256::OUTPUT_SIZE];
+                    const size_t hash_size = (opcode == OP_RIPEMD160 || opcode == OP_SHA1 || opcode == OP_HASH160) ? 20 : 32;
                     if (opcode == OP_RIPEMD160)
-                        CRIPEMD160().Write(vch.data(), vch.size()).Finalize(vchHash.data());
+                        CRIPEMD160().Write(vch.data(), vch.size()).Finalize(vchHash);
                     else if (opcode == OP_SHA1)
-                        CSHA1().Write(vch.data(), vch.size()).Finalize(vchHash.data());
+                        CSHA1().Write(vch.data(), vch.size()).Finalize(vchHash);
                     else if (opcode == OP_SHA256)
-                        CSHA256().Write(vch.data(), vch.size()).Finalize(vchHash.data());
+                        CSHA256().Write(vch.data(), vch.size()).Finalize(vchHash);
                     else if (opcode == OP_HASH160)
-                        CHash160().Write(vch).Finalize(vchHash);
+                        CHash160().Write(vch).Finalize(std::span{vchHash}.first(hash_size));
                     else if (opcode == OP_HASH256)
-                        CHash256().Write(vch).Finalize(vchHash);
+                        CHash256().Write(vch).Finalize(std::span{vchHash}.first(hash_size));
                     popstack(stack);
-                    stack.push_back(vchHash);
+                    stack.emplace_back(vchHash, vchHash + hash_size);
                 }
                 break;
 
@@ -1234,12 +1229,28 @@ bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript&
     return set_success(serror);
 }
 
+bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, script_verify_flags flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
+{
+    return EvalScriptImpl(stack, script, flags, checker, sigversion, execdata, serror);
+}
+
+bool EvalScript(ScriptStack& stack, const CScript& script, script_verify_flags flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* serror)
+{
+    return EvalScriptImpl(stack, script, flags, checker, sigversion, execdata, serror);
+}
+
 bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, script_verify_flags flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror)
 {
     ScriptExecutionData execdata;
     return EvalScript(stack, script, flags, checker, sigversion, execdata, serror);
 }
 
+bool EvalScript(ScriptStack& stack, const CScript& script, script_verify_flags flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* serror)
+{
+    ScriptExecutionData execdata;
+    return EvalScript(stack, script, flags, checker, sigversion, execdata, serror);
+}
+
 namespace {
 
 /**
@@ -1432,6 +1443,10 @@ void PrecomputedTransactionData::Init(const T& txTo, std::vector<CTxOut>&& spent
         if (uses_bip341_taproot && uses_bip143_segwit) break; // No need to scan further if we already need all.
     }
 
+    // Precomputed hashes that were kept from an earlier Init are still valid.
+    uses_bip143_segwit &= !m_bip143_segwit_ready;
+    uses_bip341_taproot &= !m_bip341_taproot_ready;
+
     if (uses_bip143_segwit || uses_bip341_taproot) {
         // Computations shared between both sighash schemes.
         m_prevouts_single_hash = GetPrevoutsSHA256(txTo);
@@ -1457,6 +1472,22 @@ PrecomputedTransactionData::PrecomputedTransactionData(const T& txTo)
     Init(txTo, {});
 }
 
+PrecomputedTransactionData PrecomputedTransactionData::HashesOnly() const
+{
+    PrecomputedTransactionData hashes;
+    hashes.m_prevouts_single_hash = m_prevouts_single_hash;
+    hashes.m_sequences_single_hash = m_sequences_single_hash;
+    hashes.m_outputs_single_hash = m_outputs_single_hash;
+    hashes.m_spent_amounts_single_hash = m_spent_amounts_single_hash;
+    hashes.m_spent_scripts_single_hash = m_spent_scripts_single_hash;
+    hashes.m_bip341_taproot_ready = m_bip341_taproot_ready;
+    hashes.hashPrevouts = hashPrevouts;
+    hashes.hashSequence = hashSequence;
+    hashes.hashOutputs = hashOutputs;
+    hashes.m_bip143_segwit_ready = m_bip143_segwit_ready;
+    return hashes;
+}
+
 // explicit instantiation
 template void PrecomputedTransactionData::Init(const CTransaction& txTo, std::vector<CTxOut>&& spent_outputs, bool force);
 template void PrecomputedTransactionData::Init(const CMutableTransaction& txTo, std::vector<CTxOut>&& spent_outputs, bool force);
@@ -1831,8 +1862,6 @@ template class GenericTransactionSignatureChecker<CMutableTransaction>;
 
 static bool ExecuteWitnessScript(const std::span<const valtype>& stack_span, const CScript& exec_script, script_verify_flags flags, SigVersion sigversion, const BaseSignatureChecker& checker, ScriptExecutionData& execdata, ScriptError* serror)
 {
-    std::vector<valtype> stack{stack_span.begin(), stack_span.end()};
-
     if (sigversion == SigVersion::TAPSCRIPT) {
         // OP_SUCCESSx processing overrides everything, including stack element size limits
         CScript::const_iterator pc = exec_script.begin();
@@ -1852,14 +1881,22 @@ static bool ExecuteWitnessScript(const std::span<const valtype>& stack_span, con
         }
 
         // Tapscript enforces initial stack size limits (altstack is empty here)
-        if (stack.size() > MAX_STACK_SIZE) return set_error(serror, SCRIPT_ERR_STACK_SIZE);
+        if (stack_span.size() > MAX_STACK_SIZE) return set_error(serror, SCRIPT_ERR_STACK_SIZE);
     }
 
     // Disallow stack item size > MAX_SCRIPT_ELEMENT_SIZE in witness stack
-    for (const valtype& elem : stack) {
+    for (const valtype& elem : stack_span) {
         if (elem.size() > MAX_SCRIPT_ELEMENT_SIZE) return set_error(serror, SCRIPT_ERR_PUSH_SIZE);
     }
 
+    // Reused by the inputs verified on this thread, like the stacks in
+    // VerifyScriptImpl, unless it has more items than a script can leave.
+    static thread_local ScriptStack reused_stack;
+    ScriptStack oversized_stack;
+    ScriptStack& stack{stack_span.size() <= MAX_STACK_SIZE ? reused_stack : oversized_stack};
+    stack.clear();
+    for (const valtype& item : stack_span) stack.push_back(item);
+
     // Run the script interpreter.
     if (!EvalScript(stack, exec_script, flags, checker, sigversion, execdata, serror)) return false;
 
@@ -1914,7 +1951,33 @@ static bool VerifyTaprootCommitment(const std::vector<unsigned char>& control, c
     return q.CheckTapTweak(p, merkle_root, control[0] & 1);
 }
 
-static bool VerifyWitnessProgram(const CScriptWitness& witness, int witversion, const std::vector<unsigned char>& program, script_verify_flags flags, const BaseSignatureChecker& checker, ScriptError* serror, bool is_p2sh)
+/** Verify a P2WPKH spend the way executing OP_DUP OP_HASH160 <program>
+ *  OP_EQUALVERIFY OP_CHECKSIG on its two witness items would (including the
+ *  checks of ExecuteWitnessScript), but without copying them to a stack and
+ *  running the interpreter. */
+static bool VerifyWitnessKeyHash(std::span<const valtype> stack, const std::vector<unsigned char>& program, script_verify_flags flags, const BaseSignatureChecker& checker, ScriptError* serror)
+{
+    assert(stack.size() == 2 && program.size() == WITNESS_V0_KEYHASH_SIZE);
+    const valtype& sig = stack[0];
+    const valtype& pubkey = stack[1];
+    if (sig.size() > MAX_SCRIPT_ELEMENT_SIZE || pubkey.size() > MAX_SCRIPT_ELEMENT_SIZE) {
+        return set_error(serror, SCRIPT_ERR_PUSH_SIZE);
+    }
+    if (Hash160(pubkey) != uint160{program}) {
+        return set_error(serror, SCRIPT_ERR_EQUALVERIFY);
+    }
+    // The scriptCode is the implied script, which fits in a CScript without allocating
+    const CScript script_code = CScript() << OP_DUP << OP_HASH160 << program << OP_EQUALVERIFY << OP_CHECKSIG;
+    bool success;
+    if (!EvalChecksigPreTapscript(sig, pubkey, script_code.begin(), script_code.end(), flags, checker, SigVersion::WITNESS_V0, serror, success)) {
+        return false; // serror is set
+    }
+    // The result of OP_CHECKSIG is the only item left
+    if (!success) return set_error(serror, SCRIPT_ERR_EVAL_FALSE);
+    return set_success(serror);
+}
+
+static bool VerifyWitnessProgram(const CScriptWitness& witness, int witversion, const std::vector<unsigned char>& program, script_verify_flags flags, const BaseSignatureChecker& checker, ScriptError* serror, bool is_p2sh, bool fast_paths)
 {
     CScript exec_script; //!< Actually executed script (last stack item in P2WSH; implied P2PKH script in P2WPKH; leaf script in P2TR)
     std::span stack{witness.stack};
@@ -1939,6 +2002,7 @@ static bool VerifyWitnessProgram(const CScriptWitness& witness, int witversion,
             if (stack.size() != 2) {
                 return set_error(serror, SCRIPT_ERR_WITNESS_PROGRAM_MISMATCH); // 2 items in witness
             }
+            if (fast_paths) return VerifyWitnessKeyHash(stack, program, flags, checker, serror);
             exec_script << OP_DUP << OP_HASH160 << program << OP_EQUALVERIFY << OP_CHECKSIG;
             return ExecuteWitnessScript(stack, exec_script, flags, SigVersion::WITNESS_V0, checker, execdata, serror);
         } else {
@@ -1999,7 +2063,7 @@ static bool VerifyWitnessProgram(const CScriptWitness& witness, int witversion,
     // There is intentionally no return statement here, to be able to use "control reaches end of non-void function" warnings to detect gaps in the logic above.
 }
 
-bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, script_verify_flags flags, const BaseSignatureChecker& checker, ScriptError* serror)
+static bool VerifyScriptImpl(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, script_verify_flags flags, const BaseSignatureChecker& checker, ScriptError* serror, bool fast_paths)
 {
     static const CScriptWitness emptyWitness;
     if (witness == nullptr) {
@@ -2009,13 +2073,37 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
 
     set_error(serror, SCRIPT_ERR_UNKNOWN_ERROR);
 
+    // Native witness programs, like P2WPKH and P2TR outputs: the empty scriptSig
+    // pushes nothing, and the scriptPubKey pushes the version and the program,
+    // so only the program is left to check before the witness is verified.
+    int witnessversion;
+    std::vector<unsigned char> witnessprogram;
+    if (fast_paths && scriptSig.empty() && (flags & SCRIPT_VERIFY_WITNESS) && scriptPubKey.IsWitnessProgram(witnessversion, witnessprogram)) {
+        if (!CastToBool(witnessprogram)) {
+            return set_error(serror, SCRIPT_ERR_EVAL_FALSE);
+        }
+        if (!VerifyWitnessProgram(*witness, witnessversion, witnessprogram, flags, checker, serror, /*is_p2sh=*/false, fast_paths)) {
+            return false;
+        }
+        // As below, after which the stack is a single item and the witness was expected
+        assert((flags & SCRIPT_VERIFY_P2SH) != 0);
+        return set_success(serror);
+    }
+
     if ((flags & SCRIPT_VERIFY_SIGPUSHONLY) != 0 && !scriptSig.IsPushOnly()) {
         return set_error(serror, SCRIPT_ERR_SIG_PUSHONLY);
     }
 
     // scriptSig and scriptPubKey must be evaluated sequentially on the same stack
     // rather than being simply concatenated (see CVE-2010-5141)
-    std::vector<std::vector<unsigned char> > stack, stackCopy;
+    //
+    // The stacks are reused by the inputs verified on this thread, so that once
+    // it has verified a few inputs, their pushes reuse the buffers of earlier
+    // items rather than allocating. What they keep is bounded by the stack size
+    // and element size limits.
+    static thread_local ScriptStack stack, stackCopy;
+    stack.clear();
+    stackCopy.clear();
     if (!EvalScript(stack, scriptSig, flags, checker, SigVersion::BASE, serror))
         // serror is set
         return false;
@@ -2030,8 +2118,6 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
         return set_error(serror, SCRIPT_ERR_EVAL_FALSE);
 
     // Bare witness programs
-    int witnessversion;
-    std::vector<unsigned char> witnessprogram;
     if (flags & SCRIPT_VERIFY_WITNESS) {
         if (scriptPubKey.IsWitnessProgram(witnessversion, witnessprogram)) {
             hadWitness = true;
@@ -2039,7 +2125,7 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
                 // The scriptSig must be _exactly_ CScript(), otherwise we reintroduce malleability.
                 return set_error(serror, SCRIPT_ERR_WITNESS_MALLEATED);
             }
-            if (!VerifyWitnessProgram(*witness, witnessversion, witnessprogram, flags, checker, serror, /*is_p2sh=*/false)) {
+            if (!VerifyWitnessProgram(*witness, witnessversion, witnessprogram, flags, checker, serror, /*is_p2sh=*/false, fast_paths)) {
                 return false;
             }
             // Bypass the cleanstack check at the end. The actual stack is obviously not clean
@@ -2084,7 +2170,7 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
                     // reintroduce malleability.
                     return set_error(serror, SCRIPT_ERR_WITNESS_MALLEATED_P2SH);
                 }
-                if (!VerifyWitnessProgram(*witness, witnessversion, witnessprogram, flags, checker, serror, /*is_p2sh=*/true)) {
+                if (!VerifyWitnessProgram(*witness, witnessversion, witnessprogram, flags, checker, serror, /*is_p2sh=*/true, fast_paths)) {
                     return false;
                 }
                 // Bypass the cleanstack check at the end. The actual stack is obviously not clean
@@ -2120,6 +2206,16 @@ bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const C
     return set_success(serror);
 }
 
+bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, script_verify_flags flags, const BaseSignatureChecker& checker, ScriptError* serror)
+{
+    return VerifyScriptImpl(scriptSig, scriptPubKey, witness, flags, checker, serror, /*fast_paths=*/true);
+}
+
+bool VerifyScriptGeneric(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, script_verify_flags flags, const BaseSignatureChecker& checker, ScriptError* serror)
+{
+    return VerifyScriptImpl(scriptSig, scriptPubKey, witness, flags, checker, serror, /*fast_paths=*/false);
+}
+
 size_t static WitnessSigOps(int witversion, const std::vector<unsigned char>& witprogram, const CScriptWitness& witness)
 {
     if (witversion == 0) {
@@ -10,6 +10,7 @@
 #include <hash.h>
 #include <primitives/transaction.h>
 #include <script/script_error.h> // IWYU pragma: export
+#include <script/script_stack.h>
 #include <script/verify_flags.h> // IWYU pragma: export
 #include <span.h>
 #include <uint256.h>
@@ -189,10 +190,17 @@ struct PrecomputedTransactionData
      * @param[in]   spent_outputs  The CTxOuts being spent, one for each tx.vin, in order.
      * @param[in]   force          Whether to precompute data for all optional features,
      *                             regardless of what is in the inputs (used at signing
-     *                             time, when the inputs aren't filled in yet). */
+     *                             time, when the inputs aren't filled in yet).
+     *
+     * Hashes that are already marked ready, like those of a copy made with
+     * HashesOnly(), are kept and not computed again. */
     template <class T>
     void Init(const T& tx, std::vector<CTxOut>&& spent_outputs, bool force = false);
 
+    /** A copy with the precomputed hashes only, without the spent outputs, to
+     *  be kept along with the transaction and passed to Init again later. */
+    PrecomputedTransactionData HashesOnly() const;
+
     template <class T>
     explicit PrecomputedTransactionData(const T& tx);
 };
@@ -375,7 +383,13 @@ uint256 ComputeTaprootMerkleRoot(std::span<const unsigned char> control, const u
 
 bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, script_verify_flags flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* error = nullptr);
 bool EvalScript(std::vector<std::vector<unsigned char> >& stack, const CScript& script, script_verify_flags flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* error = nullptr);
+//! Evaluate a script on a ScriptStack, which reuses the buffers of the items it pops
+bool EvalScript(ScriptStack& stack, const CScript& script, script_verify_flags flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptExecutionData& execdata, ScriptError* error = nullptr);
+bool EvalScript(ScriptStack& stack, const CScript& script, script_verify_flags flags, const BaseSignatureChecker& checker, SigVersion sigversion, ScriptError* error = nullptr);
 bool VerifyScript(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, script_verify_flags flags, const BaseSignatureChecker& checker, ScriptError* serror = nullptr);
+/** VerifyScript without its fast paths for standard templates (native witness
+ *  programs and P2WPKH), which skip the interpreter. Only for testing them. */
+bool VerifyScriptGeneric(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness* witness, script_verify_flags flags, const BaseSignatureChecker& checker, ScriptError* serror = nullptr);
 
 size_t CountWitnessSigOps(const CScript& scriptSig, const CScript& scriptPubKey, const CScriptWitness& witness, script_verify_flags flags);
 
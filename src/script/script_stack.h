@@ -0,0 +1,136 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef HYLIUM_SCRIPT_SCRIPT_STACK_H
+#define HYLIUM_SCRIPT_SCRIPT_STACK_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/**
+ * The stack (or altstack) of a script execution, used like a
+ * std::vector<std::vector<unsigned char>>. Its items are not destroyed when
+ * they are popped: they keep their buffers, which the next pushes copy into.
+ * So once a stack has held as many and as large items as the scripts it runs
+ * push, pushes and pops don't allocate. A stack is meant to be used for all
+ * the scripts of an input (see VerifyScript), and cleared in between.
+ *
+ * The items stay std::vector<unsigned char>, as that is what signature
+ * checkers and CScriptNum take.
+ */
+class ScriptStack
+{
+public:
+    using value_type = std::vector<unsigned char>;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+
+private:
+    //! Items, of which the first m_size are on the stack, and the others kept for their buffers
+    std::vector<value_type> m_items;
+    size_t m_size{0};
+
+public:
+    ScriptStack() = default;
+    ScriptStack(const ScriptStack& other) { *this = other; }
+    ScriptStack(ScriptStack&& other) noexcept { swap(*this, other); }
+    ScriptStack& operator=(const ScriptStack& other)
+    {
+        if (this != &other) {
+            clear();
+            for (const value_type& item : other) push_back(item);
+        }
+        return *this;
+    }
+    ScriptStack& operator=(ScriptStack&& other) noexcept
+    {
+        swap(*this, other);
+        return *this;
+    }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    iterator begin() { return m_items.data(); }
+    iterator end() { return m_items.data() + m_size; }
+    const_iterator begin() const { return m_items.data(); }
+    const_iterator end() const { return m_items.data() + m_size; }
+
+    value_type& operator[](size_t pos) { return m_items[pos]; }
+    const value_type& operator[](size_t pos) const { return m_items[pos]; }
+    value_type& at(size_t pos)
+    {
+        if (pos >= m_size) throw std::out_of_range("ScriptStack::at");
+        return m_items[pos];
+    }
+    value_type& back() { assert(m_size > 0); return m_items[m_size - 1]; }
+    const value_type& back() const { assert(m_size > 0); return m_items[m_size - 1]; }
+
+    /** Push a copy of item, which may be on the stack (but not popped from it). */
+    void push_back(const value_type& item) { emplace_back(item.begin(), item.end()); }
+
+    /** Push an item with the bytes in [first, last). */
+    template <typename It>
+    void emplace_back(It first, It last)
+    {
+        if (m_size == m_items.size()) {
+            m_items.emplace_back(first, last);
+        } else {
+            m_items[m_size].assign(first, last);
+        }
+        ++m_size;
+    }
+
+    void pop_back()
+    {
+        assert(m_size > 0);
+        --m_size;
+    }
+
+    /** Push a copy of item before pos, like std::vector::insert. */
+    iterator insert(const_iterator pos, const value_type& item)
+    {
+        const size_t index = pos - begin();
+        push_back(item);
+        std::rotate(begin() + index, end() - 1, end());
+        return begin() + index;
+    }
+
+    /** Remove items, like std::vector::erase, keeping their buffers. */
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        const iterator it = begin() + (first - begin());
+        std::rotate(it, it + (last - first), end());
+        m_size -= last - first;
+        return it;
+    }
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    /** Resize, with empty items if it grows. */
+    void resize(size_t size)
+    {
+        for (; m_size < size; ++m_size) {
+            if (m_size == m_items.size()) {
+                m_items.emplace_back();
+            } else {
+                m_items[m_size].clear();
+            }
+        }
+        m_size = size;
+    }
+
+    void clear() { m_size = 0; }
+
+    friend void swap(ScriptStack& a, ScriptStack& b) noexcept
+    {
+        a.m_items.swap(b.m_items);
+        std::swap(a.m_size, b.m_size);
+    }
+};
+
+#endif // HYLIUM_SCRIPT_SCRIPT_STACK_H
@@ -0,0 +1,127 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef HYLIUM_SUPPORT_ALLOCATORS_CHUNK_ARENA_H
+#define HYLIUM_SUPPORT_ALLOCATORS_CHUNK_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+template <typename T>
+class ChunkArenaAllocator;
+
+/**
+ * A monotonic memory resource for objects that are created together, like the
+ * transactions of a block, and their parts. Memory is carved out of large
+ * chunks and never freed on its own. Instead, each object holds the chunk it
+ * starts in, through the ChunkArenaAllocator it is created with (see
+ * std::allocate_shared), and a chunk is freed once all objects in it are. So
+ * an object kept after the others, like a transaction of a block added to a
+ * wallet, only keeps its chunk allocated, not those of the others.
+ *
+ * The parts of an object, like its scripts, are allocated with Allocate after
+ * the object is started with StartObject and before the next one is, so that
+ * they are in the chunk it holds.
+ *
+ * ChunkArena is not thread-safe.
+ */
+class ChunkArena
+{
+    const size_t m_chunk_size;
+    std::shared_ptr<std::byte[]> m_chunk;
+    size_t m_capacity{0};
+    size_t m_used{0};
+    size_t m_chunks{0};
+
+    template <typename T>
+    friend class ChunkArenaAllocator;
+
+public:
+    explicit ChunkArena(size_t chunk_size) : m_chunk_size{chunk_size} {}
+
+    /**
+     * Start an object, in a new chunk if the current one has less than
+     * min_free bytes left. The returned allocator holds the chunk.
+     */
+    template <typename T>
+    ChunkArenaAllocator<T> StartObject(size_t min_free)
+    {
+        if (m_capacity - m_used < min_free) {
+            m_capacity = std::max(m_chunk_size, min_free);
+            m_chunk = std::make_shared_for_overwrite<std::byte[]>(m_capacity);
+            m_used = 0;
+            ++m_chunks;
+        }
+        return ChunkArenaAllocator<T>{m_chunk, m_capacity, this};
+    }
+
+    /** Memory in the current chunk, or nullptr if it doesn't have room. */
+    void* Allocate(size_t bytes, size_t alignment) noexcept
+    {
+        if (!m_chunk) return nullptr;
+        void* ptr{m_chunk.get() + m_used};
+        size_t space{m_capacity - m_used};
+        if (!std::align(alignment, bytes, ptr, space)) return nullptr;
+        m_used = m_capacity - space + bytes;
+        return ptr;
+    }
+
+    /** Number of chunks allocated so far. */
+    size_t ChunkCount() const noexcept { return m_chunks; }
+};
+
+/**
+ * Allocates from the chunk of a ChunkArena an object was started in, and holds
+ * the chunk. Allocations that don't fit in it use operator new().
+ */
+template <typename T>
+class ChunkArenaAllocator
+{
+    std::shared_ptr<std::byte[]> m_chunk;
+    size_t m_capacity;
+    //! The arena, only used while the object is created
+    ChunkArena* m_arena;
+
+    template <typename U>
+    friend class ChunkArenaAllocator;
+    friend class ChunkArena;
+
+    ChunkArenaAllocator(std::shared_ptr<std::byte[]> chunk, size_t capacity, ChunkArena* arena) noexcept
+        : m_chunk{std::move(chunk)}, m_capacity{capacity}, m_arena{arena} {}
+
+    bool InChunk(const T* ptr) const noexcept
+    {
+        const std::byte* const begin{m_chunk.get()};
+        return begin && reinterpret_cast<const std::byte*>(ptr) >= begin && reinterpret_cast<const std::byte*>(ptr) < begin + m_capacity;
+    }
+
+public:
+    using value_type = T;
+
+    template <typename U>
+    ChunkArenaAllocator(const ChunkArenaAllocator<U>& other) noexcept
+        : m_chunk{other.m_chunk}, m_capacity{other.m_capacity}, m_arena{other.m_arena} {}
+
+    T* allocate(size_t n)
+    {
+        if (m_arena && m_arena->m_chunk == m_chunk) {
+            if (void* ptr{m_arena->Allocate(n * sizeof(T), alignof(T))}) return static_cast<T*>(ptr);
+        }
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) noexcept
+    {
+        if (!InChunk(ptr)) std::allocator<T>{}.deallocate(ptr, n);
+    }
+
+    friend bool operator==(const ChunkArenaAllocator& a, const ChunkArenaAllocator& b) noexcept
+    {
+        return a.m_chunk == b.m_chunk;
+    }
+};
+
+#endif // HYLIUM_SUPPORT_ALLOCATORS_CHUNK_ARENA_H
@@ -0,0 +1,132 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <consensus/merkle.h>
+#include <consensus/validation.h>
+#include <primitives/block.h>
+#include <primitives/block_view.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <serialize.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <ios>
+#include <stdexcept>
+#include <vector>
+
+BOOST_FIXTURE_TEST_SUITE(block_view_tests, BasicTestingSetup)
+
+static CBlock MakeBlock(FastRandomContext& rng)
+{
+    CBlock block;
+    block.nVersion = 4;
+    block.hashPrevBlock = rng.rand256();
+    block.nTime = 1234;
+    block.nBits = 0x207fffff;
+
+    CMutableTransaction coinbase;
+    coinbase.vin.emplace_back();
+    coinbase.vin[0].scriptSig = CScript() << OP_1 << OP_0;
+    coinbase.vout.emplace_back(50 * COIN, CScript() << OP_TRUE);
+    block.vtx.push_back(MakeTransactionRef(coinbase));
+
+    // Witnesses for some inputs only
+    CMutableTransaction witness_tx;
+    for (int i = 0; i < 3; ++i) {
+        witness_tx.vin.emplace_back(Txid::FromUint256(rng.rand256()), i);
+        witness_tx.vout.emplace_back(i * COIN, CScript() << rng.randbytes(20 + i));
+    }
+    witness_tx.vin[1].scriptWitness.stack = {rng.randbytes(72), rng.randbytes(33)};
+    witness_tx.nLockTime = 99;
+    block.vtx.push_back(MakeTransactionRef(witness_tx));
+
+    CMutableTransaction legacy_tx;
+    legacy_tx.vin.emplace_back(Txid::FromUint256(rng.rand256()), 7);
+    legacy_tx.vin[0].scriptSig = CScript() << rng.randbytes(71);
+    legacy_tx.vout.emplace_back(COIN, CScript());
+    block.vtx.push_back(MakeTransactionRef(legacy_tx));
+
+    // Serialized like the marker of a witness transaction with no flag
+    block.vtx.push_back(MakeTransactionRef(CMutableTransaction{}));
+    return block;
+}
+
+BOOST_AUTO_TEST_CASE(block_view_matches_block)
+{
+    const CBlock block{MakeBlock(m_rng)};
+    DataStream stream{};
+    stream << TX_WITH_WITNESS(block);
+    const std::vector<std::byte> data{stream.begin(), stream.end()};
+    const BlockView view{data};
+
+    BOOST_CHECK_EQUAL(view.GetHash(), block.GetHash());
+    BOOST_CHECK_EQUAL(view.Header().hashPrevBlock, block.hashPrevBlock);
+    BOOST_REQUIRE_EQUAL(view.TxCount(), block.vtx.size());
+    // As the transactions are located by the txindex
+    uint32_t tx_offset{uint32_t(GetSizeOfCompactSize(block.vtx.size()))};
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const CTransaction& tx{*block.vtx[i]};
+        BOOST_CHECK_EQUAL(view.GetTxid(i), tx.GetHash());
+        BOOST_CHECK_EQUAL(view.GetWtxid(i), tx.GetWitnessHash());
+        BOOST_CHECK_EQUAL(view.Layout(i).HasWitness(), tx.HasWitness());
+        BOOST_CHECK_EQUAL(view.TxOffset(i), tx_offset);
+        tx_offset += ::GetSerializeSize(TX_WITH_WITNESS(tx));
+        BOOST_CHECK(*view.GetTransaction(i) == tx);
+        BOOST_REQUIRE_EQUAL(view.InputCount(i), tx.vin.size());
+        BOOST_REQUIRE_EQUAL(view.OutputCount(i), tx.vout.size());
+        for (uint32_t n = 0; n < tx.vin.size(); ++n) BOOST_CHECK(view.GetInput(i, n) == tx.vin[n]);
+        for (uint32_t n = 0; n < tx.vout.size(); ++n) BOOST_CHECK(view.GetOutput(i, n) == tx.vout[n]);
+        BOOST_CHECK_THROW(view.GetInput(i, tx.vin.size()), std::out_of_range);
+        BOOST_CHECK_THROW(view.GetOutput(i, tx.vout.size()), std::out_of_range);
+    }
+    BOOST_CHECK(std::ranges::equal(view.GetTxids(), block.vtx, {}, {}, [](const auto& tx) { return tx->GetHash(); }));
+    BOOST_CHECK(std::ranges::equal(view.GetWtxids(), block.vtx, {}, {}, [](const auto& tx) { return tx->GetWitnessHash(); }));
+    BOOST_CHECK_EQUAL(BlockMerkleRoot(view), BlockMerkleRoot(block));
+    BOOST_CHECK_EQUAL(BlockWitnessMerkleRoot(view), BlockWitnessMerkleRoot(block));
+    BOOST_CHECK_THROW(view.GetTxid(block.vtx.size()), std::out_of_range);
+
+    BOOST_CHECK_EQUAL(view.Size(), data.size());
+    BOOST_CHECK_EQUAL(view.StrippedSize(), ::GetSerializeSize(TX_NO_WITNESS(block)));
+    BOOST_CHECK_EQUAL(view.Weight(), GetBlockWeight(block));
+}
+
+BOOST_AUTO_TEST_CASE(block_view_invalid)
+{
+    const CBlock block{MakeBlock(m_rng)};
+    DataStream stream{};
+    stream << TX_WITH_WITNESS(block);
+    std::vector<std::byte> data{stream.begin(), stream.end()};
+
+    for (size_t size = 0; size < data.size(); ++size) {
+        BOOST_CHECK_THROW(BlockView{std::span{data}.first(size)}, std::ios_base::failure);
+    }
+
+    // A witness flag with all witness stacks empty
+    CMutableTransaction tx;
+    tx.vin.emplace_back(Txid::FromUint256(m_rng.rand256()), 0);
+    tx.vout.emplace_back(COIN, CScript());
+    DataStream tx_stream{};
+    tx_stream << TX_NO_WITNESS(tx);
+    std::vector<std::byte> bad_tx{tx_stream.begin(), tx_stream.end()};
+    // The marker and flag after the version, and an empty stack before the lock time
+    bad_tx.insert(bad_tx.begin() + 4, {std::byte{0x00}, std::byte{0x01}});
+    bad_tx.insert(bad_tx.end() - 4, std::byte{0x00});
+    DataStream bad_block{};
+    bad_block << block.GetBlockHeader() << CompactSizeWriter(1);
+    bad_block.write(bad_tx);
+    BOOST_CHECK_EXCEPTION(BlockView{bad_block}, std::ios_base::failure, HasReason{"Superfluous witness record"});
+
+    // An unknown flag
+    bad_tx[5] = std::byte{0x02};
+    DataStream bad_flag_block{};
+    bad_flag_block << block.GetBlockHeader() << CompactSizeWriter(1);
+    bad_flag_block.write(bad_tx);
+    BOOST_CHECK_EXCEPTION(BlockView{bad_flag_block}, std::ios_base::failure, HasReason{"Unknown transaction optional data"});
+}
+
+BOOST_AUTO_TEST_SUITE_END()
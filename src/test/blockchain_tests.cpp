@@ -4,14 +4,17 @@
 
 #include <chain.h>
 #include <node/blockstorage.h>
+#include <node/kernel_notifications.h>
 #include <rpc/blockchain.h>
 #include <sync.h>
 #include <test/util/setup_common.h>
 #include <util/string.h>
+#include <validation.h>
 
 #include <boost/test/unit_test.hpp>
 
 #include <cstdlib>
+#include <memory>
 
 using util::ToString;
 
@@ -117,6 +120,40 @@ BOOST_AUTO_TEST_CASE(num_chain_tx_max)
     BOOST_CHECK_EQUAL(block_index.m_chain_tx_count, std::numeric_limits<uint64_t>::max());
 }
 
+BOOST_AUTO_TEST_CASE(tip_waiters)
+{
+    node::KernelNotifications notifications{Assert(m_node.shutdown_request), m_node.exit_status, *Assert(m_node.warnings)};
+    const uint256 hash_a{uint256::ONE}, hash_b{2};
+    CBlockIndex block_a, block_b;
+    block_a.phashBlock = &hash_a;
+    block_b.phashBlock = &hash_b;
+
+    int woken{0};
+    auto state{std::make_shared<int>()};
+    const auto wake{[&woken, state] { ++woken; }};
+
+    // Waiters are woken once the tip is set and differs from theirs
+    notifications.WaitTipChangedAsync(hash_a, wake);
+    BOOST_CHECK(notifications.blockTip(SynchronizationState::POST_INIT, block_a, 1.0).index() == 0);
+    BOOST_CHECK_EQUAL(woken, 0);
+    notifications.WaitTipChangedAsync(hash_a, wake);
+    BOOST_CHECK(notifications.blockTip(SynchronizationState::POST_INIT, block_b, 1.0).index() == 0);
+    BOOST_CHECK_EQUAL(woken, 2);
+    notifications.WaitTipChangedAsync(hash_a, wake);
+    BOOST_CHECK_EQUAL(woken, 3);
+    BOOST_CHECK_EQUAL(state.use_count(), 2);
+
+    // A cancelled waiter, and what its callback holds, is dropped right away
+    const uint64_t id{notifications.WaitTipChangedAsync(hash_b, wake)};
+    BOOST_CHECK_EQUAL(state.use_count(), 3);
+    notifications.CancelTipWaiter(id);
+    BOOST_CHECK_EQUAL(state.use_count(), 2);
+    BOOST_CHECK(notifications.blockTip(SynchronizationState::POST_INIT, block_a, 1.0).index() == 0);
+    BOOST_CHECK_EQUAL(woken, 3);
+    // Cancelling a waiter already woken has no effect
+    notifications.CancelTipWaiter(id);
+}
+
 BOOST_FIXTURE_TEST_CASE(invalidate_block, TestChain100Setup)
 {
     const CChain& active{*WITH_LOCK(Assert(m_node.chainman)->GetMutex(), return &Assert(m_node.chainman)->ActiveChain())};
@@ -269,6 +269,29 @@ BOOST_FIXTURE_TEST_CASE(blockfilter_index_initial_sync, BuildChainTestingSetup)
     filter_index.Stop();
 }
 
+BOOST_FIXTURE_TEST_CASE(blockfilter_index_parallel_sync, BuildChainTestingSetup)
+{
+    // Filters are computed out of order by the workers, but headers must still chain up as in a serial sync.
+    BlockFilterIndex filter_index(interfaces::MakeChain(m_node), BlockFilterType::BASIC, 1 << 20, true);
+    filter_index.SetSyncWorkers(3);
+    BOOST_REQUIRE(filter_index.Init());
+    filter_index.Sync();
+    BOOST_CHECK(filter_index.BlockUntilSyncedToCurrentChain());
+
+    {
+        LOCK(cs_main);
+        uint256 last_header;
+        for (const CBlockIndex* block_index = m_node.chainman->ActiveChain().Genesis();
+             block_index != nullptr;
+             block_index = m_node.chainman->ActiveChain().Next(block_index)) {
+            CheckFilterLookups(filter_index, block_index, last_header, m_node.chainman->m_blockman);
+        }
+    }
+
+    filter_index.Interrupt();
+    filter_index.Stop();
+}
+
 BOOST_FIXTURE_TEST_CASE(blockfilter_index_init_destroy, BasicTestingSetup)
 {
     BlockFilterIndex* filter_index;
@@ -383,4 +406,55 @@ BOOST_FIXTURE_TEST_CASE(index_reorg_crash, BuildChainTestingSetup)
     index.Stop();
 }
 
+class IndexProcessThrows : public BaseIndex
+{
+private:
+    std::unique_ptr<BaseIndex::DB> m_db;
+    int m_throwing_height;
+
+public:
+    int m_appended_height{-1};
+
+    explicit IndexProcessThrows(std::unique_ptr<interfaces::Chain> chain, int throwing_height)
+        : BaseIndex(std::move(chain), "test index"), m_throwing_height(throwing_height)
+    {
+        const fs::path path = gArgs.GetDataDirNet() / "index";
+        fs::create_directories(path);
+        m_db = std::make_unique<BaseIndex::DB>(path / "db", /*n_cache_size=*/0, /*f_memory=*/true, /*f_wipe=*/false);
+    }
+
+    bool AllowPrune() const override { return false; }
+    bool AllowParallelSync() const override { return true; }
+    BaseIndex::DB& GetDB() const override { return *m_db; }
+
+    std::any CustomProcessBlock(const interfaces::BlockInfo& block) const override
+    {
+        if (block.height == m_throwing_height) throw std::runtime_error{"test failure"};
+        return {};
+    }
+
+    bool CustomAppend(const interfaces::BlockInfo& block) override
+    {
+        BOOST_CHECK_EQUAL(block.height, m_appended_height + 1);
+        m_appended_height = block.height;
+        return true;
+    }
+};
+
+BOOST_FIXTURE_TEST_CASE(index_parallel_sync_exception, BuildChainTestingSetup)
+{
+    // An exception on a worker fails the sync from the sync thread, once the blocks before it are appended.
+    const int throwing_height{50};
+    IndexProcessThrows index(interfaces::MakeChain(m_node), throwing_height);
+    index.SetSyncWorkers(3);
+    BOOST_REQUIRE(index.Init());
+    index.Sync();
+    BOOST_CHECK_EQUAL(index.m_appended_height, throwing_height - 1);
+    BOOST_CHECK(!index.GetSummary().synced);
+    BOOST_CHECK_EQUAL(m_node.exit_status.load(), EXIT_FAILURE);
+
+    index.Interrupt();
+    index.Stop();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -1086,6 +1086,42 @@ BOOST_AUTO_TEST_CASE(sha256d64)
     }
 }
 
+BOOST_AUTO_TEST_CASE(sha256multi)
+{
+    for (const auto implementation : {sha256_implementation::STANDARD, sha256_implementation::USE_SSE4, sha256_implementation::USE_SSE4_AND_AVX2, sha256_implementation::USE_ALL}) {
+        BOOST_TEST_MESSAGE(SHA256AutoDetect(implementation));
+        // Lengths around the padding boundaries, in random pieces
+        std::vector<std::vector<unsigned char>> data;
+        for (size_t len = 0; len <= 300; len += 1 + (len % 64 >= 50 && len % 64 < 66 ? 0 : m_rng.randrange(9))) {
+            data.push_back(m_rng.randbytes<unsigned char>(len));
+        }
+        std::vector<std::vector<std::span<const unsigned char>>> pieces(data.size());
+        for (size_t i = 0; i < data.size(); ++i) {
+            std::span<const unsigned char> rest{data[i]};
+            do {
+                const size_t piece_len = m_rng.randbool() ? rest.size() : m_rng.randrange(rest.size() + 1);
+                pieces[i].push_back(rest.first(piece_len));
+                rest = rest.subspan(piece_len);
+            } while (!rest.empty());
+        }
+        // Different numbers of messages, to leave lanes unused
+        for (size_t count : {size_t{0}, size_t{1}, size_t{3}, size_t{9}, data.size()}) {
+            std::vector<SHA256Message> messages(pieces.begin(), pieces.begin() + count);
+            std::vector<unsigned char> out(32 * count), out_d(32 * count);
+            SHA256Multi(out.data(), messages);
+            SHA256DMulti(out_d.data(), messages);
+            for (size_t i = 0; i < count; ++i) {
+                unsigned char hash[32], hash_d[32];
+                CSHA256().Write(data[i].data(), data[i].size()).Finalize(hash);
+                CHash256().Write(data[i]).Finalize(hash_d);
+                BOOST_CHECK(std::ranges::equal(hash, std::span{out}.subspan(32 * i, 32)));
+                BOOST_CHECK(std::ranges::equal(hash_d, std::span{out_d}.subspan(32 * i, 32)));
+            }
+        }
+    }
+    SHA256AutoDetect();
+}
+
 void CryptoTest::TestSHA3_256(const std::string& input, const std::string& output)
 {
     const auto in_bytes = ParseHex(input);
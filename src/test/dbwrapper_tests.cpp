@@ -2,14 +2,20 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <dbtrace.h>
 #include <dbwrapper.h>
+#include <kvstore.h>
 #include <test/util/random.h>
 #include <test/util/setup_common.h>
 #include <uint256.h>
 #include <util/string.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <map>
 #include <memory>
 #include <ranges>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -305,42 +311,44 @@ BOOST_AUTO_TEST_CASE(existing_data_reindex)
 
 BOOST_AUTO_TEST_CASE(iterator_ordering)
 {
-    fs::path ph = m_args.GetDataDirBase() / "iterator_ordering";
-    CDBWrapper dbw({.path = ph, .cache_bytes = 1 << 20, .memory_only = true, .wipe_data = false, .obfuscate = false});
-    for (int x=0x00; x<256; ++x) {
-        uint8_t key = x;
-        uint32_t value = x*x;
-        if (!(x & 1)) dbw.Write(key, value);
-    }
+    for (const DBEngine engine : {DBEngine::LEVELDB, DBEngine::LOGDB}) {
+        fs::path ph = m_args.GetDataDirBase() / "iterator_ordering";
+        CDBWrapper dbw({.path = ph, .cache_bytes = 1 << 20, .memory_only = true, .wipe_data = false, .obfuscate = false, .options = {.engine = engine}});
+        for (int x=0x00; x<256; ++x) {
+            uint8_t key = x;
+            uint32_t value = x*x;
+            if (!(x & 1)) dbw.Write(key, value);
+        }
 
-    // Check that creating an iterator creates a snapshot
-    std::unique_ptr<CDBIterator> it(const_cast<CDBWrapper&>(dbw).NewIterator());
+        // Check that creating an iterator creates a snapshot
+        std::unique_ptr<CDBIterator> it(const_cast<CDBWrapper&>(dbw).NewIterator());
 
-    for (unsigned int x=0x00; x<256; ++x) {
-        uint8_t key = x;
-        uint32_t value = x*x;
-        if (x & 1) dbw.Write(key, value);
-    }
+        for (unsigned int x=0x00; x<256; ++x) {
+            uint8_t key = x;
+            uint32_t value = x*x;
+            if (x & 1) dbw.Write(key, value);
+        }
 
-    for (const int seek_start : {0x00, 0x80}) {
-        it->Seek((uint8_t)seek_start);
-        for (unsigned int x=seek_start; x<255; ++x) {
-            uint8_t key;
-            uint32_t value;
-            BOOST_CHECK(it->Valid());
-            if (!it->Valid()) // Avoid spurious errors about invalid iterator's key and value in case of failure
-                break;
-            BOOST_CHECK(it->GetKey(key));
-            if (x & 1) {
-                BOOST_CHECK_EQUAL(key, x + 1);
-                continue;
+        for (const int seek_start : {0x00, 0x80}) {
+            it->Seek((uint8_t)seek_start);
+            for (unsigned int x=seek_start; x<255; ++x) {
+                uint8_t key;
+                uint32_t value;
+                BOOST_CHECK(it->Valid());
+                if (!it->Valid()) // Avoid spurious errors about invalid iterator's key and value in case of failure
+                    break;
+                BOOST_CHECK(it->GetKey(key));
+                if (x & 1) {
+                    BOOST_CHECK_EQUAL(key, x + 1);
+                    continue;
+                }
+                BOOST_CHECK(it->GetValue(value));
+                BOOST_CHECK_EQUAL(key, x);
+                BOOST_CHECK_EQUAL(value, x*x);
+                it->Next();
             }
-            BOOST_CHECK(it->GetValue(value));
-            BOOST_CHECK_EQUAL(key, x);
-            BOOST_CHECK_EQUAL(value, x*x);
-            it->Next();
+            BOOST_CHECK(!it->Valid());
         }
-        BOOST_CHECK(!it->Valid());
     }
 }
 
@@ -409,6 +417,307 @@ BOOST_AUTO_TEST_CASE(iterator_string_ordering)
     }
 }
 
+static std::map<uint32_t, uint256> ReadAll(CDBWrapper& dbw)
+{
+    std::map<uint32_t, uint256> entries;
+    std::unique_ptr<CDBIterator> it{dbw.NewIterator()};
+    for (it->SeekToFirst(); it->Valid(); it->Next()) {
+        uint32_t key{0};
+        uint256 value;
+        BOOST_REQUIRE(it->GetKey(key));
+        BOOST_REQUIRE(it->GetValue(value));
+        entries.emplace(key, value);
+    }
+    return entries;
+}
+
+BOOST_AUTO_TEST_CASE(logdb)
+{
+    const fs::path path{m_args.GetDataDirBase() / "logdb"};
+    const DBParams params{.path = path, .cache_bytes = 1 << 20, .wipe_data = true, .obfuscate = false, .options = {.engine = DBEngine::LOGDB}};
+    DBParams reopen{params};
+    reopen.wipe_data = false;
+
+    std::map<uint32_t, uint256> expected;
+    {
+        CDBWrapper dbw{params};
+        for (int round{0}; round < 4; ++round) {
+            CDBBatch batch{dbw};
+            for (uint32_t key{0}; key < 1000; ++key) {
+                if (m_rng.randbool()) {
+                    const uint256 value{m_rng.rand256()};
+                    batch.Write(key, value);
+                    expected[key] = value;
+                } else if (m_rng.randbool()) {
+                    batch.Erase(key);
+                    expected.erase(key);
+                }
+            }
+            dbw.WriteBatch(batch);
+        }
+        BOOST_CHECK(ReadAll(dbw) == expected);
+    }
+    BOOST_CHECK(fs::exists(path / "LOGDB"));
+
+    // The log is replayed on open, and compaction keeps the live entries only
+    for (const bool compact : {false, true}) {
+        reopen.options.force_compact = compact;
+        CDBWrapper dbw{reopen};
+        BOOST_CHECK(ReadAll(dbw) == expected);
+        for (uint32_t key{0}; key < 1000; ++key) {
+            uint256 value;
+            BOOST_CHECK_EQUAL(dbw.Read(key, value), expected.contains(key));
+            if (expected.contains(key)) BOOST_CHECK_EQUAL(value, expected[key]);
+        }
+    }
+    reopen.options.force_compact = false;
+
+    // Iterators keep reading the entries they were created on
+    {
+        CDBWrapper dbw{reopen};
+        std::unique_ptr<CDBIterator> it{dbw.NewIterator()};
+        CDBBatch batch{dbw};
+        for (uint32_t key{0}; key < 1000; ++key) batch.Erase(key);
+        dbw.WriteBatch(batch);
+        BOOST_CHECK(dbw.IsEmpty());
+        size_t count{0};
+        for (it->SeekToFirst(); it->Valid(); it->Next()) ++count;
+        BOOST_CHECK_EQUAL(count, expected.size());
+        expected.clear();
+    }
+
+    // An incomplete write at the end of the log is dropped
+    {
+        CDBWrapper dbw{reopen};
+        dbw.Write(uint32_t{1}, uint256::ONE);
+        expected[1] = uint256::ONE;
+    }
+    std::vector<fs::path> segments;
+    for (const auto& entry : fs::directory_iterator(path)) {
+        if (entry.path().extension() == ".seg") segments.push_back(entry.path());
+    }
+    std::ranges::sort(segments);
+    {
+        FILE* file{fsbridge::fopen(segments.back(), "ab")};
+        BOOST_REQUIRE(file);
+        BOOST_CHECK_EQUAL(std::fwrite("\xff\xff\xff\xff\x01", 1, 5, file), 5U);
+        std::fclose(file);
+    }
+    {
+        CDBWrapper dbw{reopen};
+        BOOST_CHECK(ReadAll(dbw) == expected);
+    }
+
+    // An existing database keeps its engine, until it is wiped
+    reopen.options.engine = DBEngine::LEVELDB;
+    {
+        CDBWrapper dbw{reopen};
+        BOOST_CHECK(ReadAll(dbw) == expected);
+    }
+    BOOST_CHECK(!fs::exists(path / "CURRENT"));
+    {
+        DBParams wipe{reopen};
+        wipe.wipe_data = true;
+        CDBWrapper dbw{wipe};
+        BOOST_CHECK(dbw.IsEmpty());
+    }
+    BOOST_CHECK(!fs::exists(path / "LOGDB"));
+    BOOST_CHECK(fs::exists(path / "CURRENT"));
+}
+
+BOOST_AUTO_TEST_CASE(logdb_interrupted_compaction)
+{
+    const fs::path path{m_args.GetDataDirBase() / "logdb_interrupted_compaction"};
+    const DBParams params{.path = path, .cache_bytes = 1 << 20, .wipe_data = true, .obfuscate = false, .options = {.engine = DBEngine::LOGDB}};
+    DBParams reopen{params};
+    reopen.wipe_data = false;
+    const auto list_segments{[&] {
+        std::vector<fs::path> segments;
+        for (const auto& entry : fs::directory_iterator(path)) {
+            if (entry.path().extension() == ".seg") segments.push_back(entry.path());
+        }
+        std::ranges::sort(segments);
+        return segments;
+    }};
+
+    // Each open starts a segment: the first one has key 1 written, and a later one has it erased
+    {
+        CDBWrapper dbw{params};
+        dbw.Write(uint32_t{1}, uint256::ONE);
+        dbw.Write(uint32_t{2}, uint256::ONE);
+    }
+    {
+        CDBWrapper dbw{reopen};
+        dbw.Erase(uint32_t{1});
+    }
+    const fs::path first_segment{list_segments().front()};
+    const fs::path backup{path / "backup"};
+    BOOST_REQUIRE(fs::copy_file(first_segment, backup, fs::copy_options::none));
+
+    reopen.options.force_compact = true;
+    {
+        CDBWrapper dbw{reopen};
+        BOOST_CHECK(!dbw.Exists(uint32_t{1}));
+    }
+    reopen.options.force_compact = false;
+    BOOST_CHECK(!fs::exists(first_segment));
+
+    // A crash after the compaction removed the segment erasing key 1, but not
+    // the one writing it, does not bring it back
+    fs::rename(backup, first_segment);
+    {
+        CDBWrapper dbw{reopen};
+        BOOST_CHECK(!dbw.Exists(uint32_t{1}));
+        uint256 value;
+        BOOST_CHECK(dbw.Read(uint32_t{2}, value));
+        BOOST_CHECK_EQUAL(value, uint256::ONE);
+    }
+    BOOST_CHECK(!fs::exists(first_segment));
+
+    {
+        DBParams wipe{reopen};
+        wipe.wipe_data = true;
+        CDBWrapper dbw{wipe};
+    }
+    BOOST_CHECK(!fs::exists(path / "COMPACTED"));
+}
+
+BOOST_AUTO_TEST_CASE(logdb_truncated_segment)
+{
+    const fs::path path{m_args.GetDataDirBase() / "logdb_truncated_segment"};
+    const DBParams params{.path = path, .cache_bytes = 1 << 20, .wipe_data = true, .obfuscate = false, .options = {.engine = DBEngine::LOGDB}};
+    DBParams reopen{params};
+    reopen.wipe_data = false;
+    const auto list_segments{[&] {
+        std::vector<fs::path> segments;
+        for (const auto& entry : fs::directory_iterator(path)) {
+            if (entry.path().extension() == ".seg") segments.push_back(entry.path());
+        }
+        std::ranges::sort(segments);
+        return segments;
+    }};
+
+    // Each open starts a segment, syncing and sealing the one before
+    {
+        CDBWrapper dbw{params};
+        dbw.Write(uint32_t{1}, uint256::ONE);
+    }
+    {
+        CDBWrapper dbw{reopen};
+        dbw.Write(uint32_t{2}, uint256::ONE);
+    }
+    const std::vector<fs::path> segments{list_segments()};
+    BOOST_REQUIRE_EQUAL(segments.size(), 2U);
+
+    // The last segment may be cut short by a crash, losing its last writes
+    fs::resize_file(segments[1], fs::file_size(segments[1]) - 1);
+    {
+        CDBWrapper dbw{reopen};
+        BOOST_CHECK(dbw.Exists(uint32_t{1}));
+        BOOST_CHECK(!dbw.Exists(uint32_t{2}));
+    }
+
+    // A sealed one was synced, so it is corrupted if cut short, rather than
+    // replayed without its lost writes
+    fs::resize_file(segments[0], fs::file_size(segments[0]) - 1);
+    BOOST_CHECK_EXCEPTION(CDBWrapper{reopen}, dbwrapper_error, HasReason{"Corrupted segment"});
+}
+
+BOOST_AUTO_TEST_CASE(dbwrapper_compaction)
+{
+    for (const DBEngine engine : {DBEngine::LEVELDB, DBEngine::LOGDB}) {
+        // A small cache, for many files of LevelDB at level 0, compacted in
+        // subcompactions, with entries overwritten and erased across all of them
+        const DBParams params{.path = m_args.GetDataDirBase() / "dbwrapper_compaction", .cache_bytes = 1 << 20, .wipe_data = true, .obfuscate = false, .options = {.engine = engine}};
+        std::map<uint32_t, uint256> expected;
+        {
+            CDBWrapper dbw{params};
+            for (int round{0}; round < 3; ++round) {
+                for (uint32_t begin{0}; begin < 40'000; begin += 1000) {
+                    CDBBatch batch{dbw};
+                    for (uint32_t key{begin}; key < begin + 1000; ++key) {
+                        if (round == 0 || m_rng.randrange(4) == 0) {
+                            batch.Write(key, expected[key] = m_rng.rand256());
+                        } else if (m_rng.randrange(4) == 0) {
+                            batch.Erase(key);
+                            expected.erase(key);
+                        }
+                    }
+                    dbw.WriteBatch(batch);
+                }
+            }
+            BOOST_CHECK(ReadAll(dbw) == expected);
+        }
+
+        DBParams reopen{params};
+        reopen.wipe_data = false;
+        reopen.options.force_compact = true;
+        CDBWrapper dbw{reopen};
+        BOOST_CHECK(ReadAll(dbw) == expected);
+
+        const DBStats stats{dbw.GetStats()};
+        BOOST_CHECK(stats.engine == engine);
+        uint64_t bytes{0}, compaction_bytes_written{0};
+        for (const auto& level : stats.levels) {
+            bytes += level.bytes;
+            compaction_bytes_written += level.compaction_bytes_written;
+        }
+        BOOST_CHECK_GT(bytes, 0U);
+        BOOST_CHECK_GT(compaction_bytes_written, 0U);
+        if (engine == DBEngine::LEVELDB) {
+            BOOST_CHECK_EQUAL(stats.levels.size(), 7U);
+            BOOST_CHECK_EQUAL(stats.write_stalls.size(), 3U);
+        } else {
+            BOOST_CHECK_EQUAL(stats.levels.size(), 1U);
+            BOOST_REQUIRE_EQUAL(stats.write_stalls.size(), 2U);
+            BOOST_CHECK_EQUAL(stats.write_stalls[0].cause, "index_merge");
+            BOOST_CHECK_EQUAL(stats.write_stalls[1].cause, "segment_sync");
+            // The compaction sealed the segment it started on
+            BOOST_CHECK_GT(stats.write_stalls[1].count, 0U);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(dbwrapper_trace)
+{
+    const fs::path path{m_args.GetDataDirBase() / "dbwrapper_trace"};
+    DBOptions options;
+    options.trace_path = m_args.GetDataDirBase() / "traces" / "test.dbtrace";
+    {
+        CDBWrapper dbw{{.path = path, .cache_bytes = 1 << 20, .wipe_data = true, .obfuscate = false, .options = options}};
+        CDBBatch batch{dbw};
+        batch.Write(uint8_t{1}, uint256::ONE);
+        batch.Write(uint8_t{2}, std::vector<unsigned char>(1000));
+        batch.Erase(uint8_t{3});
+        dbw.WriteBatch(batch, /*fSync=*/true);
+        BOOST_CHECK(dbw.Exists(uint8_t{1}));
+        uint256 value;
+        BOOST_CHECK(!dbw.Read(uint8_t{3}, value));
+        std::unique_ptr<CDBIterator> it{dbw.NewIterator()};
+        it->Seek(uint8_t{2});
+        it->Next();
+    }
+
+    const auto trace{ReadDBTrace(options.trace_path)};
+    std::vector<DBTraceOp::Type> types;
+    for (const auto& op : trace) types.push_back(op.type);
+    using enum DBTraceOp::Type;
+    // The first read is that of the obfuscation key
+    BOOST_CHECK((types == std::vector{READ, PUT, PUT, ERASE, COMMIT, EXISTS, READ, SEEK, NEXT}));
+    BOOST_CHECK_EQUAL(trace[2].key, "\x02");
+    BOOST_CHECK_EQUAL(trace[2].value_size, 1003U); // with the compact size of the vector
+    BOOST_CHECK_EQUAL(trace[4].value_size, 1U);
+
+    // A replay writes values of the recorded sizes under the recorded keys
+    const auto store{OpenLevelDB({.path = m_args.GetDataDirBase() / "dbwrapper_replay", .cache_bytes = 1 << 20, .wipe_data = true})};
+    ReplayDBTrace(*store, trace);
+    const auto replayed{store->Read(MakeByteSpan(trace[2].key))};
+    BOOST_REQUIRE(replayed);
+    BOOST_CHECK_EQUAL(replayed->size(), 1003U);
+    BOOST_CHECK(store->Exists(MakeByteSpan(trace[1].key)));
+    BOOST_CHECK(!store->Exists(MakeByteSpan(trace[3].key)));
+}
+
 BOOST_AUTO_TEST_CASE(unicodepath)
 {
     // Attempt to create a database with a UTF8 character in the path.
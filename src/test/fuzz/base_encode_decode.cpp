@@ -11,8 +11,12 @@
 #include <util/strencodings.h>
 #include <util/string.h>
 
+#include <algorithm>
 #include <cassert>
+#include <limits>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <ranges>
 
@@ -37,6 +41,68 @@ FUZZ_TARGET(base58_encode_decode)
     }
 }
 
+namespace {
+/** EncodeBase58 and DecodeBase58 a byte or digit at a time, for the ones with larger limbs to be compared to */
+std::string ReferenceEncodeBase58(std::span<const unsigned char> input)
+{
+    const char* alphabet{"123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz"};
+    size_t zeroes{0};
+    while (zeroes < input.size() && input[zeroes] == 0) ++zeroes;
+    std::vector<unsigned char> b58; // least significant first
+    for (const unsigned char byte : input.subspan(zeroes)) {
+        int carry{byte};
+        for (auto& digit : b58) {
+            carry += 256 * digit;
+            digit = carry % 58;
+            carry /= 58;
+        }
+        for (; carry; carry /= 58) b58.push_back(carry % 58);
+    }
+    std::string str(zeroes, '1');
+    for (auto it = b58.rbegin(); it != b58.rend(); ++it) str += alphabet[*it];
+    return str;
+}
+
+std::optional<std::vector<unsigned char>> ReferenceDecodeBase58(std::string_view str)
+{
+    const std::string_view alphabet{"123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz"};
+    size_t zeroes{0};
+    while (zeroes < str.size() && str[zeroes] == '1') ++zeroes;
+    std::vector<unsigned char> b256; // least significant first
+    for (const char c : str.substr(zeroes)) {
+        const size_t digit{alphabet.find(c)};
+        if (c == '\0' || digit == std::string_view::npos) return std::nullopt;
+        int carry = digit;
+        for (auto& byte : b256) {
+            carry += 58 * byte;
+            byte = carry % 256;
+            carry /= 256;
+        }
+        for (; carry; carry /= 256) b256.push_back(carry % 256);
+    }
+    std::vector<unsigned char> bytes(zeroes, 0);
+    bytes.insert(bytes.end(), b256.rbegin(), b256.rend());
+    return bytes;
+}
+} // namespace
+
+FUZZ_TARGET(base58_reference)
+{
+    FuzzedDataProvider provider{buffer.data(), buffer.size()};
+    const auto bytes{provider.ConsumeBytes<unsigned char>(provider.ConsumeIntegralInRange<size_t>(0, 200))};
+    assert(EncodeBase58(bytes) == ReferenceEncodeBase58(bytes));
+
+    const auto str{provider.ConsumeRemainingBytesAsString()};
+    std::vector<unsigned char> decoded;
+    const bool ok{DecodeBase58(str, decoded, std::numeric_limits<int>::max())};
+    // Unlike DecodeBase58, the reference doesn't skip whitespace around the digits
+    if (std::ranges::none_of(str, IsSpace)) {
+        const auto reference{ReferenceDecodeBase58(str)};
+        assert(ok == reference.has_value());
+        if (ok) assert(decoded == *reference);
+    }
+}
+
 FUZZ_TARGET(base58check_encode_decode)
 {
     FuzzedDataProvider provider{buffer.data(), buffer.size()};
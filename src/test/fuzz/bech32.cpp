@@ -13,6 +13,37 @@
 #include <string>
 #include <vector>
 
+namespace {
+/** The Bech32 checksum of a string, computed bit by bit as in BIP173, for the table-driven one to be compared to */
+uint32_t ReferencePolyMod(const std::string& hrp, const std::vector<uint8_t>& values)
+{
+    std::vector<uint8_t> expanded;
+    for (const char c : hrp) expanded.push_back(c >> 5);
+    expanded.push_back(0);
+    for (const char c : hrp) expanded.push_back(c & 0x1f);
+    expanded.insert(expanded.end(), values.begin(), values.end());
+    constexpr uint32_t GENERATOR[5] = {0x3b6a57b2, 0x26508e6d, 0x1ea119fa, 0x3d4233dd, 0x2a1462b3};
+    uint32_t chk = 1;
+    for (const uint8_t v : expanded) {
+        const uint32_t top = chk >> 25;
+        chk = ((chk & 0x1ffffff) << 5) ^ v;
+        for (int i = 0; i < 5; ++i) {
+            if ((top >> i) & 1) chk ^= GENERATOR[i];
+        }
+    }
+    return chk;
+}
+
+/** The values of the data part of a valid encoding, with its checksum */
+std::vector<uint8_t> DataPart(const std::string& encoded, size_t hrp_size)
+{
+    const std::string charset{"qpzry9x8gf2tvdw0s3jn54khce6mua7l"};
+    std::vector<uint8_t> values;
+    for (const char c : encoded.substr(hrp_size + 1)) values.push_back(charset.find(ToLower(c)));
+    return values;
+}
+} // namespace
+
 FUZZ_TARGET(bech32_random_decode)
 {
     auto limit = bech32::CharLimit::BECH32;
@@ -27,6 +58,7 @@ FUZZ_TARGET(bech32_random_decode)
         assert(decoded.encoding != bech32::Encoding::INVALID);
         auto reencoded = bech32::Encode(decoded.encoding, decoded.hrp, decoded.data);
         assert(CaseInsensitiveEqual(random_string, reencoded));
+        assert(ReferencePolyMod(decoded.hrp, DataPart(random_string, decoded.hrp.size())) == (decoded.encoding == bech32::Encoding::BECH32 ? 1 : 0x2bc830a3));
     }
 }
 
@@ -59,6 +91,7 @@ FUZZ_TARGET(bech32_roundtrip)
         for (auto encoding: {bech32::Encoding::BECH32, bech32::Encoding::BECH32M}) {
             auto encoded = bech32::Encode(encoding, hrp, converted_input);
             assert(!encoded.empty());
+            assert(ReferencePolyMod(hrp, DataPart(encoded, hrp.size())) == (encoding == bech32::Encoding::BECH32 ? 1 : 0x2bc830a3));
 
             const auto decoded = bech32::Decode(encoded);
             assert(decoded.encoding == encoding);
@@ -8,13 +8,17 @@
 #include <core_io.h>
 #include <core_memusage.h>
 #include <primitives/block.h>
+#include <primitives/block_view.h>
 #include <pubkey.h>
 #include <streams.h>
+#include <support/allocators/chunk_arena.h>
 #include <test/fuzz/fuzz.h>
 #include <util/chaintype.h>
 #include <validation.h>
 
+#include <algorithm>
 #include <cassert>
+#include <optional>
 #include <string>
 
 void initialize_block()
@@ -24,13 +28,58 @@ void initialize_block()
 
 FUZZ_TARGET(block, .init = initialize_block)
 {
+    std::optional<BlockView> view;
+    try {
+        view.emplace(std::as_bytes(buffer));
+    } catch (const std::ios_base::failure&) {
+    }
     DataStream ds{buffer};
     CBlock block;
     try {
         ds >> TX_WITH_WITNESS(block);
     } catch (const std::ios_base::failure&) {
+        assert(!view);
         return;
     }
+    // The view parses exactly the blocks that deserialize, the same way
+    assert(view);
+    assert(view->GetHash() == block.GetHash());
+    assert(view->TxCount() == block.vtx.size());
+    for (size_t i = 0; i < block.vtx.size(); ++i) {
+        const CTransaction& tx{*block.vtx[i]};
+        assert(view->GetTxid(i) == tx.GetHash());
+        assert(view->GetWtxid(i) == tx.GetWitnessHash());
+        DataStream tx_ds{};
+        tx_ds << TX_WITH_WITNESS(tx);
+        assert(std::ranges::equal(view->TxBytes(i), tx_ds));
+        assert(view->InputCount(i) == tx.vin.size());
+        assert(view->OutputCount(i) == tx.vout.size());
+        for (uint32_t n = 0; n < tx.vin.size(); ++n) assert(view->GetInput(i, n) == tx.vin[n]);
+        for (uint32_t n = 0; n < tx.vout.size(); ++n) assert(view->GetOutput(i, n) == tx.vout[n]);
+    }
+    bool mutated, view_mutated;
+    assert(BlockMerkleRoot(*view, &view_mutated) == BlockMerkleRoot(block, &mutated));
+    assert(view_mutated == mutated);
+    if (!block.vtx.empty()) assert(BlockWitnessMerkleRoot(*view) == BlockWitnessMerkleRoot(block));
+    assert(view->Size() == ::GetSerializeSize(TX_WITH_WITNESS(block)));
+    assert(view->StrippedSize() == ::GetSerializeSize(TX_NO_WITNESS(block)));
+    assert(view->Weight() == GetBlockWeight(block));
+    {
+        // The same block deserialized in an arena
+        DataStream arena_ds{buffer};
+        CBlock arena_block;
+        {
+            ChunkArena arena{TX_ARENA_CHUNK_SIZE};
+            const TransactionSerParams params{.allow_witness = true, .arena = &arena};
+            arena_ds >> params(arena_block);
+        }
+        assert(arena_ds.size() == ds.size());
+        assert(arena_block.vtx.size() == block.vtx.size());
+        for (size_t i = 0; i < block.vtx.size(); ++i) {
+            assert(*arena_block.vtx[i] == *block.vtx[i]);
+            assert(CMutableTransaction{*arena_block.vtx[i]}.GetHash() == block.vtx[i]->GetHash());
+        }
+    }
     const Consensus::Params& consensus_params = Params().GetConsensus();
     BlockValidationState validation_state_pow_and_merkle;
     const bool valid_incl_pow_and_merkle = CheckBlock(block, validation_state_pow_and_merkle, consensus_params, /* fCheckPOW= */ true, /* fCheckMerkleRoot= */ true);
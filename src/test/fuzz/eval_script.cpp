@@ -4,9 +4,12 @@
 
 #include <pubkey.h>
 #include <script/interpreter.h>
+#include <script/script_stack.h>
 #include <test/fuzz/FuzzedDataProvider.h>
 #include <test/fuzz/fuzz.h>
 
+#include <algorithm>
+#include <cassert>
 #include <limits>
 
 FUZZ_TARGET(eval_script)
@@ -24,8 +27,19 @@ FUZZ_TARGET(eval_script)
         }
     }();
     const CScript script(script_bytes.begin(), script_bytes.end());
+    // Reused, so that the items it keeps are too
+    ScriptStack script_stack;
     for (const auto sig_version : {SigVersion::BASE, SigVersion::WITNESS_V0}) {
         std::vector<std::vector<unsigned char>> stack;
-        (void)EvalScript(stack, script, flags, BaseSignatureChecker(), sig_version, nullptr);
+        ScriptError error;
+        const bool ret{EvalScript(stack, script, flags, BaseSignatureChecker(), sig_version, &error)};
+
+        // The same on a ScriptStack
+        script_stack.clear();
+        ScriptError script_stack_error;
+        const bool script_stack_ret{EvalScript(script_stack, script, flags, BaseSignatureChecker(), sig_version, &script_stack_error)};
+        assert(ret == script_stack_ret);
+        assert(error == script_stack_error);
+        assert(std::ranges::equal(stack, script_stack));
     }
 }
@@ -16,6 +16,8 @@
 #include <cassert>
 #include <cstdint>
 #include <iosfwd>
+#include <optional>
+#include <span>
 #include <unordered_set>
 #include <vector>
 
@@ -80,6 +82,27 @@ FUZZ_TARGET(golomb_rice)
 
     assert(encoded_deltas == decoded_deltas);
 
+    // The word-at-a-time writer and reader must be equivalent to the bit stream ones.
+    {
+        std::vector<uint8_t> word_data;
+        VectorWriter stream{word_data, 0};
+        WriteCompactSize(stream, static_cast<uint32_t>(encoded_deltas.size()));
+        GolombRiceWriter writer{word_data};
+        for (const uint64_t delta : encoded_deltas) {
+            writer.Encode(BASIC_FILTER_P, delta);
+        }
+        writer.Flush();
+        assert(word_data == golomb_rice_data);
+
+        SpanReader header{word_data};
+        (void)ReadCompactSize(header);
+        GolombRiceReader reader{std::span{word_data}.last(header.size())};
+        for (const uint64_t delta : encoded_deltas) {
+            assert(reader.Decode(BASIC_FILTER_P) == delta);
+        }
+        assert(reader.BytesRead() == header.size());
+    }
+
     {
         const std::vector<uint8_t> random_bytes = ConsumeRandomLengthByteVector(fuzzed_data_provider, 1024);
         SpanReader stream{random_bytes};
@@ -89,12 +112,20 @@ FUZZ_TARGET(golomb_rice)
         } catch (const std::ios_base::failure&) {
             return;
         }
+        GolombRiceReader reader{std::span{random_bytes}.last(stream.size())};
         BitStreamReader bitreader{stream};
         for (uint32_t i = 0; i < std::min<uint32_t>(n, 1024); ++i) {
+            std::optional<uint64_t> bit_value, word_value;
+            try {
+                bit_value = GolombRiceDecode(bitreader, BASIC_FILTER_P);
+            } catch (const std::ios_base::failure&) {
+            }
             try {
-                (void)GolombRiceDecode(bitreader, BASIC_FILTER_P);
+                word_value = reader.Decode(BASIC_FILTER_P);
             } catch (const std::ios_base::failure&) {
             }
+            assert(bit_value == word_value);
+            if (!bit_value) break;
         }
     }
 }
@@ -15,16 +15,51 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
+namespace {
+/** ParseHex and HexStr a character at a time, for the vectorized ones to be compared to */
+std::optional<std::vector<unsigned char>> ReferenceParseHex(std::string_view str)
+{
+    std::vector<unsigned char> bytes;
+    for (auto it = str.begin(); it != str.end();) {
+        if (IsSpace(*it)) {
+            ++it;
+            continue;
+        }
+        const auto c1 = HexDigit(*(it++));
+        if (it == str.end()) return std::nullopt;
+        const auto c2 = HexDigit(*(it++));
+        if (c1 < 0 || c2 < 0) return std::nullopt;
+        bytes.push_back((c1 << 4) | c2);
+    }
+    return bytes;
+}
+
+std::string ReferenceHexStr(std::span<const unsigned char> bytes)
+{
+    std::string hex;
+    for (const unsigned char b : bytes) {
+        hex += "0123456789abcdef"[b >> 4];
+        hex += "0123456789abcdef"[b & 15];
+    }
+    return hex;
+}
+} // namespace
+
 FUZZ_TARGET(hex)
 {
     const std::string random_hex_string(buffer.begin(), buffer.end());
     const std::vector<unsigned char> data = ParseHex(random_hex_string);
     const std::vector<std::byte> bytes{ParseHex<std::byte>(random_hex_string)};
     assert(std::ranges::equal(std::as_bytes(std::span{data}), bytes));
+    assert(TryParseHex<unsigned char>(random_hex_string) == ReferenceParseHex(random_hex_string));
     const std::string hex_data = HexStr(data);
+    assert(hex_data == ReferenceHexStr(data));
+    assert(HexStr(buffer) == ReferenceHexStr(buffer));
     if (IsHex(random_hex_string)) {
         assert(ToLower(random_hex_string) == hex_data);
     }
@@ -127,6 +127,7 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "getchainstates",
     "getchaintxstats",
     "getconnectioncount",
+    "getdbstats",
     "getdeploymentinfo",
     "getdescriptoractivity",
     "getdescriptorinfo",
@@ -151,6 +152,8 @@ const std::vector<std::string> RPC_COMMANDS_SAFE_FOR_FUZZING{
     "getrawmempool",
     "getrawtransaction",
     "getrpcinfo",
+    "getscripthistory",
+    "getscriptunspent",
     "gettxout",
     "gettxoutsetinfo",
     "gettxspendingprevout",
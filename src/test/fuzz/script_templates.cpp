@@ -0,0 +1,137 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <hash.h>
+#include <key.h>
+#include <primitives/transaction.h>
+#include <pubkey.h>
+#include <script/interpreter.h>
+#include <script/script.h>
+#include <script/script_error.h>
+#include <test/fuzz/FuzzedDataProvider.h>
+#include <test/fuzz/fuzz.h>
+#include <test/fuzz/util.h>
+#include <test/util/script.h>
+#include <test/util/transaction_utils.h>
+#include <uint256.h>
+
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+void initialize_script_templates()
+{
+    static ECC_Context ecc_context{};
+}
+
+/** Differential fuzzing of the fast paths of VerifyScript for standard
+ *  templates against the generic interpreter, with spends of P2WPKH, P2SH-P2WPKH
+ *  and P2TR key path outputs that are valid before they are fuzzed. */
+FUZZ_TARGET(script_templates, .init = initialize_script_templates)
+{
+    FuzzedDataProvider provider(buffer.data(), buffer.size());
+    const CKey key{ConsumePrivateKey(provider)};
+    if (!key.IsValid()) return;
+    const CPubKey pubkey{key.GetPubKey()};
+
+    enum class Template { P2WPKH, P2SH_P2WPKH, P2TR };
+    const auto type{provider.PickValueInArray({Template::P2WPKH, Template::P2SH_P2WPKH, Template::P2TR})};
+    CScript script_pubkey;
+    CScript script_sig;
+    const CScript p2wpkh{CScript() << OP_0 << ToByteVector(Hash160(pubkey))};
+    if (type == Template::P2TR) {
+        const auto output_key{XOnlyPubKey{pubkey}.CreateTapTweak(nullptr)};
+        assert(output_key);
+        script_pubkey = CScript() << OP_1 << ToByteVector(output_key->first);
+    } else if (type == Template::P2SH_P2WPKH) {
+        script_pubkey = GetScriptForDestination(ScriptHash(p2wpkh));
+        script_sig = CScript() << ToByteVector(p2wpkh);
+    } else {
+        script_pubkey = p2wpkh;
+    }
+
+    const CAmount amount{ConsumeMoney(provider)};
+    CMutableTransaction credit{BuildCreditingTransaction(script_pubkey, amount)};
+    CMutableTransaction spend{BuildSpendingTransaction(script_sig, CScriptWitness(), CTransaction(credit))};
+    spend.vout[0].nValue = ConsumeMoney(provider);
+    spend.nLockTime = provider.ConsumeIntegral<uint32_t>();
+    PrecomputedTransactionData txdata;
+    txdata.Init(spend, {credit.vout[0]}, /*force=*/true);
+
+    std::vector<std::vector<unsigned char>>& stack{spend.vin[0].scriptWitness.stack};
+    if (type == Template::P2TR) {
+        const uint8_t hash_type{provider.PickValueInArray<uint8_t>({SIGHASH_DEFAULT, SIGHASH_ALL, SIGHASH_NONE, SIGHASH_SINGLE, SIGHASH_ALL | SIGHASH_ANYONECANPAY})};
+        ScriptExecutionData execdata;
+        execdata.m_annex_init = true;
+        execdata.m_annex_present = false;
+        uint256 hash;
+        if (!SignatureHashSchnorr(hash, execdata, spend, 0, hash_type, SigVersion::TAPROOT, txdata, MissingDataBehavior::ASSERT_FAIL)) return;
+        std::vector<unsigned char> sig(64);
+        const uint256 merkle_root{};
+        assert(key.SignSchnorr(hash, sig, &merkle_root, ConsumeUInt256(provider)));
+        if (hash_type != SIGHASH_DEFAULT) sig.push_back(hash_type);
+        stack.push_back(std::move(sig));
+    } else {
+        const int hash_type{provider.PickValueInArray<int>({SIGHASH_ALL, SIGHASH_NONE, SIGHASH_SINGLE, SIGHASH_ALL | SIGHASH_ANYONECANPAY})};
+        const CScript script_code{CScript() << OP_DUP << OP_HASH160 << ToByteVector(Hash160(pubkey)) << OP_EQUALVERIFY << OP_CHECKSIG};
+        std::vector<unsigned char> sig;
+        assert(key.Sign(SignatureHash(script_code, spend, 0, hash_type, amount, SigVersion::WITNESS_V0, &txdata), sig));
+        sig.push_back(uint8_t(hash_type));
+        stack.push_back(std::move(sig));
+        stack.push_back(ToByteVector(pubkey));
+    }
+
+    // Break the spend in the ways the fast paths have to catch
+    LIMITED_WHILE(provider.ConsumeBool(), 4) {
+        CallOneOf(
+            provider,
+            [&] {
+                if (stack.empty()) return;
+                auto& item{stack[provider.ConsumeIntegralInRange<size_t>(0, stack.size() - 1)]};
+                if (item.empty()) return;
+                item[provider.ConsumeIntegralInRange<size_t>(0, item.size() - 1)] ^= provider.ConsumeIntegralInRange<uint8_t>(1, 255);
+            },
+            [&] {
+                if (stack.empty()) return;
+                stack[provider.ConsumeIntegralInRange<size_t>(0, stack.size() - 1)] = ConsumeRandomLengthByteVector(provider, MAX_SCRIPT_ELEMENT_SIZE + 1);
+            },
+            [&] {
+                stack.insert(stack.begin() + provider.ConsumeIntegralInRange<size_t>(0, stack.size()), ConsumeRandomLengthByteVector(provider, 80));
+            },
+            [&] {
+                if (stack.empty()) return;
+                stack.erase(stack.begin() + provider.ConsumeIntegralInRange<size_t>(0, stack.size() - 1));
+            },
+            [&] {
+                // An annex, which is only allowed in P2TR spends
+                std::vector<unsigned char> annex{ConsumeRandomLengthByteVector(provider, 80)};
+                annex.insert(annex.begin(), ANNEX_TAG);
+                stack.push_back(std::move(annex));
+            },
+            [&] {
+                spend.vin[0].scriptSig = ConsumeScript(provider);
+            },
+            [&] {
+                // Spend a program that is all zeroes instead
+                script_pubkey = CScript() << OP_0 << std::vector<unsigned char>(provider.PickValueInArray({20, 32}), 0);
+            });
+    }
+
+    script_verify_flags flags{SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_WITNESS};
+    if (provider.ConsumeBool()) flags |= script_verify_flags::from_int(provider.ConsumeIntegral<script_verify_flags::value_type>());
+    if (!IsValidFlagCombination(flags)) return;
+
+    const CTransaction tx{spend};
+    txdata = PrecomputedTransactionData{};
+    txdata.Init(tx, {CTxOut{amount, script_pubkey}});
+    const TransactionSignatureChecker checker{&tx, 0, amount, txdata, MissingDataBehavior::ASSERT_FAIL};
+    ScriptError error;
+    ScriptError generic_error;
+    const bool ret{VerifyScript(tx.vin[0].scriptSig, script_pubkey, &tx.vin[0].scriptWitness, flags, checker, &error)};
+    const bool generic_ret{VerifyScriptGeneric(tx.vin[0].scriptSig, script_pubkey, &tx.vin[0].scriptWitness, flags, checker, &generic_error)};
+    assert(ret == generic_ret);
+    assert(error == generic_error);
+}
@@ -147,6 +147,9 @@ BOOST_AUTO_TEST_CASE(siphash)
         WriteLE32(nb, n);
         sip288.Write(nb);
         BOOST_CHECK_EQUAL(PresaltedSipHasher(k0, k1)(x, n), sip288.Finalize());
+
+        const std::vector<unsigned char> bytes{ctx.randbytes(ctx.randrange(100))};
+        BOOST_CHECK_EQUAL(PresaltedSipHasher(k0, k1)(bytes), CSipHasher(k0, k1).Write(bytes).Finalize());
     }
 }
 
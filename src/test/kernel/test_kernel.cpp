@@ -595,6 +595,36 @@ BOOST_AUTO_TEST_CASE(hylk_block)
     BOOST_CHECK_THROW(Block{empty_data}, std::runtime_error);
 }
 
+BOOST_AUTO_TEST_CASE(hylk_block_view)
+{
+    const auto raw_block{hex_string_to_byte_vec(REGTEST_BLOCK_DATA[205])};
+    Block block{raw_block};
+    BlockView block_view{raw_block};
+    BlockView block_view_100{hex_string_to_byte_vec(REGTEST_BLOCK_DATA[100])};
+    BOOST_CHECK(block_view.GetHash() == block.GetHash());
+    BOOST_CHECK(block_view_100.GetHash() != block.GetHash());
+    BOOST_CHECK(BlockView{block_view}.GetHash() == block.GetHash());
+
+    BOOST_REQUIRE_EQUAL(block_view.CountTransactions(), block.CountTransactions());
+    for (size_t i{0}; i < block.CountTransactions(); ++i) {
+        const auto tx{block.GetTransaction(i)};
+        BOOST_CHECK(block_view.GetTxid(i) == Txid{tx.Txid()});
+        check_equal(block_view.GetTransaction(i).ToBytes(), tx.ToBytes());
+        for (size_t n{0}; n < tx.CountOutputs(); ++n) {
+            const auto output{block_view.GetOutput(i, n)};
+            BOOST_REQUIRE(output);
+            BOOST_CHECK_EQUAL(output->Amount(), tx.GetOutput(n).Amount());
+            check_equal(output->GetScriptPubkey().ToBytes(), tx.GetOutput(n).GetScriptPubkey().ToBytes());
+        }
+        BOOST_CHECK(!block_view.GetOutput(i, tx.CountOutputs()));
+    }
+
+    BOOST_CHECK_THROW(BlockView{hex_string_to_byte_vec("012300")}, std::runtime_error);
+    BOOST_CHECK_THROW(BlockView{hex_string_to_byte_vec("")}, std::runtime_error);
+    // Truncated in the last transaction
+    BOOST_CHECK_THROW(BlockView{std::span{raw_block}.first(raw_block.size() - 1)}, std::runtime_error);
+}
+
 Context create_context(std::shared_ptr<TestKernelNotifications> notifications, ChainType chain_type, std::shared_ptr<TestValidationInterface> validation_interface = nullptr)
 {
     ContextOptions options{};
@@ -916,6 +946,11 @@ BOOST_AUTO_TEST_CASE(hylk_chainman_regtest_tests)
     auto read_block_2 = chainman->ReadBlock(tip_2).value();
     check_equal(read_block_2.ToBytes(), hex_string_to_byte_vec(REGTEST_BLOCK_DATA[REGTEST_BLOCK_DATA.size() - 2]));
 
+    auto read_block_view = chainman->ReadBlockView(tip).value();
+    BOOST_CHECK(read_block_view.GetHash() == read_block.GetHash());
+    BOOST_CHECK_EQUAL(read_block_view.CountTransactions(), read_block.CountTransactions());
+    BOOST_CHECK(read_block_view.GetTxid(0) == Txid{read_block.GetTransaction(0).Txid()});
+
     Txid txid = read_block.Transactions()[0].Txid();
     Txid txid_2 = read_block_2.Transactions()[0].Txid();
     BOOST_CHECK(txid != txid_2);
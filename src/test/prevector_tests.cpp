@@ -313,4 +313,53 @@ BOOST_AUTO_TEST_CASE(PrevectorTestInt)
     }
 }
 
+BOOST_AUTO_TEST_CASE(PrevectorBorrowed)
+{
+    std::vector<unsigned char> storage(40);
+
+    prevector<28, unsigned char> v(30, 1);
+    v.borrow_uninitialized(storage.data(), 40);
+    BOOST_CHECK(v.is_borrowed());
+    BOOST_CHECK_EQUAL(v.size(), 40U);
+    BOOST_CHECK(v.data() == storage.data());
+    std::ranges::fill(v, 7);
+    BOOST_CHECK_EQUAL(storage[39], 7);
+
+    // Copies own their memory, moves keep borrowing it
+    const prevector<28, unsigned char> copy{v};
+    BOOST_CHECK(!copy.is_borrowed());
+    BOOST_CHECK(copy == v);
+    prevector<28, unsigned char> moved{std::move(v)};
+    BOOST_CHECK(moved.is_borrowed());
+    BOOST_CHECK(moved.data() == storage.data());
+
+    // Growing moves the elements to memory of its own
+    moved.push_back(8);
+    BOOST_CHECK(!moved.is_borrowed());
+    BOOST_CHECK(moved.data() != storage.data());
+    BOOST_CHECK_EQUAL(moved.size(), 41U);
+    BOOST_CHECK_EQUAL(moved[39], 7);
+    BOOST_CHECK_EQUAL(moved[40], 8);
+
+    // As does shrinking to fit, while assigning within the storage keeps using it
+    prevector<28, unsigned char> shrunk;
+    shrunk.borrow_uninitialized(storage.data(), 40);
+    shrunk.resize(5);
+    shrunk.shrink_to_fit();
+    BOOST_CHECK(!shrunk.is_borrowed());
+    BOOST_CHECK_EQUAL(shrunk[4], 7);
+    std::ranges::fill(storage, 0);
+    shrunk.borrow_uninitialized(storage.data(), 40);
+    shrunk = copy;
+    BOOST_CHECK(shrunk.is_borrowed());
+    BOOST_CHECK(shrunk == copy);
+    BOOST_CHECK_EQUAL(storage[0], 7);
+
+    // Elements that fit are stored directly
+    prevector<28, unsigned char> direct;
+    direct.borrow_uninitialized(storage.data(), 28);
+    BOOST_CHECK(!direct.is_borrowed());
+    BOOST_CHECK_EQUAL(direct.size(), 28U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
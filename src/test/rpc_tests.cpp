@@ -2,18 +2,26 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <chainparams.h>
 #include <core_io.h>
 #include <interfaces/chain.h>
 #include <node/context.h>
+#include <rpc/binary.h>
 #include <rpc/blockchain.h>
 #include <rpc/client.h>
 #include <rpc/server.h>
 #include <rpc/util.h>
+#include <streams.h>
 #include <test/util/setup_common.h>
 #include <univalue.h>
+#include <util/check.h>
 #include <util/time.h>
+#include <validation.h>
 
 #include <any>
+#include <ios>
+#include <span>
+#include <string>
 #include <string_view>
 
 #include <boost/test/unit_test.hpp>
@@ -642,4 +650,141 @@ BOOST_AUTO_TEST_CASE(rpc_arg_helper)
     CheckRpc(params, UniValue{JSON(R"([5, "hello", 4, "test", true, 1.23, "world"])")}, check_positional);
 }
 
+BOOST_AUTO_TEST_CASE(rpc_json_stream_writer)
+{
+    const UniValue value{JSON(R"({"a": [], "b\"c":{"d": [1, "x", null, {"e": true}], "f": {}}, "g": [[2], [3, 4]]})")};
+    for (const size_t buffer_size : {size_t{1}, size_t{8}, JSONStreamWriter::DEFAULT_BUFFER_SIZE}) {
+        std::string text;
+        size_t pieces{0};
+        JSONStreamWriter writer{[&](std::string_view piece) { text += piece; ++pieces; }, buffer_size};
+        writer.BeginObject();
+        writer.Key("a");
+        writer.BeginArray();
+        writer.EndArray();
+        writer.Key("b\"c");
+        writer.BeginObject();
+        writer.Fields(value["b\"c"]);
+        writer.EndObject();
+        writer.Key("g");
+        writer.BeginArray();
+        for (const UniValue& item : value["g"].getValues()) writer.Value(item);
+        writer.EndArray();
+        writer.EndObject();
+        // Nothing is passed to the sink until the buffer is full.
+        BOOST_CHECK_EQUAL(pieces == 0, buffer_size > value.write().size());
+        writer.Flush();
+        BOOST_CHECK_EQUAL(text, value.write());
+    }
+
+    // A streamed block is the same as its description built in memory.
+    const CBlock& block{Params().GenesisBlock()};
+    const CBlockIndex& genesis{*Assert(WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Genesis()))};
+    const uint256 pow_limit{Params().GetConsensus().powLimit};
+    for (const TxVerbosity verbosity : {TxVerbosity::SHOW_TXID, TxVerbosity::SHOW_DETAILS, TxVerbosity::SHOW_DETAILS_AND_PREVOUT}) {
+        std::string text;
+        JSONStreamWriter writer{[&](std::string_view piece) { text += piece; }, /*buffer_size=*/16};
+        WriteBlockJSON(writer, block, /*block_undo=*/nullptr, genesis, genesis, verbosity, pow_limit);
+        writer.Flush();
+        BOOST_CHECK_EQUAL(text, blockToJSON(m_node.chainman->m_blockman, block, genesis, genesis, verbosity, pow_limit).write());
+    }
+}
+
+BOOST_AUTO_TEST_CASE(rpc_streamed_result_call_state)
+{
+    // A call that streams its result runs until the result is written, so it
+    // keeps its -rpcmethodlimit slot and getrpcinfo entry until then.
+    BOOST_REQUIRE(SetRPCMethodLimits({"streamed:1"}));
+    if (RPCIsInWarmup(nullptr)) SetRPCWarmupFinished();
+    const CRPCCommand command{"test", "streamed", [](const JSONRPCRequest&, UniValue&, bool) -> bool {
+        throw RPCStreamedResult{.write = [](JSONStreamWriter& writer) { writer.Value(UniValue{1}); }};
+    }, {}, /*unique_id=*/0};
+    CRPCTable table;
+    table.appendCommand("streamed", &command);
+    JSONRPCRequest request;
+    request.strMethod = "streamed";
+    const auto rpc_info{[] {
+        JSONRPCRequest info_request;
+        info_request.strMethod = "getrpcinfo";
+        return tableRPC.execute(info_request);
+    }};
+
+    try {
+        table.execute(request);
+        BOOST_ERROR("streamed did not stream its result");
+    } catch (const RPCStreamedResult& result) {
+        const UniValue info{rpc_info()};
+        BOOST_CHECK_EQUAL(info["active_commands"].size(), 2U);
+        BOOST_CHECK_EQUAL(info["method_limits"]["streamed"]["active"].getInt<int>(), 1);
+        try {
+            table.execute(request);
+            BOOST_ERROR("streamed went over its limit");
+        } catch (const UniValue& error) {
+            BOOST_CHECK(error["message"].get_str().starts_with("Too many concurrent streamed calls"));
+        }
+        std::string text;
+        JSONStreamWriter writer{[&](std::string_view piece) { text += piece; }};
+        result.write(writer);
+        writer.Flush();
+        BOOST_CHECK_EQUAL(text, "1");
+    }
+    const UniValue info{rpc_info()};
+    BOOST_CHECK_EQUAL(info["active_commands"].size(), 1U);
+    BOOST_CHECK_EQUAL(info["method_limits"]["streamed"]["active"].getInt<int>(), 0);
+    BOOST_CHECK_THROW(table.execute(request), RPCStreamedResult);
+    BOOST_CHECK(SetRPCMethodLimits({}));
+}
+
+BOOST_AUTO_TEST_CASE(rpc_binary_encoding)
+{
+    const UniValue params{JSON(R"([1, -2.5e3, "a\u0000b", true, false, null, [], {}, {"k": [{"n": 1}]}])")};
+    DataStream body;
+    WriteBinaryRPCRequest(body, {.id = 7, .method = "getblock", .params = params});
+    WriteBinaryRPCRequest(body, {.id = 8, .method = "help", .params = UniValue{UniValue::VOBJ}});
+    const auto requests{ReadBinaryRPCRequests(body)};
+    BOOST_REQUIRE_EQUAL(requests.size(), 2U);
+    BOOST_CHECK_EQUAL(requests[0].id, 7U);
+    BOOST_CHECK_EQUAL(requests[0].method, "getblock");
+    BOOST_CHECK_EQUAL(requests[0].params.write(), params.write());
+    BOOST_CHECK_EQUAL(requests[1].id, 8U);
+    BOOST_CHECK(requests[1].params.isObject());
+
+    DataStream reply_body;
+    BinaryRPCReply reply;
+    reply.id = 7;
+    reply.result = std::string{"\x00\x01\xff", 3};
+    WriteBinaryRPCReply(reply_body, reply);
+    reply.id = 8;
+    reply.error = JSONRPCError(RPC_INVALID_PARAMETER, "bad");
+    WriteBinaryRPCReply(reply_body, reply);
+    const auto replies{ReadBinaryRPCReplies(reply_body)};
+    BOOST_REQUIRE_EQUAL(replies.size(), 2U);
+    BOOST_CHECK_EQUAL(replies[0].result.get_str(), std::string("\x00\x01\xff", 3));
+    BOOST_CHECK(replies[0].error.isNull());
+    BOOST_CHECK(replies[1].result.isNull());
+    BOOST_CHECK_EQUAL(replies[1].error["code"].getInt<int>(), RPC_INVALID_PARAMETER);
+
+    // Malformed bodies are rejected.
+    BOOST_CHECK_THROW(ReadBinaryRPCRequests(std::span{body}.first(body.size() - 1)), std::ios_base::failure);
+    const auto frame{[](std::vector<uint8_t> payload) {
+        DataStream s;
+        ser_writedata32(s, payload.size());
+        s << std::span{payload};
+        return s;
+    }};
+    // Params that are not an array or object
+    BOOST_CHECK_THROW(ReadBinaryRPCRequests(frame({0, 0, 0, 0, 1, 'm', 0})), std::ios_base::failure);
+    // Unknown tag
+    BOOST_CHECK_THROW(ReadBinaryRPCRequests(frame({0, 0, 0, 0, 1, 'm', 7})), std::ios_base::failure);
+    // Trailing data in the frame
+    BOOST_CHECK_THROW(ReadBinaryRPCRequests(frame({0, 0, 0, 0, 1, 'm', 5, 0, 0})), std::ios_base::failure);
+    // Invalid number
+    BOOST_CHECK_THROW(ReadBinaryRPCRequests(frame({0, 0, 0, 0, 1, 'm', 5, 1, 3, 1, 'x'})), std::ios_base::failure);
+    BOOST_CHECK_EQUAL(ReadBinaryRPCRequests(frame({0, 0, 0, 0, 1, 'm', 5, 1, 3, 1, '5'}))[0].params[0].getInt<int>(), 5);
+    // Too deeply nested
+    std::vector<uint8_t> nested{0, 0, 0, 0, 1, 'm'};
+    for (int i{0}; i < 600; ++i) nested.insert(nested.end(), {5, 1});
+    nested.push_back(0);
+    BOOST_CHECK_THROW(ReadBinaryRPCRequests(frame(nested)), std::ios_base::failure);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,146 @@
+// Copyright (c) 2025-present The Hylium Core developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <addresstype.h>
+#include <chainparams.h>
+#include <consensus/validation.h>
+#include <index/scripthashindex.h>
+#include <interfaces/chain.h>
+#include <interfaces/types.h>
+#include <test/util/setup_common.h>
+#include <validation.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+
+BOOST_AUTO_TEST_SUITE(scripthashindex_tests)
+
+BOOST_FIXTURE_TEST_CASE(scripthashindex_initial_sync, TestChain100Setup)
+{
+    ScriptHashIndex index(interfaces::MakeChain(m_node), 1 << 20, true);
+    BOOST_REQUIRE(index.Init());
+
+    const CScript coinbase_script{CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG};
+    const uint256 coinbase_hash{ComputeScriptHash(coinbase_script)};
+
+    // Nothing should be found in the index before it is started.
+    BOOST_CHECK(index.FindHistory(coinbase_hash, std::nullopt, 1000)->empty());
+    BOOST_CHECK(!index.BlockUntilSyncedToCurrentChain());
+
+    index.Sync();
+
+    // Check that the index excludes the genesis block.
+    const CBlock& genesis_block = Params().GenesisBlock();
+    BOOST_CHECK(index.FindHistory(ComputeScriptHash(genesis_block.vtx[0]->vout[0].scriptPubKey), std::nullopt, 1000)->empty());
+
+    // Every coinbase output of the chain is in the history, and unspent, as of the tip.
+    interfaces::BlockRef synced_block;
+    const auto history{index.FindHistory(coinbase_hash, std::nullopt, 1000, &synced_block)};
+    BOOST_REQUIRE(history);
+    BOOST_CHECK_EQUAL(synced_block.height, 100);
+    BOOST_CHECK_EQUAL(synced_block.hash, WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip()->GetBlockHash()));
+    BOOST_REQUIRE_EQUAL(history->size(), m_coinbase_txns.size());
+    for (size_t i = 0; i < m_coinbase_txns.size(); ++i) {
+        const ScriptHistoryEntry& entry{(*history)[i]};
+        BOOST_CHECK_EQUAL(entry.pos.height, i + 1);
+        BOOST_CHECK(!entry.pos.spending);
+        BOOST_CHECK(entry.txid == m_coinbase_txns[i]->GetHash());
+        BOOST_CHECK_EQUAL(entry.amount, m_coinbase_txns[i]->vout[0].nValue);
+    }
+    const auto unspent{index.FindUnspent(coinbase_hash, std::nullopt, 1000)};
+    BOOST_REQUIRE(unspent);
+    BOOST_CHECK_EQUAL(unspent->size(), m_coinbase_txns.size());
+
+    // Paging through the history returns the same entries.
+    std::vector<ScriptHistoryEntry> paged;
+    std::optional<ScriptHistoryPosition> after;
+    while (true) {
+        const auto page{index.FindHistory(coinbase_hash, after, 7)};
+        BOOST_REQUIRE(page);
+        if (page->empty()) break;
+        BOOST_CHECK(page->size() <= 7);
+        paged.insert(paged.end(), page->begin(), page->end());
+        after = page->back().pos;
+    }
+    BOOST_REQUIRE_EQUAL(paged.size(), history->size());
+    for (size_t i = 0; i < paged.size(); ++i) {
+        BOOST_CHECK(paged[i].pos == (*history)[i].pos);
+    }
+    std::optional<COutPoint> after_outpoint;
+    size_t unspent_count{0};
+    while (true) {
+        const auto page{index.FindUnspent(coinbase_hash, after_outpoint, 7)};
+        BOOST_REQUIRE(page);
+        if (page->empty()) break;
+        unspent_count += page->size();
+        after_outpoint = page->back().outpoint;
+    }
+    BOOST_CHECK_EQUAL(unspent_count, m_coinbase_txns.size());
+
+    // Spend the first coinbase output to another script in a new block.
+    const CScript other_script{GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()))};
+    const CMutableTransaction spend{CreateValidMempoolTransaction(m_coinbase_txns[0], /*input_vout=*/0, /*input_height=*/1,
+                                                                  coinbaseKey, other_script, 1 * COIN, /*submit=*/false)};
+    const CBlock block{CreateAndProcessBlock({spend}, coinbase_script)};
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+
+    // The new block's coinbase output is received before the spend, which is ordered by its position in the block.
+    const auto new_history{index.FindHistory(coinbase_hash, history->back().pos, 1000)};
+    BOOST_REQUIRE(new_history);
+    BOOST_REQUIRE_EQUAL(new_history->size(), 2U);
+    BOOST_CHECK(!(*new_history)[0].pos.spending);
+    BOOST_CHECK((*new_history)[0].txid == block.vtx[0]->GetHash());
+    BOOST_CHECK((*new_history)[1].pos.spending);
+    BOOST_CHECK_EQUAL((*new_history)[1].pos.tx_pos, 1U);
+    BOOST_CHECK((*new_history)[1].txid == spend.GetHash());
+    BOOST_CHECK((*new_history)[1].outpoint == COutPoint(m_coinbase_txns[0]->GetHash(), 0));
+    BOOST_CHECK_EQUAL((*new_history)[1].amount, m_coinbase_txns[0]->vout[0].nValue);
+
+    // The spent output is gone, and the new coinbase output took its place.
+    auto new_unspent{index.FindUnspent(coinbase_hash, std::nullopt, 1000, &synced_block)};
+    BOOST_REQUIRE(new_unspent);
+    BOOST_CHECK_EQUAL(synced_block.height, 101);
+    BOOST_CHECK_EQUAL(synced_block.hash, block.GetHash());
+    BOOST_CHECK_EQUAL(new_unspent->size(), m_coinbase_txns.size());
+    for (const ScriptUnspentEntry& entry : *new_unspent) {
+        BOOST_CHECK(entry.outpoint != COutPoint(m_coinbase_txns[0]->GetHash(), 0));
+    }
+    const auto other_unspent{index.FindUnspent(ComputeScriptHash(other_script), std::nullopt, 1000)};
+    BOOST_REQUIRE(other_unspent);
+    BOOST_REQUIRE_EQUAL(other_unspent->size(), 1U);
+    BOOST_CHECK(other_unspent->front().outpoint == COutPoint(spend.GetHash(), 0));
+    BOOST_CHECK_EQUAL(other_unspent->front().height, 101);
+
+    // Replacing the block with one without the spend rewinds the index past it.
+    // Disconnected blocks are removed from the index once the next block is
+    // connected (see BaseIndex::Rewind).
+    {
+        BlockValidationState state;
+        CBlockIndex* tip{WITH_LOCK(::cs_main, return m_node.chainman->ActiveChain().Tip())};
+        BOOST_REQUIRE(m_node.chainman->ActiveChainstate().InvalidateBlock(state, tip));
+    }
+    const CBlock replacement{CreateAndProcessBlock({}, coinbase_script)};
+    BOOST_CHECK(index.BlockUntilSyncedToCurrentChain());
+    const auto replaced_history{index.FindHistory(coinbase_hash, std::nullopt, 1000, &synced_block)};
+    BOOST_REQUIRE(replaced_history);
+    BOOST_CHECK_EQUAL(synced_block.height, 101);
+    BOOST_CHECK_EQUAL(synced_block.hash, replacement.GetHash());
+    BOOST_REQUIRE_EQUAL(replaced_history->size(), history->size() + 1);
+    BOOST_CHECK(replaced_history->back().txid == replacement.vtx[0]->GetHash());
+    BOOST_CHECK(!replaced_history->back().pos.spending);
+    BOOST_CHECK(index.FindHistory(ComputeScriptHash(other_script), std::nullopt, 1000)->empty());
+    BOOST_CHECK(index.FindUnspent(ComputeScriptHash(other_script), std::nullopt, 1000)->empty());
+    new_unspent = index.FindUnspent(coinbase_hash, std::nullopt, 1000);
+    BOOST_REQUIRE(new_unspent);
+    BOOST_CHECK_EQUAL(new_unspent->size(), unspent->size() + 1);
+    BOOST_CHECK(std::ranges::any_of(*new_unspent, [&](const ScriptUnspentEntry& entry) {
+        return entry.outpoint == COutPoint(m_coinbase_txns[0]->GetHash(), 0) && entry.height == 1;
+    }));
+
+    // shutdown sequence (c.f. Shutdown() in init.cpp)
+    index.Stop();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
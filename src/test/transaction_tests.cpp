@@ -16,6 +16,7 @@
 #include <key.h>
 #include <policy/policy.h>
 #include <policy/settings.h>
+#include <primitives/block.h>
 #include <primitives/transaction_identifier.h>
 #include <script/interpreter.h>
 #include <script/script.h>
@@ -25,6 +26,7 @@
 #include <script/signingprovider.h>
 #include <script/solver.h>
 #include <streams.h>
+#include <support/allocators/chunk_arena.h>
 #include <test/util/json.h>
 #include <test/util/random.h>
 #include <test/util/script.h>
@@ -388,6 +390,60 @@ BOOST_AUTO_TEST_CASE(basic_transaction_tests)
     BOOST_CHECK_MESSAGE(!CheckTransaction(CTransaction(tx), state) || !state.IsValid(), "Transaction with duplicate txins should be invalid.");
 }
 
+BOOST_AUTO_TEST_CASE(arena_deserialization)
+{
+    // Transactions with scripts that fit in a CScript (like P2WSH), that
+    // don't, and one that doesn't fit in a chunk of the arena
+    CBlock block;
+    for (int i{0}; i < 200; ++i) {
+        CMutableTransaction mtx;
+        mtx.vin.emplace_back(Txid::FromUint256(m_rng.rand256()), i, CScript() << m_rng.randbytes(i % 3 == 0 ? 100 : 10));
+        mtx.vin[0].scriptWitness.stack.emplace_back(m_rng.randbytes(72));
+        mtx.vout.emplace_back(i, GetScriptForDestination(WitnessV0ScriptHash{m_rng.rand256()}));
+        mtx.vout.emplace_back(i, CScript() << OP_RETURN << m_rng.randbytes(i == 100 ? TX_ARENA_CHUNK_SIZE : 80));
+        block.vtx.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+    DataStream stream;
+    stream << TX_WITH_WITNESS(block);
+
+    CBlock arena_block;
+    CTransactionRef kept;
+    {
+        ChunkArena arena{TX_ARENA_CHUNK_SIZE};
+        const TransactionSerParams params{.allow_witness = true, .arena = &arena};
+        stream >> params(arena_block);
+        BOOST_CHECK_GT(arena.ChunkCount(), 1U);
+        BOOST_CHECK_LT(arena.ChunkCount(), block.vtx.size() / 10);
+    }
+    BOOST_REQUIRE_EQUAL(arena_block.vtx.size(), block.vtx.size());
+    for (size_t i{0}; i < block.vtx.size(); ++i) {
+        const CTransaction& tx{*arena_block.vtx[i]};
+        BOOST_CHECK(tx.GetWitnessHash() == block.vtx[i]->GetWitnessHash());
+        BOOST_CHECK_EQUAL(tx.vin[0].scriptSig.is_borrowed(), i % 3 == 0);
+        BOOST_CHECK(!tx.vout[0].scriptPubKey.is_borrowed());
+        BOOST_CHECK_EQUAL(tx.vout[1].scriptPubKey.is_borrowed(), i != 100);
+    }
+    BOOST_CHECK(arena_block.GetHash() == block.GetHash());
+
+    // A transaction kept after its block, and the arena, are gone
+    kept = arena_block.vtx[150];
+    arena_block.vtx.clear();
+    BOOST_CHECK(kept->GetWitnessHash() == block.vtx[150]->GetWitnessHash());
+    BOOST_CHECK(CMutableTransaction{*kept}.GetHash() == kept->GetHash());
+    BOOST_CHECK(kept->IsInArena());
+
+    // A detached copy owns its scripts, and a transaction that is not in an
+    // arena is not copied
+    const CTransactionRef detached{DetachFromArena(kept)};
+    BOOST_CHECK(detached != kept);
+    BOOST_CHECK(!detached->IsInArena());
+    BOOST_CHECK(!detached->vin[0].scriptSig.is_borrowed());
+    BOOST_CHECK(!detached->vout[1].scriptPubKey.is_borrowed());
+    BOOST_CHECK(detached->GetWitnessHash() == kept->GetWitnessHash());
+    BOOST_CHECK(!block.vtx[150]->IsInArena());
+    BOOST_CHECK(DetachFromArena(block.vtx[150]) == block.vtx[150]);
+}
+
 BOOST_AUTO_TEST_CASE(test_Get)
 {
     FillableSigningProvider keystore;
@@ -24,7 +24,8 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
                        const CCoinsViewCache& inputs, script_verify_flags flags, bool cacheSigStore,
                        bool cacheFullScriptStore, PrecomputedTransactionData& txdata,
                        ValidationCache& validation_cache,
-                       std::vector<CScriptCheck>* pvChecks) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+                       std::vector<CScriptCheck>* pvChecks,
+                       const CTxMemPool* mempool = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 BOOST_AUTO_TEST_SUITE(txvalidationcache_tests)
 
@@ -385,4 +386,103 @@ BOOST_FIXTURE_TEST_CASE(checkinputs_test, Dersig100Setup)
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(mempool_precomputed_txdata, Dersig100Setup)
+{
+    // The sighash precomputations of a segwit transaction accepted to the
+    // mempool are kept with its entry, and reused when it is in a block.
+    CScript p2pk_scriptPubKey = CScript() << ToByteVector(coinbaseKey.GetPubKey()) << OP_CHECKSIG;
+    CScript p2wpkh_scriptPubKey = GetScriptForDestination(WitnessV0KeyHash(coinbaseKey.GetPubKey()));
+    FillableSigningProvider keystore;
+    BOOST_CHECK(keystore.AddKey(coinbaseKey));
+
+    const auto GetTxData = [this](const CMutableTransaction& tx) {
+        LOCK(m_node.mempool->cs);
+        const auto it{m_node.mempool->GetIter(CTransaction{tx}.GetWitnessHash())};
+        BOOST_REQUIRE(it);
+        return (*it)->GetPrecomputedTxData();
+    };
+
+    CMutableTransaction legacy_tx;
+    legacy_tx.version = 1;
+    legacy_tx.vin.resize(1);
+    legacy_tx.vin[0].prevout = COutPoint{m_coinbase_txns[0]->GetHash(), 0};
+    legacy_tx.vout.resize(1);
+    legacy_tx.vout[0].nValue = 11 * CENT;
+    legacy_tx.vout[0].scriptPubKey = p2wpkh_scriptPubKey;
+    std::vector<unsigned char> vchSig;
+    uint256 hash = SignatureHash(p2pk_scriptPubKey, legacy_tx, 0, SIGHASH_ALL, 0, SigVersion::BASE);
+    BOOST_CHECK(coinbaseKey.Sign(hash, vchSig));
+    vchSig.push_back((unsigned char)SIGHASH_ALL);
+    legacy_tx.vin[0].scriptSig << vchSig;
+
+    // Nothing is kept for a transaction without witnesses
+    BOOST_CHECK_EQUAL(WITH_LOCK(cs_main, return m_node.chainman->ProcessTransaction(MakeTransactionRef(legacy_tx)).m_result_type), MempoolAcceptResult::ResultType::VALID);
+    BOOST_CHECK(!GetTxData(legacy_tx));
+    CreateAndProcessBlock({legacy_tx}, p2pk_scriptPubKey);
+
+    CMutableTransaction segwit_tx;
+    segwit_tx.version = 2;
+    segwit_tx.vin.resize(1);
+    segwit_tx.vin[0].prevout = COutPoint{legacy_tx.GetHash(), 0};
+    segwit_tx.vout.resize(1);
+    segwit_tx.vout[0].nValue = 10 * CENT;
+    segwit_tx.vout[0].scriptPubKey = p2pk_scriptPubKey;
+    SignatureData sigdata;
+    BOOST_CHECK(ProduceSignature(keystore, MutableTransactionSignatureCreator(segwit_tx, 0, 11 * CENT, SIGHASH_ALL), p2wpkh_scriptPubKey, sigdata));
+    UpdateInput(segwit_tx.vin[0], sigdata);
+
+    BOOST_CHECK_EQUAL(WITH_LOCK(cs_main, return m_node.chainman->ProcessTransaction(MakeTransactionRef(segwit_tx)).m_result_type), MempoolAcceptResult::ResultType::VALID);
+    const auto cached{GetTxData(segwit_tx)};
+    BOOST_REQUIRE(cached);
+    BOOST_CHECK(cached->m_bip143_segwit_ready);
+    BOOST_CHECK(!cached->m_spent_outputs_ready);
+
+    PrecomputedTransactionData expected;
+    expected.Init(segwit_tx, {legacy_tx.vout[0]});
+    BOOST_CHECK_EQUAL(cached->hashPrevouts, expected.hashPrevouts);
+    BOOST_CHECK_EQUAL(cached->hashSequence, expected.hashSequence);
+    BOOST_CHECK_EQUAL(cached->hashOutputs, expected.hashOutputs);
+
+    // Initializing a copy only adds the spent outputs
+    PrecomputedTransactionData reused{*cached};
+    reused.Init(segwit_tx, {legacy_tx.vout[0]});
+    BOOST_CHECK(reused.m_spent_outputs_ready);
+    BOOST_CHECK(reused.m_spent_outputs == expected.m_spent_outputs);
+    BOOST_CHECK_EQUAL(reused.hashOutputs, expected.hashOutputs);
+
+    // ConnectBlock passes the mempool to CheckInputScripts, which starts from
+    // them on a miss of the script execution cache, as with a new one here:
+    // hashes that don't match the transaction would fail it
+    {
+        LOCK(cs_main);
+        ValidationCache validation_cache{1 << 20, 1 << 20};
+        const script_verify_flags flags{SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_WITNESS};
+        const CTransaction tx{segwit_tx};
+        const auto set_txdata{[&](std::shared_ptr<const PrecomputedTransactionData> txdata) {
+            LOCK(m_node.mempool->cs);
+            (*m_node.mempool->GetIter(tx.GetWitnessHash()))->SetPrecomputedTxData(std::move(txdata));
+        }};
+        TxValidationState state;
+        PrecomputedTransactionData txdata;
+        BOOST_CHECK(CheckInputScripts(tx, state, &m_node.chainman->ActiveChainstate().CoinsTip(), flags, false, false, txdata, validation_cache, nullptr, m_node.mempool.get()));
+        BOOST_CHECK(txdata.m_spent_outputs_ready);
+        BOOST_CHECK_EQUAL(txdata.hashOutputs, expected.hashOutputs);
+
+        auto wrong{std::make_shared<PrecomputedTransactionData>(*cached)};
+        wrong->hashOutputs = uint256::ONE;
+        set_txdata(wrong);
+        PrecomputedTransactionData wrong_txdata;
+        BOOST_CHECK(!CheckInputScripts(tx, state, &m_node.chainman->ActiveChainstate().CoinsTip(), flags, false, false, wrong_txdata, validation_cache, nullptr, m_node.mempool.get()));
+        BOOST_CHECK_EQUAL(wrong_txdata.hashOutputs, uint256::ONE);
+        PrecomputedTransactionData fresh_txdata;
+        state = TxValidationState{};
+        BOOST_CHECK(CheckInputScripts(tx, state, &m_node.chainman->ActiveChainstate().CoinsTip(), flags, false, false, fresh_txdata, validation_cache, nullptr));
+        set_txdata(cached);
+    }
+
+    const CBlock block{CreateAndProcessBlock({segwit_tx}, p2pk_scriptPubKey)};
+    BOOST_CHECK_EQUAL(WITH_LOCK(cs_main, return m_node.chainman->ActiveChain().Tip()->GetBlockHash()), block.GetHash());
+    BOOST_CHECK_EQUAL(m_node.mempool->size(), 0U);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
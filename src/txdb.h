@@ -56,6 +56,8 @@ public:
 
     //! @returns filesystem path to on-disk storage or std::nullopt if in memory.
     std::optional<fs::path> StoragePath() { return m_db->StoragePath(); }
+
+    DBStats GetDBStats() const { return m_db->GetStats(); }
 };
 
 #endif // HYLIUM_TXDB_H
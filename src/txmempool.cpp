@@ -594,6 +594,26 @@ std::vector<TxMempoolInfo> CTxMemPool::infoAll() const
     return ret;
 }
 
+std::vector<TxMempoolInfo> CTxMemPool::infoSorted(std::span<const Wtxid> wtxids) const
+{
+    LOCK(cs);
+    std::vector<txiter> iters;
+    iters.reserve(wtxids.size());
+    for (const Wtxid& wtxid : wtxids) {
+        if (auto i{GetIter(wtxid)}) iters.push_back(*i);
+    }
+    std::sort(iters.begin(), iters.end(), [this](const auto& a, const auto& b) EXCLUSIVE_LOCKS_REQUIRED(cs) noexcept {
+        return m_txgraph->CompareMainOrder(*a, *b) < 0;
+    });
+
+    std::vector<TxMempoolInfo> ret;
+    ret.reserve(iters.size());
+    for (auto it : iters) {
+        ret.push_back(GetInfo(it));
+    }
+    return ret;
+}
+
 const CTxMemPoolEntry* CTxMemPool::GetEntry(const Txid& txid) const
 {
     AssertLockHeld(cs);
@@ -37,6 +37,7 @@
 #include <map>
 #include <optional>
 #include <set>
+#include <span>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -538,6 +539,9 @@ public:
 
     std::vector<CTxMemPoolEntryRef> entryAll() const EXCLUSIVE_LOCKS_REQUIRED(cs);
     std::vector<TxMempoolInfo> infoAll() const;
+    /** Returns info for those of the given transactions that are in the mempool, sorted like infoAll() (i.e.
+     *  topologically and by mining score, see CompareMiningScoreWithTopology()). */
+    std::vector<TxMempoolInfo> infoSorted(std::span<const Wtxid> wtxids) const;
 
     size_t DynamicMemoryUsage() const;
 
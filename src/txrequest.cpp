@@ -9,17 +9,18 @@
 #include <primitives/transaction.h>
 #include <random.h>
 #include <uint256.h>
+#include <util/hasher.h>
 
-#include <boost/multi_index/indexed_by.hpp>
-#include <boost/multi_index/ordered_index.hpp>
-#include <boost/multi_index/sequenced_index.hpp>
-#include <boost/multi_index/tag.hpp>
-#include <boost/multi_index_container.hpp>
-#include <boost/tuple/tuple.hpp>
-
+#include <algorithm>
+#include <array>
 #include <chrono>
+#include <limits>
+#include <map>
+#include <optional>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <cassert>
 
@@ -28,7 +29,7 @@ namespace {
 /** The various states a (txhash,peer) pair can be in.
  *
  * Note that CANDIDATE is split up into 3 substates (DELAYED, BEST, READY), allowing more efficient implementation.
- * Also note that the sorting order of ByTxHashView relies on the specific order of values in this enum.
+ * Also note that GetCandidatePeers() reports announcements in the order of the values in this enum.
  *
  * Expected behaviour is:
  *   - When first announced by a peer, the state is CANDIDATE_DELAYED until reqtime is reached.
@@ -57,22 +58,40 @@ enum class State : uint8_t {
 //! Type alias for sequence numbers.
 using SequenceNumber = uint64_t;
 
+//! Type alias for priorities.
+using Priority = uint64_t;
+
+//! Position of an announcement in TxRequestTracker::Impl's announcement pool.
+using AnnIndex = uint32_t;
+
 /** An announcement. This is the data we track for each txid or wtxid that is announced to us by each peer. */
 struct Announcement {
     /** Txid or wtxid that was announced. */
-    const GenTxid m_gtxid;
+    GenTxid m_gtxid;
     /** For CANDIDATE_{DELAYED,BEST,READY} the reqtime; for REQUESTED the expiry. */
     std::chrono::microseconds m_time;
+    /** Priority of this announcement (see PriorityComputer); cached as it never changes. */
+    Priority m_priority;
     /** What peer the request was from. */
-    const NodeId m_peer;
+    NodeId m_peer;
     /** What sequence number this announcement has. */
-    const SequenceNumber m_sequence : 59;
+    SequenceNumber m_sequence : 59;
     /** Whether the request is preferred. */
-    const bool m_preferred : 1;
+    bool m_preferred : 1;
     /** What state this announcement is in. */
     State m_state : 3 {State::CANDIDATE_DELAYED};
+    /** Whether this pool entry holds an announcement (as opposed to being on the free list). */
+    bool m_live : 1 {false};
+    /** Position of this announcement in its peer's PeerInfo::m_anns. */
+    uint32_t m_peer_pos{0};
+    /** Position of this announcement in its txhash's TxHashBucket. */
+    uint32_t m_bucket_pos{0};
+    /** Position of this announcement in its peer's PeerInfo::m_best (only while CANDIDATE_BEST). */
+    uint32_t m_best_pos{0};
+    /** Bumped whenever the announcement is (re)scheduled or freed, to invalidate older timer wheel entries. */
+    uint32_t m_timer_gen{0};
+
     State GetState() const { return m_state; }
-    void SetState(State state) { m_state = state; }
 
     /** Whether this announcement is selected. There can be at most 1 selected peer per txhash. */
     bool IsSelected() const
@@ -92,15 +111,9 @@ struct Announcement {
         return GetState() == State::CANDIDATE_READY || GetState() == State::CANDIDATE_BEST;
     }
 
-    /** Construct a new announcement from scratch, initially in CANDIDATE_DELAYED state. */
-    Announcement(const GenTxid& gtxid, NodeId peer, bool preferred, std::chrono::microseconds reqtime,
-                 SequenceNumber sequence)
-        : m_gtxid(gtxid), m_time(reqtime), m_peer(peer), m_sequence(sequence), m_preferred(preferred) {}
+    Announcement() : m_gtxid{Txid{}}, m_time{0}, m_priority{0}, m_peer{0}, m_sequence{0}, m_preferred{false} {}
 };
 
-//! Type alias for priorities.
-using Priority = uint64_t;
-
 /** A functor with embedded salt that computes priority of an announcement.
  *
  * Higher priorities are selected first.
@@ -117,121 +130,21 @@ public:
         uint64_t low_bits = CSipHasher(m_k0, m_k1).Write(txhash).Write(peer).Finalize() >> 1;
         return low_bits | uint64_t{preferred} << 63;
     }
-
-    Priority operator()(const Announcement& ann) const
-    {
-        return operator()(ann.m_gtxid.ToUint256(), ann.m_peer, ann.m_preferred);
-    }
 };
 
-// Definitions for the 3 indexes used in the main data structure.
-//
-// Each index has a By* type to identify it, a By*View data type to represent the view of announcement it is sorted
-// by, and an By*ViewExtractor type to convert an announcement into the By*View type.
-// See https://www.boost.org/doc/libs/1_58_0/libs/multi_index/doc/reference/key_extraction.html#key_extractors
-// for more information about the key extraction concept.
-
-// The ByPeer index is sorted by (peer, state == CANDIDATE_BEST, txhash)
-//
-// Uses:
-// * Looking up existing announcements by peer/txhash, by checking both (peer, false, txhash) and
-//   (peer, true, txhash).
-// * Finding all CANDIDATE_BEST announcements for a given peer in GetRequestable.
-struct ByPeer {};
-using ByPeerView = std::tuple<NodeId, bool, const uint256&>;
-struct ByPeerViewExtractor
-{
-    using result_type = ByPeerView;
-    result_type operator()(const Announcement& ann) const
-    {
-        return ByPeerView{ann.m_peer, ann.GetState() == State::CANDIDATE_BEST, ann.m_gtxid.ToUint256()};
-    }
-};
-
-// The ByTxHash index is sorted by (txhash, state, priority).
-//
-// Note: priority == 0 whenever state != CANDIDATE_READY.
-//
-// Uses:
-// * Deleting all announcements with a given txhash in ForgetTxHash.
-// * Finding the best CANDIDATE_READY to convert to CANDIDATE_BEST, when no other CANDIDATE_READY or REQUESTED
-//   announcement exists for that txhash.
-// * Determining when no more non-COMPLETED announcements for a given txhash exist, so the COMPLETED ones can be
-//   deleted.
-struct ByTxHash {};
-using ByTxHashView = std::tuple<const uint256&, State, Priority>;
-class ByTxHashViewExtractor {
-    const PriorityComputer& m_computer;
-public:
-    explicit ByTxHashViewExtractor(const PriorityComputer& computer) : m_computer(computer) {}
-    using result_type = ByTxHashView;
-    result_type operator()(const Announcement& ann) const
-    {
-        const Priority prio = (ann.GetState() == State::CANDIDATE_READY) ? m_computer(ann) : 0;
-        return ByTxHashView{ann.m_gtxid.ToUint256(), ann.GetState(), prio};
-    }
-};
-
-enum class WaitState {
-    //! Used for announcements that need efficient testing of "is their timestamp in the future?".
-    FUTURE_EVENT,
-    //! Used for announcements whose timestamp is not relevant.
-    NO_EVENT,
-    //! Used for announcements that need efficient testing of "is their timestamp in the past?".
-    PAST_EVENT,
-};
-
-WaitState GetWaitState(const Announcement& ann)
-{
-    if (ann.IsWaiting()) return WaitState::FUTURE_EVENT;
-    if (ann.IsSelectable()) return WaitState::PAST_EVENT;
-    return WaitState::NO_EVENT;
-}
-
-// The ByTime index is sorted by (wait_state, time).
-//
-// All announcements with a timestamp in the future can be found by iterating the index forward from the beginning.
-// All announcements with a timestamp in the past can be found by iterating the index backwards from the end.
-//
-// Uses:
-// * Finding CANDIDATE_DELAYED announcements whose reqtime has passed, and REQUESTED announcements whose expiry has
-//   passed.
-// * Finding CANDIDATE_READY/BEST announcements whose reqtime is in the future (when the clock time went backwards).
-struct ByTime {};
-using ByTimeView = std::pair<WaitState, std::chrono::microseconds>;
-struct ByTimeViewExtractor
-{
-    using result_type = ByTimeView;
-    result_type operator()(const Announcement& ann) const
-    {
-        return ByTimeView{GetWaitState(ann), ann.m_time};
-    }
-};
-
-struct Announcement_Indices final : boost::multi_index::indexed_by<
-    boost::multi_index::ordered_unique<boost::multi_index::tag<ByPeer>, ByPeerViewExtractor>,
-    boost::multi_index::ordered_non_unique<boost::multi_index::tag<ByTxHash>, ByTxHashViewExtractor>,
-    boost::multi_index::ordered_non_unique<boost::multi_index::tag<ByTime>, ByTimeViewExtractor>
->
-{};
-
-/** Data type for the main data structure (Announcement objects with ByPeer/ByTxHash/ByTime indexes). */
-using Index = boost::multi_index_container<
-    Announcement,
-    Announcement_Indices
->;
-
-/** Helper type to simplify syntax of iterator types. */
-template<typename Tag>
-using Iter = typename Index::index<Tag>::type::iterator;
-
-/** Per-peer statistics object. */
+/** Per-peer data: statistics, plus the peer's announcements and CANDIDATE_BEST announcements. */
 struct PeerInfo {
     size_t m_total = 0; //!< Total number of announcements for this peer.
     size_t m_completed = 0; //!< Number of COMPLETED announcements for this peer.
     size_t m_requested = 0; //!< Number of REQUESTED announcements for this peer.
+    std::vector<AnnIndex> m_anns; //!< All announcements of this peer.
+    std::vector<AnnIndex> m_best; //!< The CANDIDATE_BEST announcements of this peer, in no particular order.
 };
 
+/** All announcements for one txhash. Txhashes are typically announced by a handful of peers (at most one
+ *  announcement per peer), so a flat vector is both the most compact and the fastest representation. */
+using TxHashBucket = std::vector<AnnIndex>;
+
 /** Per-txhash statistics object. Only used for sanity checking. */
 struct TxHashInfo
 {
@@ -251,53 +164,29 @@ struct TxHashInfo
     std::vector<NodeId> m_peers;
 };
 
-/** Compare two PeerInfo objects. Only used for sanity checking. */
-bool operator==(const PeerInfo& a, const PeerInfo& b)
-{
-    return std::tie(a.m_total, a.m_completed, a.m_requested) ==
-           std::tie(b.m_total, b.m_completed, b.m_requested);
+/** A hashed timer wheel entry: announcement plus the m_timer_gen it was scheduled with. */
+struct TimerEntry {
+    AnnIndex m_ann;
+    uint32_t m_gen;
 };
 
-/** (Re)compute the PeerInfo map from the index. Only used for sanity checking. */
-std::unordered_map<NodeId, PeerInfo> RecomputePeerInfo(const Index& index)
-{
-    std::unordered_map<NodeId, PeerInfo> ret;
-    for (const Announcement& ann : index) {
-        PeerInfo& info = ret[ann.m_peer];
-        ++info.m_total;
-        info.m_requested += (ann.GetState() == State::REQUESTED);
-        info.m_completed += (ann.GetState() == State::COMPLETED);
-    }
-    return ret;
-}
+//! log2 of the timer wheel's slot width in microseconds (~65 ms).
+constexpr int TIMER_SLOT_BITS{16};
+//! Number of slots in the timer wheel (together ~67 s, a bit more than the usual request expiry).
+constexpr size_t TIMER_SLOTS{1024};
 
-/** Compute the TxHashInfo map. Only used for sanity checking. */
-std::map<uint256, TxHashInfo> ComputeTxHashInfo(const Index& index, const PriorityComputer& computer)
-{
-    std::map<uint256, TxHashInfo> ret;
-    for (const Announcement& ann : index) {
-        TxHashInfo& info = ret[ann.m_gtxid.ToUint256()];
-        // Classify how many announcements of each state we have for this txhash.
-        info.m_candidate_delayed += (ann.GetState() == State::CANDIDATE_DELAYED);
-        info.m_candidate_ready += (ann.GetState() == State::CANDIDATE_READY);
-        info.m_candidate_best += (ann.GetState() == State::CANDIDATE_BEST);
-        info.m_requested += (ann.GetState() == State::REQUESTED);
-        // And track the priority of the best CANDIDATE_READY/CANDIDATE_BEST announcements.
-        if (ann.GetState() == State::CANDIDATE_BEST) {
-            info.m_priority_candidate_best = computer(ann);
-        }
-        if (ann.GetState() == State::CANDIDATE_READY) {
-            info.m_priority_best_candidate_ready = std::max(info.m_priority_best_candidate_ready, computer(ann));
-        }
-        // Also keep track of which peers this txhash has an announcement for (so we can detect duplicates).
-        info.m_peers.push_back(ann.m_peer);
-    }
-    return ret;
-}
+//! Timer wheel tick (slot number before wrapping) a point in time falls into.
+int64_t TimerTick(std::chrono::microseconds time) { return time.count() >> TIMER_SLOT_BITS; }
 
 }  // namespace
 
-/** Actual implementation for TxRequestTracker's data structure. */
+/** Actual implementation for TxRequestTracker's data structure.
+ *
+ * Announcements live in a pool (m_anns, with a free list), and are referenced by position from:
+ * - m_txhashes: one flat bucket of announcements per txhash.
+ * - m_peerinfo: per peer, all its announcements and its CANDIDATE_BEST ones.
+ * - m_timer_wheel: CANDIDATE_DELAYED and REQUESTED announcements, keyed by the time they need attention.
+ */
 class TxRequestTracker::Impl {
     //! The current sequence number. Increases for every announcement. This is used to sort txhashes returned by
     //! GetRequestable in announcement order.
@@ -306,21 +195,95 @@ class TxRequestTracker::Impl {
     //! This tracker's priority computer.
     const PriorityComputer m_computer;
 
-    //! This tracker's main data structure. See SanityCheck() for the invariants that apply to it.
-    Index m_index;
+    //! Pool of announcements, and the positions in it that are unused.
+    std::vector<Announcement> m_anns;
+    std::vector<AnnIndex> m_free;
+
+    //! All announcements grouped by txhash.
+    std::unordered_map<uint256, TxHashBucket, SaltedUint256Hasher> m_txhashes;
 
-    //! Map with this tracker's per-peer statistics.
+    //! Map with this tracker's per-peer data.
     std::unordered_map<NodeId, PeerInfo> m_peerinfo;
 
+    //! Hashed timer wheel of CANDIDATE_DELAYED reqtimes and REQUESTED expiries. Entries are invalidated lazily
+    //! (see Announcement::m_timer_gen) and dropped when their slot is next visited.
+    std::array<std::vector<TimerEntry>, TIMER_SLOTS> m_timer_wheel;
+    //! Timer wheel tick from which the next SetTimePoint() starts visiting slots. Entries scheduled for an earlier
+    //! tick are placed in this tick's slot instead.
+    int64_t m_timer_tick{std::numeric_limits<int64_t>::min()};
+    //! The 'now' passed to the previous SetTimePoint(), to detect the clock going backwards.
+    std::chrono::microseconds m_last_now{std::chrono::microseconds::min()};
+
 public:
     void SanityCheck() const
     {
-        // Recompute m_peerdata from m_index. This verifies the data in it as it should just be caching statistics
-        // on m_index. It also verifies the invariant that no PeerInfo announcements with m_total==0 exist.
-        assert(m_peerinfo == RecomputePeerInfo(m_index));
+        // Recompute per-peer statistics from the announcement pool. This verifies the data in m_peerinfo as it
+        // should just be caching statistics. It also verifies the invariant that no PeerInfo entries with
+        // m_total==0 exist.
+        std::unordered_map<NodeId, PeerInfo> peerinfo;
+        std::map<uint256, TxHashInfo> txhashinfo;
+        size_t live{0};
+        for (AnnIndex idx = 0; idx < m_anns.size(); ++idx) {
+            const Announcement& ann = m_anns[idx];
+            if (!ann.m_live) continue;
+            ++live;
+            PeerInfo& info = peerinfo[ann.m_peer];
+            ++info.m_total;
+            info.m_requested += (ann.GetState() == State::REQUESTED);
+            info.m_completed += (ann.GetState() == State::COMPLETED);
+
+            // Every announcement must be reachable through its peer and its txhash.
+            const auto peerit = m_peerinfo.find(ann.m_peer);
+            assert(peerit != m_peerinfo.end());
+            assert(ann.m_peer_pos < peerit->second.m_anns.size() && peerit->second.m_anns[ann.m_peer_pos] == idx);
+            if (ann.GetState() == State::CANDIDATE_BEST) {
+                assert(ann.m_best_pos < peerit->second.m_best.size() && peerit->second.m_best[ann.m_best_pos] == idx);
+            }
+            const auto txit = m_txhashes.find(ann.m_gtxid.ToUint256());
+            assert(txit != m_txhashes.end());
+            assert(std::count(txit->second.begin(), txit->second.end(), idx) == 1);
+            assert(ann.m_priority == m_computer(ann.m_gtxid.ToUint256(), ann.m_peer, ann.m_preferred));
+
+            TxHashInfo& txinfo = txhashinfo[ann.m_gtxid.ToUint256()];
+            // Classify how many announcements of each state we have for this txhash.
+            txinfo.m_candidate_delayed += (ann.GetState() == State::CANDIDATE_DELAYED);
+            txinfo.m_candidate_ready += (ann.GetState() == State::CANDIDATE_READY);
+            txinfo.m_candidate_best += (ann.GetState() == State::CANDIDATE_BEST);
+            txinfo.m_requested += (ann.GetState() == State::REQUESTED);
+            // And track the priority of the best CANDIDATE_READY/CANDIDATE_BEST announcements.
+            if (ann.GetState() == State::CANDIDATE_BEST) {
+                txinfo.m_priority_candidate_best = ann.m_priority;
+            }
+            if (ann.GetState() == State::CANDIDATE_READY) {
+                txinfo.m_priority_best_candidate_ready = std::max(txinfo.m_priority_best_candidate_ready, ann.m_priority);
+            }
+            // Also keep track of which peers this txhash has an announcement for (so we can detect duplicates).
+            txinfo.m_peers.push_back(ann.m_peer);
+        }
+        assert(live + m_free.size() == m_anns.size());
+
+        assert(peerinfo.size() == m_peerinfo.size());
+        for (const auto& [peer, info] : m_peerinfo) {
+            const auto it = peerinfo.find(peer);
+            assert(it != peerinfo.end());
+            assert(info.m_total == it->second.m_total);
+            assert(info.m_requested == it->second.m_requested);
+            assert(info.m_completed == it->second.m_completed);
+            assert(info.m_anns.size() == info.m_total);
+            for (AnnIndex idx : info.m_best) assert(m_anns[idx].m_live && m_anns[idx].GetState() == State::CANDIDATE_BEST);
+        }
 
-        // Calculate per-txhash statistics from m_index, and validate invariants.
-        for (auto& item : ComputeTxHashInfo(m_index, m_computer)) {
+        size_t bucketed{0};
+        for (const auto& [txhash, bucket] : m_txhashes) {
+            assert(!bucket.empty());
+            for (size_t pos = 0; pos < bucket.size(); ++pos) assert(m_anns[bucket[pos]].m_bucket_pos == pos);
+            bucketed += bucket.size();
+        }
+        assert(bucketed == live);
+        assert(txhashinfo.size() == m_txhashes.size());
+
+        // Validate per-txhash invariants.
+        for (auto& item : txhashinfo) {
             TxHashInfo& info = item.second;
 
             // Cannot have only COMPLETED peer (txhash should have been forgotten already)
@@ -345,11 +308,23 @@ public:
             std::sort(info.m_peers.begin(), info.m_peers.end());
             assert(std::adjacent_find(info.m_peers.begin(), info.m_peers.end()) == info.m_peers.end());
         }
+
+        // Every waiting announcement must have a live timer wheel entry.
+        std::vector<bool> scheduled(m_anns.size());
+        for (const auto& slot : m_timer_wheel) {
+            for (const TimerEntry& entry : slot) {
+                if (m_anns[entry.m_ann].m_timer_gen == entry.m_gen) scheduled[entry.m_ann] = true;
+            }
+        }
+        for (AnnIndex idx = 0; idx < m_anns.size(); ++idx) {
+            if (m_anns[idx].m_live && m_anns[idx].IsWaiting()) assert(scheduled[idx]);
+        }
     }
 
     void PostGetRequestableSanityCheck(std::chrono::microseconds now) const
     {
-        for (const Announcement& ann : m_index) {
+        for (const Announcement& ann : m_anns) {
+            if (!ann.m_live) continue;
             if (ann.IsWaiting()) {
                 // REQUESTED and CANDIDATE_DELAYED must have a time in the future (they should have been converted
                 // to COMPLETED/CANDIDATE_READY respectively).
@@ -363,120 +338,175 @@ public:
     }
 
 private:
-    //! Wrapper around Index::...::erase that keeps m_peerinfo up to date.
-    template<typename Tag>
-    Iter<Tag> Erase(Iter<Tag> it)
+    //! Find the announcement by peer for txhash, or nullopt.
+    std::optional<AnnIndex> Find(NodeId peer, const uint256& txhash) const
+    {
+        const auto it = m_txhashes.find(txhash);
+        if (it == m_txhashes.end()) return std::nullopt;
+        for (AnnIndex idx : it->second) {
+            if (m_anns[idx].m_peer == peer) return idx;
+        }
+        return std::nullopt;
+    }
+
+    //! Find the IsSelected() announcement in a bucket, if any.
+    std::optional<AnnIndex> FindSelected(const TxHashBucket& bucket) const
+    {
+        for (AnnIndex idx : bucket) {
+            if (m_anns[idx].IsSelected()) return idx;
+        }
+        return std::nullopt;
+    }
+
+    //! Add an entry for an announcement to the timer wheel, for its current m_time.
+    void Schedule(AnnIndex idx)
+    {
+        Announcement& ann = m_anns[idx];
+        const int64_t tick{std::max(TimerTick(ann.m_time), m_timer_tick)};
+        m_timer_wheel[tick & (TIMER_SLOTS - 1)].push_back({idx, ++ann.m_timer_gen});
+    }
+
+    //! Change an announcement's state, keeping m_peerinfo up to date.
+    void SetState(AnnIndex idx, State new_state)
+    {
+        Announcement& ann = m_anns[idx];
+        if (ann.GetState() == new_state) return;
+        PeerInfo& info = m_peerinfo.find(ann.m_peer)->second;
+        info.m_completed -= ann.GetState() == State::COMPLETED;
+        info.m_requested -= ann.GetState() == State::REQUESTED;
+        if (ann.GetState() == State::CANDIDATE_BEST) {
+            // Swap-remove from the peer's CANDIDATE_BEST list.
+            const AnnIndex last = info.m_best.back();
+            info.m_best[ann.m_best_pos] = last;
+            m_anns[last].m_best_pos = ann.m_best_pos;
+            info.m_best.pop_back();
+        }
+        ann.m_state = new_state;
+        info.m_completed += new_state == State::COMPLETED;
+        info.m_requested += new_state == State::REQUESTED;
+        if (new_state == State::CANDIDATE_BEST) {
+            ann.m_best_pos = info.m_best.size();
+            info.m_best.push_back(idx);
+        }
+    }
+
+    //! Delete an announcement, keeping m_peerinfo and m_txhashes up to date.
+    void Erase(AnnIndex idx)
     {
-        auto peerit = m_peerinfo.find(it->m_peer);
-        peerit->second.m_completed -= it->GetState() == State::COMPLETED;
-        peerit->second.m_requested -= it->GetState() == State::REQUESTED;
-        if (--peerit->second.m_total == 0) m_peerinfo.erase(peerit);
-        return m_index.get<Tag>().erase(it);
+        Announcement& ann = m_anns[idx];
+        SetState(idx, State::COMPLETED);
+        auto peerit = m_peerinfo.find(ann.m_peer);
+        PeerInfo& info = peerit->second;
+        const AnnIndex last = info.m_anns.back();
+        info.m_anns[ann.m_peer_pos] = last;
+        m_anns[last].m_peer_pos = ann.m_peer_pos;
+        info.m_anns.pop_back();
+        --info.m_completed;
+        if (--info.m_total == 0) m_peerinfo.erase(peerit);
+
+        auto txit = m_txhashes.find(ann.m_gtxid.ToUint256());
+        TxHashBucket& bucket = txit->second;
+        const AnnIndex last_in_bucket = bucket.back();
+        bucket[ann.m_bucket_pos] = last_in_bucket;
+        m_anns[last_in_bucket].m_bucket_pos = ann.m_bucket_pos;
+        bucket.pop_back();
+        if (bucket.empty()) m_txhashes.erase(txit);
+
+        ann.m_live = false;
+        ++ann.m_timer_gen;
+        m_free.push_back(idx);
     }
 
-    //! Wrapper around Index::...::modify that keeps m_peerinfo up to date.
-    template<typename Tag, typename Modifier>
-    void Modify(Iter<Tag> it, Modifier modifier)
+    //! Delete all announcements for the txhash of the given bucket.
+    void EraseTxHash(const uint256& txhash)
     {
-        auto peerit = m_peerinfo.find(it->m_peer);
-        peerit->second.m_completed -= it->GetState() == State::COMPLETED;
-        peerit->second.m_requested -= it->GetState() == State::REQUESTED;
-        m_index.get<Tag>().modify(it, std::move(modifier));
-        peerit->second.m_completed += it->GetState() == State::COMPLETED;
-        peerit->second.m_requested += it->GetState() == State::REQUESTED;
+        auto txit = m_txhashes.find(txhash);
+        if (txit == m_txhashes.end()) return;
+        // Erase from the back, so that no announcement moves; Erase() drops the bucket along with the last one.
+        for (size_t left = txit->second.size(); left > 0; --left) Erase(txit->second.back());
     }
 
     //! Convert a CANDIDATE_DELAYED announcement into a CANDIDATE_READY. If this makes it the new best
     //! CANDIDATE_READY (and no REQUESTED exists) and better than the CANDIDATE_BEST (if any), it becomes the new
     //! CANDIDATE_BEST.
-    void PromoteCandidateReady(Iter<ByTxHash> it)
+    void PromoteCandidateReady(AnnIndex idx)
     {
-        assert(it != m_index.get<ByTxHash>().end());
-        assert(it->GetState() == State::CANDIDATE_DELAYED);
-        // Convert CANDIDATE_DELAYED to CANDIDATE_READY first.
-        Modify<ByTxHash>(it, [](Announcement& ann){ ann.SetState(State::CANDIDATE_READY); });
-        // The following code relies on the fact that the ByTxHash is sorted by txhash, and then by state (first
-        // _DELAYED, then _READY, then _BEST/REQUESTED). Within the _READY announcements, the best one (highest
-        // priority) comes last. Thus, if an existing _BEST exists for the same txhash that this announcement may
-        // be preferred over, it must immediately follow the newly created _READY.
-        auto it_next = std::next(it);
-        if (it_next == m_index.get<ByTxHash>().end() || it_next->m_gtxid.ToUint256() != it->m_gtxid.ToUint256() ||
-            it_next->GetState() == State::COMPLETED) {
-            // This is the new best CANDIDATE_READY, and there is no IsSelected() announcement for this txhash
-            // already.
-            Modify<ByTxHash>(it, [](Announcement& ann){ ann.SetState(State::CANDIDATE_BEST); });
-        } else if (it_next->GetState() == State::CANDIDATE_BEST) {
-            Priority priority_old = m_computer(*it_next);
-            Priority priority_new = m_computer(*it);
-            if (priority_new > priority_old) {
-                // There is a CANDIDATE_BEST announcement already, but this one is better.
-                Modify<ByTxHash>(it_next, [](Announcement& ann){ ann.SetState(State::CANDIDATE_READY); });
-                Modify<ByTxHash>(it, [](Announcement& ann){ ann.SetState(State::CANDIDATE_BEST); });
-            }
+        assert(m_anns[idx].GetState() == State::CANDIDATE_DELAYED);
+        SetState(idx, State::CANDIDATE_READY);
+        const auto selected = FindSelected(m_txhashes.find(m_anns[idx].m_gtxid.ToUint256())->second);
+        if (!selected) {
+            // There is no IsSelected() announcement for this txhash already, so (by the invariants) no other
+            // CANDIDATE_READY either; this is the new best.
+            SetState(idx, State::CANDIDATE_BEST);
+        } else if (m_anns[*selected].GetState() == State::CANDIDATE_BEST &&
+                   m_anns[idx].m_priority > m_anns[*selected].m_priority) {
+            // There is a CANDIDATE_BEST announcement already, but this one is better.
+            SetState(*selected, State::CANDIDATE_READY);
+            SetState(idx, State::CANDIDATE_BEST);
         }
     }
 
     //! Change the state of an announcement to something non-IsSelected(). If it was IsSelected(), the next best
     //! announcement will be marked CANDIDATE_BEST.
-    void ChangeAndReselect(Iter<ByTxHash> it, State new_state)
+    void ChangeAndReselect(AnnIndex idx, State new_state)
     {
         assert(new_state == State::COMPLETED || new_state == State::CANDIDATE_DELAYED);
-        assert(it != m_index.get<ByTxHash>().end());
-        if (it->IsSelected() && it != m_index.get<ByTxHash>().begin()) {
-            auto it_prev = std::prev(it);
-            // The next best CANDIDATE_READY, if any, immediately precedes the REQUESTED or CANDIDATE_BEST
-            // announcement in the ByTxHash index.
-            if (it_prev->m_gtxid.ToUint256() == it->m_gtxid.ToUint256() && it_prev->GetState() == State::CANDIDATE_READY) {
-                // If one such CANDIDATE_READY exists (for this txhash), convert it to CANDIDATE_BEST.
-                Modify<ByTxHash>(it_prev, [](Announcement& ann){ ann.SetState(State::CANDIDATE_BEST); });
+        if (m_anns[idx].IsSelected()) {
+            // Find the highest-priority CANDIDATE_READY for this txhash, if any, and make it CANDIDATE_BEST.
+            std::optional<AnnIndex> best;
+            for (AnnIndex other : m_txhashes.find(m_anns[idx].m_gtxid.ToUint256())->second) {
+                if (m_anns[other].GetState() == State::CANDIDATE_READY &&
+                    (!best || m_anns[other].m_priority > m_anns[*best].m_priority)) {
+                    best = other;
+                }
             }
+            if (best) SetState(*best, State::CANDIDATE_BEST);
         }
-        Modify<ByTxHash>(it, [new_state](Announcement& ann){ ann.SetState(new_state); });
+        SetState(idx, new_state);
     }
 
-    //! Check if 'it' is the only announcement for a given txhash that isn't COMPLETED.
-    bool IsOnlyNonCompleted(Iter<ByTxHash> it)
+    //! Check if idx is the only announcement for a given txhash that isn't COMPLETED.
+    bool IsOnlyNonCompleted(AnnIndex idx) const
     {
-        assert(it != m_index.get<ByTxHash>().end());
-        assert(it->GetState() != State::COMPLETED); // Not allowed to call this on COMPLETED announcements.
-
-        // This announcement has a predecessor that belongs to the same txhash. Due to ordering, and the
-        // fact that 'it' is not COMPLETED, its predecessor cannot be COMPLETED here.
-        if (it != m_index.get<ByTxHash>().begin() && std::prev(it)->m_gtxid.ToUint256() == it->m_gtxid.ToUint256()) return false;
-
-        // This announcement has a successor that belongs to the same txhash, and is not COMPLETED.
-        if (std::next(it) != m_index.get<ByTxHash>().end() && std::next(it)->m_gtxid.ToUint256() == it->m_gtxid.ToUint256() &&
-            std::next(it)->GetState() != State::COMPLETED) return false;
-
+        assert(m_anns[idx].GetState() != State::COMPLETED); // Not allowed to call this on COMPLETED announcements.
+        for (AnnIndex other : m_txhashes.find(m_anns[idx].m_gtxid.ToUint256())->second) {
+            if (other != idx && m_anns[other].GetState() != State::COMPLETED) return false;
+        }
         return true;
     }
 
     /** Convert any announcement to a COMPLETED one. If there are no non-COMPLETED announcements left for this
      *  txhash, they are deleted. If this was a REQUESTED announcement, and there are other CANDIDATEs left, the
      *  best one is made CANDIDATE_BEST. Returns whether the announcement still exists. */
-    bool MakeCompleted(Iter<ByTxHash> it)
+    bool MakeCompleted(AnnIndex idx)
     {
-        assert(it != m_index.get<ByTxHash>().end());
-
         // Nothing to be done if it's already COMPLETED.
-        if (it->GetState() == State::COMPLETED) return true;
+        if (m_anns[idx].GetState() == State::COMPLETED) return true;
 
-        if (IsOnlyNonCompleted(it)) {
+        if (IsOnlyNonCompleted(idx)) {
             // This is the last non-COMPLETED announcement for this txhash. Delete all.
-            uint256 txhash = it->m_gtxid.ToUint256();
-            do {
-                it = Erase<ByTxHash>(it);
-            } while (it != m_index.get<ByTxHash>().end() && it->m_gtxid.ToUint256() == txhash);
+            EraseTxHash(m_anns[idx].m_gtxid.ToUint256());
             return false;
         }
 
-        // Mark the announcement COMPLETED, and select the next best announcement (the first CANDIDATE_READY) if
+        // Mark the announcement COMPLETED, and select the next best announcement (the best CANDIDATE_READY) if
         // needed.
-        ChangeAndReselect(it, State::COMPLETED);
+        ChangeAndReselect(idx, State::COMPLETED);
 
         return true;
     }
 
+    //! Rebuild the timer wheel from scratch, starting at the given tick. Needed when the clock moved to before the
+    //! part of the wheel that was already visited.
+    void RebuildTimerWheel(int64_t tick)
+    {
+        for (auto& slot : m_timer_wheel) slot.clear();
+        m_timer_tick = tick;
+        for (AnnIndex idx = 0; idx < m_anns.size(); ++idx) {
+            if (m_anns[idx].m_live && m_anns[idx].IsWaiting()) Schedule(idx);
+        }
+    }
+
     //! Make the data structure consistent with a given point in time:
     //! - REQUESTED announcements with expiry <= now are turned into COMPLETED.
     //! - CANDIDATE_DELAYED announcements with reqtime <= now are turned into CANDIDATE_{READY,BEST}.
@@ -485,112 +515,147 @@ private:
     {
         if (expired) expired->clear();
 
-        // Iterate over all CANDIDATE_DELAYED and REQUESTED from old to new, as long as they're in the past,
-        // and convert them to CANDIDATE_READY and COMPLETED respectively.
-        while (!m_index.empty()) {
-            auto it = m_index.get<ByTime>().begin();
-            if (it->GetState() == State::CANDIDATE_DELAYED && it->m_time <= now) {
-                PromoteCandidateReady(m_index.project<ByTxHash>(it));
-            } else if (it->GetState() == State::REQUESTED && it->m_time <= now) {
-                if (expired) expired->emplace_back(it->m_peer, it->m_gtxid);
-                MakeCompleted(m_index.project<ByTxHash>(it));
-            } else {
-                break;
+        const int64_t now_tick{TimerTick(now)};
+        if (now_tick < m_timer_tick) RebuildTimerWheel(now_tick);
+
+        // Visit all slots from m_timer_tick up to now (each slot at most once), firing the entries that are due.
+        // Entries for later rounds of the wheel, or later in now's slot, are kept. Which order announcements are
+        // processed in doesn't affect the resulting state.
+        std::vector<AnnIndex> due;
+        const int64_t last_tick{std::min<int64_t>(now_tick, m_timer_tick + int64_t{TIMER_SLOTS} - 1)};
+        for (int64_t tick = m_timer_tick; tick <= last_tick; ++tick) {
+            auto& slot = m_timer_wheel[tick & (TIMER_SLOTS - 1)];
+            size_t kept{0};
+            for (const TimerEntry& entry : slot) {
+                const Announcement& ann = m_anns[entry.m_ann];
+                if (ann.m_timer_gen != entry.m_gen || !ann.m_live || !ann.IsWaiting()) continue; // stale
+                if (ann.m_time <= now) {
+                    due.push_back(entry.m_ann);
+                } else {
+                    slot[kept++] = entry;
+                }
+            }
+            slot.resize(kept);
+        }
+        m_timer_tick = now_tick;
+
+        // Report expirations in time order, like a time-sorted index would.
+        std::sort(due.begin(), due.end(), [this](AnnIndex a, AnnIndex b) {
+            return std::tuple(m_anns[a].m_time, SequenceNumber{m_anns[a].m_sequence}) < std::tuple(m_anns[b].m_time, SequenceNumber{m_anns[b].m_sequence});
+        });
+        for (AnnIndex idx : due) {
+            // Processing an earlier entry may have deleted this announcement (all announcements for a txhash are
+            // deleted once they're all COMPLETED). Pool positions are not reused here, as nothing is added.
+            const Announcement& ann = m_anns[idx];
+            if (!ann.m_live) continue;
+            if (ann.GetState() == State::CANDIDATE_DELAYED) {
+                PromoteCandidateReady(idx);
+            } else if (ann.GetState() == State::REQUESTED) {
+                if (expired) expired->emplace_back(ann.m_peer, ann.m_gtxid);
+                MakeCompleted(idx);
             }
         }
 
-        while (!m_index.empty()) {
+        if (now < m_last_now) {
             // If time went backwards, we may need to demote CANDIDATE_BEST and CANDIDATE_READY announcements back
             // to CANDIDATE_DELAYED. This is an unusual edge case, and unlikely to matter in production. However,
             // it makes it much easier to specify and test TxRequestTracker::Impl's behaviour.
-            auto it = std::prev(m_index.get<ByTime>().end());
-            if (it->IsSelectable() && it->m_time > now) {
-                ChangeAndReselect(m_index.project<ByTxHash>(it), State::CANDIDATE_DELAYED);
-            } else {
-                break;
+            for (AnnIndex idx = 0; idx < m_anns.size(); ++idx) {
+                if (m_anns[idx].m_live && m_anns[idx].IsSelectable() && m_anns[idx].m_time > now) {
+                    ChangeAndReselect(idx, State::CANDIDATE_DELAYED);
+                    Schedule(idx);
+                }
             }
         }
+        m_last_now = now;
     }
 
 public:
     explicit Impl(bool deterministic) :
-        m_computer(deterministic),
-        // Explicitly initialize m_index as we need to pass a reference to m_computer to ByTxHashViewExtractor.
-        m_index(boost::make_tuple(
-            boost::make_tuple(ByPeerViewExtractor(), std::less<ByPeerView>()),
-            boost::make_tuple(ByTxHashViewExtractor(m_computer), std::less<ByTxHashView>()),
-            boost::make_tuple(ByTimeViewExtractor(), std::less<ByTimeView>())
-        )) {}
-
-    // Disable copying and assigning (a default copy won't work due the stateful ByTxHashViewExtractor).
+        m_computer(deterministic) {}
+
     Impl(const Impl&) = delete;
     Impl& operator=(const Impl&) = delete;
 
     void DisconnectedPeer(NodeId peer)
     {
-        auto& index = m_index.get<ByPeer>();
-        auto it = index.lower_bound(ByPeerView{peer, false, uint256::ZERO});
-        while (it != index.end() && it->m_peer == peer) {
-            // Check what to continue with after this iteration. 'it' will be deleted in what follows, so we need to
-            // decide what to continue with afterwards. There are a number of cases to consider:
-            // - std::next(it) is end() or belongs to a different peer. In that case, this is the last iteration
-            //   of the loop (denote this by setting it_next to end()).
-            // - 'it' is not the only non-COMPLETED announcement for its txhash. This means it will be deleted, but
-            //   no other Announcement objects will be modified. Continue with std::next(it) if it belongs to the
-            //   same peer, but decide this ahead of time (as 'it' may change position in what follows).
-            // - 'it' is the only non-COMPLETED announcement for its txhash. This means it will be deleted along
-            //   with all other announcements for the same txhash - which may include std::next(it). However, other
-            //   than 'it', no announcements for the same peer can be affected (due to (peer, txhash) uniqueness).
-            //   In other words, the situation where std::next(it) is deleted can only occur if std::next(it)
-            //   belongs to a different peer but the same txhash as 'it'. This is covered by the first bulletpoint
-            //   already, and we'll have set it_next to end().
-            auto it_next = (std::next(it) == index.end() || std::next(it)->m_peer != peer) ? index.end() :
-                std::next(it);
+        auto peerit = m_peerinfo.find(peer);
+        if (peerit == m_peerinfo.end()) return;
+        // Deleting announcements modifies the peer's list (and removes the entry once empty), so work on a copy.
+        // Each announcement of this peer is for a different txhash, so deleting one can never delete another one
+        // of this peer.
+        const std::vector<AnnIndex> anns = peerit->second.m_anns;
+        for (AnnIndex idx : anns) {
             // If the announcement isn't already COMPLETED, first make it COMPLETED (which will mark other
             // CANDIDATEs as CANDIDATE_BEST, or delete all of a txhash's announcements if no non-COMPLETED ones are
             // left).
-            if (MakeCompleted(m_index.project<ByTxHash>(it))) {
+            if (MakeCompleted(idx)) {
                 // Then actually delete the announcement (unless it was already deleted by MakeCompleted).
-                Erase<ByPeer>(it);
+                Erase(idx);
             }
-            it = it_next;
         }
     }
 
     void ForgetTxHash(const uint256& txhash)
     {
-        auto it = m_index.get<ByTxHash>().lower_bound(ByTxHashView{txhash, State::CANDIDATE_DELAYED, 0});
-        while (it != m_index.get<ByTxHash>().end() && it->m_gtxid.ToUint256() == txhash) {
-            it = Erase<ByTxHash>(it);
-        }
+        EraseTxHash(txhash);
     }
 
     void GetCandidatePeers(const uint256& txhash, std::vector<NodeId>& result_peers) const
     {
-        auto it = m_index.get<ByTxHash>().lower_bound(ByTxHashView{txhash, State::CANDIDATE_DELAYED, 0});
-        while (it != m_index.get<ByTxHash>().end() && it->m_gtxid.ToUint256() == txhash && it->GetState() != State::COMPLETED) {
-            result_peers.push_back(it->m_peer);
-            ++it;
+        const auto it = m_txhashes.find(txhash);
+        if (it == m_txhashes.end()) return;
+        // Report candidates by state (DELAYED, READY, BEST, REQUESTED), and READY ones by ascending priority.
+        std::vector<const Announcement*> anns;
+        for (AnnIndex idx : it->second) {
+            if (m_anns[idx].GetState() != State::COMPLETED) anns.push_back(&m_anns[idx]);
         }
+        std::sort(anns.begin(), anns.end(), [](const Announcement* a, const Announcement* b) {
+            const Priority prio_a = a->GetState() == State::CANDIDATE_READY ? a->m_priority : 0;
+            const Priority prio_b = b->GetState() == State::CANDIDATE_READY ? b->m_priority : 0;
+            return std::tuple(a->GetState(), prio_a, SequenceNumber{a->m_sequence}) < std::tuple(b->GetState(), prio_b, SequenceNumber{b->m_sequence});
+        });
+        for (const Announcement* ann : anns) result_peers.push_back(ann->m_peer);
     }
 
     void ReceivedInv(NodeId peer, const GenTxid& gtxid, bool preferred,
                      std::chrono::microseconds reqtime)
     {
-        // Bail out if we already have a CANDIDATE_BEST announcement for this (txhash, peer) combination. The case
-        // where there is a non-CANDIDATE_BEST announcement already will be caught by the uniqueness property of the
-        // ByPeer index when we try to emplace the new object below.
-        if (m_index.get<ByPeer>().count(ByPeerView{peer, true, gtxid.ToUint256()})) return;
+        // Bail out if we already have an announcement for this (txhash, peer) combination.
+        const uint256& txhash = gtxid.ToUint256();
+        TxHashBucket& bucket = m_txhashes[txhash];
+        for (AnnIndex idx : bucket) {
+            if (m_anns[idx].m_peer == peer) return;
+        }
 
-        // Try creating the announcement with CANDIDATE_DELAYED state (which will fail due to the uniqueness
-        // of the ByPeer index if a non-CANDIDATE_BEST announcement already exists with the same txhash and peer).
-        // Bail out in that case.
-        auto ret = m_index.get<ByPeer>().emplace(gtxid, peer, preferred, reqtime, m_current_sequence);
-        if (!ret.second) return;
+        AnnIndex idx;
+        if (m_free.empty()) {
+            idx = m_anns.size();
+            m_anns.emplace_back();
+        } else {
+            idx = m_free.back();
+            m_free.pop_back();
+        }
+        Announcement& ann = m_anns[idx];
+        ann.m_gtxid = gtxid;
+        ann.m_time = reqtime;
+        ann.m_priority = m_computer(txhash, peer, preferred);
+        ann.m_peer = peer;
+        ann.m_sequence = m_current_sequence;
+        ann.m_preferred = preferred;
+        ann.m_state = State::CANDIDATE_DELAYED;
+        ann.m_live = true;
+        ann.m_bucket_pos = bucket.size();
+        bucket.push_back(idx);
 
         // Update accounting metadata.
-        ++m_peerinfo[peer].m_total;
+        PeerInfo& info = m_peerinfo[peer];
+        ann.m_peer_pos = info.m_anns.size();
+        info.m_anns.push_back(idx);
+        ++info.m_total;
         ++m_current_sequence;
+
+        Schedule(idx);
     }
 
     //! Find the GenTxids to request now from peer.
@@ -602,11 +667,10 @@ public:
 
         // Find all CANDIDATE_BEST announcements for this peer.
         std::vector<const Announcement*> selected;
-        auto it_peer = m_index.get<ByPeer>().lower_bound(ByPeerView{peer, true, uint256::ZERO});
-        while (it_peer != m_index.get<ByPeer>().end() && it_peer->m_peer == peer &&
-            it_peer->GetState() == State::CANDIDATE_BEST) {
-            selected.emplace_back(&*it_peer);
-            ++it_peer;
+        auto peerit = m_peerinfo.find(peer);
+        if (peerit != m_peerinfo.end()) {
+            selected.reserve(peerit->second.m_best.size());
+            for (AnnIndex idx : peerit->second.m_best) selected.push_back(&m_anns[idx]);
         }
 
         // Sort by sequence number.
@@ -625,57 +689,48 @@ public:
 
     void RequestedTx(NodeId peer, const uint256& txhash, std::chrono::microseconds expiry)
     {
-        auto it = m_index.get<ByPeer>().find(ByPeerView{peer, true, txhash});
-        if (it == m_index.get<ByPeer>().end()) {
-            // There is no CANDIDATE_BEST announcement, look for a _READY or _DELAYED instead. If the caller only
-            // ever invokes RequestedTx with the values returned by GetRequestable, and no other non-const functions
-            // other than ForgetTxHash and GetRequestable in between, this branch will never execute (as txhashes
-            // returned by GetRequestable always correspond to CANDIDATE_BEST announcements).
-
-            it = m_index.get<ByPeer>().find(ByPeerView{peer, false, txhash});
-            if (it == m_index.get<ByPeer>().end() || (it->GetState() != State::CANDIDATE_DELAYED &&
-                                                      it->GetState() != State::CANDIDATE_READY)) {
+        const auto idx = Find(peer, txhash);
+        if (!idx) return;
+        const State state = m_anns[*idx].GetState();
+        if (state != State::CANDIDATE_BEST) {
+            // If the caller only ever invokes RequestedTx with the values returned by GetRequestable, and no other
+            // non-const functions other than ForgetTxHash and GetRequestable in between, this branch will never
+            // execute (as txhashes returned by GetRequestable always correspond to CANDIDATE_BEST announcements).
+            if (state != State::CANDIDATE_DELAYED && state != State::CANDIDATE_READY) {
                 // There is no CANDIDATE announcement tracked for this peer, so we have nothing to do. Either this
                 // txhash wasn't tracked at all (and the caller should have called ReceivedInv), or it was already
                 // requested and/or completed for other reasons and this is just a superfluous RequestedTx call.
                 return;
             }
 
-            // Look for an existing CANDIDATE_BEST or REQUESTED with the same txhash. We only need to do this if the
-            // found announcement had a different state than CANDIDATE_BEST. If it did, invariants guarantee that no
-            // other CANDIDATE_BEST or REQUESTED can exist.
-            auto it_old = m_index.get<ByTxHash>().lower_bound(ByTxHashView{txhash, State::CANDIDATE_BEST, 0});
-            if (it_old != m_index.get<ByTxHash>().end() && it_old->m_gtxid.ToUint256() == txhash) {
-                if (it_old->GetState() == State::CANDIDATE_BEST) {
+            // Look for an existing CANDIDATE_BEST or REQUESTED with the same txhash.
+            const auto old = FindSelected(m_txhashes.find(txhash)->second);
+            if (old) {
+                if (m_anns[*old].GetState() == State::CANDIDATE_BEST) {
                     // The data structure's invariants require that there can be at most one CANDIDATE_BEST or one
                     // REQUESTED announcement per txhash (but not both simultaneously), so we have to convert any
                     // existing CANDIDATE_BEST to another CANDIDATE_* when constructing another REQUESTED.
                     // It doesn't matter whether we pick CANDIDATE_READY or _DELAYED here, as SetTimePoint()
                     // will correct it at GetRequestable() time. If time only goes forward, it will always be
                     // _READY, so pick that to avoid extra work in SetTimePoint().
-                    Modify<ByTxHash>(it_old, [](Announcement& ann) { ann.SetState(State::CANDIDATE_READY); });
-                } else if (it_old->GetState() == State::REQUESTED) {
+                    SetState(*old, State::CANDIDATE_READY);
+                } else {
                     // As we're no longer waiting for a response to the previous REQUESTED announcement, convert it
                     // to COMPLETED. This also helps guaranteeing progress.
-                    Modify<ByTxHash>(it_old, [](Announcement& ann) { ann.SetState(State::COMPLETED); });
+                    SetState(*old, State::COMPLETED);
                 }
             }
         }
 
-        Modify<ByPeer>(it, [expiry](Announcement& ann) {
-            ann.SetState(State::REQUESTED);
-            ann.m_time = expiry;
-        });
+        SetState(*idx, State::REQUESTED);
+        m_anns[*idx].m_time = expiry;
+        Schedule(*idx);
     }
 
     void ReceivedResponse(NodeId peer, const uint256& txhash)
     {
-        // We need to search the ByPeer index for both (peer, false, txhash) and (peer, true, txhash).
-        auto it = m_index.get<ByPeer>().find(ByPeerView{peer, false, txhash});
-        if (it == m_index.get<ByPeer>().end()) {
-            it = m_index.get<ByPeer>().find(ByPeerView{peer, true, txhash});
-        }
-        if (it != m_index.get<ByPeer>().end()) MakeCompleted(m_index.project<ByTxHash>(it));
+        const auto idx = Find(peer, txhash);
+        if (idx) MakeCompleted(*idx);
     }
 
     size_t CountInFlight(NodeId peer) const
@@ -700,7 +755,7 @@ public:
     }
 
     //! Count how many announcements are being tracked in total across all peers and transactions.
-    size_t Size() const { return m_index.size(); }
+    size_t Size() const { return m_anns.size() - m_free.size(); }
 
     uint64_t ComputePriority(const uint256& txhash, NodeId peer, bool preferred) const
     {
@@ -5,6 +5,7 @@
 #define HYLIUM_UNIVALUE_INCLUDE_UNIVALUE_UTFFILTER_H
 
 #include <string>
+#include <string_view>
 
 /**
  * Filter that generates and validates UTF-8, as well as collates UTF-16
@@ -45,6 +46,14 @@ public:
                 push_back_u(codepoint);
         }
     }
+    // Write a run of 7-bit ASCII chars, like push_back for each of them
+    void append_ascii(std::string_view chars)
+    {
+        if (state) // Not a continuation, invalid
+            is_valid = false;
+        else
+            str.append(chars);
+    }
     // Write codepoint directly, possibly collating surrogate pairs
     void push_back_u(unsigned int codepoint_)
     {
@@ -10,6 +10,7 @@
 #include <cstring>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 /*
@@ -52,6 +53,41 @@ static const char *hatoui(const char *first, const char *last,
     return first;
 }
 
+static constexpr uint64_t BYTES_01{0x0101010101010101};
+static constexpr uint64_t BYTES_80{0x8080808080808080};
+
+// Whether any byte of the word is less than n, for n <= 0x80
+static constexpr uint64_t has_byte_less(uint64_t word, uint8_t n)
+{
+    return (word - BYTES_01 * n) & ~word & BYTES_80;
+}
+
+// Whether any byte of the word equals ch
+static constexpr uint64_t has_byte(uint64_t word, uint8_t ch)
+{
+    return has_byte_less(word ^ (BYTES_01 * ch), 1);
+}
+
+// Skip the leading characters of a string that can be copied as they are:
+// 7-bit ASCII, other than control characters, '"' and '\\'. Eight characters
+// are checked at a time, as most strings (hex, base64, addresses) are
+// entirely made of them.
+static const char* skip_plain_chars(const char* raw, const char* end)
+{
+    while (end - raw >= 8) {
+        uint64_t word;
+        std::memcpy(&word, raw, 8);
+        if ((word & BYTES_80) || has_byte_less(word, 0x20) || has_byte(word, '"') || has_byte(word, '\\')) break;
+        raw += 8;
+    }
+    while (raw < end) {
+        const unsigned char ch = *raw;
+        if (ch >= 0x80 || ch < 0x20 || ch == '"' || ch == '\\') break;
+        raw++;
+    }
+    return raw;
+}
+
 enum jtokentype getJsonToken(std::string& tokenVal, unsigned int& consumed,
                             const char *raw, const char *end)
 {
@@ -124,8 +160,6 @@ enum jtokentype getJsonToken(std::string& tokenVal, unsigned int& consumed,
     case '8':
     case '9': {
         // part 1: int
-        std::string numStr;
-
         const char *first = raw;
 
         const char *firstDigit = first;
@@ -134,49 +168,42 @@ enum jtokentype getJsonToken(std::string& tokenVal, unsigned int& consumed,
         if ((*firstDigit == '0') && json_isdigit(firstDigit[1]))
             return JTOK_ERR;
 
-        numStr += *raw;                       // copy first char
-        raw++;
+        raw++;                                // skip first char
 
         if ((*first == '-') && (raw < end) && (!json_isdigit(*raw)))
             return JTOK_ERR;
 
-        while (raw < end && json_isdigit(*raw)) {  // copy digits
-            numStr += *raw;
+        while (raw < end && json_isdigit(*raw)) {  // skip digits
             raw++;
         }
 
         // part 2: frac
         if (raw < end && *raw == '.') {
-            numStr += *raw;                   // copy .
-            raw++;
+            raw++;                            // skip .
 
             if (raw >= end || !json_isdigit(*raw))
                 return JTOK_ERR;
-            while (raw < end && json_isdigit(*raw)) { // copy digits
-                numStr += *raw;
+            while (raw < end && json_isdigit(*raw)) { // skip digits
                 raw++;
             }
         }
 
         // part 3: exp
         if (raw < end && (*raw == 'e' || *raw == 'E')) {
-            numStr += *raw;                   // copy E
-            raw++;
+            raw++;                            // skip E
 
-            if (raw < end && (*raw == '-' || *raw == '+')) { // copy +/-
-                numStr += *raw;
+            if (raw < end && (*raw == '-' || *raw == '+')) { // skip +/-
                 raw++;
             }
 
             if (raw >= end || !json_isdigit(*raw))
                 return JTOK_ERR;
-            while (raw < end && json_isdigit(*raw)) { // copy digits
-                numStr += *raw;
+            while (raw < end && json_isdigit(*raw)) { // skip digits
                 raw++;
             }
         }
 
-        tokenVal = numStr;
+        tokenVal.assign(first, raw);          // copy the number at once
         consumed = (raw - rawStart);
         return JTOK_NUMBER;
         }
@@ -184,10 +211,16 @@ enum jtokentype getJsonToken(std::string& tokenVal, unsigned int& consumed,
     case '"': {
         raw++;                                // skip "
 
-        std::string valStr;
-        JSONUTF8StringFilter writer(valStr);
+        JSONUTF8StringFilter writer(tokenVal);
 
         while (true) {
+            // copy the characters that need no decoding at once
+            const char* plain_end = skip_plain_chars(raw, end);
+            if (plain_end != raw) {
+                writer.append_ascii(std::string_view(raw, plain_end - raw));
+                raw = plain_end;
+            }
+
             if (raw >= end || (unsigned char)*raw < 0x20)
                 return JTOK_ERR;
 
@@ -238,7 +271,6 @@ enum jtokentype getJsonToken(std::string& tokenVal, unsigned int& consumed,
 
         if (!writer.finalize())
             return JTOK_ERR;
-        tokenVal = valStr;
         consumed = (raw - rawStart);
         return JTOK_STRING;
         }
@@ -328,9 +360,8 @@ bool UniValue::read(std::string_view str_in)
                     setArray();
                 stack.push_back(this);
             } else {
-                UniValue tmpVal(utyp);
                 UniValue *top = stack.back();
-                top->values.push_back(tmpVal);
+                top->values.emplace_back(utyp);
 
                 UniValue *newTop = &(top->values.back());
                 stack.push_back(newTop);
@@ -410,21 +441,21 @@ bool UniValue::read(std::string_view str_in)
             }
 
             UniValue *top = stack.back();
-            top->values.push_back(tmpVal);
+            top->values.push_back(std::move(tmpVal));
 
             setExpect(NOT_VALUE);
             break;
             }
 
         case JTOK_NUMBER: {
-            UniValue tmpVal(VNUM, tokenVal);
+            UniValue tmpVal(VNUM, std::move(tokenVal));
             if (!stack.size()) {
-                *this = tmpVal;
+                *this = std::move(tmpVal);
                 break;
             }
 
             UniValue *top = stack.back();
-            top->values.push_back(tmpVal);
+            top->values.push_back(std::move(tmpVal));
 
             setExpect(NOT_VALUE);
             break;
@@ -433,17 +464,17 @@ bool UniValue::read(std::string_view str_in)
         case JTOK_STRING: {
             if (expect(OBJ_NAME)) {
                 UniValue *top = stack.back();
-                top->keys.push_back(tokenVal);
+                top->keys.push_back(std::move(tokenVal));
                 clearExpect(OBJ_NAME);
                 setExpect(COLON);
             } else {
-                UniValue tmpVal(VSTR, tokenVal);
+                UniValue tmpVal(VSTR, std::move(tokenVal));
                 if (!stack.size()) {
-                    *this = tmpVal;
+                    *this = std::move(tmpVal);
                     break;
                 }
                 UniValue *top = stack.back();
-                top->values.push_back(tmpVal);
+                top->values.push_back(std::move(tmpVal));
             }
 
             setExpect(NOT_VALUE);
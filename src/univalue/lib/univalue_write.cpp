@@ -5,35 +5,71 @@
 #include <univalue.h>
 #include <univalue_escapes.h>
 
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
 
-static std::string json_escape(const std::string& inS)
+static constexpr uint64_t BYTES_01{0x0101010101010101};
+static constexpr uint64_t BYTES_80{0x8080808080808080};
+
+// Whether any byte of the word is less than n, for n <= 0x80
+static constexpr uint64_t has_byte_less(uint64_t word, uint8_t n)
 {
-    std::string outS;
-    outS.reserve(inS.size() * 2);
+    return (word - BYTES_01 * n) & ~word & BYTES_80;
+}
 
-    for (unsigned int i = 0; i < inS.size(); i++) {
-        unsigned char ch = static_cast<unsigned char>(inS[i]);
-        const char *escStr = escapes[ch];
+// Whether any byte of the word equals ch
+static constexpr uint64_t has_byte(uint64_t word, uint8_t ch)
+{
+    return has_byte_less(word ^ (BYTES_01 * ch), 1);
+}
 
-        if (escStr)
-            outS += escStr;
-        else
-            outS += static_cast<char>(ch);
-    }
+// Whether any of the eight chars of the word has an entry in escapes
+static bool needs_escape(uint64_t word)
+{
+    return has_byte_less(word, 0x20) || has_byte(word, '"') || has_byte(word, '\\') || has_byte(word, 0x7f);
+}
+
+static void json_escape(const std::string& inS, std::string& outS)
+{
+    const char* raw = inS.data();
+    const char* end = raw + inS.size();
+    while (raw < end) {
+        // Copy the run of chars that need no escaping at once, checking
+        // eight chars at a time.
+        const char* run = raw;
+        while (end - raw >= 8) {
+            uint64_t word;
+            std::memcpy(&word, raw, 8);
+            if (needs_escape(word)) break;
+            raw += 8;
+        }
+        while (raw < end && !escapes[static_cast<unsigned char>(*raw)])
+            raw++;
+        outS.append(run, raw);
 
-    return outS;
+        if (raw < end) {
+            outS += escapes[static_cast<unsigned char>(*raw)];
+            raw++;
+        }
+    }
 }
 
-// NOLINTNEXTLINE(misc-no-recursion)
 std::string UniValue::write(unsigned int prettyIndent,
                             unsigned int indentLevel) const
 {
     std::string s;
     s.reserve(1024);
+    write(prettyIndent, indentLevel, s);
+    return s;
+}
 
+// NOLINTNEXTLINE(misc-no-recursion)
+void UniValue::write(unsigned int prettyIndent,
+                     unsigned int indentLevel, std::string& s) const
+{
     unsigned int modIndent = indentLevel;
     if (modIndent == 0)
         modIndent = 1;
@@ -49,7 +85,9 @@ std::string UniValue::write(unsigned int prettyIndent,
         writeArray(prettyIndent, modIndent, s);
         break;
     case VSTR:
-        s += "\"" + json_escape(val) + "\"";
+        s += '"';
+        json_escape(val, s);
+        s += '"';
         break;
     case VNUM:
         s += val;
@@ -58,8 +96,6 @@ std::string UniValue::write(unsigned int prettyIndent,
         s += (val == "1" ? "true" : "false");
         break;
     }
-
-    return s;
 }
 
 static void indentStr(unsigned int prettyIndent, unsigned int indentLevel, std::string& s)
@@ -77,7 +113,7 @@ void UniValue::writeArray(unsigned int prettyIndent, unsigned int indentLevel, s
     for (unsigned int i = 0; i < values.size(); i++) {
         if (prettyIndent)
             indentStr(prettyIndent, indentLevel, s);
-        s += values[i].write(prettyIndent, indentLevel + 1);
+        values[i].write(prettyIndent, indentLevel + 1, s);
         if (i != (values.size() - 1)) {
             s += ",";
         }
@@ -100,10 +136,12 @@ void UniValue::writeObject(unsigned int prettyIndent, unsigned int indentLevel,
     for (unsigned int i = 0; i < keys.size(); i++) {
         if (prettyIndent)
             indentStr(prettyIndent, indentLevel, s);
-        s += "\"" + json_escape(keys[i]) + "\":";
+        s += '"';
+        json_escape(keys[i], s);
+        s += "\":";
         if (prettyIndent)
             s += " ";
-        s += values.at(i).write(prettyIndent, indentLevel + 1);
+        values.at(i).write(prettyIndent, indentLevel + 1, s);
         if (i != (values.size() - 1))
             s += ",";
         if (prettyIndent)
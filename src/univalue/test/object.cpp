@@ -12,6 +12,7 @@
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #define BOOST_CHECK(expr) assert(expr)
@@ -455,6 +456,34 @@ void univalue_readwrite()
     BOOST_CHECK(!v.read("{} 42"));
 }
 
+void univalue_readwrite_long_strings()
+{
+    // Special characters at every offset of strings longer than the eight
+    // characters that are scanned at a time.
+    const std::string plain(19, 'a');
+    const std::vector<std::pair<std::string, std::string>> specials{
+        {"\"", "\\\""}, {"\\", "\\\\"}, {"\n", "\\n"}, {std::string(1, '\0'), "\\u0000"},
+        {"\x7f", "\\u007f"}, {"\xc3\xa9", "\xc3\xa9"}, {"\xf0\x9d\x84\x9e", "\xf0\x9d\x84\x9e"}};
+    for (const auto& [raw, escaped] : specials) {
+        for (size_t pos = 0; pos <= plain.size(); ++pos) {
+            const std::string str{plain.substr(0, pos) + raw + plain.substr(pos)};
+            const std::string json{"[\"" + plain.substr(0, pos) + escaped + plain.substr(pos) + "\"]"};
+            UniValue v(UniValue::VARR);
+            v.push_back(str);
+            BOOST_CHECK_EQUAL(v.write(), json);
+            UniValue parsed;
+            BOOST_CHECK(parsed.read(json));
+            BOOST_CHECK_EQUAL(parsed[0].get_str(), str);
+        }
+    }
+    // Invalid UTF-8 and unescaped control characters are found after a run of plain characters.
+    for (const std::string invalid : {"\x80", "\xc3", "\xc3" "a", "\n"}) {
+        UniValue v;
+        BOOST_CHECK(!v.read("\"" + plain + invalid + "\""));
+        BOOST_CHECK(!v.read("\"" + plain + invalid + plain + "\""));
+    }
+}
+
 int main(int argc, char* argv[])
 {
     univalue_constructor();
@@ -464,5 +493,6 @@ int main(int argc, char* argv[])
     univalue_array();
     univalue_object();
     univalue_readwrite();
+    univalue_readwrite_long_strings();
     return 0;
 }
@@ -5,11 +5,19 @@
 #ifndef HYLIUM_UTIL_GOLOMBRICE_H
 #define HYLIUM_UTIL_GOLOMBRICE_H
 
+#include <attributes.h>
+#include <crypto/common.h>
 #include <util/fastrange.h>
 
 #include <streams.h>
 
+#include <algorithm>
+#include <bit>
+#include <cstddef>
 #include <cstdint>
+#include <ios>
+#include <span>
+#include <vector>
 
 template <typename OStream>
 void GolombRiceEncode(BitStreamWriter<OStream>& bitwriter, uint8_t P, uint64_t x)
@@ -42,4 +50,156 @@ uint64_t GolombRiceDecode(BitStreamReader<IStream>& bitreader, uint8_t P)
     return (q << P) + r;
 }
 
+/**
+ * Golomb-Rice encoder producing the same bit stream as GolombRiceEncode, but
+ * buffering bits in a 64-bit word and appending to the output a word at a time.
+ */
+class GolombRiceWriter
+{
+    std::vector<unsigned char>& m_out;
+    /// Bits not yet appended to m_out, most significant bit first.
+    uint64_t m_buffer{0};
+    /// Number of high order bits of m_buffer in use.
+    int m_bits{0};
+
+    void FlushWord()
+    {
+        const size_t pos{m_out.size()};
+        m_out.resize(pos + 8);
+        WriteBE64(m_out.data() + pos, m_buffer);
+        m_buffer = 0;
+        m_bits = 0;
+    }
+
+    /** Write the nbits (0 to 64) least significant bits of data. */
+    void Write(uint64_t data, int nbits)
+    {
+        if (nbits == 0) return;
+        if (nbits < 64) data &= (uint64_t{1} << nbits) - 1;
+        const int free{64 - m_bits};
+        if (nbits < free) {
+            m_buffer |= data << (free - nbits);
+            m_bits += nbits;
+            return;
+        }
+        const int rest{nbits - free};
+        m_buffer |= data >> rest;
+        FlushWord();
+        if (rest > 0) {
+            m_buffer = data << (64 - rest);
+            m_bits = rest;
+        }
+    }
+
+public:
+    explicit GolombRiceWriter(std::vector<unsigned char>& out LIFETIMEBOUND) : m_out{out} {}
+    ~GolombRiceWriter() { Flush(); }
+
+    void Encode(uint8_t P, uint64_t x)
+    {
+        uint64_t q = x >> P;
+        while (q >= 64) {
+            Write(~0ULL, 64);
+            q -= 64;
+        }
+        // The quotient as q 1's followed by one 0, then the remainder in P bits.
+        const uint64_t unary{((uint64_t{1} << q) - 1) << 1};
+        if (q + 1 + P <= 64) {
+            Write((unary << P) | (P ? x & (~0ULL >> (64 - P)) : 0), q + 1 + P);
+        } else {
+            Write(unary, q + 1);
+            Write(x, P);
+        }
+    }
+
+    /** Append the buffered bits to the output, padding the last byte with zeros. */
+    void Flush()
+    {
+        const int nbytes{(m_bits + 7) / 8};
+        for (int i = 0; i < nbytes; ++i) {
+            m_out.push_back(static_cast<unsigned char>(m_buffer >> (56 - 8 * i)));
+        }
+        m_buffer = 0;
+        m_bits = 0;
+    }
+};
+
+/**
+ * Golomb-Rice decoder for bit streams written by GolombRiceEncode or
+ * GolombRiceWriter. Input is loaded up to a 64-bit word at a time, and unary
+ * quotients are decoded by counting leading one bits rather than bit by bit.
+ * Throws std::ios_base::failure when reading past the end of the data.
+ */
+class GolombRiceReader
+{
+    std::span<const unsigned char> m_data;
+    /// Next byte of m_data to load into m_buffer.
+    size_t m_pos{0};
+    /// Loaded bits, most significant bit first. Bits past the first m_avail
+    /// may hold the start of the next byte to load.
+    uint64_t m_buffer{0};
+    /// Number of high order bits of m_buffer available to read.
+    int m_avail{0};
+
+    void Refill()
+    {
+        if (m_pos + 8 <= m_data.size()) {
+            m_buffer |= ReadBE64(m_data.data() + m_pos) >> m_avail;
+            const int nbytes{(63 - m_avail) / 8};
+            m_pos += nbytes;
+            m_avail += 8 * nbytes;
+            return;
+        }
+        while (m_avail <= 56 && m_pos < m_data.size()) {
+            m_buffer |= uint64_t{m_data[m_pos++]} << (56 - m_avail);
+            m_avail += 8;
+        }
+    }
+
+    void Consume(int nbits)
+    {
+        m_buffer = nbits < 64 ? m_buffer << nbits : 0;
+        m_avail -= nbits;
+    }
+
+    /** Read nbits (0 to 56) bits. */
+    uint64_t Read(int nbits)
+    {
+        if (nbits == 0) return 0;
+        if (nbits > m_avail) {
+            Refill();
+            if (nbits > m_avail) throw std::ios_base::failure("GolombRiceReader: end of data");
+        }
+        const uint64_t data{m_buffer >> (64 - nbits)};
+        Consume(nbits);
+        return data;
+    }
+
+public:
+    explicit GolombRiceReader(std::span<const unsigned char> data LIFETIMEBOUND) : m_data{data} {}
+
+    uint64_t Decode(uint8_t P)
+    {
+        uint64_t q = 0;
+        while (true) {
+            if (m_avail == 0) {
+                Refill();
+                if (m_avail == 0) throw std::ios_base::failure("GolombRiceReader: end of data");
+            }
+            const int ones{std::min(std::countl_one(m_buffer), m_avail)};
+            q += ones;
+            if (ones < m_avail) {
+                Consume(ones + 1);
+                break;
+            }
+            Consume(ones);
+        }
+        const uint64_t r{P > 56 ? (Read(P - 32) << 32) | Read(32) : Read(P)};
+        return (q << P) + r;
+    }
+
+    /** Number of bytes of the data read so far, including a partially read last byte. */
+    size_t BytesRead() const { return m_pos - m_avail / 8; }
+};
+
 #endif // HYLIUM_UTIL_GOLOMBRICE_H
@@ -8,6 +8,7 @@
 #include <crypto/hex_base.h>
 #include <span.h>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstring>
@@ -58,11 +59,15 @@ std::optional<std::vector<Byte>> TryParseHex(std::string_view str)
             ++it;
             continue;
         }
-        auto c1 = HexDigit(*(it++));
-        if (it == str.end()) return std::nullopt;
-        auto c2 = HexDigit(*(it++));
-        if (c1 < 0 || c2 < 0) return std::nullopt;
-        vch.push_back(Byte(c1 << 4) | Byte(c2));
+        // Decode the digits up to the next whitespace at once. Whitespace
+        // may only separate whole bytes.
+        const auto run_end = std::find_if(it, str.end(), IsSpace);
+        const size_t run = run_end - it;
+        if (run % 2 != 0) return std::nullopt;
+        const size_t offset = vch.size();
+        vch.resize(offset + run / 2);
+        if (!DecodeHexDigits({it, run_end}, UCharSpanCast(std::span{vch}.subspan(offset)))) return std::nullopt;
+        it = run_end;
     }
     return vch;
 }
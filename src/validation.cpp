@@ -142,7 +142,8 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
                        const CCoinsViewCache& inputs, script_verify_flags flags, bool cacheSigStore,
                        bool cacheFullScriptStore, PrecomputedTransactionData& txdata,
                        ValidationCache& validation_cache,
-                       std::vector<CScriptCheck>* pvChecks = nullptr)
+                       std::vector<CScriptCheck>* pvChecks = nullptr,
+                       const CTxMemPool* mempool = nullptr)
                        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
 bool CheckFinalTxAtTip(const CBlockIndex& active_chain_tip, const CTransaction& tx)
@@ -1167,6 +1168,14 @@ bool MemPoolAccept::PolicyScriptChecks(const ATMPArgs& args, Workspace& ws)
         return false; // state filled in by CheckInputScripts
     }
 
+    // Keep the sighash precomputations with the entry, for when the
+    // transaction is in a block (see ConnectBlock). Legacy transactions have
+    // none.
+    const auto& txdata{ws.m_precomputed_txdata};
+    if (txdata.m_bip143_segwit_ready || txdata.m_bip341_taproot_ready) {
+        ws.m_tx_handle->SetPrecomputedTxData(std::make_shared<const PrecomputedTransactionData>(txdata.HashesOnly()));
+    }
+
     return true;
 }
 
@@ -1901,6 +1910,12 @@ void Chainstate::InitCoinsDB(
         leveldb_name += node::SNAPSHOT_CHAINSTATE_SUFFIX;
     }
 
+    DBOptions coins_db{m_chainman.m_options.coins_db};
+    // Both chainstates of a snapshot are open at once, so each gets its own trace
+    if (!coins_db.trace_path.empty()) {
+        coins_db.trace_path.replace_filename(fs::u8path(fs::PathToString(leveldb_name) + ".dbtrace"));
+    }
+
     m_coins_views = std::make_unique<CoinsViews>(
         DBParams{
             .path = m_chainman.m_options.datadir / leveldb_name,
@@ -1908,7 +1923,7 @@ void Chainstate::InitCoinsDB(
             .memory_only = in_memory,
             .wipe_data = should_wipe,
             .obfuscate = true,
-            .options = m_chainman.m_options.coins_db},
+            .options = std::move(coins_db)},
         m_chainman.m_options.coins_view);
 
     m_coinsdb_cache_size_bytes = cache_size_bytes;
@@ -2065,6 +2080,9 @@ ValidationCache::ValidationCache(const size_t script_execution_cache_bytes, cons
  * which are matched. This is useful for checking blocks where we will likely never need the cache
  * entry again.
  *
+ * If mempool is not nullptr, the sighash precomputations kept with the entry of the transaction in
+ * it are reused.
+ *
  * Note that we may set state.reason to NOT_STANDARD for extra soft-fork flags in flags, block-checking
  * callers should probably reset it to CONSENSUS in such cases.
  *
@@ -2074,7 +2092,8 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
                        const CCoinsViewCache& inputs, script_verify_flags flags, bool cacheSigStore,
                        bool cacheFullScriptStore, PrecomputedTransactionData& txdata,
                        ValidationCache& validation_cache,
-                       std::vector<CScriptCheck>* pvChecks)
+                       std::vector<CScriptCheck>* pvChecks,
+                       const CTxMemPool* mempool)
 {
     if (tx.IsCoinBase()) return true;
 
@@ -2096,6 +2115,16 @@ bool CheckInputScripts(const CTransaction& tx, TxValidationState& state,
     }
 
     if (!txdata.m_spent_outputs_ready) {
+        if (mempool) {
+            // Start from the sighash precomputations made when the
+            // transaction was accepted to the mempool. As with the script
+            // execution cache, this relies on the prevouts of the transaction
+            // committing to the outputs it spends. Only looked up on a miss of
+            // that cache, as transactions validated for the mempool hit it.
+            LOCK(mempool->cs);
+            const auto it{mempool->GetIter(tx.GetWitnessHash())};
+            if (it && (*it)->GetPrecomputedTxData()) txdata = *(*it)->GetPrecomputedTxData();
+        }
         std::vector<CTxOut> spent_outputs;
         spent_outputs.reserve(tx.vin.size());
 
@@ -2591,10 +2620,10 @@ bool Chainstate::ConnectBlock(const CBlock& block, BlockValidationState& state,
             // they need to be added to control which runs them asynchronously. Otherwise, CheckInputScripts runs the checks before returning.
             if (control) {
                 std::vector<CScriptCheck> vChecks;
-                tx_ok = CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], m_chainman.m_validation_cache, &vChecks);
+                tx_ok = CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], m_chainman.m_validation_cache, &vChecks, m_mempool);
                 if (tx_ok) control->Add(std::move(vChecks));
             } else {
-                tx_ok = CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], m_chainman.m_validation_cache);
+                tx_ok = CheckInputScripts(tx, tx_state, view, flags, fCacheResults, fCacheResults, txsdata[i], m_chainman.m_validation_cache, nullptr, m_mempool);
             }
             if (!tx_ok) {
                 // Any transaction validation failure in ConnectBlock is a block consensus failure
@@ -3869,15 +3898,20 @@ void ChainstateManager::ReceivedBlockTransactions(const CBlock& block, CBlockInd
     }
 }
 
-static bool CheckBlockHeader(const CBlockHeader& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true)
+static bool CheckBlockHeader(const CBlockHeader& block, const uint256& hash, BlockValidationState& state, const Consensus::Params& consensusParams)
 {
     // Check proof of work matches claimed amount
-    if (fCheckPOW && !CheckProofOfWork(block.GetHash(), block.nBits, consensusParams))
+    if (!CheckProofOfWork(hash, block.nBits, consensusParams))
         return state.Invalid(BlockValidationResult::BLOCK_INVALID_HEADER, "high-hash", "proof of work failed");
 
     return true;
 }
 
+static bool CheckBlockHeader(const CBlockHeader& block, BlockValidationState& state, const Consensus::Params& consensusParams, bool fCheckPOW = true)
+{
+    return !fCheckPOW || CheckBlockHeader(block, block.GetHash(), state, consensusParams);
+}
+
 static bool CheckMerkleRoot(const CBlock& block, BlockValidationState& state)
 {
     if (block.m_checked_merkle_root) return true;
@@ -4071,6 +4105,15 @@ bool HasValidProofOfWork(const std::vector<CBlockHeader>& headers, const Consens
             [&](const auto& header) { return CheckProofOfWork(header.GetHash(), header.nBits, consensusParams);});
 }
 
+bool HasValidProofOfWork(std::span<const CBlockHeader> headers, std::span<const uint256> hashes, const Consensus::Params& consensusParams)
+{
+    if (!Assume(headers.size() == hashes.size())) return false;
+    for (size_t i{0}; i < headers.size(); ++i) {
+        if (!CheckProofOfWork(hashes[i], headers[i].nBits, consensusParams)) return false;
+    }
+    return true;
+}
+
 bool IsBlockMutated(const CBlock& block, bool check_witness_root)
 {
     BlockValidationState state;
@@ -4231,12 +4274,11 @@ static bool ContextualCheckBlock(const CBlock& block, BlockValidationState& stat
     return true;
 }
 
-bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValidationState& state, CBlockIndex** ppindex, bool min_pow_checked)
+bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, const uint256& hash, BlockValidationState& state, CBlockIndex** ppindex, bool min_pow_checked)
 {
     AssertLockHeld(cs_main);
 
     // Check for duplicate
-    uint256 hash = block.GetHash();
     BlockMap::iterator miSelf{m_blockman.m_block_index.find(hash)};
     if (hash != GetConsensus().hashGenesisBlock) {
         if (miSelf != m_blockman.m_block_index.end()) {
@@ -4252,7 +4294,7 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
             return true;
         }
 
-        if (!CheckBlockHeader(block, state, GetConsensus())) {
+        if (!CheckBlockHeader(block, hash, state, GetConsensus())) {
             LogDebug(BCLog::VALIDATION, "%s: Consensus::CheckBlockHeader: %s, %s\n", __func__, hash.ToString(), state.ToString());
             return false;
         }
@@ -4278,7 +4320,7 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
         LogDebug(BCLog::VALIDATION, "%s: not adding new block header %s, missing anti-dos proof-of-work validation\n", __func__, hash.ToString());
         return state.Invalid(BlockValidationResult::BLOCK_HEADER_LOW_WORK, "too-little-chainwork");
     }
-    CBlockIndex* pindex{m_blockman.AddToBlockIndex(block, m_best_header)};
+    CBlockIndex* pindex{m_blockman.AddToBlockIndex(block, hash, m_best_header)};
 
     if (ppindex)
         *ppindex = pindex;
@@ -4287,14 +4329,16 @@ bool ChainstateManager::AcceptBlockHeader(const CBlockHeader& block, BlockValida
 }
 
 // Exposed wrapper for AcceptBlockHeader
-bool ChainstateManager::ProcessNewBlockHeaders(std::span<const CBlockHeader> headers, bool min_pow_checked, BlockValidationState& state, const CBlockIndex** ppindex)
+bool ChainstateManager::ProcessNewBlockHeaders(std::span<const CBlockHeader> headers, bool min_pow_checked, BlockValidationState& state, const CBlockIndex** ppindex, std::span<const uint256> hashes)
 {
     AssertLockNotHeld(cs_main);
+    Assume(hashes.empty() || hashes.size() == headers.size());
     {
         LOCK(cs_main);
-        for (const CBlockHeader& header : headers) {
+        for (size_t i{0}; i < headers.size(); ++i) {
+            const CBlockHeader& header{headers[i]};
             CBlockIndex *pindex = nullptr; // Use a temp pindex instead of ppindex to avoid a const_cast
-            bool accepted{AcceptBlockHeader(header, state, &pindex, min_pow_checked)};
+            bool accepted{AcceptBlockHeader(header, hashes.size() == headers.size() ? hashes[i] : header.GetHash(), state, &pindex, min_pow_checked)};
             CheckBlockIndex();
 
             if (!accepted) {
@@ -4353,7 +4397,7 @@ bool ChainstateManager::AcceptBlock(const std::shared_ptr<const CBlock>& pblock,
     CBlockIndex *pindexDummy = nullptr;
     CBlockIndex *&pindex = ppindex ? *ppindex : pindexDummy;
 
-    bool accepted_header{AcceptBlockHeader(block, state, &pindex, min_pow_checked)};
+    bool accepted_header{AcceptBlockHeader(block, block.GetHash(), state, &pindex, min_pow_checked)};
     CheckBlockIndex();
 
     if (!accepted_header)
@@ -250,7 +250,7 @@ public:
     mutable bool fChangeCached;
     mutable CAmount nChangeCached;
 
-    CWalletTx(CTransactionRef tx, const TxState& state) : tx(std::move(tx)), m_state(state)
+    CWalletTx(CTransactionRef tx, const TxState& state) : tx(DetachFromArena(std::move(tx))), m_state(state)
     {
         Init();
     }
@@ -331,7 +331,7 @@ public:
 
     void SetTx(CTransactionRef arg)
     {
-        tx = std::move(arg);
+        tx = DetachFromArena(std::move(arg));
     }
 
     //! make sure balances are recalculated
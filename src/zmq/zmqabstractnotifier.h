@@ -5,6 +5,8 @@
 #ifndef HYLIUM_ZMQ_ZMQABSTRACTNOTIFIER_H
 #define HYLIUM_ZMQ_ZMQABSTRACTNOTIFIER_H
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
@@ -20,6 +22,7 @@ class CZMQAbstractNotifier
 {
 public:
     static const int DEFAULT_ZMQ_SNDHWM {1000};
+    static const int64_t DEFAULT_ZMQ_QUEUE_SIZE {100000};
 
     virtual ~CZMQAbstractNotifier();
 
@@ -39,6 +42,17 @@ public:
             outbound_message_high_water_mark = sndhwm;
         }
     }
+    //! Messages waiting to be sent, beyond which new ones are dropped (0 means no limit)
+    int64_t GetMaxMessagesQueued() const { return m_max_messages_queued; }
+    void SetMaxMessagesQueued(const int64_t max_queued) {
+        if (max_queued >= 0) {
+            m_max_messages_queued = max_queued;
+        }
+    }
+    //! Messages waiting to be sent
+    size_t GetMessagesQueued() const { return m_messages_queued; }
+    //! Messages not sent, whose sequence numbers subscribers see skipped
+    uint64_t GetMessagesDropped() const { return m_messages_dropped; }
 
     virtual bool Initialize(void *pcontext) = 0;
     virtual void Shutdown() = 0;
@@ -61,6 +75,9 @@ protected:
     std::string type;
     std::string address;
     int outbound_message_high_water_mark{DEFAULT_ZMQ_SNDHWM}; // aka SNDHWM
+    int64_t m_max_messages_queued{DEFAULT_ZMQ_QUEUE_SIZE};
+    std::atomic<size_t> m_messages_queued{0};
+    std::atomic<uint64_t> m_messages_dropped{0};
 };
 
 #endif // HYLIUM_ZMQ_ZMQABSTRACTNOTIFIER_H
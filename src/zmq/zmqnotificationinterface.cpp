@@ -66,6 +66,7 @@ std::unique_ptr<CZMQNotificationInterface> CZMQNotificationInterface::Create(std
             notifier->SetType(entry.first);
             notifier->SetAddress(address);
             notifier->SetOutboundMessageHighWaterMark(static_cast<int>(gArgs.GetIntArg(arg + "hwm", CZMQAbstractNotifier::DEFAULT_ZMQ_SNDHWM)));
+            notifier->SetMaxMessagesQueued(gArgs.GetIntArg("-zmqqueuesize", CZMQAbstractNotifier::DEFAULT_ZMQ_QUEUE_SIZE));
             notifiers.push_back(std::move(notifier));
         }
     }
@@ -19,18 +19,24 @@
 #include <streams.h>
 #include <sync.h>
 #include <uint256.h>
+#include <util/thread.h>
 #include <zmq/zmqutil.h>
 
 #include <zmq.h>
 
 #include <cassert>
-#include <cstdarg>
+#include <cerrno>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <cstring>
+#include <deque>
 #include <map>
+#include <memory>
 #include <optional>
+#include <span>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -46,48 +52,136 @@ static const char *MSG_RAWBLOCK  = "rawblock";
 static const char *MSG_RAWTX     = "rawtx";
 static const char *MSG_SEQUENCE  = "sequence";
 
-// Internal function to send multipart message
-static int zmq_send_multipart(void *sock, const void* data, size_t size, ...)
+namespace {
+
+/** A message queued for the publisher thread */
+struct ZMQMessage {
+    CZMQAbstractPublishNotifier* notifier;
+    void* socket;
+    const char* command;
+    //! Keeps data alive until the message is sent
+    std::shared_ptr<const void> owner;
+    std::span<const std::byte> data;
+    uint32_t sequence;
+};
+
+/** Release the data of a message, once ZMQ is done with it */
+void FreeMessageData(void* /*data*/, void* hint)
 {
-    va_list args;
-    va_start(args, size);
+    delete static_cast<std::shared_ptr<const void>*>(hint);
+}
 
-    while (1)
-    {
-        zmq_msg_t msg;
+using SendResult = CZMQAbstractPublishNotifier::SendResult;
 
-        int rc = zmq_msg_init_size(&msg, size);
-        if (rc != 0)
-        {
-            zmqError("Unable to initialize ZMQ msg");
-            va_end(args);
-            return -1;
+/** Send the three parts of a message. The data is not copied. */
+SendResult SendMultipart(const ZMQMessage& message)
+{
+    if (zmq_send(message.socket, message.command, strlen(message.command), ZMQ_SNDMORE | ZMQ_DONTWAIT) == -1) {
+        // With ZMQ_XPUB_NODROP, a subscriber at the high water mark fails the
+        // first part, and so the whole message, rather than having it dropped
+        // silently. Once the first part is queued, the others are too.
+        if (zmq_errno() == EAGAIN) {
+            LogDebug(BCLog::ZMQ, "Drop %s message %u, the high water mark is reached\n", message.command, message.sequence);
+            return SendResult::DROPPED;
         }
+        zmqError("Unable to send ZMQ msg");
+        return SendResult::FAILED;
+    }
 
-        void *buf = zmq_msg_data(&msg);
-        memcpy(buf, data, size);
+    auto owner{new std::shared_ptr<const void>(message.owner)};
+    zmq_msg_t msg;
+    if (zmq_msg_init_data(&msg, const_cast<std::byte*>(message.data.data()), message.data.size(), FreeMessageData, owner) != 0) {
+        delete owner;
+        zmqError("Unable to initialize ZMQ msg");
+        return SendResult::FAILED;
+    }
+    if (zmq_msg_send(&msg, message.socket, ZMQ_SNDMORE | ZMQ_DONTWAIT) == -1) {
+        zmqError("Unable to send ZMQ msg");
+        zmq_msg_close(&msg);
+        return SendResult::FAILED;
+    }
 
-        data = va_arg(args, const void*);
+    unsigned char msgseq[sizeof(uint32_t)];
+    WriteLE32(msgseq, message.sequence);
+    if (zmq_send(message.socket, msgseq, sizeof(msgseq), ZMQ_DONTWAIT) == -1) {
+        zmqError("Unable to send ZMQ msg");
+        return SendResult::FAILED;
+    }
+    return SendResult::SENT;
+}
 
-        rc = zmq_msg_send(&msg, sock, data ? ZMQ_SNDMORE : 0);
-        if (rc == -1)
-        {
-            zmqError("Unable to send ZMQ msg");
-            zmq_msg_close(&msg);
-            va_end(args);
-            return -1;
+/**
+ * Sends the messages of all publish notifiers on its own thread, so that the
+ * validation interface callbacks only queue them. The messages queued while a
+ * batch is sent are taken together as the next batch.
+ */
+class ZMQPublisher
+{
+private:
+    Mutex m_mutex;
+    std::condition_variable m_cond;
+    std::deque<ZMQMessage> m_queue GUARDED_BY(m_mutex);
+    //! Whether a batch taken off the queue is being sent
+    bool m_sending GUARDED_BY(m_mutex){false};
+    bool m_stop GUARDED_BY(m_mutex){false};
+    std::thread m_thread;
+
+    void ThreadPublish() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        std::deque<ZMQMessage> batch;
+        WAIT_LOCK(m_mutex, lock);
+        while (true) {
+            m_cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_stop || !m_queue.empty(); });
+            // Only stop once everything queued is sent.
+            if (m_queue.empty()) break;
+            batch.swap(m_queue);
+            m_sending = true;
+            {
+                REVERSE_LOCK(lock, m_mutex);
+                for (const ZMQMessage& message : batch) {
+                    message.notifier->MessageSent(SendMultipart(message));
+                }
+                batch.clear();
+            }
+            m_sending = false;
+            m_cond.notify_all();
         }
+    }
 
-        zmq_msg_close(&msg);
+public:
+    void Start() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        assert(!m_thread.joinable());
+        m_thread = std::thread(&util::TraceThread, "zmqpub", [this] { ThreadPublish(); });
+    }
 
-        if (!data)
-            break;
+    /** Send what is queued, and stop the thread */
+    void Stop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        if (!m_thread.joinable()) return;
+        WITH_LOCK(m_mutex, m_stop = true);
+        m_cond.notify_all();
+        m_thread.join();
+        WITH_LOCK(m_mutex, m_stop = false);
+    }
 
-        size = va_arg(args, size_t);
+    void Push(ZMQMessage&& message) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WITH_LOCK(m_mutex, m_queue.push_back(std::move(message)));
+        m_cond.notify_all();
     }
-    va_end(args);
-    return 0;
-}
+
+    /** Wait until everything queued so far is sent */
+    void Flush() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex)
+    {
+        WAIT_LOCK(m_mutex, lock);
+        m_cond.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) { return m_queue.empty() && !m_sending; });
+    }
+};
+
+ZMQPublisher g_publisher;
+
+} // namespace
 
 static bool IsZMQAddressIPV6(const std::string &zmq_address)
 {
@@ -128,6 +222,18 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
             return false;
         }
 
+#ifdef ZMQ_XPUB_NODROP
+        // Fail sends at the high water mark, for them to be counted as
+        // dropped, rather than having the socket drop them silently.
+        const int nodrop_option{1};
+        rc = zmq_setsockopt(psocket, ZMQ_XPUB_NODROP, &nodrop_option, sizeof(nodrop_option));
+        if (rc != 0) {
+            zmqError("Failed to set ZMQ_XPUB_NODROP");
+            zmq_close(psocket);
+            return false;
+        }
+#endif
+
         const int so_keepalive_option {1};
         rc = zmq_setsockopt(psocket, ZMQ_TCP_KEEPALIVE, &so_keepalive_option, sizeof(so_keepalive_option));
         if (rc != 0) {
@@ -155,6 +261,7 @@ bool CZMQAbstractPublishNotifier::Initialize(void *pcontext)
 
         // register this notifier for the address, so it can be reused for other publish notifier
         mapPublishNotifiers.insert(std::make_pair(address, this));
+        if (mapPublishNotifiers.size() == 1) g_publisher.Start();
         return true;
     }
     else
@@ -174,6 +281,9 @@ void CZMQAbstractPublishNotifier::Shutdown()
     // Early return if Initialize was not called
     if (!psocket) return;
 
+    // Nothing queued may refer to this notifier or its socket anymore
+    g_publisher.Flush();
+
     int count = mapPublishNotifiers.count(address);
 
     // remove this notifier from the list of publishers using this address
@@ -189,6 +299,8 @@ void CZMQAbstractPublishNotifier::Shutdown()
         }
     }
 
+    if (mapPublishNotifiers.empty()) g_publisher.Stop();
+
     if (count == 1)
     {
         LogDebug(BCLog::ZMQ, "Close socket at address %s\n", address);
@@ -200,23 +312,58 @@ void CZMQAbstractPublishNotifier::Shutdown()
     psocket = nullptr;
 }
 
-bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command, const void* data, size_t size)
+bool CZMQAbstractPublishNotifier::SendZmqMessage(const char *command, std::span<const std::byte> data, std::shared_ptr<const void> owner)
 {
     assert(psocket);
 
-    /* send three parts, command & data & a LE 4byte sequence number */
-    unsigned char msgseq[sizeof(uint32_t)];
-    WriteLE32(msgseq, nSequence);
-    int rc = zmq_send_multipart(psocket, command, strlen(command), data, size, msgseq, (size_t)sizeof(uint32_t), nullptr);
-    if (rc == -1)
-        return false;
+    if (m_send_failed) return false;
 
-    /* increment memory only sequence number after sending */
-    nSequence++;
+    /* the sequence number is used even if the message is dropped, so subscribers can tell */
+    const uint32_t sequence{nSequence++};
+    if (m_max_messages_queued > 0 && m_messages_queued >= uint64_t(m_max_messages_queued)) {
+        ++m_messages_dropped;
+        LogDebug(BCLog::ZMQ, "Drop %s message %u to %s, %d messages queued\n", command, sequence, address, m_max_messages_queued);
+        return true;
+    }
 
+    if (!owner) {
+        auto copy{std::make_shared<std::vector<std::byte>>(data.begin(), data.end())};
+        data = *copy;
+        owner = std::move(copy);
+    }
+    ++m_messages_queued;
+    g_publisher.Push({.notifier = this, .socket = psocket, .command = command, .owner = std::move(owner), .data = data, .sequence = sequence});
     return true;
 }
 
+void CZMQAbstractPublishNotifier::MessageSent(SendResult result)
+{
+    if (result != SendResult::SENT) ++m_messages_dropped;
+    if (result == SendResult::FAILED) m_send_failed = true;
+    --m_messages_queued;
+}
+
+/**
+ * The serialization of the last transaction published, which the rawtx
+ * notifiers of all addresses publish one after the other, and which the
+ * queued messages refer to until they are sent.
+ */
+static Mutex g_last_raw_tx_mutex;
+static uint256 g_last_raw_tx_wtxid GUARDED_BY(g_last_raw_tx_mutex);
+static std::shared_ptr<const DataStream> g_last_raw_tx GUARDED_BY(g_last_raw_tx_mutex);
+
+static std::shared_ptr<const DataStream> SerializeTransaction(const CTransaction& transaction)
+{
+    LOCK(g_last_raw_tx_mutex);
+    if (!g_last_raw_tx || g_last_raw_tx_wtxid != transaction.GetWitnessHash().ToUint256()) {
+        auto ss{std::make_shared<DataStream>()};
+        *ss << TX_WITH_WITNESS(transaction);
+        g_last_raw_tx = std::move(ss);
+        g_last_raw_tx_wtxid = transaction.GetWitnessHash().ToUint256();
+    }
+    return g_last_raw_tx;
+}
+
 bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
 {
     uint256 hash = pindex->GetBlockHash();
@@ -225,7 +372,7 @@ bool CZMQPublishHashBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
     for (unsigned int i = 0; i < 32; i++) {
         data[31 - i] = hash.begin()[i];
     }
-    return SendZmqMessage(MSG_HASHBLOCK, data, 32);
+    return SendZmqMessage(MSG_HASHBLOCK, std::as_bytes(std::span{data}));
 }
 
 bool CZMQPublishHashTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
@@ -236,29 +383,28 @@ bool CZMQPublishHashTransactionNotifier::NotifyTransaction(const CTransaction &t
     for (unsigned int i = 0; i < 32; i++) {
         data[31 - i] = hash.begin()[i];
     }
-    return SendZmqMessage(MSG_HASHTX, data, 32);
+    return SendZmqMessage(MSG_HASHTX, std::as_bytes(std::span{data}));
 }
 
 bool CZMQPublishRawBlockNotifier::NotifyBlock(const CBlockIndex *pindex)
 {
     LogDebug(BCLog::ZMQ, "Publish rawblock %s to %s\n", pindex->GetBlockHash().GetHex(), this->address);
 
-    std::vector<std::byte> block{};
-    if (!m_get_block_by_index(block, *pindex)) {
+    auto block{std::make_shared<std::vector<std::byte>>()};
+    if (!m_get_block_by_index(*block, *pindex)) {
         zmqError("Can't read block from disk");
         return false;
     }
 
-    return SendZmqMessage(MSG_RAWBLOCK, block.data(), block.size());
+    return SendZmqMessage(MSG_RAWBLOCK, *block, block);
 }
 
 bool CZMQPublishRawTransactionNotifier::NotifyTransaction(const CTransaction &transaction)
 {
     uint256 hash = transaction.GetHash().ToUint256();
     LogDebug(BCLog::ZMQ, "Publish rawtx %s to %s\n", hash.GetHex(), this->address);
-    DataStream ss;
-    ss << TX_WITH_WITNESS(transaction);
-    return SendZmqMessage(MSG_RAWTX, &(*ss.begin()), ss.size());
+    const auto ss{SerializeTransaction(transaction)};
+    return SendZmqMessage(MSG_RAWTX, std::span{ss->data(), ss->size()}, ss);
 }
 
 // Helper function to send a 'sequence' topic message with the following structure:
@@ -271,7 +417,7 @@ static bool SendSequenceMsg(CZMQAbstractPublishNotifier& notifier, uint256 hash,
     }
     data[sizeof(hash)] = label;
     if (sequence) WriteLE64(data + sizeof(hash) + sizeof(label), *sequence);
-    return notifier.SendZmqMessage(MSG_SEQUENCE, data, sequence ? sizeof(data) : sizeof(hash) + sizeof(label));
+    return notifier.SendZmqMessage(MSG_SEQUENCE, std::as_bytes(std::span{data}).first(sequence ? sizeof(data) : sizeof(hash) + sizeof(label)));
 }
 
 bool CZMQPublishSequenceNotifier::NotifyBlockConnect(const CBlockIndex *pindex)
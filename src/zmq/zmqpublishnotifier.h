@@ -7,9 +7,12 @@
 
 #include <zmq/zmqabstractnotifier.h>
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <memory>
+#include <span>
 #include <vector>
 
 class CBlockIndex;
@@ -19,16 +22,32 @@ class CZMQAbstractPublishNotifier : public CZMQAbstractNotifier
 {
 private:
     uint32_t nSequence {0U}; //!< upcounting per message sequence number
+    //! Whether the publisher thread failed to send a message of this notifier
+    std::atomic<bool> m_send_failed{false};
 
 public:
+    enum class SendResult {
+        SENT,
+        //! The high water mark of the socket was reached
+        DROPPED,
+        FAILED,
+    };
 
-    /* send zmq multipart message
+    /* queue zmq multipart message, sent by the publisher thread
        parts:
           * command
           * data
           * message sequence number
+
+       The data is kept alive by owner until it is sent, or copied if there
+       is no owner. When m_max_messages_queued messages of this notifier are
+       already queued, the message is dropped, and its sequence number
+       skipped. Returns false once a message of this notifier failed to send,
+       so that it is shut down.
     */
-    bool SendZmqMessage(const char *command, const void* data, size_t size);
+    bool SendZmqMessage(const char *command, std::span<const std::byte> data, std::shared_ptr<const void> owner = {});
+    //! Called by the publisher thread for each message, once it is sent, dropped or failed to
+    void MessageSent(SendResult result);
 
     bool Initialize(void *pcontext) override;
     void Shutdown() override;
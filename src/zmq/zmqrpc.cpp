@@ -32,6 +32,8 @@ static RPCHelpMan getzmqnotifications()
                             {RPCResult::Type::STR, "type", "Type of notification"},
                             {RPCResult::Type::STR, "address", "Address of the publisher"},
                             {RPCResult::Type::NUM, "hwm", "Outbound message high water mark"},
+                            {RPCResult::Type::NUM, "queued", "Number of messages waiting to be sent"},
+                            {RPCResult::Type::NUM, "dropped", "Number of messages dropped because -zmqqueuesize messages were already queued, or the high water mark of a subscriber was reached, or that failed to send. Subscribers see their sequence numbers skipped."},
                         }},
                     }
                 },
@@ -48,6 +50,8 @@ static RPCHelpMan getzmqnotifications()
             obj.pushKV("type", n->GetType());
             obj.pushKV("address", n->GetAddress());
             obj.pushKV("hwm", n->GetOutboundMessageHighWaterMark());
+            obj.pushKV("queued", n->GetMessagesQueued());
+            obj.pushKV("dropped", n->GetMessagesDropped());
             result.push_back(std::move(obj));
         }
     }
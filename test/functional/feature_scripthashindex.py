@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025- The Hylium Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""Test scripthashindex and the getscripthistory/getscriptunspent RPCs and REST endpoints.
+
+- the index tracks received and spent outputs of a script, and its unspent outputs
+- results can be paged through with the returned cursor
+- a reorg rolls back the history and restores spent outputs
+- the REST endpoints return the same results as the RPCs
+"""
+
+from decimal import Decimal
+import http.client
+import json
+import urllib.parse
+
+from test_framework.address import ADDRESS_BCRT1_UNSPENDABLE
+from test_framework.test_framework import HyliumTestFramework
+from test_framework.util import (
+    assert_equal,
+    assert_raises_rpc_error,
+)
+from test_framework.wallet import MiniWallet
+
+
+class ScriptHashIndexTest(HyliumTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 2
+        self.extra_args = [["-scripthashindex", "-rest"], []]
+
+    def rest_request(self, uri, status=200):
+        url = urllib.parse.urlparse(self.nodes[0].url)
+        conn = http.client.HTTPConnection(url.hostname, url.port)
+        conn.request('GET', '/rest' + uri)
+        resp = conn.getresponse()
+        assert_equal(resp.status, status)
+        return resp.read().decode('utf-8')
+
+    def get_full_history(self, node, script, count):
+        history = []
+        cursor = None
+        while True:
+            res = node.getscripthistory(script, count) if cursor is None else node.getscripthistory(script, count, cursor)
+            assert len(res['history']) <= count
+            history += res['history']
+            if 'cursor' not in res:
+                return history
+            cursor = res['cursor']
+
+    def get_full_unspent(self, node, script, count):
+        unspents = []
+        cursor = None
+        while True:
+            res = node.getscriptunspent(script, count) if cursor is None else node.getscriptunspent(script, count, cursor)
+            unspents += res['unspents']
+            if 'cursor' not in res:
+                return unspents
+            cursor = res['cursor']
+
+    def run_test(self):
+        node = self.nodes[0]
+        wallet = MiniWallet(node)
+        address = wallet.get_address()
+        script_hex = wallet.get_output_script().hex()
+
+        self.log.info("Check that the index tracks coinbase outputs")
+        self.generate(wallet, 101)
+        self.wait_until(lambda: node.getindexinfo()['scripthashindex']['synced'])
+        res = node.getscripthistory(address)
+        assert_equal(res['height'], 101)
+        assert_equal(res['bestblock'], node.getbestblockhash())
+        assert 'cursor' not in res
+        history = res['history']
+        assert_equal(len(history), 101)
+        for height, entry in enumerate(history, start=1):
+            assert_equal(entry['type'], 'receive')
+            assert_equal(entry['height'], height)
+            assert_equal(entry['vout'], 0)
+            assert_equal(entry['txid'], node.getblock(node.getblockhash(height))['tx'][0])
+        unspents = node.getscriptunspent(address)['unspents']
+        assert_equal(len(unspents), 101)
+        assert_equal(node.getscripthistory(script_hex), res)
+
+        self.log.info("Check paging")
+        assert_equal(self.get_full_history(node, address, 40), history)
+        assert_equal(self.get_full_unspent(node, address, 40), unspents)
+        assert_equal(self.get_full_history(node, address, 1), history)
+
+        self.log.info("Check that spends are recorded")
+        tx = wallet.send_self_transfer(from_node=node)
+        self.generate(wallet, 1)
+        prevout = tx['tx'].vin[0].prevout
+        # The entries after the first 101 are the new coinbase output, then the
+        # output of the spending transaction, which is ordered before its spend.
+        new_entries = node.getscripthistory(address, 10, node.getscripthistory(address, 101)['cursor'])['history']
+        assert_equal([e['type'] for e in new_entries], ['receive', 'receive', 'spend'])
+        spend = next(e for e in new_entries if e['type'] == 'spend')
+        assert_equal(spend['txid'], tx['txid'])
+        assert_equal(spend['vin'], 0)
+        assert_equal(spend['prevout_txid'], f"{prevout.hash:064x}")
+        assert_equal(spend['prevout_vout'], prevout.n)
+        assert_equal(spend['height'], 102)
+        receive = next(e for e in new_entries if e['type'] == 'receive' and e['txid'] == tx['txid'])
+        assert_equal(receive['amount'], tx['tx'].vout[0].nValue / Decimal(100_000_000))
+        unspent_outpoints = {(u['txid'], u['vout']) for u in node.getscriptunspent(address)['unspents']}
+        assert (f"{prevout.hash:064x}", prevout.n) not in unspent_outpoints
+        assert (tx['txid'], 0) in unspent_outpoints
+
+        self.log.info("Check that a reorg rolls the index back")
+        # The index rewinds when a block of the other branch is connected, so
+        # replace the tip with an empty block that pays elsewhere.
+        tip = node.getbestblockhash()
+        node.invalidateblock(tip)
+        replacement = self.generateblock(node, ADDRESS_BCRT1_UNSPENDABLE, [], sync_fun=self.no_op)['hash']
+        self.wait_until(lambda: node.getindexinfo()['scripthashindex']['best_block_height'] == 102)
+        res = node.getscripthistory(address)
+        assert_equal(res['bestblock'], replacement)
+        assert_equal(res['history'], history)
+        assert_equal(node.getscriptunspent(address)['unspents'], unspents)
+        node.invalidateblock(replacement)
+        node.reconsiderblock(tip)
+        self.wait_until(lambda: node.getscripthistory(address)['bestblock'] == tip)
+        assert_equal(node.getscripthistory(address)['history'][:101] + new_entries, node.getscripthistory(address)['history'])
+
+        self.log.info("Check the REST endpoints")
+        full = node.getscripthistory(address, 40)
+        assert_equal(json.loads(self.rest_request(f"/scripthistory/{address}.json?count=40"), parse_float=Decimal), full)
+        assert_equal(json.loads(self.rest_request(f"/scripthistory/{script_hex}.json?count=40&cursor={full['cursor']}"), parse_float=Decimal),
+                     node.getscripthistory(address, 40, full['cursor']))
+        assert_equal(json.loads(self.rest_request(f"/scriptunspent/{address}.json"), parse_float=Decimal), node.getscriptunspent(address))
+        unspent_page = node.getscriptunspent(address, 40)
+        assert_equal(json.loads(self.rest_request(f"/scriptunspent/{address}.json?count=40&cursor={unspent_page['cursor']}"), parse_float=Decimal),
+                     node.getscriptunspent(address, 40, unspent_page['cursor']))
+        self.rest_request(f"/scripthistory/{address}.json?count=x", status=400)
+        self.rest_request(f"/scripthistory/{address}.json?count=0", status=400)
+        self.rest_request("/scriptunspent/nonsense.json", status=400)
+        self.rest_request(f"/scriptunspent/{address}.bin", status=404)
+
+        self.log.info("Check errors")
+        assert_raises_rpc_error(-8, "count must be between 1 and 10000", node.getscripthistory, address, 0)
+        assert_raises_rpc_error(-8, "Invalid cursor", node.getscripthistory, address, 10, "00")
+        assert_raises_rpc_error(-8, "Invalid cursor", node.getscriptunspent, address, 10, "00")
+        # The cursors of both are opaque hex strings, but not interchangeable
+        assert_raises_rpc_error(-8, "Invalid cursor", node.getscriptunspent, address, 10, node.getscripthistory(address, 1)['cursor'])
+        assert_raises_rpc_error(-5, "Invalid address or output script", node.getscripthistory, "nonsense")
+        assert_raises_rpc_error(-1, "Requires scripthashindex", self.nodes[1].getscripthistory, address)
+        assert_raises_rpc_error(-1, "Requires scripthashindex", self.nodes[1].getscriptunspent, address)
+
+
+if __name__ == '__main__':
+    ScriptHashIndexTest(__file__).main()
@@ -16,6 +16,7 @@ import urllib.parse
 from test_framework.messages import (
     BLOCK_HEADER_SIZE,
     COIN,
+    CBlock,
     deser_block_spent_outputs,
 )
 from test_framework.test_framework import HyliumTestFramework
@@ -32,6 +33,8 @@ from test_framework.wallet import (
 
 INVALID_PARAM = "abc"
 UNKNOWN_PARAM = "0000000000000000000000000000000000000000000000000000000000000000"
+# Magic bytes, version, network magic, base block hash and number of coins
+SNAPSHOT_METADATA_SIZE = 5 + 2 + 4 + 32 + 8
 
 
 class ReqType(Enum):
@@ -492,6 +495,62 @@ class RESTTest (HyliumTestFramework):
 
         self.test_rest_request(f"/blockpart/{blockhash}", status=400, req_type=ReqType.JSON, ret_type=RetType.OBJ)
 
+        self.log.info("Test the /blocks URI")
+
+        block_count = self.nodes[0].getblockcount()
+        genesis_hash = self.nodes[0].getblockhash(0)
+        for req_type in (ReqType.BIN, ReqType.HEX):
+            # More blocks than there are: up to the tip
+            blocks_bin = self.test_rest_request(f"/blocks/{genesis_hash}", req_type=req_type, ret_type=RetType.BYTES,
+                                                query_params={"count": block_count + 10, "undo": "true"})
+            if req_type is ReqType.HEX:
+                blocks_bin = bytes.fromhex(blocks_bin.decode().strip())
+            f = BytesIO(blocks_bin)
+            for height in range(0, block_count + 1):
+                blockhash = self.nodes[0].getblockhash(height)
+                block = CBlock()
+                block.deserialize(f)
+                assert_equal(block.hash_hex, blockhash)
+                spent_bin = self.test_rest_request(f"/spenttxouts/{blockhash}", req_type=ReqType.BIN, ret_type=RetType.BYTES)
+                assert_equal(f.read(len(spent_bin)), spent_bin)
+            assert_equal(f.read(), b"")
+
+        blockhash = self.nodes[0].getblockhash(block_count - 1)
+        blocks_bin = self.test_rest_request(f"/blocks/{blockhash}", req_type=ReqType.BIN, ret_type=RetType.BYTES, query_params={"count": 2})
+        expected = b"".join(self.test_rest_request(f"/block/{self.nodes[0].getblockhash(h)}", req_type=ReqType.BIN, ret_type=RetType.BYTES)
+                            for h in (block_count - 1, block_count))
+        assert_equal(blocks_bin, expected)
+
+        self.test_rest_request(f"/blocks/{blockhash}", status=400, req_type=ReqType.BIN, ret_type=RetType.OBJ)
+        self.test_rest_request(f"/blocks/{blockhash}", status=400, req_type=ReqType.BIN, ret_type=RetType.OBJ, query_params={"count": 0})
+        self.test_rest_request(f"/blocks/{blockhash}", status=400, req_type=ReqType.BIN, ret_type=RetType.OBJ, query_params={"count": 1001})
+        self.test_rest_request(f"/blocks/{blockhash}", status=400, req_type=ReqType.BIN, ret_type=RetType.OBJ, query_params={"count": 1, "undo": "yes"})
+        self.test_rest_request(f"/blocks/{INVALID_PARAM}", status=400, req_type=ReqType.BIN, ret_type=RetType.OBJ, query_params={"count": 1})
+        self.test_rest_request(f"/blocks/{UNKNOWN_PARAM}", status=404, req_type=ReqType.BIN, ret_type=RetType.OBJ, query_params={"count": 1})
+        self.test_rest_request(f"/blocks/{blockhash}", status=404, req_type=ReqType.JSON, ret_type=RetType.OBJ, query_params={"count": 1})
+
+        self.log.info("Test the /utxoset URI")
+
+        # The endpoint doesn't flush the coins cache, which dumptxoutset does
+        snapshot_path = self.nodes[0].dumptxoutset("utxoset.dat", "latest")["path"]
+        utxoset_bin = self.test_rest_request("/utxoset", req_type=ReqType.BIN, ret_type=RetType.BYTES)
+        utxoset_hex = self.test_rest_request("/utxoset", req_type=ReqType.HEX, ret_type=RetType.BYTES)
+        assert_equal(bytes.fromhex(utxoset_hex.decode().strip()), utxoset_bin)
+        assert_equal(utxoset_bin[:32][::-1].hex(), self.nodes[0].getbestblockhash())
+        assert_equal(int.from_bytes(utxoset_bin[32:36], "little"), self.nodes[0].getblockcount())
+        # The coins are like in the body of a snapshot, after its metadata
+        with open(snapshot_path, "rb") as snapshot:
+            assert_equal(utxoset_bin[36:], snapshot.read()[SNAPSHOT_METADATA_SIZE:])
+        # A new block isn't seen until the coins cache is flushed
+        flushed_hash = self.nodes[0].getbestblockhash()
+        self.generate(self.nodes[0], 1, sync_fun=self.no_op)
+        utxoset_bin = self.test_rest_request("/utxoset", req_type=ReqType.BIN, ret_type=RetType.BYTES)
+        assert_equal(utxoset_bin[:32][::-1].hex(), flushed_hash)
+        self.nodes[0].gettxoutsetinfo()
+        utxoset_bin = self.test_rest_request("/utxoset", req_type=ReqType.BIN, ret_type=RetType.BYTES)
+        assert_equal(utxoset_bin[:32][::-1].hex(), self.nodes[0].getbestblockhash())
+        self.test_rest_request("/utxoset", status=404, req_type=ReqType.JSON, ret_type=RetType.OBJ)
+
         self.log.info("Missing block data should cause REST API to fail")
 
         self.test_rest_request(f"/block/{blockhash}", status=200, req_type=ReqType.BIN, ret_type=RetType.OBJ)
@@ -4,16 +4,26 @@
 # file COPYING or http://www.opensource.org/licenses/mit-license.php.
 """Tests some generic aspects of the RPC interface."""
 
+import base64
+import http.client
 import json
 import os
+import struct
+import urllib.parse
 from dataclasses import dataclass
+from io import BytesIO
+from test_framework.authproxy import JSONRPCException
+from test_framework.messages import deser_compact_size, deser_string, ser_compact_size, ser_string
 from test_framework.test_framework import HyliumTestFramework
-from test_framework.util import assert_equal, assert_greater_than_or_equal
+from test_framework.util import assert_equal, assert_greater_than_or_equal, assert_raises_rpc_error, get_rpc_proxy
 from threading import Thread
 from typing import Optional
-import subprocess
 
 
+RPC_MISC_ERROR             = -1
+RPC_DESERIALIZATION_ERROR  = -22
+RPC_VERIFY_ALREADY_IN_UTXO_SET = -27
+RPC_INVALID_ADDRESS_OR_KEY = -5
 RPC_INVALID_PARAMETER      = -8
 RPC_METHOD_NOT_FOUND       = -32601
 RPC_INVALID_REQUEST        = -32600
@@ -69,6 +79,66 @@ def send_json_rpc(node, body: object) -> tuple[object, int]:
     return send_raw_rpc(node, raw)
 
 
+def ser_binary_value(value) -> bytes:
+    if value is None:
+        return b"\x00"
+    if isinstance(value, bool):
+        return b"\x02" if value else b"\x01"
+    if isinstance(value, (int, float)):
+        return b"\x03" + ser_string(json.dumps(value).encode())
+    if isinstance(value, (str, bytes)):
+        return b"\x04" + ser_string(value.encode() if isinstance(value, str) else value)
+    if isinstance(value, list):
+        return b"\x05" + ser_compact_size(len(value)) + b"".join(ser_binary_value(v) for v in value)
+    return b"\x06" + ser_compact_size(len(value)) + b"".join(ser_string(k.encode()) + ser_binary_value(v) for k, v in value.items())
+
+
+def deser_binary_value(f):
+    tag = f.read(1)[0]
+    if tag <= 2:
+        return [None, False, True][tag]
+    if tag == 3:
+        return json.loads(deser_string(f))
+    if tag == 4:
+        # Left as bytes, as strings can be raw blocks and transactions
+        return deser_string(f)
+    if tag == 5:
+        return [deser_binary_value(f) for _ in range(deser_compact_size(f))]
+    assert_equal(tag, 6)
+    return {deser_string(f).decode(): deser_binary_value(f) for _ in range(deser_compact_size(f))}
+
+
+def send_binary_rpc(node, calls, path="/binary") -> tuple[list, int]:
+    """Send (method, params) calls over the binary transport, returning the (result, error) of each."""
+    body = b""
+    for idx, (method, params) in enumerate(calls):
+        payload = struct.pack("<I", idx) + ser_string(method.encode()) + ser_binary_value(params)
+        body += struct.pack("<I", len(payload)) + payload
+    return send_raw_binary_rpc(node, body, path)
+
+
+def send_raw_binary_rpc(node, body, path="/binary") -> tuple[list, int]:
+    url = urllib.parse.urlparse(node.url)
+    auth = base64.b64encode(f"{url.username}:{url.password}".encode()).decode()
+    conn = http.client.HTTPConnection(url.hostname, url.port)
+    conn.request("POST", path, body, {"Authorization": f"Basic {auth}"})
+    response = conn.getresponse()
+    data = response.read()
+    conn.close()
+    if response.status != 200:
+        return data, response.status
+    replies = []
+    f = BytesIO(data)
+    while f.tell() < len(data):
+        length = struct.unpack("<I", f.read(4))[0]
+        frame = BytesIO(f.read(length))
+        idx, failed = struct.unpack("<IB", frame.read(5))
+        assert_equal(idx, len(replies))
+        value = deser_binary_value(frame)
+        replies.append((None, value) if failed else (value, None))
+    return replies, response.status
+
+
 def expect_http_rpc_status(expected_http_status, expected_rpc_error_code, node, method, params, version=1, notification=False):
     req = format_request(BatchOptions(version, notification), 0, {"method": method, "params": params})
     response, status = send_json_rpc(node, req)
@@ -80,11 +150,14 @@ def expect_http_rpc_status(expected_http_status, expected_rpc_error_code, node,
 
 
 def test_work_queue_getblock(node, got_exceeded_error):
+    # Single waitfornewblock calls are suspended without holding a worker
+    # thread, but calls in a batch block it.
+    rpc = get_rpc_proxy(node.url, node.index, timeout=node.rpc_timeout)
     while not got_exceeded_error:
         try:
-            node.cli("waitfornewblock", "500").send_cli()
-        except subprocess.CalledProcessError as e:
-            assert_equal(e.output, 'error: Server response: Work queue depth exceeded\n')
+            send_json_rpc(rpc, [{"method": "waitfornewblock", "params": [500], "id": 0}])
+        except JSONRPCException as e:
+            assert_equal(e.http_status, 503)
             got_exceeded_error.append(True)
 
 
@@ -105,6 +178,16 @@ class RPCInterfaceTest(HyliumTestFramework):
         assert_greater_than_or_equal(command['duration'], 0)
         assert_equal(info['logpath'], os.path.join(self.nodes[0].chain_path, 'debug.log'))
 
+        work_queue = info['work_queue']
+        assert_equal(work_queue['depth'], 0)
+        assert_equal(work_queue['max_depth'], 64)
+        assert_greater_than_or_equal(work_queue['dispatched'], 1)
+        assert_equal(work_queue['rejected'], 0)
+        assert_greater_than_or_equal(work_queue['max_wait'], 0)
+        assert_greater_than_or_equal(work_queue['total_wait'], work_queue['max_wait'])
+        assert_equal(work_queue['suspended'], 0)
+        assert_equal(info['method_limits'], {})
+
     def test_batch_request(self, call_options):
         calls = [
             # A basic request that will work fine.
@@ -177,6 +260,29 @@ class RPCInterfaceTest(HyliumTestFramework):
             request_fields={"jsonrpc": "2.1"},
             response_fields={"result": None, "error": {"code": RPC_INVALID_REQUEST, "message": "JSON-RPC version not supported"}}))
 
+    def test_parallel_batch(self):
+        self.log.info("Testing batch with calls executed in parallel...")
+        node = self.nodes[0]
+        self.restart_node(0, ['-rpcbatchparallelism=3', '-rpcthreads=2'])
+        self.generate(node, 10)
+        height = node.getblockcount()
+        # Calls to getblockhash and getblockheader run in parallel, but the
+        # responses are in order, and the calls after generatetoaddress see
+        # its block.
+        calls = [{"method": "getblockhash", "params": [h]} for h in range(height + 1)]
+        calls += [{"method": "getblockheader", "params": ["00" * 32]}]
+        calls += [{"method": "generatetoaddress", "params": [1, "rhyl1qqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqqjj9r4q"]}]
+        calls += [{"method": "getblockhash", "params": [h]} for h in range(height + 2)]
+        request = [format_request(BatchOptions(version=2), idx, call) for idx, call in enumerate(calls)]
+        response, status = send_json_rpc(node, request)
+        assert_equal(status, 200)
+        assert_equal([r["id"] for r in response], list(range(len(calls))))
+        hashes = [node.getblockhash(h) for h in range(height + 2)]
+        assert_equal([r["result"] for r in response[:height + 1]], hashes[:height + 1])
+        assert_equal(response[height + 1]["error"]["code"], RPC_INVALID_ADDRESS_OR_KEY)
+        assert_equal(response[height + 2]["result"], hashes[height + 1:])
+        assert_equal([r["result"] for r in response[height + 3:]], hashes)
+
     def test_http_status_codes(self):
         self.log.info("Testing HTTP status codes for JSON-RPC 1.1 requests...")
         # OK
@@ -238,11 +344,137 @@ class RPCInterfaceTest(HyliumTestFramework):
         for t in threads:
             t.join()
 
+    def test_long_poll_suspended(self):
+        self.log.info("Testing that long-polling calls do not hold a worker thread...")
+        node = self.nodes[0]
+        self.restart_node(0, ['-rpcthreads=1'])
+        tip = node.getbestblockhash()
+        results = []
+
+        def wait_for_new_block():
+            rpc = get_rpc_proxy(node.url, node.index, timeout=node.rpc_timeout)
+            results.append(rpc.waitfornewblock())
+
+        threads = [Thread(target=wait_for_new_block) for _ in range(4)]
+        for t in threads:
+            t.start()
+        self.wait_until(lambda: node.getrpcinfo()['work_queue']['suspended'] == 4)
+        # The single worker thread is still available for other calls
+        assert_equal(node.getbestblockhash(), tip)
+        assert_equal(results, [])
+
+        block_hash = self.generate(node, 1)[0]
+        for t in threads:
+            t.join()
+        assert_equal(results, [{"hash": block_hash, "height": node.getblockcount()}] * 4)
+        assert_equal(node.getrpcinfo()['work_queue']['suspended'], 0)
+
+        self.log.info("Testing that no more calls are suspended than the work queue can hold...")
+        self.restart_node(0, ['-rpcthreads=1', '-rpcworkqueue=2'])
+        results.clear()
+        threads = [Thread(target=wait_for_new_block) for _ in range(2)]
+        # Started one at a time, so that the calls never fill the work queue itself
+        for i, t in enumerate(threads):
+            t.start()
+            self.wait_until(lambda: node.getrpcinfo()['work_queue']['suspended'] == i + 1)
+        with node.assert_debug_log(["Request rejected because too many requests are suspended"]):
+            rpc = get_rpc_proxy(node.url, node.index, timeout=node.rpc_timeout)
+            try:
+                rpc.waitfornewblock()
+                assert False, "waitfornewblock was not rejected"
+            except JSONRPCException as e:
+                assert_equal(e.http_status, 503)
+        block_hash = self.generate(node, 1)[0]
+        for t in threads:
+            t.join()
+        assert_equal(results, [{"hash": block_hash, "height": node.getblockcount()}] * 2)
+
+        self.log.info("Testing that suspended calls time out...")
+        assert_equal(node.waitforblockheight(node.getblockcount() + 1, 100), {"hash": block_hash, "height": node.getblockcount()})
+        assert_equal(node.waitforblock("00" * 32, 100)["hash"], block_hash)
+
+    def test_method_limit(self):
+        self.log.info("Testing -rpcmethodlimit...")
+        node = self.nodes[0]
+        self.stop_node(0)
+        node.assert_start_raises_init_error(['-rpcmethodlimit=getblockcount'], "Error: Unable to start HTTP server. See debug log for details.")
+        node.assert_start_raises_init_error(['-rpcmethodlimit=getblockcount:0'], "Error: Unable to start HTTP server. See debug log for details.")
+        self.start_node(0, ['-rpcmethodlimit=waitfornewblock:1', '-rpcthreads=2'])
+        assert_equal(node.getrpcinfo()['method_limits'], {"waitfornewblock": {"limit": 1, "active": 0}})
+
+        # A batched call holds its slot until it returns
+        def batch_wait_for_new_block():
+            rpc = get_rpc_proxy(node.url, node.index, timeout=node.rpc_timeout)
+            send_json_rpc(rpc, [{"method": "waitfornewblock", "params": [5000], "id": 0}])
+
+        t = Thread(target=batch_wait_for_new_block)
+        t.start()
+        self.wait_until(lambda: node.getrpcinfo()['method_limits']['waitfornewblock']['active'] == 1)
+        assert_raises_rpc_error(RPC_MISC_ERROR, "Too many concurrent waitfornewblock calls", node.waitfornewblock, 10)
+        # Other methods are not limited
+        node.getblockcount()
+        self.generate(node, 1)
+        t.join()
+        assert_equal(node.getrpcinfo()['method_limits']['waitfornewblock']['active'], 0)
+        node.waitfornewblock(10)
+
+        # Calls of a batch run in parallel no more than the limit of their method at once
+        self.restart_node(0, ['-rpcmethodlimit=getblock:2', '-rpcbatchparallelism=8', '-rpcthreads=8'])
+        self.generate(node, 10)
+        hashes = [node.getblockhash(h) for h in range(node.getblockcount() + 1)]
+        calls = [{"method": "getblock", "params": [h, 2]} for h in hashes] * 4
+        request = [format_request(BatchOptions(version=2), idx, call) for idx, call in enumerate(calls)]
+        response, status = send_json_rpc(node, request)
+        assert_equal(status, 200)
+        assert all("error" not in r for r in response)
+        assert_equal([r["result"]["hash"] for r in response], hashes * 4)
+        assert_equal(node.getrpcinfo()['method_limits']['getblock']['active'], 0)
+
+    def test_binary_transport(self):
+        self.log.info("Testing the binary transport...")
+        node = self.nodes[0]
+        # Not available by default
+        _, status = send_binary_rpc(node, [("getblockcount", [])])
+        assert_equal(status, 404)
+
+        self.restart_node(0, ['-rpcbinary'])
+        block_hash = node.getbestblockhash()
+        replies, status = send_binary_rpc(node, [
+            ("getblockcount", []),
+            ("getblock", [block_hash, 0]),
+            ("getblock", {"blockhash": block_hash, "verbosity": 1}),
+            ("sendrawtransaction", [b"\x00\x01"]),
+            ("nonexistent", []),
+        ])
+        assert_equal(status, 200)
+        assert_equal(replies[0], (node.getblockcount(), None))
+        # Blocks are returned as is instead of in hex
+        assert_equal(replies[1], (bytes.fromhex(node.getblock(block_hash, 0)), None))
+        assert_equal([txid.decode() for txid in replies[2][0]["tx"]], node.getblock(block_hash, 1)["tx"])
+        assert_equal(replies[3][1]["code"], RPC_DESERIALIZATION_ERROR)
+        assert_equal(replies[4][1]["code"], RPC_METHOD_NOT_FOUND)
+
+        # Transactions are taken as is: the coinbase transaction is decoded, and found in the UTXO set
+        tx_hex = node.getblock(block_hash, 2)["tx"][0]["hex"]
+        replies, _ = send_binary_rpc(node, [("sendrawtransaction", [bytes.fromhex(tx_hex)])])
+        assert_equal(replies[0][1]["code"], RPC_VERIFY_ALREADY_IN_UTXO_SET)
+
+        self.log.info("Testing invalid binary requests...")
+        _, status = send_raw_binary_rpc(node, b"\x05\x00\x00\x00\x00")
+        assert_equal(status, 400)
+        _, status = send_binary_rpc(node, [("getblockcount", [])], path="/binary/other")
+        assert_equal(status, 404)
+
     def run_test(self):
         self.test_getrpcinfo()
         self.test_batch_requests()
         self.test_http_status_codes()
         self.test_work_queue_exceeded()
+        # Mines blocks, so after the tests that expect an empty chain
+        self.test_parallel_batch()
+        self.test_long_poll_suspended()
+        self.test_method_limit()
+        self.test_binary_transport()
 
 
 if __name__ == '__main__':
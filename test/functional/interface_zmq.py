@@ -25,6 +25,7 @@ from test_framework.messages import (
 )
 from test_framework.util import (
     assert_equal,
+    assert_raises,
     assert_raises_rpc_error,
     ensure_for,
     p2p_port,
@@ -129,6 +130,7 @@ class ZMQTest (HyliumTestFramework):
             self.test_mempool_sync()
             self.test_reorg()
             self.test_multiple_interfaces()
+            self.test_queue_size()
             self.test_ipv6()
         finally:
             # Destroy the ZMQ context.
@@ -137,7 +139,7 @@ class ZMQTest (HyliumTestFramework):
 
     # Restart node with the specified zmq notifications enabled, subscribe to
     # all of them and return the corresponding ZMQSubscriber objects.
-    def setup_zmq_test(self, services, *, recv_timeout=60, sync_blocks=True, ipv6=False):
+    def setup_zmq_test(self, services, *, recv_timeout=60, sync_blocks=True, ipv6=False, extra_args=()):
         subscribers = []
         for topic, address in services:
             socket = self.ctx.socket(zmq.SUB)
@@ -145,7 +147,7 @@ class ZMQTest (HyliumTestFramework):
                 socket.setsockopt(zmq.IPV6, 1)
             subscribers.append(ZMQSubscriber(socket, topic.encode()))
 
-        self.restart_node(0, [f"-zmqpub{topic}={address.replace('ipc://', 'unix:')}" for topic, address in services])
+        self.restart_node(0, [f"-zmqpub{topic}={address.replace('ipc://', 'unix:')}" for topic, address in services] + list(extra_args))
 
         for i, sub in enumerate(subscribers):
             sub.socket.connect(services[i][1])
@@ -252,10 +254,10 @@ class ZMQTest (HyliumTestFramework):
 
         self.log.info("Test the getzmqnotifications RPC")
         assert_equal(self.nodes[0].getzmqnotifications(), [
-            {"type": "pubhashblock", "address": address, "hwm": 1000},
-            {"type": "pubhashtx", "address": address, "hwm": 1000},
-            {"type": "pubrawblock", "address": address, "hwm": 1000},
-            {"type": "pubrawtx", "address": address, "hwm": 1000},
+            {"type": "pubhashblock", "address": address, "hwm": 1000, "queued": 0, "dropped": 0},
+            {"type": "pubhashtx", "address": address, "hwm": 1000, "queued": 0, "dropped": 0},
+            {"type": "pubrawblock", "address": address, "hwm": 1000, "queued": 0, "dropped": 0},
+            {"type": "pubrawtx", "address": address, "hwm": 1000, "queued": 0, "dropped": 0},
         ])
 
         assert_equal(self.nodes[1].getzmqnotifications(), [])
@@ -572,6 +574,55 @@ class ZMQTest (HyliumTestFramework):
         assert_equal(self.nodes[0].getbestblockhash(), subscribers[0].receive().hex())
         assert_equal(self.nodes[0].getbestblockhash(), subscribers[1].receive().hex())
 
+    def test_queue_size(self):
+        address = f"tcp://127.0.0.1:{self.zmq_port_base}"
+        node = self.nodes[0]
+        num_txs = 1200
+
+        self.log.info("Test that a block with more transactions than the high water mark notifies of all of them")
+        [hashtx] = self.setup_zmq_test([("hashtx", address)])
+        assert_equal(node.getzmqnotifications()[0]["hwm"], 1000)
+        # One transaction with an output for each transaction of the block
+        utxos = self.wallet.send_self_transfer_multi(from_node=node, num_outputs=num_txs + 100)["new_utxos"]
+        self.generatetoaddress(node, 1, ADDRESS_BCRT1_UNSPENDABLE)
+        for _ in range(3):
+            hashtx.receive()
+        txids = [self.wallet.send_self_transfer(from_node=node, utxo_to_spend=utxos.pop())["txid"] for _ in range(num_txs)]
+        for txid in txids:
+            assert_equal(hashtx.receive().hex(), txid)
+        block_hash = self.generatetoaddress(node, 1, ADDRESS_BCRT1_UNSPENDABLE)[0]
+        # The subscriber checks that the sequence numbers have no gap
+        assert_equal(sorted(hashtx.receive().hex() for _ in range(num_txs + 1)), sorted(node.getblock(block_hash)["tx"]))
+        assert_equal(node.getzmqnotifications(), [{"type": "pubhashtx", "address": address, "hwm": 1000, "queued": 0, "dropped": 0}])
+
+        self.log.info("Test that messages beyond -zmqqueuesize are dropped, and their sequence numbers skipped")
+        [hashtx] = self.setup_zmq_test([("hashtx", address)], extra_args=["-zmqqueuesize=1"], recv_timeout=2)
+        txs = [self.wallet.create_self_transfer(utxo_to_spend=utxos.pop())["hex"] for _ in range(len(utxos))]
+        block = create_block(int(node.getbestblockhash(), 16), create_coinbase(node.getblockcount() + 1), txlist=txs)
+        add_witness_commitment(block)
+        block.solve()
+        first_sequence = hashtx.sequence
+        assert_equal(node.submitblock(block.serialize().hex()), None)
+        # All the messages of the block are queued at once, faster than they are sent
+        self.wait_until(lambda: node.getzmqnotifications()[0]["queued"] == 0)
+        dropped = node.getzmqnotifications()[0]["dropped"]
+        assert dropped > 0
+        received = []
+        while len(received) < len(block.vtx) - dropped:
+            _, body, seq = hashtx.socket.recv_multipart()
+            received.append((struct.unpack('<I', seq)[-1], body.hex()))
+        # Nothing else is received
+        assert_raises(zmq.error.Again, hashtx.socket.recv_multipart)
+        sequences = [sequence for sequence, _ in received]
+        assert_equal(sequences, sorted(sequences))
+        assert all(first_sequence <= sequence < first_sequence + len(block.vtx) for sequence in sequences)
+        # The messages received are of the transactions of the block, in order
+        expected = [tx.txid_hex for tx in block.vtx]
+        for sequence, txid in received:
+            assert_equal(txid, expected[sequence - first_sequence])
+        self.sync_blocks()
+        self.wallet.rescan_utxos()
+
     def test_ipv6(self):
         if not test_ipv6_local():
             self.log.info("Skipping IPv6 test, because IPv6 is not supported.")
@@ -0,0 +1,194 @@
+#!/usr/bin/env python3
+# Copyright (c) 2025- The Hylium Core developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""
+Test the adaptive block download scheduler during IBD:
+
+- a block that holds back the download window at a slow peer is re-requested
+  from a faster peer before the stalling timeout disconnects the slow peer
+- a peer that has been measured to deliver blocks slowly is allowed fewer than
+  the default 16 blocks in flight, and one that delivers them quickly more
+
+Mock time moves on by a second before each batch of blocks a peer delivers, so
+the node measures the first block of a batch to take a second and the others
+no time.
+"""
+
+import time
+
+from test_framework.blocktools import (
+        create_block,
+        create_coinbase
+)
+from test_framework.messages import (
+        MSG_BLOCK,
+        MSG_TYPE_MASK,
+)
+from test_framework.p2p import (
+        CBlockHeader,
+        msg_block,
+        msg_headers,
+        p2p_lock,
+        P2PDataStore,
+)
+from test_framework.test_framework import HyliumTestFramework
+from test_framework.util import (
+        assert_equal,
+)
+
+BLOCK_DOWNLOAD_WINDOW = 1024
+DEFAULT_BLOCKS_IN_TRANSIT = 16
+MAX_BLOCKS_IN_TRANSIT_ADAPTIVE = 32
+# The in-flight limit keeps about this many seconds of downloads queued
+BLOCK_DOWNLOAD_QUEUE_TARGET = 4
+
+
+class P2PDelayedBlockProvider(P2PDataStore):
+    """Serves blocks from its block store, except for withheld blocks, which
+    are only sent once the test releases them (i.e. with artificial latency)."""
+    def __init__(self, withheld):
+        self.withheld = withheld
+        self.held_back = []
+        self.released = set()
+        super().__init__()
+
+    def on_getdata(self, message):
+        for inv in message.inv:
+            self.getdata_requests.append(inv.hash)
+            if (inv.type & MSG_TYPE_MASK) == MSG_BLOCK:
+                if inv.hash not in self.withheld:
+                    self.send_without_ping(msg_block(self.block_store[inv.hash]))
+                else:
+                    self.held_back.append(inv.hash)
+
+    def on_getheaders(self, message):
+        pass
+
+    def withheld_requests(self):
+        """The blocks requested from this peer that were withheld and not released yet."""
+        with p2p_lock:
+            return [h for h in self.held_back if h not in self.released]
+
+    def release(self, block_hashes):
+        for block_hash in block_hashes:
+            self.send_without_ping(msg_block(self.block_store[block_hash]))
+            self.released.add(block_hash)
+        self.sync_with_ping()
+
+
+class P2PIBDAdaptiveDownloadTest(HyliumTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 1
+        self.extra_args = [["-debug=net"]]
+
+    def create_blocks(self, tip, height, block_time, count):
+        blocks = []
+        for _ in range(count):
+            blocks.append(create_block(tip, create_coinbase(height), block_time))
+            blocks[-1].solve()
+            tip = blocks[-1].hash_int
+            block_time += 1
+            height += 1
+        return blocks
+
+    def bump_mocktime(self, seconds=1):
+        self.mocktime += seconds
+        self.nodes[0].setmocktime(self.mocktime)
+
+    def deliver_batch(self, peer):
+        """Wait for the node to request withheld blocks from peer, and deliver them a second later."""
+        self.wait_until(lambda: len(peer.withheld_requests()) > 0)
+        self.bump_mocktime()
+        peer.release(peer.withheld_requests())
+
+    def inflight(self, peer_id):
+        return len(next(p for p in self.nodes[0].getpeerinfo() if p['id'] == peer_id)['inflight'])
+
+    def run_test(self):
+        NUM_BLOCKS = 1030
+        node = self.nodes[0]
+        best_block = node.getblock(node.getbestblockhash())
+        self.log.info("Prepare blocks without sending them to the node")
+        blocks = self.create_blocks(int(best_block['hash'], 16), 1, best_block['time'] + 1, NUM_BLOCKS)
+        block_dict = {b.hash_int: b for b in blocks}
+        headers_message = msg_headers()
+        headers_message.headers = [CBlockHeader(b) for b in blocks]
+
+        # Mock time only moves on when a peer delivers blocks: the slow peer must not be
+        # disconnected by the stalling timeout, so only an early re-request can move the window.
+        self.mocktime = int(time.time())
+        node.setmocktime(self.mocktime)
+
+        self.log.info("Let a slow peer hold back the first blocks of the download window")
+        slow_peer = node.add_outbound_p2p_connection(P2PDelayedBlockProvider(set(block_dict)), p2p_idx=0, connection_type="outbound-full-relay")
+        slow_peer.block_store = block_dict
+        slow_peer_id = node.getpeerinfo()[-1]['id']
+        slow_peer.send_and_ping(headers_message)
+        self.wait_until(lambda: self.inflight(slow_peer_id) == DEFAULT_BLOCKS_IN_TRANSIT)
+
+        self.log.info("Check that a faster peer is asked for the stalled block before the slow peer times out")
+        fast_peer = node.add_outbound_p2p_connection(P2PDelayedBlockProvider(set(block_dict)), p2p_idx=1, connection_type="outbound-full-relay")
+        fast_peer.block_store = block_dict
+        with node.busy_wait_for_debug_log([f"Stall started peer={slow_peer_id}".encode()]):
+            fast_peer.send_and_ping(headers_message)
+            # Until the fast peer delivered the blocks of the window not held by the slow peer
+            while len(fast_peer.released) < BLOCK_DOWNLOAD_WINDOW - DEFAULT_BLOCKS_IN_TRANSIT:
+                self.deliver_batch(fast_peer)
+        assert_equal(node.getblockcount(), 0)
+        # A second is more than twice the time the fast peer was measured to need for a block, but
+        # less than the stalling timeout
+        with node.assert_debug_log(expected_msgs=[f"Re-requesting stalled block {blocks[0].hash_hex} (1) from peer="]):
+            self.bump_mocktime()
+            self.wait_until(lambda: blocks[0].hash_int in fast_peer.withheld_requests())
+        fast_peer.release([blocks[0].hash_int])
+        # Let the slow peer catch up, and both peers serve the blocks after the window
+        with p2p_lock:
+            fast_peer.withheld.clear()
+            slow_peer.withheld.clear()
+        slow_peer.release([b.hash_int for b in blocks[1:DEFAULT_BLOCKS_IN_TRANSIT]])
+        fast_peer.release(fast_peer.withheld_requests())
+        self.wait_until(lambda: node.getblockcount() == NUM_BLOCKS)
+        assert_equal(node.num_test_p2p_connections(), 2)
+
+        self.log.info("Check that a peer measured to be slow gets a smaller in-flight window")
+        node.disconnect_p2ps()
+        more_blocks = self.create_blocks(blocks[-1].hash_int, NUM_BLOCKS + 1, blocks[-1].nTime + 1, 100)
+        more_headers = msg_headers([CBlockHeader(b) for b in more_blocks])
+        slow_peer = node.add_outbound_p2p_connection(P2PDelayedBlockProvider({b.hash_int for b in more_blocks}), p2p_idx=2, connection_type="outbound-full-relay")
+        slow_peer.block_store = {b.hash_int: b for b in more_blocks}
+        slow_peer_id = node.getpeerinfo()[-1]['id']
+        slow_peer.send_and_ping(more_headers)
+        self.wait_until(lambda: self.inflight(slow_peer_id) == DEFAULT_BLOCKS_IN_TRANSIT)
+        # Deliver the blocks in flight one by one, a second apart
+        slow_delivery_time = 1
+        for i, block in enumerate(more_blocks[:DEFAULT_BLOCKS_IN_TRANSIT]):
+            self.bump_mocktime(slow_delivery_time)
+            slow_peer.release([block.hash_int])
+            assert_equal(node.getblockcount(), NUM_BLOCKS + i + 1)
+        # Blocks are only requested again once the ones in flight are below the limit, and then
+        # no more than the limit, although the peer announced many more
+        slow_limit = BLOCK_DOWNLOAD_QUEUE_TARGET // slow_delivery_time
+        assert slow_limit < DEFAULT_BLOCKS_IN_TRANSIT
+        self.wait_until(lambda: len(slow_peer.getdata_requests) == DEFAULT_BLOCKS_IN_TRANSIT + slow_limit)
+        slow_peer.sync_with_ping()
+        assert_equal(len(slow_peer.getdata_requests), DEFAULT_BLOCKS_IN_TRANSIT + slow_limit)
+        assert_equal(self.inflight(slow_peer_id), slow_limit)
+
+        self.log.info("Check that a peer measured to be fast gets a larger in-flight window")
+        # Announce the blocks of a longer chain too, to see how many the node requests at once
+        longer_blocks = self.create_blocks(more_blocks[-1].hash_int, NUM_BLOCKS + 101, more_blocks[-1].nTime + 1, 100)
+        fast_peer = node.add_outbound_p2p_connection(P2PDelayedBlockProvider({b.hash_int for b in more_blocks + longer_blocks}), p2p_idx=3, connection_type="outbound-full-relay")
+        fast_peer.block_store = {b.hash_int: b for b in more_blocks + longer_blocks}
+        fast_peer_id = node.getpeerinfo()[-1]['id']
+        fast_peer.send_and_ping(msg_headers([CBlockHeader(b) for b in more_blocks + longer_blocks]))
+        # Until the fast peer delivered the blocks not held by the slow peer
+        while len(fast_peer.released) < len(more_blocks) - DEFAULT_BLOCKS_IN_TRANSIT - slow_limit:
+            self.deliver_batch(fast_peer)
+        self.wait_until(lambda: self.inflight(fast_peer_id) == MAX_BLOCKS_IN_TRANSIT_ADAPTIVE)
+        assert MAX_BLOCKS_IN_TRANSIT_ADAPTIVE > DEFAULT_BLOCKS_IN_TRANSIT
+        assert_equal(self.inflight(slow_peer_id), slow_limit)
+
+if __name__ == '__main__':
+    P2PIBDAdaptiveDownloadTest(__file__).main()
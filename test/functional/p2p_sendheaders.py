@@ -65,8 +65,9 @@ c. Announce 1 header that forks off the last two blocks.
    Expect: no response.
 d. Announce 1 more header that builds on that fork.
    Expect: one getdata request for two blocks.
-e. Announce 16 more headers that build on that fork.
-   Expect: getdata request for 14 more blocks.
+e. Announce 32 more headers that build on that fork.
+   Expect: getdata request for 30 more blocks (test_node delivered its
+   earlier blocks at once, so its in-flight limit has grown to 32).
 f. Announce 1 more header that builds on that fork.
    Expect: no response.
 
@@ -476,7 +477,7 @@ class SendHeadersTest(HyliumTestFramework):
         blocks = []
 
         # Create extra blocks for later
-        for _ in range(20):
+        for _ in range(36):
             blocks.append(create_block(tip, create_coinbase(height), block_time))
             blocks[-1].solve()
             tip = blocks[-1].hash_int
@@ -497,15 +498,16 @@ class SendHeadersTest(HyliumTestFramework):
         test_node.sync_with_ping()
         test_node.wait_for_getdata([x.hash_int for x in blocks[0:2]], timeout=DIRECT_FETCH_RESPONSE_TIME)
 
-        # Announcing 16 more headers should trigger direct fetch for 14 more
-        # blocks
-        test_node.send_header_for_blocks(blocks[2:18])
+        # Announcing 32 more headers should trigger direct fetch for 30 more
+        # blocks: as test_node delivered its earlier blocks at once, it may
+        # have the largest adaptive number of blocks in flight, 32.
+        test_node.send_header_for_blocks(blocks[2:34])
         test_node.sync_with_ping()
-        test_node.wait_for_getdata([x.hash_int for x in blocks[2:16]], timeout=DIRECT_FETCH_RESPONSE_TIME)
+        test_node.wait_for_getdata([x.hash_int for x in blocks[2:32]], timeout=DIRECT_FETCH_RESPONSE_TIME)
 
         # Announcing 1 more header should not trigger any response
         test_node.last_message.pop("getdata", None)
-        test_node.send_header_for_blocks(blocks[18:19])
+        test_node.send_header_for_blocks(blocks[34:35])
         test_node.sync_with_ping()
         with p2p_lock:
             assert "getdata" not in test_node.last_message
@@ -91,6 +91,7 @@ class BlockchainTest(HyliumTestFramework):
 
         self._test_getblockchaininfo()
         self._test_getchaintxstats()
+        self._test_getdbstats()
         self._test_gettxoutsetinfo()
         self._test_gettxout()
         self._test_getblockheader()
@@ -304,6 +305,17 @@ class BlockchainTest(HyliumTestFramework):
         last = self.generate(self.nodes[0], 6)[-1]
         assert_equal(self.nodes[0].getblockheader(last)["mediantime"], time_2106)
 
+    def _test_getdbstats(self):
+        self.log.info("Test getdbstats")
+        res = self.nodes[0].getdbstats()
+        assert_equal(sorted(res.keys()), ['blockindex', 'chainstate'])
+        for stats in res.values():
+            assert_equal(stats['engine'], 'leveldb')
+            assert_equal(len(stats['levels']), 7)
+            for level in stats['levels']:
+                assert_equal(sorted(level.keys()), ['bytes', 'compaction_bytes_read', 'compaction_bytes_written', 'compaction_time', 'files'])
+            assert_equal([stall['cause'] for stall in stats['write_stalls']], ['level0_slowdown', 'memtable_full', 'level0_stop'])
+
     def _test_getchaintxstats(self):
         self.log.info("Test getchaintxstats")
 
@@ -273,6 +273,7 @@ BASE_SCRIPTS = [
     'p2p_outbound_eviction.py',
     'p2p_ibd_stalling.py --v1transport',
     'p2p_ibd_stalling.py --v2transport',
+    'p2p_ibd_adaptive_download.py',
     'p2p_net_deadlock.py --v1transport',
     'p2p_net_deadlock.py --v2transport',
     'wallet_signmessagewithaddress.py',
@@ -353,6 +354,7 @@ BASE_SCRIPTS = [
     'feature_anchors.py',
     'mempool_datacarrier.py',
     'feature_coinstatsindex.py',
+    'feature_scripthashindex.py',
     'feature_coinstatsindex_compatibility.py',
     'wallet_orphanedreward.py',
     'wallet_musig.py',